@@ -0,0 +1,143 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadasyncreader.h"
+
+CADAsyncReader::CADAsyncReader(CADFile * const file, size_t threadCount) :
+    pCADFile(file), ownPool(new CADThreadPool(0 == threadCount ? 1 :
+                                                                 threadCount)),
+    pool(*ownPool), pendingTasks(0)
+{
+}
+
+CADAsyncReader::CADAsyncReader(CADFile * const file, CADThreadPool& pool) :
+    pCADFile(file), pool(pool), pendingTasks(0)
+{
+}
+
+CADAsyncReader::~CADAsyncReader()
+{
+    // the queued requests use the cursors, wait for them
+    std::unique_lock<std::mutex> lock(cursorsMutex);
+    idleCondition.wait (lock, [this] { return 0 == pendingTasks; });
+}
+
+std::future<CADGeometry*> CADAsyncReader::getGeometry(size_t layerIndex,
+                                                      size_t index)
+{
+    return addTask<CADGeometry*> ([layerIndex, index](CADFileCursor& cursor)
+    {
+        return cursor.getGeometry (layerIndex, index);
+    });
+}
+
+std::future<CADGeometry*> CADAsyncReader::getGeometry(size_t layerIndex,
+                                                      size_t index,
+                                                      int projection)
+{
+    return addTask<CADGeometry*> ([layerIndex, index, projection](
+                                  CADFileCursor& cursor)
+    {
+        return cursor.getGeometry (layerIndex, index, projection);
+    });
+}
+
+std::future<CADImage*> CADAsyncReader::getImage(size_t layerIndex,
+                                                size_t index)
+{
+    return addTask<CADImage*> ([layerIndex, index](CADFileCursor& cursor)
+    {
+        return cursor.getImage (layerIndex, index);
+    });
+}
+
+std::future<size_t> CADAsyncReader::readGeometries(size_t layerIndex,
+                                                   GeometryCallback callback)
+{
+    const size_t geometryCount =
+            pCADFile->getLayer (layerIndex).getGeometryCount ();
+    return addTask<size_t> ([layerIndex, geometryCount, callback](
+                            CADFileCursor& cursor)
+    {
+        size_t count = 0;
+        while(count < geometryCount)
+        {
+            CADGeometry* geometry = cursor.getGeometry (layerIndex, count);
+            ++count;
+            if(!callback(geometry))
+                break;
+        }
+        return count;
+    });
+}
+
+template<class Result>
+std::future<Result> CADAsyncReader::addTask(
+        std::function<Result(CADFileCursor&)> read)
+{
+    auto task = std::make_shared< std::packaged_task<Result(CADFileCursor&)> >(
+                std::move(read));
+    std::future<Result> result = task->get_future ();
+    {
+        std::lock_guard<std::mutex> lock(cursorsMutex);
+        ++pendingTasks;
+    }
+    pool.addTask ([this, task]()
+    {
+        CADFileCursor* cursor = acquireCursor ();
+        (*task)(*cursor);
+        releaseCursor (cursor);
+    });
+    return result;
+}
+
+CADFileCursor* CADAsyncReader::acquireCursor()
+{
+    {
+        std::lock_guard<std::mutex> lock(cursorsMutex);
+        if(!cursors.empty ())
+        {
+            CADFileCursor* cursor = cursors.back ().release ();
+            cursors.pop_back ();
+            return cursor;
+        }
+    }
+    // no free cursor, one more request of this reader runs concurrently
+    return pCADFile->createCursor ();
+}
+
+void CADAsyncReader::releaseCursor(CADFileCursor* cursor)
+{
+    std::lock_guard<std::mutex> lock(cursorsMutex);
+    cursors.push_back (std::unique_ptr<CADFileCursor>(cursor));
+    --pendingTasks;
+    // notify under the lock, the waiting destructor frees the condition
+    idleCondition.notify_all ();
+}
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADASYNCREADER_H
+#define CADASYNCREADER_H
+
+#include "cadfile.h"
+#include "cadthreadpool.h"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The asynchronous reader of the CAD file geometries. The requests are
+ * queued to the thread pool, each running request reads with its own
+ * CADFileCursor. A slow file read holds one pool thread only, the calling
+ * thread continues and gets the result from the returned future. The pool
+ * may be shared by the readers of several files. The reader must be freed
+ * before the file, freeing waits for the queued requests.
+ */
+class OCAD_EXTERN CADAsyncReader
+{
+public:
+    /**
+     * @brief The layer geometries callback, called in the reader thread
+     * @param geometry Geometry pointer or nullptr if failed, the pointer
+     * have to be freed by callback
+     * @return false to stop the layer read
+     */
+    typedef std::function<bool(CADGeometry* geometry)> GeometryCallback;
+
+public:
+    /**
+     * @brief Create the asynchronous reader with its own thread pool
+     * @param file Parsed CAD file
+     * @param threadCount Reader threads count
+     */
+    CADAsyncReader(CADFile * const file, size_t threadCount = 2);
+    /**
+     * @brief Create the asynchronous reader running on the shared pool
+     * @param file Parsed CAD file
+     * @param pool Thread pool, must outlive the reader
+     */
+    CADAsyncReader(CADFile * const file, CADThreadPool& pool);
+    virtual ~CADAsyncReader();
+
+    /**
+     * @brief Queue the layer geometry read
+     * @param layerIndex Layer index
+     * @param index Geometry index in the layer
+     * @return future geometry, NULL if failed or pointer which mast be feed
+     * by user
+     */
+    std::future<CADGeometry*> getGeometry(size_t layerIndex, size_t index);
+    /**
+     * @brief Queue the layer geometry read with only the requested properties
+     * decoded
+     * @param layerIndex Layer index
+     * @param index Geometry index in the layer
+     * @param projection CADFile::ProjectionFlags mask
+     * @return future geometry, NULL if failed or pointer which mast be feed
+     * by user
+     */
+    std::future<CADGeometry*> getGeometry(size_t layerIndex, size_t index,
+                                          int projection);
+    /**
+     * @brief Queue the layer image read
+     * @param layerIndex Layer index
+     * @param index Image index in the layer
+     * @return future image, NULL if failed or pointer which mast be feed by
+     * user
+     */
+    std::future<CADImage*> getImage(size_t layerIndex, size_t index);
+    /**
+     * @brief Queue the read of all layer geometries in order, each geometry
+     * is passed to the callback as soon as it is decoded
+     * @param layerIndex Layer index
+     * @param callback Geometry callback
+     * @return future count of geometries passed to the callback
+     */
+    std::future<size_t> readGeometries(size_t layerIndex,
+                                       GeometryCallback callback);
+
+protected:
+    /**
+     * @brief Queue the read to the pool, the read gets a free cursor
+     */
+    template<class Result>
+    std::future<Result> addTask(std::function<Result(CADFileCursor&)> read);
+    CADFileCursor* acquireCursor();
+    void releaseCursor(CADFileCursor* cursor);
+
+protected:
+    CADFile * const          pCADFile;
+    std::unique_ptr<CADThreadPool> ownPool;
+    CADThreadPool&           pool;
+    std::vector<std::unique_ptr<CADFileCursor> > cursors; // free cursors
+    std::mutex               cursorsMutex;
+    std::condition_variable  idleCondition;
+    size_t                   pendingTasks;
+};
+
+#endif // CADASYNCREADER_H
@@ -0,0 +1,160 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#include "cadbufferio.h"
+
+#include <cstring>
+
+CADBufferIO::CADBufferIO(const char* pszFileName, const void* pData,
+                         size_t nSize) : CADFileIO(pszFileName),
+    m_pData(static_cast<const char*>(pData)),
+    m_nSize(nSize),
+    m_nPosition(0),
+    m_bEof(false)
+{
+
+}
+
+CADBufferIO::CADBufferIO(const char* pszFileName,
+                         std::shared_ptr<const char> pData,
+                         size_t nSize) : CADFileIO(pszFileName),
+    m_pSharedData(pData),
+    m_pData(pData.get()),
+    m_nSize(nSize),
+    m_nPosition(0),
+    m_bEof(false)
+{
+
+}
+
+CADBufferIO::~CADBufferIO()
+{
+
+}
+
+const char* CADBufferIO::ReadLine()
+{
+    if(m_nPosition >= m_nSize)
+    {
+        m_bEof = true;
+        return nullptr;
+    }
+
+    const char* pszStart = m_pData + m_nPosition;
+    const void* pEnd = memchr(pszStart, '\n', m_nSize - m_nPosition);
+    size_t nLength = pEnd ? static_cast<const char*>(pEnd) - pszStart :
+                            m_nSize - m_nPosition;
+    m_nPosition += pEnd ? nLength + 1 : nLength;
+    if(nLength > 0 && pszStart[nLength - 1] == '\r')
+        --nLength;
+    m_osLine.assign(pszStart, nLength);
+    return m_osLine.c_str();
+}
+
+bool CADBufferIO::Eof()
+{
+    return m_bEof;
+}
+
+bool CADBufferIO::Open(int mode)
+{
+    if(mode & OpenMode::write)
+        return false;
+
+    m_nPosition = 0;
+    m_bEof = false;
+    m_bIsOpened = m_pData != nullptr || m_nSize == 0;
+    return m_bIsOpened;
+}
+
+int CADBufferIO::Seek(long offset, CADFileIO::SeekOrigin origin)
+{
+    long nBase = 0;
+    switch (origin) {
+    case SeekOrigin::CUR:
+        nBase = static_cast<long>(m_nPosition);
+        break;
+    case SeekOrigin::END:
+        nBase = static_cast<long>(m_nSize);
+        break;
+    case SeekOrigin::BEG:
+        break;
+    }
+
+    if(offset < -nBase || nBase + offset > static_cast<long>(m_nSize))
+        return 1;
+    m_nPosition = static_cast<size_t>(nBase + offset);
+    m_bEof = false;
+    return 0;
+}
+
+long CADBufferIO::Tell()
+{
+    return static_cast<long>(m_nPosition);
+}
+
+size_t CADBufferIO::Read(void* ptr, size_t size)
+{
+    size_t nAvailable = m_nSize - m_nPosition;
+    if(size > nAvailable)
+    {
+        size = nAvailable;
+        m_bEof = true;
+    }
+    if(size > 0)
+        memcpy(ptr, m_pData + m_nPosition, size);
+    m_nPosition += size;
+    return size;
+}
+
+size_t CADBufferIO::Write(void* /*ptr*/, size_t /*size*/)
+{
+    // unsupported
+    return 0;
+}
+
+void CADBufferIO::Rewind()
+{
+    m_nPosition = 0;
+    m_bEof = false;
+}
+
+const char* CADBufferIO::GetData(size_t& size) const
+{
+    size = m_nSize;
+    return m_pData;
+}
+
+CADFileIO* CADBufferIO::Clone() const
+{
+    if(m_pSharedData)
+        return new CADBufferIO(m_soFilePath.c_str(), m_pSharedData, m_nSize);
+    return new CADBufferIO(m_soFilePath.c_str(), m_pData, m_nSize);
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#ifndef CADBUFFERIO_H
+#define CADBUFFERIO_H
+
+#include "cadfileio.h"
+
+#include <memory>
+
+/**
+ * @brief The CADBufferIO class reads the CAD file from the memory buffer. The
+ * buffer is either owned by the caller and have to outlive the in/out and its
+ * clones, or shared with them.
+ */
+class CADBufferIO : public CADFileIO
+{
+public:
+    /**
+     * @brief Constructor
+     * @param pszFileName File name, the extension is used to detect the format
+     * @param pData Caller owned buffer
+     * @param nSize Buffer size
+     */
+    CADBufferIO(const char* pszFileName, const void* pData, size_t nSize);
+    /**
+     * @brief Constructor
+     * @param pszFileName File name, the extension is used to detect the format
+     * @param pData Shared buffer, kept alive by the in/out and its clones
+     * @param nSize Buffer size
+     */
+    CADBufferIO(const char* pszFileName, std::shared_ptr<const char> pData,
+                size_t nSize);
+    virtual             ~CADBufferIO();
+
+    virtual const char* ReadLine() override;
+    virtual bool        Eof() override;
+    virtual bool        Open(int mode) override;
+    virtual int         Seek(long int offset, SeekOrigin origin) override;
+    virtual long int    Tell() override;
+    virtual size_t      Read(void* ptr, size_t size) override;
+    virtual size_t      Write(void* ptr, size_t size) override;
+    virtual void        Rewind() override;
+    virtual CADFileIO*  Clone() const override;
+    virtual const char* GetData(size_t& size) const override;
+protected:
+    std::shared_ptr<const char> m_pSharedData;
+    const char*         m_pData;
+    size_t              m_nSize;
+    size_t              m_nPosition;
+    bool                m_bEof;
+    std::string         m_osLine;
+};
+
+#endif // CADBUFFERIO_H
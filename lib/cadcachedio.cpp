@@ -0,0 +1,287 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#include "cadcachedio.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static const size_t NO_BLOCK = static_cast<size_t>(-1);
+
+double CADCachedIO::Statistics::getHitRate() const
+{
+    size_t nLookups = blockHits + blockMisses;
+    return nLookups == 0 ? 0.0 : double(blockHits) / nLookups;
+}
+
+CADCachedIO::CADCachedIO(CADFileIO* poBackend, size_t nBlockSize,
+                         size_t nMaxBlocks, size_t nMaxReadahead) :
+    CADFileIO(poBackend->GetFilePath()),
+    m_poBackend(poBackend),
+    m_nBlockSize(max(nBlockSize, size_t(1))),
+    m_nMaxBlocks(max(nMaxBlocks, size_t(1))),
+    m_nMaxReadahead(nMaxReadahead),
+    m_nFileSize(0),
+    m_nPosition(0),
+    m_bEof(false),
+    m_nLastBlock(NO_BLOCK),
+    m_nReadahead(0)
+{
+
+}
+
+CADCachedIO::~CADCachedIO()
+{
+    if(IsOpened())
+        Close();
+    delete m_poBackend;
+}
+
+const char* CADCachedIO::ReadLine()
+{
+    m_osLine.clear();
+    char c;
+    bool bRead = false;
+    while(Read(&c, 1) == 1)
+    {
+        bRead = true;
+        if(c == '\n')
+            break;
+        m_osLine += c;
+    }
+    if(!bRead)
+        return nullptr;
+    if(!m_osLine.empty() && m_osLine.back() == '\r')
+        m_osLine.pop_back();
+    return m_osLine.c_str();
+}
+
+bool CADCachedIO::Eof()
+{
+    return m_bEof;
+}
+
+bool CADCachedIO::Open(int mode)
+{
+    if(mode & OpenMode::write)
+        return false;
+
+    if(!m_poBackend->IsOpened() && !m_poBackend->Open(mode))
+        return false;
+
+    if(m_poBackend->Seek(0, SeekOrigin::END) != 0)
+        return false;
+    long nFileSize = m_poBackend->Tell();
+    if(nFileSize < 0)
+        return false;
+
+    m_nFileSize = static_cast<size_t>(nFileSize);
+    m_nPosition = 0;
+    m_bEof = false;
+    m_nLastBlock = NO_BLOCK;
+    m_nReadahead = 0;
+    m_bIsOpened = true;
+    return true;
+}
+
+bool CADCachedIO::Close()
+{
+    m_oBlocks.clear();
+    m_oRecentBlocks.clear();
+    m_poBackend->Close();
+    return CADFileIO::Close();
+}
+
+int CADCachedIO::Seek(long offset, CADFileIO::SeekOrigin origin)
+{
+    long nBase = 0;
+    switch (origin) {
+    case SeekOrigin::CUR:
+        nBase = static_cast<long>(m_nPosition);
+        break;
+    case SeekOrigin::END:
+        nBase = static_cast<long>(m_nFileSize);
+        break;
+    case SeekOrigin::BEG:
+        break;
+    }
+
+    if(offset < -nBase || nBase + offset > static_cast<long>(m_nFileSize))
+        return 1;
+    m_nPosition = static_cast<size_t>(nBase + offset);
+    m_bEof = false;
+    return 0;
+}
+
+long CADCachedIO::Tell()
+{
+    return static_cast<long>(m_nPosition);
+}
+
+size_t CADCachedIO::Read(void* ptr, size_t size)
+{
+    ++m_oStatistics.reads;
+    if(!m_bIsOpened || size == 0)
+        return 0;
+    if(m_nPosition >= m_nFileSize)
+    {
+        m_bEof = true;
+        return 0;
+    }
+    if(size > m_nFileSize - m_nPosition)
+    {
+        size = m_nFileSize - m_nPosition;
+        m_bEof = true;
+    }
+
+    size_t nFirstBlock = m_nPosition / m_nBlockSize;
+    size_t nLastBlock = (m_nPosition + size - 1) / m_nBlockSize;
+
+    // the reads continuing the previous one double the readahead window,
+    // random reads drop it
+    if(m_nLastBlock != NO_BLOCK && (nFirstBlock == m_nLastBlock ||
+                                    nFirstBlock == m_nLastBlock + 1))
+        m_nReadahead = min(max(m_nReadahead * 2, size_t(1)), m_nMaxReadahead);
+    else
+        m_nReadahead = 0;
+    m_nLastBlock = nLastBlock;
+
+    char* pabyOut = static_cast<char*>(ptr);
+    size_t nCopied = 0;
+    for(size_t nBlock = nFirstBlock; nBlock <= nLastBlock; ++nBlock)
+    {
+        const vector<char>* pBlock = getBlock(nBlock, nLastBlock);
+        size_t nOffset = m_nPosition - nBlock * m_nBlockSize;
+        if(nullptr == pBlock || nOffset >= pBlock->size())
+        {
+            m_bEof = true;
+            break;
+        }
+        size_t nCount = min(pBlock->size() - nOffset, size - nCopied);
+        memcpy(pabyOut + nCopied, pBlock->data() + nOffset, nCount);
+        nCopied += nCount;
+        m_nPosition += nCount;
+    }
+
+    m_oStatistics.bytesRead += nCopied;
+    return nCopied;
+}
+
+size_t CADCachedIO::Write(void* /*ptr*/, size_t /*size*/)
+{
+    // unsupported
+    return 0;
+}
+
+void CADCachedIO::Rewind()
+{
+    m_nPosition = 0;
+    m_bEof = false;
+}
+
+CADFileIO* CADCachedIO::Clone() const
+{
+    CADFileIO* poBackend = m_poBackend->Clone();
+    if(nullptr == poBackend)
+        return nullptr;
+    return new CADCachedIO(poBackend, m_nBlockSize, m_nMaxBlocks,
+                           m_nMaxReadahead);
+}
+
+const CADCachedIO::Statistics& CADCachedIO::getStatistics() const
+{
+    return m_oStatistics;
+}
+
+void CADCachedIO::resetStatistics()
+{
+    m_oStatistics = Statistics();
+}
+
+const vector<char>* CADCachedIO::getBlock(size_t nBlock, size_t nLastBlock)
+{
+    auto it = m_oBlocks.find(nBlock);
+    if(it != m_oBlocks.end())
+    {
+        ++m_oStatistics.blockHits;
+        m_oRecentBlocks.splice(m_oRecentBlocks.begin(), m_oRecentBlocks,
+                               it->second.position);
+        return &it->second.data;
+    }
+    ++m_oStatistics.blockMisses;
+
+    // fetch the rest of the requested blocks and the readahead window by one
+    // backend read, up to the first block which is already cached
+    size_t nBlocksCount = (m_nFileSize + m_nBlockSize - 1) / m_nBlockSize;
+    size_t nEnd = max(nLastBlock + 1, nBlock + 1 + m_nReadahead);
+    nEnd = min(min(nEnd, nBlocksCount), nBlock + m_nMaxBlocks);
+    size_t nFetchEnd = nBlock + 1;
+    while(nFetchEnd < nEnd && m_oBlocks.count(nFetchEnd) == 0)
+        ++nFetchEnd;
+
+    size_t nOffset = nBlock * m_nBlockSize;
+    size_t nSize = min(nFetchEnd * m_nBlockSize, m_nFileSize) - nOffset;
+    vector<char> buffer(nSize);
+    if(m_poBackend->Seek(static_cast<long>(nOffset), SeekOrigin::BEG) != 0)
+        return nullptr;
+    size_t nRead = m_poBackend->Read(buffer.data(), nSize);
+    ++m_oStatistics.backendReads;
+    m_oStatistics.bytesFetched += nRead;
+    if(nRead == 0)
+        return nullptr;
+
+    for(size_t i = nBlock; i < nFetchEnd; ++i)
+    {
+        size_t nBegin = (i - nBlock) * m_nBlockSize;
+        if(nBegin >= nRead)
+            break;
+        while(m_oBlocks.size() >= m_nMaxBlocks)
+            evict();
+        CachedBlock& block = m_oBlocks[i];
+        block.data.assign(buffer.begin() + nBegin,
+                          buffer.begin() + min(nBegin + m_nBlockSize, nRead));
+        m_oRecentBlocks.push_front(i);
+        block.position = m_oRecentBlocks.begin();
+    }
+
+    // the requested block is the most recently used one
+    it = m_oBlocks.find(nBlock);
+    m_oRecentBlocks.splice(m_oRecentBlocks.begin(), m_oRecentBlocks,
+                           it->second.position);
+    return &it->second.data;
+}
+
+void CADCachedIO::evict()
+{
+    m_oBlocks.erase(m_oRecentBlocks.back());
+    m_oRecentBlocks.pop_back();
+}
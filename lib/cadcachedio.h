@@ -0,0 +1,129 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#ifndef CADCACHEDIO_H
+#define CADCACHEDIO_H
+
+#include "opencad.h"
+#include "cadfileio.h"
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The CADCachedIO class decorates other in/out with the cache of the
+ * fixed size aligned blocks, so the small reads of the decoder go to the
+ * backend as a few large ones. The least recently used blocks are evicted,
+ * the adjacent missing blocks are fetched by one backend read and the
+ * sequential reads grow the readahead window. Use it for slow backends, i.e.
+ * network file systems or object stores.
+ */
+class OCAD_EXTERN CADCachedIO : public CADFileIO
+{
+public:
+    /**
+     * @brief The cache statistics
+     */
+    struct Statistics
+    {
+        size_t              reads = 0;          /**< Read calls */
+        size_t              bytesRead = 0;      /**< bytes returned by Read */
+        size_t              blockHits = 0;      /**< blocks found in cache */
+        size_t              blockMisses = 0;    /**< blocks fetched */
+        size_t              backendReads = 0;   /**< backend Read calls */
+        size_t              bytesFetched = 0;   /**< bytes read from backend */
+
+        double              getHitRate() const;
+    };
+
+public:
+    /**
+     * @brief Constructor
+     * @param poBackend Decorated in/out, owned by the cache
+     * @param nBlockSize Cache block size in bytes
+     * @param nMaxBlocks Max cached blocks count
+     * @param nMaxReadahead Max blocks fetched ahead on sequential reads
+     */
+    CADCachedIO(CADFileIO* poBackend, size_t nBlockSize = 64 * 1024,
+                size_t nMaxBlocks = 64, size_t nMaxReadahead = 16);
+    virtual             ~CADCachedIO();
+
+    virtual const char* ReadLine() override;
+    virtual bool        Eof() override;
+    virtual bool        Open(int mode) override;
+    virtual bool        Close() override;
+    virtual int         Seek(long int offset, SeekOrigin origin) override;
+    virtual long int    Tell() override;
+    virtual size_t      Read(void* ptr, size_t size) override;
+    virtual size_t      Write(void* ptr, size_t size) override;
+    virtual void        Rewind() override;
+    /**
+     * @brief Clone the backend and wrap it in the new cache with the same
+     * settings. The clones do not share the cached blocks.
+     */
+    virtual CADFileIO*  Clone() const override;
+
+    const Statistics&   getStatistics() const;
+    void                resetStatistics();
+
+protected:
+    /**
+     * @brief Get the cached block, fetching it and the following missing
+     * blocks up to nLastBlock and the readahead window
+     * @return block data or nullptr if the backend read failed
+     */
+    const std::vector<char>* getBlock(size_t nBlock, size_t nLastBlock);
+    void                evict();
+
+protected:
+    typedef std::list<size_t> BlockList;
+    struct CachedBlock
+    {
+        std::vector<char>   data;
+        BlockList::iterator position;
+    };
+
+    CADFileIO*          m_poBackend;
+    size_t              m_nBlockSize;
+    size_t              m_nMaxBlocks;
+    size_t              m_nMaxReadahead;
+    size_t              m_nFileSize;
+    size_t              m_nPosition;
+    bool                m_bEof;
+    size_t              m_nLastBlock;
+    size_t              m_nReadahead;
+    BlockList           m_oRecentBlocks; // most recently used first
+    std::unordered_map<size_t, CachedBlock> m_oBlocks;
+    Statistics          m_oStatistics;
+    std::string         m_osLine;
+};
+
+#endif // CADCACHEDIO_H
@@ -29,21 +29,66 @@
  *  SOFTWARE.
  *******************************************************************************/
 #include "cadclasses.h"
+#include "cadobjects.h"
 #include "opencad.h"
 
 #include <iostream>
+#include <map>
 
 using namespace std;
 
+static const short CADCustomClassFirstNum = 500;
+
+/**
+ * @brief C++ class name to object type map, filled with the built-in decoders
+ */
+static map<string, short>& getRegisteredClassTypes()
+{
+    static map<string, short> classTypes = {
+        { "AcDbRasterImage", CADObject::IMAGE },
+        { "AcDbRasterImageDef", CADObject::IMAGEDEF },
+        { "AcDbRasterImageDefReactor", CADObject::IMAGEDEFREACTOR }
+    };
+    return classTypes;
+}
+
 CADClasses::CADClasses()
 {
 
 }
 
+void CADClasses::registerClassType(const string &sCppClassName,
+                                   short dObjectType)
+{
+    getRegisteredClassTypes ()[sCppClassName] = dObjectType;
+}
+
 void CADClasses::addClass(CADClass stClass)
 {
     classes.push_back (stClass);
 
+    // Resolve the class once, so objects lookup their type by class number
+    if(stClass.dClassNum >= CADCustomClassFirstNum)
+    {
+        size_t index = static_cast<size_t>(stClass.dClassNum -
+                                           CADCustomClassFirstNum);
+        if(index >= classTypes.size ())
+        {
+            size_t oldSize = classTypes.size ();
+            classTypes.resize (index + 1);
+            for(size_t i = oldSize; i < classTypes.size (); ++i)
+                classTypes[i] = static_cast<short>(i + CADCustomClassFirstNum);
+        }
+
+        const map<string, short>& registered = getRegisteredClassTypes ();
+        auto override = classTypeOverrides.find (stClass.sCppClassName);
+        auto it = registered.find (stClass.sCppClassName);
+        if(override != classTypeOverrides.end ())
+            classTypes[index] = override->second;
+        else if(it != registered.end ())
+            classTypes[index] = it->second;
+    }
+
     DebugMsg ("CLASS INFO\n"
                       "  Class Number: %d\n"
                       "  Proxy capabilities flag or Version: %d\n"
@@ -63,18 +108,40 @@ void CADClasses::addClass(CADClass stClass)
 
 CADClass CADClasses::getClassByNum(short num) const
 {
-    for(CADClass cadClass : classes){
+    for(const CADClass &cadClass : classes){
         if(cadClass.dClassNum == num)
             return cadClass;
     }
     return {};
 }
 
+short CADClasses::getObjectType(short num) const
+{
+    if(num < CADCustomClassFirstNum)
+        return num;
+    size_t index = static_cast<size_t>(num - CADCustomClassFirstNum);
+    if(index >= classTypes.size ())
+        return num;
+    return classTypes[index];
+}
+
+void CADClasses::setClassType(const string &sCppClassName, short dObjectType)
+{
+    classTypeOverrides[sCppClassName] = dObjectType;
+    for(const CADClass &cadClass : classes)
+    {
+        if(cadClass.dClassNum >= CADCustomClassFirstNum &&
+           cadClass.sCppClassName == sCppClassName)
+            classTypes[static_cast<size_t>(cadClass.dClassNum -
+                                           CADCustomClassFirstNum)] = dObjectType;
+    }
+}
+
 void CADClasses::print() const
 {
     cout << "============ CLASSES Section ============" << endl;
 
-    for(CADClass stClass : classes)
+    for(const CADClass &stClass : classes)
     {
         cout << "Class: " << endl;
         cout << "  Class Number: " << stClass.dClassNum << endl;
@@ -33,6 +33,7 @@
 
 #include "opencad.h"
 
+#include <map>
 #include <vector>
 #include <string>
 
@@ -59,10 +60,38 @@ public:
 public:
     void                addClass(CADClass stClass);
     CADClass            getClassByNum(short num) const;
+    /**
+     * @brief Get the object type the custom class objects are decoded as
+     * @param num Class number
+     * @return CADObject::ObjectType registered for the class C++ name, or num
+     * if the class is unknown
+     */
+    short               getObjectType(short num) const;
+    /**
+     * @brief Set the object type the custom class objects are decoded as for
+     * this file only. Overrides the registered type, should be called before
+     * the objects are read.
+     * @param sCppClassName C++ class name, i.e. AcDbWipeout
+     * @param dObjectType CADObject::ObjectType with a decoder
+     */
+    void                setClassType(const string& sCppClassName,
+                                     short dObjectType);
     void                print() const;
 
+public:
+    /**
+     * @brief Register the object type the custom class objects should be
+     * decoded as. Not thread safe, should be called before files are opened.
+     * @param sCppClassName C++ class name, i.e. AcDbRasterImage
+     * @param dObjectType CADObject::ObjectType with a decoder
+     */
+    static void         registerClassType(const string& sCppClassName,
+                                          short dObjectType);
+
 protected:
     vector<CADClass>    classes;
+    vector<short>       classTypes; // class number - 500 <-> object type
+    map<string, short>  classTypeOverrides;
 };
 
 #endif // CADCLASSES_H
@@ -0,0 +1,584 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#include "cadcompressedio.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+static string StripSuffix(const char* pszPath, const char* pszSuffix)
+{
+    string osPath(pszPath);
+    size_t nSuffixLen = strlen(pszSuffix);
+    if(osPath.size() <= nSuffixLen)
+        return osPath;
+    for(size_t i = 0; i < nSuffixLen; ++i)
+    {
+        if(tolower(osPath[osPath.size() - nSuffixLen + i]) != pszSuffix[i])
+            return osPath;
+    }
+    return osPath.substr(0, osPath.size() - nSuffixLen);
+}
+
+static unsigned int ReadLE32(const char* pabyData)
+{
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(pabyData);
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (unsigned(p[3]) << 24);
+}
+
+// ----------------------------------------------------------------------------
+// CADCompressedIO
+// ----------------------------------------------------------------------------
+
+CADCompressedIO::CADCompressedIO(CADFileIO* poBackend, const char* pszSuffix,
+                                 size_t nMaxFrames) :
+    CADFileIO(StripSuffix(poBackend->GetFilePath(), pszSuffix).c_str()),
+    m_poBackend(poBackend),
+    m_nMaxFrames(max(nMaxFrames, size_t(1))),
+    m_bIndexed(false),
+    m_nSize(0),
+    m_nPosition(0),
+    m_bEof(false)
+{
+
+}
+
+CADCompressedIO::~CADCompressedIO()
+{
+    if(IsOpened())
+        Close();
+    delete m_poBackend;
+}
+
+const char* CADCompressedIO::ReadLine()
+{
+    m_osLine.clear();
+    char c;
+    bool bRead = false;
+    while(Read(&c, 1) == 1)
+    {
+        bRead = true;
+        if(c == '\n')
+            break;
+        m_osLine += c;
+    }
+    if(!bRead)
+        return nullptr;
+    if(!m_osLine.empty() && m_osLine.back() == '\r')
+        m_osLine.pop_back();
+    return m_osLine.c_str();
+}
+
+bool CADCompressedIO::Eof()
+{
+    return m_bEof;
+}
+
+bool CADCompressedIO::Open(int mode)
+{
+    if(mode & OpenMode::write)
+        return false;
+
+    if(!m_poBackend->IsOpened() &&
+       !m_poBackend->Open(mode | OpenMode::binary))
+        return false;
+
+    if(!m_bIndexed)
+    {
+        if(m_poBackend->Seek(0, SeekOrigin::END) != 0)
+            return false;
+        long nArchiveSize = m_poBackend->Tell();
+        m_aFrames.clear();
+        m_nSize = 0;
+        if(nArchiveSize < 0 || !readIndex(static_cast<size_t>(nArchiveSize)))
+        {
+            m_poBackend->Close();
+            return false;
+        }
+        m_bIndexed = true;
+    }
+
+    m_nPosition = 0;
+    m_bEof = false;
+    m_bIsOpened = true;
+    return true;
+}
+
+bool CADCompressedIO::Close()
+{
+    m_oCachedFrames.clear();
+    m_poBackend->Close();
+    return CADFileIO::Close();
+}
+
+int CADCompressedIO::Seek(long offset, CADFileIO::SeekOrigin origin)
+{
+    long nBase = 0;
+    switch (origin) {
+    case SeekOrigin::CUR:
+        nBase = static_cast<long>(m_nPosition);
+        break;
+    case SeekOrigin::END:
+        nBase = static_cast<long>(m_nSize);
+        break;
+    case SeekOrigin::BEG:
+        break;
+    }
+
+    if(offset < -nBase || nBase + offset > static_cast<long>(m_nSize))
+        return 1;
+    m_nPosition = static_cast<size_t>(nBase + offset);
+    m_bEof = false;
+    return 0;
+}
+
+long CADCompressedIO::Tell()
+{
+    return static_cast<long>(m_nPosition);
+}
+
+size_t CADCompressedIO::Read(void* ptr, size_t size)
+{
+    if(!m_bIsOpened || size == 0)
+        return 0;
+    if(m_nPosition >= m_nSize)
+    {
+        m_bEof = true;
+        return 0;
+    }
+    if(size > m_nSize - m_nPosition)
+    {
+        size = m_nSize - m_nPosition;
+        m_bEof = true;
+    }
+
+    // the last frame starting at or before the position
+    auto it = upper_bound(m_aFrames.begin(), m_aFrames.end(), m_nPosition,
+                          [](size_t nPosition, const Frame& frame)
+                          { return nPosition < frame.offset; });
+    --it;
+
+    char* pabyOut = static_cast<char*>(ptr);
+    size_t nCopied = 0;
+    for(; nCopied < size && it != m_aFrames.end(); ++it)
+    {
+        const vector<char>* pData = getFrame(it - m_aFrames.begin());
+        if(nullptr == pData)
+        {
+            m_bEof = true;
+            break;
+        }
+        size_t nOffset = m_nPosition - it->offset;
+        size_t nCount = min(it->size - nOffset, size - nCopied);
+        memcpy(pabyOut + nCopied, pData->data() + nOffset, nCount);
+        nCopied += nCount;
+        m_nPosition += nCount;
+    }
+    return nCopied;
+}
+
+size_t CADCompressedIO::Write(void* /*ptr*/, size_t /*size*/)
+{
+    // unsupported
+    return 0;
+}
+
+void CADCompressedIO::Rewind()
+{
+    m_nPosition = 0;
+    m_bEof = false;
+}
+
+bool CADCompressedIO::readBackend(size_t nOffset, size_t nSize,
+                                  vector<char>& data)
+{
+    data.resize(nSize);
+    if(m_poBackend->Seek(static_cast<long>(nOffset), SeekOrigin::BEG) != 0)
+        return false;
+    return m_poBackend->Read(data.data(), nSize) == nSize;
+}
+
+void CADCompressedIO::copyIndex(const CADCompressedIO& other)
+{
+    m_aFrames = other.m_aFrames;
+    m_nSize = other.m_nSize;
+    m_bIndexed = other.m_bIndexed;
+}
+
+void CADCompressedIO::addFrame(size_t nCompressedOffset,
+                               size_t nCompressedSize, size_t nSize)
+{
+    if(nSize == 0)
+        return;
+    Frame frame = { nCompressedOffset, nCompressedSize, m_nSize, nSize };
+    m_aFrames.push_back(frame);
+    m_nSize += nSize;
+}
+
+const vector<char>* CADCompressedIO::getFrame(size_t nFrame)
+{
+    for(auto it = m_oCachedFrames.begin(); it != m_oCachedFrames.end(); ++it)
+    {
+        if(it->index == nFrame)
+        {
+            m_oCachedFrames.splice(m_oCachedFrames.begin(), m_oCachedFrames,
+                                   it);
+            return &m_oCachedFrames.front().data;
+        }
+    }
+
+    const Frame& frame = m_aFrames[nFrame];
+    vector<char> compressed;
+    CachedFrame cached;
+    cached.index = nFrame;
+    cached.data.resize(frame.size);
+    if(!readBackend(frame.compressedOffset, frame.compressedSize, compressed) ||
+       !decompressFrame(frame, compressed, cached.data))
+        return nullptr;
+
+    if(m_oCachedFrames.size() >= m_nMaxFrames)
+        m_oCachedFrames.pop_back();
+    m_oCachedFrames.push_front(CachedFrame());
+    m_oCachedFrames.front().index = nFrame;
+    m_oCachedFrames.front().data.swap(cached.data);
+    return &m_oCachedFrames.front().data;
+}
+
+#ifdef HAVE_ZLIB
+// ----------------------------------------------------------------------------
+// CADGzipIO
+// ----------------------------------------------------------------------------
+
+static const size_t GZIP_ACCESS_POINT_SPAN = 1024 * 1024;
+static const size_t GZIP_WINDOW_SIZE = 32 * 1024;
+
+CADGzipIO::CADGzipIO(CADFileIO* poBackend, size_t nMaxFrames) :
+    CADCompressedIO(poBackend, ".gz", nMaxFrames)
+{
+
+}
+
+CADFileIO* CADGzipIO::Clone() const
+{
+    CADFileIO* poBackend = m_poBackend->Clone();
+    if(nullptr == poBackend)
+        return nullptr;
+    CADGzipIO* poClone = new CADGzipIO(poBackend, m_nMaxFrames);
+    poClone->copyIndex(*this);
+    poClone->m_aAccessPoints = m_aAccessPoints;
+    return poClone;
+}
+
+bool CADGzipIO::readIndex(size_t nArchiveSize)
+{
+    m_aAccessPoints.clear();
+
+    // BGZF members store their size in the 'BC' extra subfield and the
+    // uncompressed size in the trailer, so no data is inflated
+    size_t nOffset = 0;
+    vector<char> header;
+    vector<char> extra;
+    while(nOffset < nArchiveSize)
+    {
+        if(nArchiveSize - nOffset < 18 || !readBackend(nOffset, 12, header))
+            break;
+        const unsigned char* p =
+                reinterpret_cast<const unsigned char*>(header.data());
+        if(p[0] != 0x1F || p[1] != 0x8B || p[2] != 8 || !(p[3] & 0x04))
+            break;
+        size_t nExtraSize = p[10] | (p[11] << 8);
+        if(!readBackend(nOffset + 12, nExtraSize, extra))
+            break;
+
+        size_t nBlockSize = 0;
+        for(size_t i = 0; i + 4 <= nExtraSize;)
+        {
+            size_t nFieldSize = static_cast<unsigned char>(extra[i + 2]) |
+                                (static_cast<unsigned char>(extra[i + 3]) << 8);
+            if(extra[i] == 'B' && extra[i + 1] == 'C' && nFieldSize == 2 &&
+               i + 6 <= nExtraSize)
+            {
+                nBlockSize = (static_cast<unsigned char>(extra[i + 4]) |
+                             (static_cast<unsigned char>(extra[i + 5]) << 8)) + 1;
+                break;
+            }
+            i += 4 + nFieldSize;
+        }
+        if(nBlockSize < 12 + nExtraSize + 8 ||
+           nBlockSize > nArchiveSize - nOffset ||
+           !readBackend(nOffset + nBlockSize - 4, 4, header))
+            break;
+
+        addFrame(nOffset, nBlockSize, ReadLE32(header.data()));
+        nOffset += nBlockSize;
+    }
+
+    if(nOffset < nArchiveSize)
+        return indexByInflate(nOffset, nArchiveSize);
+    return true;
+}
+
+bool CADGzipIO::indexByInflate(size_t nOffset, size_t nArchiveSize)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+        return false;
+
+    const size_t nChunkSize = 64 * 1024;
+    vector<char> input;
+    vector<char> output(nChunkSize);
+    size_t nReadOffset = nOffset;
+    size_t nFrameOffset = nOffset;
+    size_t nFrameSize = 0;
+    size_t nMemberSize = 0;
+    bool bResult = false;
+    while(true)
+    {
+        if(stream.avail_in == 0)
+        {
+            if(nReadOffset >= nArchiveSize)
+                break; // truncated member
+            size_t nSize = min(nChunkSize, nArchiveSize - nReadOffset);
+            if(!readBackend(nReadOffset, nSize, input))
+                break;
+            nReadOffset += nSize;
+            stream.next_in = reinterpret_cast<Bytef*>(input.data());
+            stream.avail_in = static_cast<uInt>(nSize);
+        }
+
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+        // stop at the blocks boundaries to place the access points
+        int nRet = inflate(&stream, Z_BLOCK);
+        size_t nOutSize = output.size() - stream.avail_out;
+        nFrameSize += nOutSize;
+        nMemberSize += nOutSize;
+        if(nRet == Z_STREAM_END)
+        {
+            size_t nMemberEnd = nReadOffset - stream.avail_in;
+            if(nFrameSize == 0 && !m_aAccessPoints.empty() &&
+               m_aAccessPoints.back().offset == m_nSize)
+            {
+                // the last block is empty, the previous frame ends the member
+                m_aAccessPoints.pop_back();
+                Frame& frame = m_aFrames.back();
+                frame.compressedSize = nMemberEnd - frame.compressedOffset;
+            }
+            addFrame(nFrameOffset, nMemberEnd - nFrameOffset, nFrameSize);
+            nFrameOffset = nMemberEnd;
+            nFrameSize = 0;
+            nMemberSize = 0;
+            if(nMemberEnd >= nArchiveSize)
+            {
+                bResult = true;
+                break;
+            }
+            inflateReset(&stream);
+        }
+        else if(nRet != Z_OK && nRet != Z_BUF_ERROR)
+        {
+            // trailing garbage after the last member is ignored, as gzip does
+            bResult = nMemberSize == 0 && !m_aFrames.empty();
+            break;
+        }
+        else if((stream.data_type & 0xC0) == 0x80 &&
+                nFrameSize >= GZIP_ACCESS_POINT_SPAN)
+        {
+            // the end of the not last block, the next frame starts here
+            size_t nPointOffset = nReadOffset - stream.avail_in;
+            AccessPoint point;
+            point.bits = stream.data_type & 7;
+            point.window.resize(GZIP_WINDOW_SIZE);
+            uInt nWindowSize = static_cast<uInt>(GZIP_WINDOW_SIZE);
+            if(inflateGetDictionary(&stream,
+                    reinterpret_cast<Bytef*>(point.window.data()),
+                    &nWindowSize) != Z_OK)
+                break;
+            point.window.resize(nWindowSize);
+
+            addFrame(nFrameOffset, nPointOffset - nFrameOffset, nFrameSize);
+            point.offset = m_nSize;
+            m_aAccessPoints.push_back(point);
+            // the byte with the unused bits is shared by both frames
+            nFrameOffset = nPointOffset - (point.bits ? 1 : 0);
+            nFrameSize = 0;
+        }
+    }
+
+    inflateEnd(&stream);
+    return bResult;
+}
+
+bool CADGzipIO::decompressFrame(const Frame& frame,
+                                const vector<char>& compressed,
+                                vector<char>& data)
+{
+    // the frame inside the member is the raw deflate data
+    const AccessPoint* pPoint = findAccessPoint(frame.offset);
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if(inflateInit2(&stream, pPoint ? -MAX_WBITS : 16 + MAX_WBITS) != Z_OK)
+        return false;
+
+    stream.next_in = reinterpret_cast<Bytef*>(
+                const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    if(pPoint)
+    {
+        if(pPoint->bits != 0)
+        {
+            if(compressed.empty() ||
+               inflatePrime(&stream, pPoint->bits,
+                            static_cast<unsigned char>(compressed[0]) >>
+                            (8 - pPoint->bits)) != Z_OK)
+            {
+                inflateEnd(&stream);
+                return false;
+            }
+            ++stream.next_in;
+            --stream.avail_in;
+        }
+        if(inflateSetDictionary(&stream,
+               reinterpret_cast<const Bytef*>(pPoint->window.data()),
+               static_cast<uInt>(pPoint->window.size())) != Z_OK)
+        {
+            inflateEnd(&stream);
+            return false;
+        }
+    }
+
+    stream.next_out = reinterpret_cast<Bytef*>(data.data());
+    stream.avail_out = static_cast<uInt>(data.size());
+    int nRet = inflate(&stream, Z_FINISH);
+    // the frame followed by the access point ends inside the member
+    bool bEnded = nRet == Z_STREAM_END ||
+            (nRet == Z_BUF_ERROR &&
+             nullptr != findAccessPoint(frame.offset + frame.size));
+    bool bResult = bEnded && stream.total_out == data.size();
+    inflateEnd(&stream);
+    return bResult;
+}
+
+const CADGzipIO::AccessPoint* CADGzipIO::findAccessPoint(size_t nOffset) const
+{
+    auto it = lower_bound(m_aAccessPoints.begin(), m_aAccessPoints.end(),
+                          nOffset,
+                          [](const AccessPoint& point, size_t nPointOffset)
+                          { return point.offset < nPointOffset; });
+    if(it == m_aAccessPoints.end() || it->offset != nOffset)
+        return nullptr;
+    return &(*it);
+}
+#endif // HAVE_ZLIB
+
+#ifdef HAVE_ZSTD
+// ----------------------------------------------------------------------------
+// CADZstdIO
+// ----------------------------------------------------------------------------
+
+static const unsigned int ZSTD_SKIPPABLE_MAGIC = 0x184D2A5E;
+static const unsigned int ZSTD_SEEKABLE_MAGIC = 0x8F92EAB1;
+static const size_t ZSTD_SEEK_TABLE_FOOTER_SIZE = 9;
+static const size_t ZSTD_SKIPPABLE_HEADER_SIZE = 8;
+
+CADZstdIO::CADZstdIO(CADFileIO* poBackend, size_t nMaxFrames) :
+    CADCompressedIO(poBackend, ".zst", nMaxFrames)
+{
+
+}
+
+CADFileIO* CADZstdIO::Clone() const
+{
+    CADFileIO* poBackend = m_poBackend->Clone();
+    if(nullptr == poBackend)
+        return nullptr;
+    CADZstdIO* poClone = new CADZstdIO(poBackend, m_nMaxFrames);
+    poClone->copyIndex(*this);
+    return poClone;
+}
+
+bool CADZstdIO::readIndex(size_t nArchiveSize)
+{
+    // seek table footer: frames count, descriptor, seekable magic
+    vector<char> footer;
+    if(nArchiveSize < ZSTD_SKIPPABLE_HEADER_SIZE + ZSTD_SEEK_TABLE_FOOTER_SIZE ||
+       !readBackend(nArchiveSize - ZSTD_SEEK_TABLE_FOOTER_SIZE,
+                    ZSTD_SEEK_TABLE_FOOTER_SIZE, footer) ||
+       ReadLE32(footer.data() + 5) != ZSTD_SEEKABLE_MAGIC)
+        return false;
+
+    size_t nFrames = ReadLE32(footer.data());
+    unsigned char nDescriptor = static_cast<unsigned char>(footer[4]);
+    if(nDescriptor & 0x7C) // reserved bits
+        return false;
+    size_t nEntrySize = (nDescriptor & 0x80) ? 12 : 8; // with checksums
+    size_t nTableSize = nFrames * nEntrySize;
+    size_t nSkippableSize = ZSTD_SKIPPABLE_HEADER_SIZE + nTableSize +
+                            ZSTD_SEEK_TABLE_FOOTER_SIZE;
+    vector<char> table;
+    if(nSkippableSize > nArchiveSize ||
+       !readBackend(nArchiveSize - nSkippableSize,
+                    ZSTD_SKIPPABLE_HEADER_SIZE + nTableSize, table) ||
+       ReadLE32(table.data()) != ZSTD_SKIPPABLE_MAGIC ||
+       ReadLE32(table.data() + 4) != nTableSize + ZSTD_SEEK_TABLE_FOOTER_SIZE)
+        return false;
+
+    size_t nCompressedOffset = 0;
+    for(size_t i = 0; i < nFrames; ++i)
+    {
+        const char* pabyEntry = table.data() + ZSTD_SKIPPABLE_HEADER_SIZE +
+                                i * nEntrySize;
+        size_t nCompressedSize = ReadLE32(pabyEntry);
+        addFrame(nCompressedOffset, nCompressedSize, ReadLE32(pabyEntry + 4));
+        nCompressedOffset += nCompressedSize;
+    }
+    return nCompressedOffset <= nArchiveSize - nSkippableSize;
+}
+
+bool CADZstdIO::decompressFrame(const Frame& /*frame*/,
+                                const vector<char>& compressed,
+                                vector<char>& data)
+{
+    size_t nSize = ZSTD_decompress(data.data(), data.size(), compressed.data(),
+                                   compressed.size());
+    return !ZSTD_isError(nSize) && nSize == data.size();
+}
+#endif // HAVE_ZSTD
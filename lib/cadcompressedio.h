@@ -0,0 +1,184 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ ******************************************************************************/
+#ifndef CADCOMPRESSEDIO_H
+#define CADCOMPRESSEDIO_H
+
+#include "cadfileio.h"
+
+#include <list>
+#include <vector>
+
+/**
+ * @brief The CADCompressedIO class reads the file from the compressed archive
+ * made of independently compressed frames. The frames index is read on open,
+ * only the frames covering the read data are decompressed and the recently
+ * used ones are cached. The file path is the archive path without the
+ * compression suffix, so the format is detected from the inner extension.
+ */
+class CADCompressedIO : public CADFileIO
+{
+public:
+    /**
+     * @brief Constructor
+     * @param poBackend Compressed archive in/out, owned by the object
+     * @param pszSuffix Archive suffix removed from the file path, i.e. ".gz"
+     * @param nMaxFrames Max cached decompressed frames count
+     */
+    CADCompressedIO(CADFileIO* poBackend, const char* pszSuffix,
+                    size_t nMaxFrames);
+    virtual             ~CADCompressedIO();
+
+    virtual const char* ReadLine() override;
+    virtual bool        Eof() override;
+    virtual bool        Open(int mode) override;
+    virtual bool        Close() override;
+    virtual int         Seek(long int offset, SeekOrigin origin) override;
+    virtual long int    Tell() override;
+    virtual size_t      Read(void* ptr, size_t size) override;
+    virtual size_t      Write(void* ptr, size_t size) override;
+    virtual void        Rewind() override;
+
+protected:
+    struct Frame
+    {
+        size_t          compressedOffset;
+        size_t          compressedSize;
+        size_t          offset;
+        size_t          size;
+    };
+
+protected:
+    /**
+     * @brief Fill the frames index
+     * @param nArchiveSize Compressed archive size
+     * @return false if the archive is not supported or corrupted
+     */
+    virtual bool        readIndex(size_t nArchiveSize) = 0;
+    /**
+     * @brief Decompress the frame
+     * @param frame Frame from the index
+     * @param compressed Frame compressed data
+     * @param data Buffer of the frame size for decompressed data
+     * @return false if the frame is corrupted
+     */
+    virtual bool        decompressFrame(const Frame& frame,
+                                        const std::vector<char>& compressed,
+                                        std::vector<char>& data) = 0;
+    bool                readBackend(size_t nOffset, size_t nSize,
+                                    std::vector<char>& data);
+    /**
+     * @brief Copy the frames index, so the clone does not read it again
+     */
+    void                copyIndex(const CADCompressedIO& other);
+    void                addFrame(size_t nCompressedOffset,
+                                 size_t nCompressedSize, size_t nSize);
+    const std::vector<char>* getFrame(size_t nFrame);
+
+protected:
+    struct CachedFrame
+    {
+        size_t              index;
+        std::vector<char>   data;
+    };
+
+    CADFileIO*          m_poBackend;
+    size_t              m_nMaxFrames;
+    std::vector<Frame>  m_aFrames;
+    bool                m_bIndexed;
+    size_t              m_nSize;
+    size_t              m_nPosition;
+    bool                m_bEof;
+    std::list<CachedFrame> m_oCachedFrames; // most recently used first
+    std::string         m_osLine;
+};
+
+#ifdef HAVE_ZLIB
+/**
+ * @brief The gzip archive in/out. The BGZF archives are indexed by their
+ * blocks headers, other archives are indexed by inflating them once on open.
+ * Large members are split into frames at the deflate blocks boundaries about
+ * every megabyte, the frame inside the member is inflated from the saved bit
+ * offset with the saved window of the preceding data.
+ */
+class CADGzipIO : public CADCompressedIO
+{
+public:
+    CADGzipIO(CADFileIO* poBackend, size_t nMaxFrames = 8);
+
+    virtual CADFileIO*  Clone() const override;
+
+protected:
+    virtual bool        readIndex(size_t nArchiveSize) override;
+    virtual bool        decompressFrame(const Frame& frame,
+                                        const std::vector<char>& compressed,
+                                        std::vector<char>& data) override;
+    bool                indexByInflate(size_t nOffset, size_t nArchiveSize);
+
+protected:
+    struct AccessPoint
+    {
+        size_t              offset; // uncompressed offset of the frame
+        int                 bits;   // bits of the frame first byte to use
+        std::vector<char>   window;
+    };
+
+    /**
+     * @brief Find the access point of the frame starting inside the member
+     * @param nOffset Frame uncompressed offset
+     * @return access point or null if the frame starts the member
+     */
+    const AccessPoint*  findAccessPoint(size_t nOffset) const;
+
+    std::vector<AccessPoint> m_aAccessPoints;
+};
+#endif // HAVE_ZLIB
+
+#ifdef HAVE_ZSTD
+/**
+ * @brief The zstd seekable format archive in/out, the frames index is the
+ * seek table stored in the skippable frame at the end of the archive.
+ */
+class CADZstdIO : public CADCompressedIO
+{
+public:
+    CADZstdIO(CADFileIO* poBackend, size_t nMaxFrames = 8);
+
+    virtual CADFileIO*  Clone() const override;
+
+protected:
+    virtual bool        readIndex(size_t nArchiveSize) override;
+    virtual bool        decompressFrame(const Frame& frame,
+                                        const std::vector<char>& compressed,
+                                        std::vector<char>& data) override;
+};
+#endif // HAVE_ZSTD
+
+#endif // CADCOMPRESSEDIO_H
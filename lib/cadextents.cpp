@@ -0,0 +1,308 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadextents.h"
+#include "cadnurbs.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+static const double dfPi = acos(-1.0);
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+static CADVector shift(const CADVector& point, const CADVector& vector,
+                       double scale = 1.0)
+{
+    return CADVector(point.getX () + vector.getX () * scale,
+                     point.getY () + vector.getY () * scale,
+                     point.getZ () + vector.getZ () * scale);
+}
+
+static CADVector cross(const CADVector& first, const CADVector& second)
+{
+    return CADVector(first.getY () * second.getZ () -
+                     first.getZ () * second.getY (),
+                     first.getZ () * second.getX () -
+                     first.getX () * second.getZ (),
+                     first.getX () * second.getY () -
+                     first.getY () * second.getX ());
+}
+
+static double getLength(const CADVector& vector)
+{
+    return sqrt(vector.getX () * vector.getX () +
+                vector.getY () * vector.getY () +
+                vector.getZ () * vector.getZ ());
+}
+
+static CADVector getNormal(const CADVector& extrusion)
+{
+    double length = getLength (extrusion);
+    if( length == 0.0 )
+        return CADVector(0.0, 0.0, 1.0);
+    return CADVector(extrusion.getX () / length, extrusion.getY () / length,
+                     extrusion.getZ () / length);
+}
+
+static double getSweep(double start, double end)
+{
+    double sweep = end - start;
+    while( sweep <= 0.0 )
+        sweep += 2 * dfPi;
+    while( sweep > 2 * dfPi )
+        sweep -= 2 * dfPi;
+    return sweep;
+}
+
+// ----------------------------------------------------------------------------
+// CADExtents
+// ----------------------------------------------------------------------------
+
+CADExtents::CADExtents() :
+    minX(numeric_limits<double>::infinity ()),
+    minY(numeric_limits<double>::infinity ()),
+    minZ(numeric_limits<double>::infinity ()),
+    maxX(-numeric_limits<double>::infinity ()),
+    maxY(-numeric_limits<double>::infinity ()),
+    maxZ(-numeric_limits<double>::infinity ())
+{
+
+}
+
+bool CADExtents::isEmpty() const
+{
+    return minX > maxX;
+}
+
+CADVector CADExtents::getMin() const
+{
+    return CADVector(minX, minY, minZ);
+}
+
+CADVector CADExtents::getMax() const
+{
+    return CADVector(maxX, maxY, maxZ);
+}
+
+void CADExtents::add(double x, double y, double z)
+{
+    minX = min(minX, x);
+    minY = min(minY, y);
+    minZ = min(minZ, z);
+    maxX = max(maxX, x);
+    maxY = max(maxY, y);
+    maxZ = max(maxZ, z);
+}
+
+void CADExtents::add(const CADVector &point)
+{
+    add (point.getX (), point.getY (), point.getZ ());
+}
+
+void CADExtents::add(const CADExtents &other)
+{
+    if( other.isEmpty () )
+        return;
+    add (other.minX, other.minY, other.minZ);
+    add (other.maxX, other.maxY, other.maxZ);
+}
+
+bool CADExtents::addGeometry(CADGeometry *geometry)
+{
+    switch( geometry->getType () )
+    {
+        case CADGeometry::POINT:
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+        case CADGeometry::RAY:
+        case CADGeometry::XLINE:
+            add (static_cast<CADPoint3D *>(geometry)->getPosition ());
+            return true;
+        case CADGeometry::LINE:
+        {
+            CADLine * line = static_cast<CADLine *>(geometry);
+            add (line->getStart ().getPosition ());
+            add (line->getEnd ().getPosition ());
+            return true;
+        }
+        case CADGeometry::CIRCLE:
+        case CADGeometry::ARC:
+        {
+            // circles and arcs lie in their OCS XY plane
+            CADCircle * circle = static_cast<CADCircle *>(geometry);
+            double radius = circle->getRadius ();
+            Matrix ocs = Matrix::fromExtrusion (circle->getExtrusion ());
+            CADVector major = ocs.multiply (CADVector(radius, 0.0, 0.0));
+            CADVector minor = ocs.multiply (CADVector(0.0, radius, 0.0));
+            double start = 0.0, sweep = 2 * dfPi;
+            if( geometry->getType () == CADGeometry::ARC )
+            {
+                CADArc * arc = static_cast<CADArc *>(geometry);
+                start = arc->getStartingAngle ();
+                sweep = getSweep (start, arc->getEndingAngle ());
+            }
+            addArc (circle->getPosition (), major, minor, start, sweep);
+            return true;
+        }
+        case CADGeometry::ELLIPSE:
+        {
+            CADEllipse * ellipse = static_cast<CADEllipse *>(geometry);
+            CADVector major = ellipse->getSMAxis ();
+            CADVector minor = cross (getNormal (ellipse->getExtrusion ()),
+                                     major);
+            minor = shift (CADVector(0.0, 0.0, 0.0), minor,
+                           ellipse->getAxisRatio ());
+            double start = ellipse->getStartingAngle ();
+            addArc (ellipse->getPosition (), major, minor, start,
+                    getSweep (start, ellipse->getEndingAngle ()));
+            return true;
+        }
+        case CADGeometry::LWPOLYLINE:
+        {
+            CADLWPolyline * polyline = static_cast<CADLWPolyline *>(geometry);
+            const size_t nVertexes = polyline->getVertexCount ();
+            if( 0 == nVertexes )
+                return true;
+            const vector<double>& bulges = polyline->getBulges ();
+            const CADVector normal = getNormal (polyline->getVectExtrusion ());
+            const size_t nSegments = polyline->getClosed () ? nVertexes :
+                                                              nVertexes - 1;
+            for( size_t i = 0; i < nVertexes; ++i )
+                add (polyline->getVertex (i));
+            for( size_t i = 0; i < bulges.size () && i < nSegments; ++i )
+            {
+                if( bulges[i] == 0.0 )
+                    continue;
+                // bulge is tan(sweep / 4), positive - counterclockwise
+                const CADVector& start = polyline->getVertex (i);
+                const CADVector& end = polyline->getVertex ((i + 1) % nVertexes);
+                CADVector chord = shift (end, start, -1.0);
+                double chordLength = getLength (chord);
+                if( chordLength == 0.0 )
+                    continue;
+                double sweep = 4.0 * atan(bulges[i]);
+                CADVector middle = shift (start, chord, 0.5);
+                CADVector center = shift (middle, cross (normal, chord),
+                                          0.5 / tan(sweep / 2));
+                CADVector major = shift (start, center, -1.0);
+                addArc (center, major, cross (normal, major), 0.0, sweep);
+            }
+            return true;
+        }
+        case CADGeometry::POLYLINE3D:
+        {
+            CADPolyline3D * polyline = static_cast<CADPolyline3D *>(geometry);
+            for( size_t i = 0; i < polyline->getVertexCount (); ++i )
+                add (polyline->getVertex (i));
+            return true;
+        }
+        case CADGeometry::SPLINE:
+        {
+            // the curve lies in the control points hull, weights are positive
+            CADSpline * spline = static_cast<CADSpline *>(geometry);
+            vector<CADVector> points = spline->getControlPoints ();
+            if( points.empty () )
+            {
+                CADNurbsEvaluator evaluator(spline);
+                points = evaluator.isValid () ? evaluator.getControlPoints () :
+                                                spline->getFitPoints ();
+            }
+            for( const CADVector& point : points )
+                add (point);
+            return true;
+        }
+        case CADGeometry::SOLID:
+            for( const CADVector& corner :
+                 static_cast<CADSolid *>(geometry)->getAverCorners () )
+                add (corner);
+            return true;
+        case CADGeometry::FACE3D:
+        {
+            CADFace3D * face = static_cast<CADFace3D *>(geometry);
+            for( size_t i = 0; i < 4; ++i )
+                add (face->getCorner (i));
+            return true;
+        }
+        case CADGeometry::POLYLINE_PFACE:
+            for( const CADVector& vertex :
+                 static_cast<CADPolylinePFace *>(geometry)->getVertexes () )
+                add (vertex);
+            return true;
+        case CADGeometry::MLINE:
+            for( const CADVector& vertex :
+                 static_cast<CADMLine *>(geometry)->getVertexes () )
+                add (vertex);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void CADExtents::addArc(const CADVector &center, const CADVector &major,
+                        const CADVector &minor, double start, double sweep)
+{
+    auto addPoint = [&](double angle) {
+        add (shift (shift (center, major, cos(angle)), minor, sin(angle)));
+    };
+    addPoint (start);
+    addPoint (start + sweep);
+    // the clockwise arc covers the same points as the reversed one
+    if( sweep < 0.0 )
+    {
+        start += sweep;
+        sweep = -sweep;
+    }
+
+    // the coordinate is extreme where major * sin(t) = minor * cos(t)
+    const double majorAxis[3] = { major.getX (), major.getY (), major.getZ () };
+    const double minorAxis[3] = { minor.getX (), minor.getY (), minor.getZ () };
+    for( int i = 0; i < 3; ++i )
+    {
+        if( majorAxis[i] == 0.0 && minorAxis[i] == 0.0 )
+            continue;
+        double extreme = atan2(minorAxis[i], majorAxis[i]);
+        for( int j = 0; j < 2; ++j, extreme += dfPi )
+        {
+            double offset = fmod(extreme - start, 2 * dfPi);
+            if( offset < 0.0 )
+                offset += 2 * dfPi;
+            if( offset <= sweep )
+                addPoint (start + offset);
+        }
+    }
+}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADEXTENTS_H
+#define CADEXTENTS_H
+
+#include "cadgeometry.h"
+
+/**
+ * @brief The axis aligned bounding box of points and geometries. The curves
+ * are bounded analytically: circles, arcs, ellipses and bulged LWPOLYLINE
+ * segments by their extreme points, splines by their control points hull.
+ * Rays and xlines add their base point only.
+ */
+class OCAD_EXTERN CADExtents
+{
+public:
+    CADExtents();
+
+    bool        isEmpty() const;
+    CADVector   getMin() const;
+    CADVector   getMax() const;
+
+    void        add(double x, double y, double z);
+    void        add(const CADVector& point);
+    void        add(const CADExtents& other);
+    /**
+     * @brief Add the geometry bounds
+     * @param geometry Geometry to add
+     * @return false if the geometry has no coordinates, i.e. hatch
+     */
+    bool        addGeometry(CADGeometry * geometry);
+
+protected:
+    /**
+     * @brief Add the elliptical arc center + major * cos(t) + minor * sin(t),
+     * t from start to start + sweep
+     */
+    void        addArc(const CADVector& center, const CADVector& major,
+                       const CADVector& minor, double start, double sweep);
+
+protected:
+    double      minX, minY, minZ;
+    double      maxX, maxY, maxZ;
+};
+
+#endif // CADEXTENTS_H
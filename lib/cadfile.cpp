@@ -33,9 +33,13 @@
 #include "cadfile.h"
 #include "opencad_api.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <memory>
+#include <thread>
 
-CADFile::CADFile(CADFileIO* poFileIO)
+CADFile::CADFile(CADFileIO* poFileIO) : statisticsEnabled(false)
 {
     fileIO = poFileIO;
 }
@@ -93,6 +97,223 @@ int CADFile::parseFile(enum OpenOptions eOptions)
     return CADErrorCodes::SUCCESS;
 }
 
+void CADFile::setReadFilter(const CADFile::ReadFilter &filter)
+{
+    readFilter = filter;
+    for(const auto& classType : filter.classTypes)
+        classes.setClassType (classType.first, classType.second);
+}
+
+void CADFile::setStatisticsEnabled(bool bEnabled)
+{
+    if(bEnabled)
+    {
+        std::lock_guard<std::mutex> lock(statisticsMutex);
+        statistics.clear ();
+    }
+    statisticsEnabled = bEnabled;
+}
+
+std::map<short, CADFile::ObjectStatistics> CADFile::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    return statistics;
+}
+
+int CADFile::getObjectCensus(ObjectCensus& census, bool /*bLayers*/)
+{
+    census = ObjectCensus();
+    return CADErrorCodes::UNSUPPORTED_VERSION;
+}
+
+CADFileCursor* CADFile::createCursor()
+{
+    CADFileIO* poFileIO = nullptr == fileIO ? nullptr : fileIO->Clone ();
+    if(nullptr != poFileIO &&
+       !poFileIO->Open(CADFileIO::read | CADFileIO::binary))
+    {
+        delete poFileIO;
+        poFileIO = nullptr; // fall back to the shared file in/out
+    }
+    return new CADFileCursor(this, poFileIO);
+}
+
+int CADFile::computeExtents(CADExtents &extents,
+                            std::vector<CADExtents> *layerExtents,
+                            size_t threadCount)
+{
+    // geometries of all layers are numbered one after another
+    const size_t nLayers = getLayersCount();
+    std::vector<size_t> layerStarts(nLayers + 1, 0);
+    for(size_t i = 0; i < nLayers; ++i)
+        layerStarts[i + 1] = layerStarts[i] + getLayer(i).getGeometryCount();
+    const size_t nGeometries = layerStarts.back();
+
+    const size_t nChunkSize = 256;
+    if(0 == threadCount)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::max(std::min(threadCount,
+                                    nGeometries / nChunkSize), size_t(1));
+
+    std::atomic<size_t> nextChunk(0);
+    std::vector< std::vector<CADExtents> > threadExtents(threadCount,
+                                            std::vector<CADExtents>(nLayers));
+    auto worker = [&](size_t nThread)
+    {
+        // the single thread reads with the shared file in/out
+        std::unique_ptr<CADFileCursor> cursor(threadCount > 1 ?
+                                              createCursor() : nullptr);
+        std::vector<CADExtents>& result = threadExtents[nThread];
+        while(true)
+        {
+            size_t nFirst = nextChunk.fetch_add(nChunkSize);
+            if(nFirst >= nGeometries)
+                break;
+            size_t nLast = std::min(nFirst + nChunkSize, nGeometries);
+            size_t nLayer = std::upper_bound(layerStarts.begin(),
+                                             layerStarts.end(), nFirst) -
+                    layerStarts.begin() - 1;
+            for(size_t i = nFirst; i < nLast; ++i)
+            {
+                while(i >= layerStarts[nLayer + 1])
+                    ++nLayer;
+                size_t nIndex = i - layerStarts[nLayer];
+                std::unique_ptr<CADGeometry> geometry(nullptr != cursor ?
+                    cursor->getGeometry(nLayer, nIndex, PROJECTION_COORDINATES) :
+                    getLayer(nLayer).getGeometry(nIndex, PROJECTION_COORDINATES));
+                if(nullptr != geometry)
+                    result[nLayer].addGeometry(geometry.get());
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; ++i)
+        threads.push_back(std::thread(worker, i));
+    worker(0);
+    for(std::thread& thread : threads)
+        thread.join();
+
+    extents = CADExtents();
+    if(nullptr != layerExtents)
+        layerExtents->assign(nLayers, CADExtents());
+    for(const std::vector<CADExtents>& result : threadExtents)
+    {
+        for(size_t i = 0; i < nLayers; ++i)
+        {
+            extents.add(result[i]);
+            if(nullptr != layerExtents)
+                (*layerExtents)[i].add(result[i]);
+        }
+    }
+    return CADErrorCodes::SUCCESS;
+}
+
+CADEntityObject *CADFile::getEntityHandles(long /*index*/)
+{
+    return nullptr;
+}
+
+void CADFile::readEntitiesHandles(std::vector<EntityHandles> &entities,
+                                  size_t threadCount)
+{
+    std::vector<long> indexes;
+    indexes.reserve(objectsMap.size());
+    for(const auto& object : objectsMap)
+        indexes.push_back(object.first);
+    const size_t nObjects = indexes.size();
+
+    const size_t nChunkSize = 1024;
+    if(0 == threadCount)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    threadCount = std::max(std::min(threadCount, nObjects / nChunkSize),
+                           size_t(1));
+
+    // every object has its slot, so the result is in the handles order,
+    // the slots of other objects keep the null handle
+    std::vector<EntityHandles> result(nObjects);
+    std::atomic<size_t> nextChunk(0);
+    auto worker = [&]()
+    {
+        // the single thread reads with the shared file in/out
+        std::unique_ptr<CADFileCursor> cursor(threadCount > 1 ?
+                                              createCursor() : nullptr);
+        CADFileCursor::Scope scope(cursor.get());
+        while(true)
+        {
+            size_t nFirst = nextChunk.fetch_add(nChunkSize);
+            if(nFirst >= nObjects)
+                break;
+            size_t nLast = std::min(nFirst + nChunkSize, nObjects);
+            for(size_t i = nFirst; i < nLast; ++i)
+            {
+                std::unique_ptr<CADEntityObject> ent(
+                            getEntityHandles(indexes[i]));
+                if(nullptr == ent)
+                    continue;
+
+                EntityHandles& entity = result[i];
+                const CADHandle& hEntity = ent->stCed.hObjectHandle;
+                entity.handle = hEntity.getAsLong();
+                if(0 == ent->stCed.bbEntMode)
+                    entity.owner = ent->stChed.hOwner.getAsLong(hEntity);
+                entity.layer = ent->stChed.hLayer.getAsLong(hEntity);
+                if(!ent->stCed.bNoLinks)
+                    entity.next = ent->stChed.hNextEntity.getAsLong(hEntity);
+                entity.type = ent->getType();
+                entity.entMode = ent->stCed.bbEntMode;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < threadCount; ++i)
+        threads.push_back(std::thread(worker));
+    worker();
+    for(std::thread& thread : threads)
+        thread.join();
+
+    entities.clear();
+    for(size_t i = 0; i < nObjects; ++i)
+    {
+        if(0 != result[i].handle)
+            entities.push_back(result[i]);
+    }
+}
+
+size_t CADFile::readData(long offset, void *ptr, size_t size)
+{
+    CADFileCursor* cursor = CADFileCursor::getActive ();
+    if(nullptr != cursor && cursor->pCADFile == this &&
+       nullptr != cursor->fileIO)
+        return cursor->read (offset, ptr, size);
+
+    std::lock_guard<std::mutex> lock(ioMutex);
+    if(0 != fileIO->Seek (offset, CADFileIO::SeekOrigin::BEG))
+        return 0;
+    return fileIO->Read (ptr, size);
+}
+
+const char* CADFile::mapData(long offset, size_t size) const
+{
+    size_t nDataSize = 0;
+    const char* pabyData = fileIO->GetData (nDataSize);
+    if(nullptr == pabyData || offset < 0 ||
+       static_cast<size_t>(offset) > nDataSize ||
+       size > nDataSize - static_cast<size_t>(offset))
+        return nullptr;
+    return pabyData + offset;
+}
+
+void CADFile::addStatistics(short type, size_t bytes, double decodeTime)
+{
+    std::lock_guard<std::mutex> lock(statisticsMutex);
+    ObjectStatistics& typeStatistics = statistics[type];
+    ++typeStatistics.count;
+    typeStatistics.bytes += bytes;
+    typeStatistics.decodeTime += decodeTime;
+}
+
 int CADFile::readTables(CADFile::OpenOptions /*eOptions*/)
 {
     // TODO: read other tables in ALL option mode
@@ -33,10 +33,17 @@
 #define CADFILE_H
 
 #include "cadfileio.h"
+#include "cadfilecursor.h"
+#include "cadextents.h"
 #include "cadclasses.h"
 #include "cadtables.h"
 
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 
 /**
  * @brief The abstact CAD file class
@@ -45,6 +52,7 @@ class OCAD_EXTERN CADFile
 {
     friend class CADTables;
     friend class CADLayer;
+    friend class CADFileCursor;
 public:
     /**
      * @brief The CAD file open options enum
@@ -56,6 +64,119 @@ public:
         READ_FASTEST    /**< read only geometry and layers */
     };
 
+    /**
+     * @brief The geometry projection flags, the properties to decode besides
+     * coordinates
+     */
+    enum ProjectionFlags
+    {
+        PROJECTION_COORDINATES = 0x00,  /**< positions, vertexes and sizes, always decoded */
+        PROJECTION_COLOR       = 0x01,  /**< colour */
+        PROJECTION_TEXT        = 0x02,  /**< text values, tags, prompts and dimension text */
+        PROJECTION_EED         = 0x04,  /**< extended entity data */
+        PROJECTION_DETAILS     = 0x08,  /**< data not used by geometry, i.e. spline tolerances */
+        PROJECTION_ALL         = 0x0F
+    };
+
+    /**
+     * @brief The CAD file read filter. Narrows what is decoded: the header
+     * codes are used in the READ_FAST and READ_FASTEST modes only, the layer
+     * and object type filters are applied in all modes while scanning the
+     * model space entities.
+     */
+    struct ReadFilter
+    {
+        /** header variable codes to decode, empty - the default fast set */
+        std::set<short>     headerCodes;
+        /** ProjectionFlags mask, the geometry properties to decode */
+        int                 projection = PROJECTION_ALL;
+        /** names of layers to read, empty - all layers */
+        std::set<std::string> layerNames;
+        /** handles of layers to read, empty - all layers */
+        std::set<long>      layerHandles;
+        /** CADObject::ObjectType of entities to read, empty - all types.
+         * Entities of inserted blocks are filtered by their own types,
+         * INSERT itself should be in the set to expand blocks. */
+        std::set<short>     objectTypes;
+        /** skip frozen layers */
+        bool                skipFrozenLayers = false;
+        /** skip turned off layers */
+        bool                skipOffLayers = false;
+        /** attach the model space entities to layers by reading the
+         * entities of the objects map by several threads, instead of
+         * following the entity links one by one */
+        bool                scanObjectsMap = false;
+        /** keep the layer entities in the model space order when the objects
+         * map is scanned, otherwise they are in the handles order */
+        bool                keepEntitiesOrder = false;
+        /** objects map scan threads count, 0 - the hardware concurrency */
+        size_t              scanThreadCount = 0;
+        /** C++ class name to CADObject::ObjectType the custom class objects
+         * of this file are decoded as, on top of the registered class types,
+         * see CADClasses::registerClassType */
+        std::map<std::string, short> classTypes;
+
+        /**
+         * @brief Check if entities of the type pass the filter
+         * @param type CADObject::ObjectType
+         * @return true if the type should be read
+         */
+        bool acceptsType(short type) const
+        {
+            return objectTypes.empty () || objectTypes.count (type) != 0;
+        }
+    };
+
+    /**
+     * @brief The per object type decode statistics
+     */
+    struct ObjectStatistics
+    {
+        size_t              count = 0;      /**< decoded objects count */
+        size_t              bytes = 0;      /**< decoded objects data size */
+        double              decodeTime = 0; /**< decode time in seconds */
+    };
+
+    /**
+     * @brief The objects count and size of one object type or layer
+     */
+    struct CensusEntry
+    {
+        size_t              count = 0;      /**< objects count */
+        size_t              bytes = 0;      /**< objects data size */
+    };
+
+    /**
+     * @brief The census of the file objects, taken without decoding the
+     * object bodies
+     */
+    struct ObjectCensus
+    {
+        /** CADObject::ObjectType <-> all objects of the type. The custom
+         * classes are counted by their registered types, or by the class
+         * numbers if the classes are unknown. */
+        std::map<short, CensusEntry> types;
+        /** layer handle <-> entities on the layer */
+        std::map<long, CensusEntry> layers;
+        /** objects which data could not be read, they are not counted by
+         * type or layer */
+        size_t              failed = 0;
+    };
+
+    /**
+     * @brief The entity type and handles used to attach it to the layer
+     */
+    struct EntityHandles
+    {
+        long                handle = 0;     /**< entity handle */
+        long                owner = 0;      /**< owner handle, entity mode 0 only */
+        long                layer = 0;      /**< layer handle */
+        long                next = 0;       /**< next entity handle, 0 - no links */
+        short               type = 0;       /**< CADObject::ObjectType */
+        char                entMode = 0;    /**< 0 - owned, 1 - paper space,
+                                                 2 - model space */
+    };
+
 public:
     CADFile (CADFileIO* poFileIO);
     virtual                 ~CADFile();
@@ -67,6 +188,56 @@ public:
 
 public:
     virtual int             parseFile(enum OpenOptions eOptions);
+    /**
+     * @brief Set the read filter, should be called before parseFile
+     * @param filter Read filter
+     */
+    virtual void            setReadFilter(const ReadFilter& filter);
+    /**
+     * @brief Enable or disable collecting the object decode statistics.
+     * Enabling clears the statistics collected before.
+     * @param bEnabled true to collect statistics
+     */
+    void                    setStatisticsEnabled(bool bEnabled);
+    /**
+     * @brief Get the object decode statistics. May be called while other
+     * threads read the file.
+     * @return the copy of the object type <-> statistics map
+     */
+    std::map<short, ObjectStatistics> getStatistics() const;
+    /**
+     * @brief Create the independent reader of the file objects for the use in
+     * one thread. Several threads may read the same parsed file concurrently,
+     * the cursors reopen the file so the reads do not wait for each other.
+     * @return cursor pointer. The pointer have to be freed by user before the
+     * file is freed.
+     */
+    CADFileCursor*          createCursor();
+    /**
+     * @brief Count the file objects by type and the entities by layer. Only
+     * the object sizes and types are read, and the common entity data for the
+     * layer handles, the objects are visited in the file order. Should be
+     * called after parseFile.
+     * @param census Census to fill
+     * @param bLayers true to count the entities by layer as well
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    virtual int             getObjectCensus(ObjectCensus& census,
+                                            bool bLayers = true);
+
+    /**
+     * @brief Compute the drawing extents from the layers geometries, the
+     * header $EXTMIN/$EXTMAX are often outdated. Only the coordinates are
+     * decoded, the inserted blocks are bounded after their transformation.
+     * The geometries are read by several threads with own cursors.
+     * @param extents All layers extents
+     * @param layerExtents Per layer extents in the layers order or nullptr
+     * @param threadCount Threads count, 0 - the hardware concurrency
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int                     computeExtents(CADExtents& extents,
+                                std::vector<CADExtents>* layerExtents = nullptr,
+                                size_t threadCount = 0);
     virtual size_t          getLayersCount() const;
     virtual CADLayer&       getLayer(size_t index);
 //    virtual size_t GetBlocksCount();
@@ -86,12 +257,22 @@ protected:
      */
     virtual CADObject *     getObject( long index, bool bHandlesOnly = false ) = 0;
 
+    /**
+     * @brief Read the entity common data and handles only, the same as
+     * getObject with bHandlesOnly, but other objects are not decoded
+     * @param index Object index
+     * @return pointer to CADEntityObject or nullptr if the object is not an
+     * entity or failed to read. User have to free returned pointer.
+     */
+    virtual CADEntityObject * getEntityHandles( long index );
+
     /**
      * @brief read geometry from CAD file
      * @param handle Handle of CAD object
+     * @param projection ProjectionFlags mask of properties to decode
      * @return NULL if failed or pointer which mast be feed by user
      */
-    virtual CADGeometry *   getGeometry( long index ) = 0;
+    virtual CADGeometry *   getGeometry( long index, int projection ) = 0;
 
     /**
      * @brief initially read some basic values and section locator
@@ -126,11 +307,48 @@ protected:
      */
     virtual int             readTables(enum OpenOptions eOptions);
 
+    /**
+     * @brief Read the data at the file offset with the active cursor file
+     * in/out, or with the shared one under the lock
+     * @param offset File offset
+     * @param ptr Buffer to read to
+     * @param size Size to read
+     * @return size read
+     */
+    virtual size_t          readData(long offset, void* ptr, size_t size);
+    /**
+     * @brief Get the data at the file offset in place, if the file is in
+     * memory
+     * @param offset File offset
+     * @param size Size to be available from the offset
+     * @return data pointer or nullptr if the data have to be read by readData
+     */
+    virtual const char*     mapData(long offset, size_t size) const;
+    /**
+     * @brief Read the types and handles of all entities in the objects map.
+     * The entities are read in chunks by several threads with own cursors.
+     * @param entities Entities in the handles order
+     * @param threadCount Threads count, 0 - the hardware concurrency
+     */
+    void                    readEntitiesHandles(
+                                std::vector<EntityHandles>& entities,
+                                size_t threadCount = 0);
+    /**
+     * @brief Add decoded object to the statistics, if they are enabled
+     */
+    void                    addStatistics(short type, size_t bytes,
+                                          double decodeTime);
+
 protected:
     CADFileIO*              fileIO;
     CADHeader               header;
     CADClasses              classes;
     CADTables               tables;
+    ReadFilter              readFilter;
+    std::atomic<bool>       statisticsEnabled;
+    std::map<short, ObjectStatistics> statistics;
+    std::mutex              ioMutex;
+    mutable std::mutex      statisticsMutex;
 
 protected:
     std::map<long, long>    objectsMap; // object index <-> file offset
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadfilecursor.h"
+#include "cadfile.h"
+
+// The cursor used by the current thread, see CADFileCursor::Scope
+static thread_local CADFileCursor* activeCursor = nullptr;
+
+CADFileCursor::CADFileCursor(CADFile * const file, CADFileIO* poFileIO) :
+    pCADFile(file), fileIO(poFileIO)
+{
+
+}
+
+CADFileCursor::~CADFileCursor()
+{
+    if(nullptr != fileIO)
+        delete fileIO;
+}
+
+CADGeometry *CADFileCursor::getGeometry(size_t layerIndex, size_t index)
+{
+    Scope scope(this);
+    return pCADFile->getLayer (layerIndex).getGeometry (index);
+}
+
+CADGeometry *CADFileCursor::getGeometry(size_t layerIndex, size_t index,
+                                        int projection)
+{
+    Scope scope(this);
+    return pCADFile->getLayer (layerIndex).getGeometry (index, projection);
+}
+
+CADImage *CADFileCursor::getImage(size_t layerIndex, size_t index)
+{
+    Scope scope(this);
+    return pCADFile->getLayer (layerIndex).getImage (index);
+}
+
+CADFileCursor *CADFileCursor::getActive()
+{
+    return activeCursor;
+}
+
+size_t CADFileCursor::read(long offset, void *ptr, size_t size)
+{
+    if(0 != fileIO->Seek (offset, CADFileIO::SeekOrigin::BEG))
+        return 0;
+    return fileIO->Read (ptr, size);
+}
+
+CADFileCursor::Scope::Scope(CADFileCursor *cursor) : previous(activeCursor)
+{
+    activeCursor = cursor;
+}
+
+CADFileCursor::Scope::~Scope()
+{
+    activeCursor = previous;
+}
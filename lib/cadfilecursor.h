@@ -0,0 +1,103 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADFILECURSOR_H
+#define CADFILECURSOR_H
+
+#include "cadgeometry.h"
+
+class CADFile;
+class CADFileIO;
+
+/**
+ * @brief The independent reader of the CAD file objects. The file header,
+ * classes, tables and objects map are not modified after the file is parsed
+ * and are shared between cursors, each cursor reads the objects data with its
+ * own file in/out. A cursor must be used by one thread at a time and freed
+ * before the file.
+ */
+class OCAD_EXTERN CADFileCursor
+{
+    friend class CADFile;
+public:
+    virtual ~CADFileCursor();
+
+    /**
+     * @brief Get the layer geometry
+     * @param layerIndex Layer index
+     * @param index Geometry index in the layer
+     * @return NULL if failed or pointer which mast be feed by user
+     */
+    CADGeometry* getGeometry(size_t layerIndex, size_t index);
+    /**
+     * @brief Get the layer geometry with only the requested properties decoded
+     * @param layerIndex Layer index
+     * @param index Geometry index in the layer
+     * @param projection CADFile::ProjectionFlags mask
+     * @return NULL if failed or pointer which mast be feed by user
+     */
+    CADGeometry* getGeometry(size_t layerIndex, size_t index, int projection);
+    /**
+     * @brief Get the layer image
+     * @param layerIndex Layer index
+     * @param index Image index in the layer
+     * @return NULL if failed or pointer which mast be feed by user
+     */
+    CADImage* getImage(size_t layerIndex, size_t index);
+
+    /**
+     * @brief Get the cursor active in the current thread
+     * @return cursor pointer or nullptr
+     */
+    static CADFileCursor* getActive();
+
+protected:
+    CADFileCursor(CADFile * const file, CADFileIO* poFileIO);
+    size_t read(long offset, void* ptr, size_t size);
+
+    /**
+     * @brief Makes the cursor active in the current thread for the scope
+     * lifetime, the file objects are read with the cursor file in/out.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(CADFileCursor* cursor);
+        ~Scope();
+    private:
+        CADFileCursor* previous;
+    };
+
+protected:
+    CADFile * const pCADFile;
+    CADFileIO*      fileIO; // own file in/out, nullptr - shared file in/out
+};
+
+#endif // CADFILECURSOR_H
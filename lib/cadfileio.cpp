@@ -53,6 +53,16 @@ bool CADFileIO::Close()
     return true;
 }
 
+CADFileIO* CADFileIO::Clone() const
+{
+    return nullptr;
+}
+
+const char* CADFileIO::GetData(size_t& /*size*/) const
+{
+    return nullptr;
+}
+
 const char* CADFileIO::GetFilePath() const
 {
     return m_soFilePath.c_str ();
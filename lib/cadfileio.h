@@ -69,6 +69,20 @@ public:
     virtual size_t          Read(void* ptr, size_t size) = 0;
     virtual size_t          Write(void* ptr, size_t size) = 0;
     virtual void            Rewind() = 0;
+    /**
+     * @brief Create the in/out of the same file with own position
+     * @return new not opened in/out or nullptr if not supported. The pointer
+     * have to be freed by user
+     */
+    virtual CADFileIO*      Clone() const;
+    /**
+     * @brief Get the whole file content if it is in memory, so it is read in
+     * place without copies
+     * @param size Set to the content size
+     * @return content or nullptr for the stream in/outs. The content is
+     * valid while the in/out or its clones exist
+     */
+    virtual const char*     GetData(size_t& size) const;
     const char*             GetFilePath() const;
 
 protected:
@@ -42,8 +42,12 @@ CADFileStreamIO::~CADFileStreamIO()
 
 const char* CADFileStreamIO::ReadLine()
 {
-    // TODO: getline
-    return nullptr;
+    // the last line may have no line end, nothing read is the end of file
+    if(!std::getline(m_oFileStream, m_osLine))
+        return nullptr;
+    if(!m_osLine.empty() && m_osLine.back() == '\r')
+        m_osLine.pop_back();
+    return m_osLine.c_str();
 }
 
 bool CADFileStreamIO::Eof()
@@ -90,6 +94,8 @@ int CADFileStreamIO::Seek(long offset, CADFileIO::SeekOrigin origin)
         break;
     }
 
+    // reading up to the end sets the fail bit, which would fail the seek
+    m_oFileStream.clear();
     return m_oFileStream.seekg(offset, direction).good() ? 0 : 1;
 }
 
@@ -113,5 +119,11 @@ size_t CADFileStreamIO::Write(void* /*ptr*/, size_t /*size*/)
 
 void CADFileStreamIO::Rewind()
 {
+    m_oFileStream.clear();
     m_oFileStream.seekg(0, std::ios_base::beg);
 }
+
+CADFileIO* CADFileStreamIO::Clone() const
+{
+    return new CADFileStreamIO(m_soFilePath.c_str());
+}
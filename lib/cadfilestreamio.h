@@ -34,6 +34,7 @@
 #include "cadfileio.h"
 
 #include <fstream>
+#include <string>
 
 class CADFileStreamIO : public CADFileIO
 {
@@ -50,8 +51,10 @@ public:
     virtual size_t      Read(void* ptr, size_t size) override;
     virtual size_t      Write(void* ptr, size_t size) override;
     virtual void        Rewind() override;
+    virtual CADFileIO*  Clone() const override;
 protected:
     std::ifstream       m_oFileStream;
+    std::string         m_osLine;
 };
 
 #endif // CADFILESTREAMIO_H
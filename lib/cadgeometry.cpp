@@ -31,81 +31,211 @@
 
 #include "cadgeometry.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 
 using namespace std;
 
 //------------------------------------------------------------------------------
-// CADGeometry
+// Matrix
 //------------------------------------------------------------------------------
 
 Matrix::Matrix()
 {
-    matrix[0] = 1.0;
-    matrix[1] = 0.0;
-    matrix[2] = 0.0;
-    matrix[3] = 0.0;
-    matrix[4] = 1.0;
-    matrix[5] = 0.0;
-    matrix[6] = 0.0;
-    matrix[7] = 0.0;
-    matrix[8] = 1.0;
+    matrix.fill (0.0);
+    matrix[0]  = 1.0;
+    matrix[5]  = 1.0;
+    matrix[10] = 1.0;
+    matrix[15] = 1.0;
 }
 
 void Matrix::translate(const CADVector &vector)
 {
-    double a00 = matrix[0], a01 = matrix[1], a02 = matrix[2],
-              a10 = matrix[3], a11 = matrix[4], a12 = matrix[5],
-              a20 = matrix[6], a21 = matrix[7], a22 = matrix[8];
-
-    matrix[6] = vector.getX () * a00 + vector.getY () * a10 + a20;
-    matrix[7] = vector.getX () * a01 + vector.getY () * a11 + a21;
-    matrix[8] = vector.getX () * a02 + vector.getY () * a12 + a22;
+    double x = vector.getX (), y = vector.getY (), z = vector.getZ ();
+    for( size_t i = 0; i < 12; i += 4 )
+    {
+        matrix[i + 3] += matrix[i] * x + matrix[i + 1] * y + matrix[i + 2] * z;
+    }
 }
 
 void Matrix::rotate(double rotation)
 {
     double s = sin(rotation),
-           c = cos(rotation),
-           a00 = matrix[0],
-           a01 = matrix[1],
-           a02 = matrix[2],
-           a10 = matrix[3],
-           a11 = matrix[4],
-           a12 = matrix[5];
-
-        matrix[0] = c * a00 + s * a10;
-        matrix[1] = c * a01 + s * a11;
-        matrix[2] = c * a02 + s * a12;
+           c = cos(rotation);
 
-        matrix[3] = c * a10 - s * a00;
-        matrix[4] = c * a11 - s * a01;
-        matrix[5] = c * a12 - s * a02;
+    for( size_t i = 0; i < 12; i += 4 )
+    {
+        double a0 = matrix[i], a1 = matrix[i + 1];
+        matrix[i]     = c * a0 + s * a1;
+        matrix[i + 1] = c * a1 - s * a0;
+    }
 }
 
 void Matrix::scale(const CADVector &vector)
 {
-    matrix[0] *= vector.getX ();
-    matrix[1] *= vector.getX ();
-    matrix[2] *= vector.getX ();
-    matrix[3] *= vector.getY ();
-    matrix[4] *= vector.getY ();
-    matrix[5] *= vector.getY ();
+    double x = vector.getX (), y = vector.getY ();
+    // 2D scale vectors leave Z untouched.
+    double z = vector.getBHasZ () ? vector.getZ () : 1.0;
+    for( size_t i = 0; i < 12; i += 4 )
+    {
+        matrix[i]     *= x;
+        matrix[i + 1] *= y;
+        matrix[i + 2] *= z;
+    }
 }
 
 CADVector Matrix::multiply(const CADVector &vector) const
 {
-    CADVector out;
-    out.setX (vector.getX () * matrix[0] + vector.getY () * matrix[1] +
-            vector.getZ () * matrix[2]);
-    out.setY (vector.getX () * matrix[3] + vector.getY () * matrix[4] +
-            vector.getZ () * matrix[5]);
-    out.setZ (vector.getX () * matrix[6] + vector.getY () * matrix[7] +
-            vector.getZ () * matrix[8]);
+    CADVector out(vector);
+    multiply(&out, 1);
     return out;
 }
 
+Matrix Matrix::multiply(const Matrix &other) const
+{
+    Matrix out;
+    const array<double, 16> &b = other.matrix;
+    for( size_t i = 0; i < 12; i += 4 )
+    {
+        double a0 = matrix[i], a1 = matrix[i + 1], a2 = matrix[i + 2];
+        out.matrix[i]     = a0 * b[0] + a1 * b[4] + a2 * b[8];
+        out.matrix[i + 1] = a0 * b[1] + a1 * b[5] + a2 * b[9];
+        out.matrix[i + 2] = a0 * b[2] + a1 * b[6] + a2 * b[10];
+        out.matrix[i + 3] = a0 * b[3] + a1 * b[7] + a2 * b[11] + matrix[i + 3];
+    }
+    return out;
+}
+
+void Matrix::multiply(CADVector *vertexes, size_t count) const
+{
+    const double m0 = matrix[0], m1 = matrix[1], m2  = matrix[2],  m3  = matrix[3],
+                 m4 = matrix[4], m5 = matrix[5], m6  = matrix[6],  m7  = matrix[7],
+                 m8 = matrix[8], m9 = matrix[9], m10 = matrix[10], m11 = matrix[11];
+    for( size_t i = 0; i < count; ++i )
+    {
+        CADVector &v = vertexes[i];
+        double x = v.X, y = v.Y, z = v.Z;
+        v.X = m0 * x + m1 * y + m2  * z + m3;
+        v.Y = m4 * x + m5 * y + m6  * z + m7;
+        v.Z = m8 * x + m9 * y + m10 * z + m11;
+        // Keep 2D vertexes 2D while they stay in the XY plane.
+        v.bHasZ = v.bHasZ || v.Z != 0.0;
+    }
+}
+
+void Matrix::multiply(double *xyz, size_t count) const
+{
+    const double m0 = matrix[0], m1 = matrix[1], m2  = matrix[2],  m3  = matrix[3],
+                 m4 = matrix[4], m5 = matrix[5], m6  = matrix[6],  m7  = matrix[7],
+                 m8 = matrix[8], m9 = matrix[9], m10 = matrix[10], m11 = matrix[11];
+    for( size_t i = 0; i < count * 3; i += 3 )
+    {
+        double x = xyz[i], y = xyz[i + 1], z = xyz[i + 2];
+        xyz[i]     = m0 * x + m1 * y + m2  * z + m3;
+        xyz[i + 1] = m4 * x + m5 * y + m6  * z + m7;
+        xyz[i + 2] = m8 * x + m9 * y + m10 * z + m11;
+    }
+}
+
+CADVector Matrix::multiplyDirection(const CADVector &vector) const
+{
+    double x = vector.getX (), y = vector.getY (), z = vector.getZ ();
+    return CADVector(matrix[0] * x + matrix[1] * y + matrix[2] * z,
+                     matrix[4] * x + matrix[5] * y + matrix[6] * z,
+                     matrix[8] * x + matrix[9] * y + matrix[10] * z);
+}
+
+bool Matrix::isIdentity() const
+{
+    return matrix == Matrix().matrix;
+}
+
+Matrix Matrix::fromExtrusion(const CADVector &extrusion)
+{
+    Matrix out;
+    double nx = extrusion.getX (), ny = extrusion.getY (), nz = extrusion.getZ ();
+    double len = sqrt( nx * nx + ny * ny + nz * nz );
+    if( len == 0.0 )
+        return out;
+    nx /= len; ny /= len; nz /= len;
+
+    // Arbitrary axis algorithm: if the normal is close to the world Z axis
+    // Ax = Wy x N, otherwise Ax = Wz x N. Ay = N x Ax.
+    double ax, ay, az;
+    if( fabs( nx ) < 1.0 / 64 && fabs( ny ) < 1.0 / 64 )
+    {
+        ax = nz; ay = 0.0; az = -nx;
+    }
+    else
+    {
+        ax = -ny; ay = nx; az = 0.0;
+    }
+    len = sqrt( ax * ax + ay * ay + az * az );
+    ax /= len; ay /= len; az /= len;
+
+    double bx = ny * az - nz * ay,
+           by = nz * ax - nx * az,
+           bz = nx * ay - ny * ax;
+
+    // OCS axes are the matrix columns.
+    out.matrix[0] = ax; out.matrix[1] = bx; out.matrix[2]  = nx;
+    out.matrix[4] = ay; out.matrix[5] = by; out.matrix[6]  = ny;
+    out.matrix[8] = az; out.matrix[9] = bz; out.matrix[10] = nz;
+    return out;
+}
+
+static double dot(const CADVector& first, const CADVector& second)
+{
+    return first.getX () * second.getX () + first.getY () * second.getY () +
+           first.getZ () * second.getZ ();
+}
+
+static CADVector cross(const CADVector& first, const CADVector& second)
+{
+    return CADVector(first.getY () * second.getZ () - first.getZ () * second.getY (),
+                     first.getZ () * second.getX () - first.getX () * second.getZ (),
+                     first.getX () * second.getY () - first.getY () * second.getX ());
+}
+
+static CADVector scaled(const CADVector& vector, double factor)
+{
+    return CADVector(vector.getX () * factor, vector.getY () * factor,
+                     vector.getZ () * factor);
+}
+
+static CADVector combined(const CADVector& first, double firstFactor,
+                          const CADVector& second, double secondFactor)
+{
+    return CADVector(first.getX () * firstFactor + second.getX () * secondFactor,
+                     first.getY () * firstFactor + second.getY () * secondFactor,
+                     first.getZ () * firstFactor + second.getZ () * secondFactor);
+}
+
+/**
+ * @brief Transforms the OCS X and Y axes of the extrusion and replaces the
+ * extrusion by the normal of the transformed axes, so a mirrored plane gets
+ * the opposite extrusion and the counterclockwise angles stay such.
+ * @param matrix Transformation
+ * @param extrusion OCS extrusion to transform
+ * @param xAxis Transformed OCS X axis
+ * @return area scale of the plane
+ */
+static double transformOCS(const Matrix& matrix, CADVector& extrusion,
+                           CADVector& xAxis)
+{
+    Matrix ocs = Matrix::fromExtrusion (extrusion);
+    xAxis = matrix.multiplyDirection (
+                ocs.multiplyDirection (CADVector(1.0, 0.0, 0.0)));
+    CADVector yAxis = matrix.multiplyDirection (
+                ocs.multiplyDirection (CADVector(0.0, 1.0, 0.0)));
+    CADVector normal = cross (xAxis, yAxis);
+    double area = sqrt(dot (normal, normal));
+    if( area > 0.0 )
+        extrusion = scaled (normal, 1.0 / area);
+    return area;
+}
+
 //------------------------------------------------------------------------------
 // CADGeometry
 //------------------------------------------------------------------------------
@@ -314,6 +444,27 @@ void CADCircle::print() const
 
 }
 
+void CADCircle::transform(const Matrix &matrix)
+{
+    CADPoint3D::transform (matrix);
+    CADVector xAxis;
+    radius *= sqrt(transformOCS (matrix, extrusion, xAxis));
+}
+
+bool CADCircle::isTransformedToCircle(const Matrix &matrix) const
+{
+    Matrix ocs = Matrix::fromExtrusion (extrusion);
+    CADVector xAxis = matrix.multiplyDirection (
+                ocs.multiplyDirection (CADVector(1.0, 0.0, 0.0)));
+    CADVector yAxis = matrix.multiplyDirection (
+                ocs.multiplyDirection (CADVector(0.0, 1.0, 0.0)));
+    double xLength = dot (xAxis, xAxis);
+    double yLength = dot (yAxis, yAxis);
+    double epsilon = 1e-9 * max (xLength, yLength);
+    return fabs(xLength - yLength) <= epsilon &&
+           fabs(dot (xAxis, yAxis)) <= epsilon;
+}
+
 //------------------------------------------------------------------------------
 // CADArc
 //------------------------------------------------------------------------------
@@ -323,6 +474,12 @@ CADArc::CADArc() : CADCircle(), startingAngle(0.0f), endingAngle(0.0f)
     geometryType = CADGeometry::ARC;
 }
 
+CADArc::CADArc(const CADCircle &circle) : CADCircle(circle),
+    startingAngle(0.0), endingAngle(2 * acos(-1.0))
+{
+    geometryType = CADGeometry::ARC;
+}
+
 double CADArc::getStartingAngle() const
 {
     return startingAngle;
@@ -357,6 +514,19 @@ void CADArc::print() const
          << endl;
 }
 
+void CADArc::transform(const Matrix &matrix)
+{
+    CADPoint3D::transform (matrix);
+    CADVector xAxis;
+    radius *= sqrt(transformOCS (matrix, extrusion, xAxis));
+    // the angle of the transformed OCS X axis in the new OCS
+    Matrix ocs = Matrix::fromExtrusion (extrusion);
+    double turn = atan2(dot (xAxis, ocs.multiplyDirection (CADVector(0.0, 1.0, 0.0))),
+                        dot (xAxis, ocs.multiplyDirection (CADVector(1.0, 0.0, 0.0))));
+    startingAngle += turn;
+    endingAngle += turn;
+}
+
 //------------------------------------------------------------------------------
 // CADPolyline3D
 //------------------------------------------------------------------------------
@@ -381,6 +551,11 @@ CADVector &CADPolyline3D::getVertex(size_t index)
     return vertexes[index];
 }
 
+void CADPolyline3D::setVertexes(const vector<CADVector> &value)
+{
+    vertexes = value;
+}
+
 void CADPolyline3D::print() const
 {
     cout << "|------Polyline3D-----|" << endl;
@@ -394,17 +569,14 @@ void CADPolyline3D::print() const
 
 void CADPolyline3D::transform(const Matrix &matrix)
 {
-    for(CADVector& vertex : vertexes)
-    {
-        vertex = matrix.multiply(vertex);
-    }
+    matrix.multiply (vertexes.data (), vertexes.size ());
 }
 
 //------------------------------------------------------------------------------
 // CADLWPolyline
 //------------------------------------------------------------------------------
 
-CADLWPolyline::CADLWPolyline()
+CADLWPolyline::CADLWPolyline() : closed(false)
 {
     geometryType = CADGeometry::LWPOLYLINE;
 }
@@ -460,6 +632,39 @@ void CADLWPolyline::setWidths(const vector<pair<double, double> > &value)
     widths = value;
 }
 
+const vector<double>& CADLWPolyline::getBulges() const
+{
+    return bulges;
+}
+
+void CADLWPolyline::setBulges(const vector<double> &value)
+{
+    bulges = value;
+}
+
+bool CADLWPolyline::getClosed() const
+{
+    return closed;
+}
+
+void CADLWPolyline::setClosed(bool value)
+{
+    closed = value;
+}
+
+void CADLWPolyline::transform(const Matrix &matrix)
+{
+    CADPolyline3D::transform (matrix);
+    CADVector xAxis;
+    double factor = sqrt(transformOCS (matrix, vectExtrusion, xAxis));
+    constWidth *= factor;
+    for( pair<double, double>& width : widths )
+    {
+        width.first *= factor;
+        width.second *= factor;
+    }
+}
+
 //------------------------------------------------------------------------------
 // CADEllipse
 //------------------------------------------------------------------------------
@@ -469,6 +674,13 @@ CADEllipse::CADEllipse(): CADArc(), axisRatio(0.0f)
     geometryType = CADGeometry::ELLIPSE;
 }
 
+CADEllipse::CADEllipse(const CADArc &arc) : CADArc(arc), axisRatio(1.0)
+{
+    geometryType = CADGeometry::ELLIPSE;
+    vectSMAxis = Matrix::fromExtrusion (extrusion).multiplyDirection (
+                CADVector(radius, 0.0, 0.0));
+}
+
 double CADEllipse::getAxisRatio() const
 {
     return axisRatio;
@@ -502,6 +714,38 @@ void CADEllipse::print() const
          << endl;
 }
 
+void CADEllipse::transform(const Matrix &matrix)
+{
+    CADPoint3D::transform (matrix);
+    double length = sqrt(dot (extrusion, extrusion));
+    CADVector minorAxis = cross (length > 0.0 ? scaled (extrusion, 1.0 / length) :
+                                                CADVector(0.0, 0.0, 1.0),
+                                 vectSMAxis);
+    minorAxis = matrix.multiplyDirection (scaled (minorAxis, axisRatio));
+    CADVector majorAxis = matrix.multiplyDirection (vectSMAxis);
+
+    // the point is major * cos(t) + minor * sin(t), the axes are at the
+    // parameter turn where the diameters are orthogonal
+    double majorDot = dot (majorAxis, majorAxis);
+    double minorDot = dot (minorAxis, minorAxis);
+    double turn = 0.5 * atan2(2 * dot (majorAxis, minorAxis),
+                              majorDot - minorDot);
+    double c = cos(turn), s = sin(turn);
+    vectSMAxis = combined (majorAxis, c, minorAxis, s);
+    minorAxis = combined (minorAxis, c, majorAxis, -s);
+    startingAngle -= turn;
+    endingAngle -= turn;
+
+    double majorLength = sqrt(dot (vectSMAxis, vectSMAxis));
+    CADVector normal = cross (vectSMAxis, minorAxis);
+    double area = sqrt(dot (normal, normal));
+    if( majorLength > 0.0 && area > 0.0 )
+    {
+        extrusion = scaled (normal, 1.0 / area);
+        axisRatio = sqrt(dot (minorAxis, minorAxis)) / majorLength;
+    }
+}
+
 //------------------------------------------------------------------------------
 // CADText
 //------------------------------------------------------------------------------
@@ -592,6 +836,15 @@ void CADRay::print() const
          << "\n" << std::endl;
 }
 
+void CADRay::transform(const Matrix &matrix)
+{
+    CADPoint3D::transform (matrix);
+    CADVector direction = matrix.multiplyDirection (extrusion);
+    double length = sqrt(dot (direction, direction));
+    if( length > 0.0 )
+        extrusion = scaled (direction, 1.0 / length);
+}
+
 //------------------------------------------------------------------------------
 // CADHatch
 //------------------------------------------------------------------------------
@@ -605,7 +858,15 @@ CADHatch::CADHatch()
 // CADSpline
 //------------------------------------------------------------------------------
 
-CADSpline::CADSpline()
+CADSpline::CADSpline() :
+    scenario(0),
+    rational(false),
+    closed(false),
+    weight(false),
+    fitTollerance(0.0),
+    degree(0),
+    begTangent(0.0, 0.0, 0.0),
+    endTangent(0.0, 0.0, 0.0)
 {
     geometryType = CADGeometry::SPLINE;
 }
@@ -643,10 +904,18 @@ void CADSpline::print() const
 
 void CADSpline::transform(const Matrix &matrix)
 {
-    for(CADVector& pt : avertCtrlPoints)
-        pt = matrix.multiply (pt);
-    for(CADVector& pt : averFitPoints)
-        pt = matrix.multiply (pt);
+    matrix.multiply (avertCtrlPoints.data (), avertCtrlPoints.size ());
+    matrix.multiply (averFitPoints.data (), averFitPoints.size ());
+    // tangents are directions, not affected by the translation
+    CADVector origin = matrix.multiply (CADVector(0.0, 0.0, 0.0));
+    CADVector beg = matrix.multiply (begTangent);
+    CADVector end = matrix.multiply (endTangent);
+    begTangent = CADVector(beg.getX () - origin.getX (),
+                           beg.getY () - origin.getY (),
+                           beg.getZ () - origin.getZ ());
+    endTangent = CADVector(end.getX () - origin.getX (),
+                           end.getY () - origin.getY (),
+                           end.getZ () - origin.getZ ());
 }
 
 long CADSpline::getScenario() const
@@ -739,6 +1008,36 @@ vector<double>& CADSpline::getControlPointsWeights()
     return ctrlPointsWeight;
 }
 
+vector<double>& CADSpline::getKnots()
+{
+    return knots;
+}
+
+void CADSpline::addKnot(double knot)
+{
+    knots.push_back (knot);
+}
+
+CADVector CADSpline::getBegTangent() const
+{
+    return begTangent;
+}
+
+void CADSpline::setBegTangent(const CADVector &value)
+{
+    begTangent = value;
+}
+
+CADVector CADSpline::getEndTangent() const
+{
+    return endTangent;
+}
+
+void CADSpline::setEndTangent(const CADVector &value)
+{
+    endTangent = value;
+}
+
 //------------------------------------------------------------------------------
 // CADSolid
 //------------------------------------------------------------------------------
@@ -764,8 +1063,7 @@ void CADSolid::print() const
 void CADSolid::transform(const Matrix &matrix)
 {
     CADPoint3D::transform (matrix);
-    for(CADVector& corner : avertCorners)
-        corner = matrix.multiply (corner);
+    matrix.multiply (avertCorners.data (), avertCorners.size ());
 }
 
 double CADSolid::getElevation() const
@@ -783,6 +1081,11 @@ void CADSolid::addAverCorner(const CADVector &corner)
     avertCorners.push_back (corner);
 }
 
+const vector<CADVector>& CADSolid::getAverCorners() const
+{
+    return avertCorners;
+}
+
 //------------------------------------------------------------------------------
 // CADImage
 //------------------------------------------------------------------------------
@@ -895,8 +1198,7 @@ void CADImage::print() const
 void CADImage::transform(const Matrix &matrix)
 {
     vertInsertionPoint = matrix.multiply (vertInsertionPoint);
-    for(CADVector& pt : avertClippingPolygon)
-        pt = matrix.multiply (pt);
+    matrix.multiply (avertClippingPolygon.data (), avertClippingPolygon.size ());
 }
 
 void CADImage::addClippingPoint(const CADVector &pt)
@@ -989,10 +1291,7 @@ void CADFace3D::print() const
 
 void CADFace3D::transform(const Matrix &matrix)
 {
-    for(CADVector &corner : avertCorners)
-    {
-        corner = matrix.multiply (corner);
-    }
+    matrix.multiply (avertCorners.data (), avertCorners.size ());
 }
 
 short CADFace3D::getInvisFlags() const
@@ -1029,8 +1328,7 @@ void CADPolylinePFace::print() const
 
 void CADPolylinePFace::transform(const Matrix &matrix)
 {
-    for(CADVector& vertex : vertexes)
-        vertex = matrix.multiply (vertex);
+    matrix.multiply (vertexes.data (), vertexes.size ());
 }
 
 void CADPolylinePFace::addVertex(const CADVector &vertex)
@@ -1038,6 +1336,11 @@ void CADPolylinePFace::addVertex(const CADVector &vertex)
     vertexes.push_back (vertex);
 }
 
+const vector<CADVector>& CADPolylinePFace::getVertexes() const
+{
+    return vertexes;
+}
+
 //------------------------------------------------------------------------------
 // CADXLine
 //------------------------------------------------------------------------------
@@ -1091,10 +1394,7 @@ void CADMLine::print() const
 void CADMLine::transform(const Matrix &matrix)
 {
     CADPoint3D::transform (matrix);
-    for(CADVector& vertex : avertVertexes)
-    {
-        vertex = matrix.multiply (vertex);
-    }
+    matrix.multiply (avertVertexes.data (), avertVertexes.size ());
 }
 
 double CADMLine::getScale() const
@@ -1122,6 +1422,11 @@ void CADMLine::addVertex(const CADVector &vertex)
     avertVertexes.push_back (vertex);
 }
 
+const vector<CADVector>& CADMLine::getVertexes() const
+{
+    return avertVertexes;
+}
+
 //------------------------------------------------------------------------------
 // CADAttrib
 //------------------------------------------------------------------------------
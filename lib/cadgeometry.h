@@ -35,10 +35,16 @@
 #include "cadobjects.h"
 #include "cadcolors.h"
 
+#include <array>
+
 using namespace std;
 
 /**
- * @brief The Matrix class
+ * @brief The 4x4 affine transformation matrix class
+ *
+ * The matrix is stored row-major and transforms column vectors, so the
+ * translate/rotate/scale calls are post-multiplied: the last operation added
+ * is the first one applied to a point. The bottom row is always (0 0 0 1).
  */
 class Matrix
 {
@@ -48,8 +54,30 @@ public:
     void rotate(double rotation);
     void scale(const CADVector &vector);
     CADVector multiply(const CADVector &vector) const;
+    /**
+     * @brief Composition: returns this * other, so other is applied first.
+     */
+    Matrix multiply(const Matrix &other) const;
+    /**
+     * @brief Transforms the contiguous array of vertexes in place.
+     */
+    void multiply(CADVector *vertexes, size_t count) const;
+    /**
+     * @brief Transforms count points stored as interleaved x, y, z doubles.
+     */
+    void multiply(double *xyz, size_t count) const;
+    /**
+     * @brief Transforms the direction vector: the translation is not applied.
+     */
+    CADVector multiplyDirection(const CADVector &vector) const;
+    bool isIdentity() const;
+    /**
+     * @brief Returns the OCS to WCS matrix for the extrusion (normal) vector,
+     * built with the DWG/DXF arbitrary axis algorithm.
+     */
+    static Matrix fromExtrusion(const CADVector &extrusion);
 protected:
-    array<double, 9> matrix;
+    array<double, 16> matrix;
 };
 
 /**
@@ -165,6 +193,7 @@ public:
     void                addVertex(const CADVector& vertex);
     size_t              getVertexCount() const;
     CADVector&          getVertex(size_t index);
+    void                setVertexes(const vector<CADVector>& value);
 
     virtual void        print () const override;
     virtual void        transform(const Matrix& matrix) override;
@@ -193,12 +222,28 @@ public:
     vector<pair<double, double> > getWidths() const;
     void                          setWidths(const vector<pair<double, double> > &value);
 
+    const vector<double>&         getBulges() const;
+    void                          setBulges(const vector<double> &value);
+
+    bool                          getClosed() const;
+    void                          setClosed(bool value);
+
     virtual void print () const override;
+    /**
+     * @brief Transforms the vertexes and the extrusion, the widths are scaled.
+     * The mirrored polyline gets the opposite extrusion, so the bulges keep
+     * their signs. The non-uniform scale keeps the bulges, so the bulge arcs
+     * stay circular instead of elliptical, and the widths are scaled by the
+     * mean scale of the plane.
+     */
+    virtual void transform(const Matrix& matrix) override;
 protected:
     double                           constWidth;
     double                           elevation;
     CADVector                        vectExtrusion;
     vector< pair< double, double > > widths; // start, end.
+    vector< double >                 bulges; // per vertex, empty if no arcs
+    bool                             closed;
 };
 
 /**
@@ -213,6 +258,18 @@ public:
     void                setRadius(double value);
 
     virtual void        print () const override;
+    /**
+     * @brief Transforms the center and the extrusion and scales the radius.
+     * A circle can not be scaled non-uniformly, the radius is scaled by the
+     * mean scale of its plane then. Such circles are transformed as the
+     * CADEllipse, see isTransformedToCircle.
+     */
+    virtual void        transform(const Matrix& matrix) override;
+    /**
+     * @brief Check the transformed circle stays the circle: the transformed
+     * OCS axes are orthogonal and have equal lengths
+     */
+    bool                isTransformedToCircle(const Matrix& matrix) const;
 protected:
     double              radius;
 };
@@ -252,6 +309,10 @@ class CADArc : public CADCircle
 {
 public:
     CADArc();
+    /**
+     * @brief The full circle arc, from 0 to 2 * pi
+     */
+    explicit CADArc(const CADCircle& circle);
 
     double              getStartingAngle() const;
     void                setStartingAngle(double value);
@@ -260,6 +321,11 @@ public:
     void                setEndingAngle(double value);
 
     virtual void        print () const override;
+    /**
+     * @brief Transforms the arc as a circle, the angles are turned with the
+     * arc plane axes
+     */
+    virtual void        transform(const Matrix& matrix) override;
 protected:
     double              startingAngle;
     double              endingAngle;
@@ -272,6 +338,11 @@ class CADEllipse : public CADArc
 {
 public:
     CADEllipse();
+    /**
+     * @brief The ellipse of the arc: the major axis is the OCS X axis of the
+     * radius length and the axis ratio is 1, the parameters are the angles
+     */
+    explicit CADEllipse(const CADArc& arc);
 
     double              getAxisRatio() const;
     void                setAxisRatio(double value);
@@ -280,6 +351,13 @@ public:
     void                setSMAxis(const CADVector& vectSMA);
 
     virtual void        print () const override;
+    /**
+     * @brief Transforms the center, the major and the minor axes. The
+     * transformed axes are the conjugate diameters, the new axes are found
+     * where they are orthogonal and the parameters are shifted to keep the
+     * start and the end points.
+     */
+    virtual void        transform(const Matrix& matrix) override;
 protected:
     CADVector           vectSMAxis;
     double              axisRatio;
@@ -305,10 +383,21 @@ public:
     vector<CADVector>&  getControlPoints();
     vector<CADVector>&  getFitPoints();
     vector<double>&     getControlPointsWeights();
+    vector<double>&     getKnots();
 
     void                addControlPointsWeight(double weight);
     void                addControlPoint(const CADVector& point);
     void                addFitPoint(const CADVector& point);
+    void                addKnot(double knot);
+
+    /**
+     * @brief Start and end tangent directions of the fit points spline, zero
+     * vector if not set
+     */
+    CADVector           getBegTangent() const;
+    void                setBegTangent(const CADVector& value);
+    CADVector           getEndTangent() const;
+    void                setEndTangent(const CADVector& value);
     bool                getWeight() const;
     void                setWeight(bool value);
 
@@ -327,8 +416,11 @@ protected:
     bool                weight;
     double              fitTollerance;
     long                degree;
+    CADVector           begTangent;
+    CADVector           endTangent;
 
     vector < double >    ctrlPointsWeight;
+    vector < double >    knots;
     vector < CADVector > avertCtrlPoints;
     vector < CADVector > averFitPoints;
 };
@@ -344,6 +436,7 @@ public:
     double              getElevation() const;
     void                setElevation(double value);
     void                addAverCorner(const CADVector& corner);
+    const vector<CADVector>& getAverCorners() const;
 
     virtual void        print () const override;
     virtual void        transform(const Matrix& matrix) override;
@@ -364,6 +457,10 @@ public:
     void                setVectVector(const CADVector &value);
 
     virtual void        print () const override;
+    /**
+     * @brief Transforms the base point and the direction
+     */
+    virtual void        transform(const Matrix& matrix) override;
 };
 
 /**
@@ -498,6 +595,7 @@ public:
     CADPolylinePFace();
 
     void                addVertex(const CADVector& vertex);
+    const vector<CADVector>& getVertexes() const;
 
     virtual void        print () const override;
     virtual void        transform(const Matrix& matrix) override;
@@ -531,6 +629,7 @@ public:
     void                setOpened(bool value);
 
     void                addVertex(const CADVector& vertex);
+    const vector<CADVector>& getVertexes() const;
 
     virtual void        print () const override;
     virtual void        transform(const Matrix& matrix) override;
@@ -32,8 +32,10 @@
 #include "cadheader.h"
 #include "opencad_api.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <unordered_map>
 
 using namespace std;
 
@@ -347,126 +349,61 @@ bool CADHandle::isNull () const
 // CADVariant
 //------------------------------------------------------------------------------
 
-CADVariant::CADVariant()
+CADVariant::CADVariant() : type(DataType::INVALID)
 {
-    type = DataType::INVALID;
-    decimalVal = 0;
-    xVal = 0;
-    yVal = 0;
-    zVal = 0;
-    dateTimeVal = 0;
+    value.decimalVal = 0;
 }
 
-CADVariant::CADVariant(const char* val)
+CADVariant::CADVariant(const char* val) : type(DataType::STRING), stringVal(val)
 {
-    type = DataType::STRING;
-    stringVal = string(val);
-    decimalVal = 0;
-    xVal = 0;
-    yVal = 0;
-    zVal = 0;
-    dateTimeVal = 0;
+    value.decimalVal = 0;
 }
 
-CADVariant::CADVariant(int val)
+CADVariant::CADVariant(int val) : type(DataType::DECIMAL)
 {
-    type = DataType::DECIMAL;
-    decimalVal = val;
-    stringVal = to_string(decimalVal);
-    xVal = 0;
-    yVal = 0;
-    zVal = 0;
-    dateTimeVal = 0;
+    value.decimalVal = val;
 }
 
-CADVariant::CADVariant(short val)
+CADVariant::CADVariant(short val) : type(DataType::DECIMAL)
 {
-    type = DataType::DECIMAL;
-    decimalVal = val;
-    stringVal = to_string(decimalVal);
-    xVal = 0;
-    yVal = 0;
-    zVal = 0;
-    dateTimeVal = 0;
+    value.decimalVal = val;
 }
 
-CADVariant::CADVariant(double val)
+CADVariant::CADVariant(double val) : type(DataType::REAL)
 {
-    type = DataType::REAL;
-    xVal = val;
-    stringVal = to_string(xVal);
-    decimalVal = 0;
-    yVal = 0;
-    zVal = 0;
-    dateTimeVal = 0;
+    value.xyzVal[0] = val;
+    value.xyzVal[1] = 0;
+    value.xyzVal[2] = 0;
 }
 
-CADVariant::CADVariant(double x, double y, double z)
+CADVariant::CADVariant(double x, double y, double z) :
+    type(DataType::COORDINATES)
 {
-    type = DataType::COORDINATES;
-    xVal = x;
-    yVal = y;
-    zVal = z;
-
-    char str_buff[256];
-    snprintf (str_buff, 255, "[%f,%f,%f]", x, y, z);
-    stringVal = str_buff;
-
-    decimalVal = 0;
-    dateTimeVal = 0;
+    value.xyzVal[0] = x;
+    value.xyzVal[1] = y;
+    value.xyzVal[2] = z;
 }
 
-CADVariant::CADVariant(const string& val)
+CADVariant::CADVariant(const string& val) : type(DataType::STRING),
+    stringVal(val)
 {
-    type = DataType::STRING;
-    stringVal = val;
-
-    decimalVal = 0;
-    xVal = 0;
-    yVal = 0;
-    zVal = 0;
-    dateTimeVal = 0;
+    value.decimalVal = 0;
 }
 
-CADVariant::CADVariant(time_t val)
+CADVariant::CADVariant(time_t val) : type(DataType::DATETIME)
 {
-    type = DataType::DATETIME;
-    dateTimeVal = val;
-
-    //TODO: data/time format
-    char str_buff[256];
-    snprintf (str_buff, 255, "%ld", dateTimeVal);
-    stringVal = str_buff;
-
-    decimalVal = 0;
-    xVal = 0;
-    yVal = 0;
-    zVal = 0;
+    value.dateTimeVal = val;
 }
 
-CADVariant::CADVariant(const CADHandle& val)
+CADVariant::CADVariant(const CADHandle& val) : type(DataType::HANDLE),
+    handleVal(val)
 {
-    type = DataType::HANDLE;
-    handleVal = val;
-    stringVal = to_string(val.getAsLong ());
-
-    decimalVal = 0;
-    xVal = 0;
-    yVal = 0;
-    zVal = 0;
-    dateTimeVal = 0;
+    value.decimalVal = 0;
 }
 
-CADVariant::CADVariant(const CADVariant& orig)
+CADVariant::CADVariant(const CADVariant& orig) : type(orig.type),
+    value(orig.value), stringVal(orig.stringVal), handleVal(orig.handleVal)
 {
-    type = orig.type;
-    stringVal = orig.stringVal;
-    decimalVal = orig.decimalVal;
-    xVal = orig.xVal;
-    yVal = orig.yVal;
-    zVal = orig.zVal;
-    handleVal = orig.handleVal;
-    dateTimeVal = orig.dateTimeVal;
 }
 
 CADVariant& CADVariant::operator = (const CADVariant& orig)
@@ -474,29 +411,44 @@ CADVariant& CADVariant::operator = (const CADVariant& orig)
     if (this == &orig)
         return *this;
     type = orig.type;
+    value = orig.value;
     stringVal = orig.stringVal;
-    decimalVal = orig.decimalVal;
-    xVal = orig.xVal;
-    yVal = orig.yVal;
-    zVal = orig.zVal;
     handleVal = orig.handleVal;
-    dateTimeVal = orig.dateTimeVal;
     return *this;
 }
 
 long CADVariant::getDecimal() const
 {
-    return decimalVal;
+    return type == DataType::DECIMAL ? value.decimalVal : 0;
 }
 
 double CADVariant::getReal() const
 {
-    return xVal;
+    return getX();
 }
 
-const string &CADVariant::getString() const
+string CADVariant::getString() const
 {
-    return stringVal;
+    char str_buff[256];
+    switch(type)
+    {
+        case DataType::DECIMAL:
+            return to_string(value.decimalVal);
+        case DataType::REAL:
+            return to_string(value.xyzVal[0]);
+        case DataType::COORDINATES:
+            snprintf (str_buff, 255, "[%f,%f,%f]", value.xyzVal[0],
+                      value.xyzVal[1], value.xyzVal[2]);
+            return str_buff;
+        case DataType::DATETIME:
+            //TODO: data/time format
+            snprintf (str_buff, 255, "%ld", static_cast<long>(value.dateTimeVal));
+            return str_buff;
+        case DataType::HANDLE:
+            return to_string(handleVal.getAsLong ());
+        default:
+            return stringVal;
+    }
 }
 
 CADVariant::DataType CADVariant::getType() const
@@ -506,17 +458,25 @@ CADVariant::DataType CADVariant::getType() const
 
 double CADVariant::getX() const
 {
-    return xVal;
+    return type == DataType::REAL || type == DataType::COORDINATES ?
+                value.xyzVal[0] : 0;
 }
 
 double CADVariant::getY() const
 {
-    return yVal;
+    return type == DataType::REAL || type == DataType::COORDINATES ?
+                value.xyzVal[1] : 0;
 }
 
 double CADVariant::getZ() const
 {
-    return zVal;
+    return type == DataType::REAL || type == DataType::COORDINATES ?
+                value.xyzVal[2] : 0;
+}
+
+time_t CADVariant::getDateTime() const
+{
+    return type == DataType::DATETIME ? value.dateTimeVal : 0;
 }
 
 const CADHandle &CADVariant::getHandle() const
@@ -528,16 +488,116 @@ const CADHandle &CADVariant::getHandle() const
 // CADHeader
 //------------------------------------------------------------------------------
 
-CADHeader::CADHeader()
+// Codes below are stored in the dense array, see CADHeaderConstants.
+static const short CADHeaderValuesCount = CADHeader::TSTACKSIZE + 1;
+
+CADHeader::CADHeader() : values(CADHeaderValuesCount), valuesCount(0)
+{
+}
+
+CADHeader::Slot *CADHeader::findValue(short code)
+{
+    return const_cast<Slot*>(
+                static_cast<const CADHeader*>(this)->findValue(code));
+}
+
+const CADHeader::Slot *CADHeader::findValue(short code) const
 {
+    if(code >= 0 && code < CADHeaderValuesCount)
+        return &values[code];
+
+    auto it = lower_bound(userValues.begin(), userValues.end(), code,
+                          [](const pair<short, Slot>& val, short key)
+                          { return val.first < key; });
+    if(it != userValues.end() && it->first == code)
+        return &it->second;
+    return nullptr;
+}
+
+const string& CADHeader::emptyString()
+{
+    static const string empty;
+    return empty;
+}
+
+const CADHandle& CADHeader::emptyHandle()
+{
+    static const CADHandle empty;
+    return empty;
+}
+
+CADVariant CADHeader::toVariant(const Slot &slot) const
+{
+    switch(slot.type)
+    {
+        case CADVariant::DataType::DECIMAL:
+            return CADVariant(static_cast<int>(slot.value.decimalVal));
+        case CADVariant::DataType::REAL:
+            return CADVariant(slot.value.realVal);
+        case CADVariant::DataType::STRING:
+            return CADVariant(strings[slot.value.index]);
+        case CADVariant::DataType::DATETIME:
+            return CADVariant(slot.value.dateTimeVal);
+        case CADVariant::DataType::COORDINATES:
+        {
+            const CADVector& xyz = coordinates[slot.value.index];
+            return CADVariant(xyz.getX(), xyz.getY(), xyz.getZ());
+        }
+        case CADVariant::DataType::HANDLE:
+            return CADVariant(handles[slot.value.index]);
+        default:
+            return CADVariant();
+    }
 }
 
 int CADHeader::addValue(short code, const CADVariant &val)
 {
-    if(valuesMap.find(code) != valuesMap.end())
+    Slot* pValue = findValue(code);
+    if(nullptr != pValue && pValue->type != CADVariant::DataType::INVALID)
         return CADErrorCodes::VALUE_EXISTS;
 
-    valuesMap[code] = val;
+    Slot slot;
+    slot.type = val.getType();
+    switch(slot.type)
+    {
+        case CADVariant::DataType::DECIMAL:
+            slot.value.decimalVal = val.getDecimal();
+            break;
+        case CADVariant::DataType::REAL:
+            slot.value.realVal = val.getReal();
+            break;
+        case CADVariant::DataType::STRING:
+            slot.value.index = strings.size();
+            strings.push_back(val.getString());
+            break;
+        case CADVariant::DataType::DATETIME:
+            slot.value.dateTimeVal = val.getDateTime();
+            break;
+        case CADVariant::DataType::COORDINATES:
+            slot.value.index = coordinates.size();
+            coordinates.push_back(CADVector(val.getX(), val.getY(), val.getZ()));
+            break;
+        case CADVariant::DataType::HANDLE:
+            slot.value.index = handles.size();
+            handles.push_back(val.getHandle());
+            break;
+        default:
+            slot.value.index = 0;
+            break;
+    }
+
+    if(nullptr != pValue)
+    {
+        *pValue = slot;
+    }
+    else
+    {
+        auto it = lower_bound(userValues.begin(), userValues.end(), code,
+                              [](const pair<short, Slot>& item, short key)
+                              { return item.first < key; });
+        userValues.insert(it, make_pair(code, slot));
+    }
+    ++valuesCount;
     return CADErrorCodes::SUCCESS;
 }
 
@@ -603,11 +663,11 @@ int CADHeader::getGroupCode(short code) const
     return -1;
 }
 
-const CADVariant &CADHeader::getValue(short code, const CADVariant& val) const
+CADVariant CADHeader::getValue(short code, const CADVariant& val) const
 {
-    auto it = valuesMap.find(code);
-    if(it != valuesMap.end())
-        return it->second;
+    const Slot* pValue = findValue(code);
+    if(nullptr != pValue && pValue->type != CADVariant::DataType::INVALID)
+        return toVariant(*pValue);
     else
         return val;
 }
@@ -622,23 +682,53 @@ const char *CADHeader::getValueName(short code) const
     return "Undefined";
 }
 
+short CADHeader::getConstant(const string &valueName)
+{
+    // DXF files list hundreds of variables, so the names are hashed once
+    static const unordered_map<string, short> constants = []()
+    {
+        unordered_map<string, short> names;
+        for(CADHeaderConstantDetail detail : CADHeaderConstantDetails)
+        {
+            if(nullptr != detail.pszValueName)
+                names[detail.pszValueName] = detail.nConstant;
+        }
+        return names;
+    }();
+
+    auto it = constants.find(valueName);
+    return it == constants.end() ? -1 : it->second;
+}
+
 void CADHeader::print() const
 {
     cout << "============ HEADER Section ============" << endl;
-    for(auto it : valuesMap)
+    for(short code = 0; code < CADHeaderValuesCount; ++code)
     {
-        cout << getValueName(it.first) << ": " << it.second.getString() << endl;
+        if(values[code].type != CADVariant::DataType::INVALID)
+            cout << getValueName(code) << ": " <<
+                    toVariant(values[code]).getString() << endl;
+    }
+    for(const auto& item : userValues)
+    {
+        cout << getValueName(item.first) << ": " <<
+                toVariant(item.second).getString() << endl;
     }
 }
 
 size_t CADHeader::getSize() const
 {
-    return valuesMap.size();
+    return valuesCount;
 }
 
 short CADHeader::getCode(int index) const
 {
-    auto it = valuesMap.begin();
-    advance( it, index );
-    return it->first;
+    for(short code = 0; code < CADHeaderValuesCount; ++code)
+    {
+        if(values[code].type == CADVariant::DataType::INVALID)
+            continue;
+        if(index-- == 0)
+            return code;
+    }
+    return userValues[index].first;
 }
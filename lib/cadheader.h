@@ -32,6 +32,7 @@
 #define CADHEADER_H
 
 #include "opencad.h"
+#include <ctime>
 #include <map>
 #include <string>
 #include <vector>
@@ -52,6 +53,37 @@ protected:
     std::vector<unsigned char>  handleOrOffset;
 };
 
+class CADVector
+{
+public:
+    CADVector();
+    CADVector( double dx, double dy);
+    CADVector( double dx, double dy, double dz);
+    CADVector(const CADVector& other);
+    bool operator == (const CADVector& second);
+    CADVector operator = (const CADVector& second);
+    double getX() const;
+    void setX(double value);
+
+    double getY() const;
+    void setY(double value);
+
+    double getZ() const;
+    void setZ(double value);
+
+    bool getBHasZ() const;
+    void setBHasZ(bool value);
+
+    friend class Matrix;
+protected:
+    inline bool fcmp(double x, double y);
+protected:
+    double X;
+    double Y;
+    double Z;
+    bool bHasZ;
+};
+
 class OCAD_EXTERN CADVariant final
 {
 public:
@@ -82,23 +114,31 @@ public:
 public:
     long                getDecimal() const;
     double              getReal() const;
-    const std::string&  getString() const;
+    /**
+     * @brief Returns the value as string. Non string values are formatted on
+     * request, so the value is returned by copy.
+     */
+    std::string         getString() const;
     enum DataType       getType() const;
     double              getX() const;
     double              getY() const;
     double              getZ() const;
+    time_t              getDateTime() const;
     const CADHandle&    getHandle() const;
 protected:
     enum DataType       type;
-    long                decimalVal;
-    double              xVal;
-    double              yVal;
-    double              zVal;
-    std::string         stringVal;
-    CADHandle           handleVal;
-    time_t              dateTimeVal;
+    // Only one of the scalar values is used, depending on the type.
+    union
+    {
+        long            decimalVal;
+        double          xyzVal[3];
+        time_t          dateTimeVal;
+    }                   value;
+    std::string         stringVal;  // STRING only
+    CADHandle           handleVal;  // HANDLE only
 };
 
+template<int code> struct CADHeaderValue;
 
 /**
  * @brief The common CAD header class
@@ -702,14 +742,163 @@ public:
     int addValue(short code, double x, double y, double z = 0);
     int addValue(short code, long julianday, long milliseconds);
     int getGroupCode(short code) const;
-    const CADVariant& getValue(short code,
-                               const CADVariant& val = CADVariant()) const;
+    /**
+     * @brief Returns the copy of the value or val if the value is not set
+     */
+    CADVariant      getValue(short code,
+                             const CADVariant& val = CADVariant()) const;
+    /**
+     * @brief Typed access to the header value, e.g. get<CADHeader::EXTMIN>()
+     * returns CADVector. The typed values are read from the storage without
+     * the CADVariant, codes without the declared type return CADVariant.
+     */
+    template<int code>
+    typename CADHeaderValue<code>::type get() const
+    {
+        return CADHeaderValue<code>::get(*this);
+    }
     const char*     getValueName(short code) const;
+    /**
+     * @brief Get the constant by the DXF variable name
+     * @param valueName Variable name with $, i.e. $EXTMIN
+     * @return code from constants enum or -1 if the name is unknown
+     */
+    static short    getConstant(const std::string& valueName);
     void            print() const;
     size_t          getSize() const;
     short           getCode(int index) const;
 protected:
-    std::map<short, CADVariant> valuesMap;
+    /**
+     * @brief The stored value: type and 8 byte payload. Strings, handles and
+     * coordinates are kept in the side tables and the payload is the index.
+     */
+    struct Slot
+    {
+        CADVariant::DataType type;
+        union
+        {
+            long        decimalVal;
+            double      realVal;
+            time_t      dateTimeVal;
+            size_t      index;
+        }                    value;
+    };
+    Slot*           findValue(short code);
+    const Slot*     findValue(short code) const;
+    CADVariant      toVariant(const Slot& slot) const;
+
+    static const std::string& emptyString();
+    static const CADHandle&   emptyHandle();
+
+    template<int code> friend struct CADHeaderValue;
+protected:
+    /**
+     * The values are stored in the array indexed by code. User constants
+     * (codes from MAX_HEADER_CONSTANT) are stored in the short sorted list.
+     */
+    std::vector<Slot>                           values;
+    std::vector<std::pair<short, Slot> >        userValues;
+    std::vector<std::string>                    strings;
+    std::vector<CADHandle>                      handles;
+    std::vector<CADVector>                      coordinates;
+    size_t                                      valuesCount;
+};
+
+/**
+ * @brief Compile time header value type. By default the value is CADVariant.
+ * The typed values are read straight from the header slot and side tables,
+ * the value of other stored type reads as the empty one.
+ */
+template<int code> struct CADHeaderValue
+{
+    typedef CADVariant type;
+    static type get(const CADHeader& header) { return header.getValue(code); }
 };
 
+#define CADHeaderValueType(code, valueType, getter) \
+    template<> struct CADHeaderValue<CADHeader::code> \
+    { \
+        typedef valueType type; \
+        static type get(const CADHeader& header) \
+        { \
+            const CADHeader::Slot& slot = header.values[CADHeader::code]; \
+            return getter; \
+        } \
+    };
+
+#define CADHeaderSlotIs(valueType) \
+    (slot.type == CADVariant::DataType::valueType)
+
+#define CADHeaderVectorValue(code) CADHeaderValueType(code, CADVector, \
+    CADHeaderSlotIs(COORDINATES) ? header.coordinates[slot.value.index] : \
+    CADHeaderSlotIs(REAL) ? CADVector(slot.value.realVal, 0, 0) : \
+                            CADVector(0, 0, 0))
+#define CADHeaderRealValue(code) CADHeaderValueType(code, double, \
+    CADHeaderSlotIs(REAL) ? slot.value.realVal : \
+    CADHeaderSlotIs(COORDINATES) ? \
+        header.coordinates[slot.value.index].getX() : 0.0)
+#define CADHeaderDecimalValue(code) CADHeaderValueType(code, long, \
+    CADHeaderSlotIs(DECIMAL) ? slot.value.decimalVal : 0)
+#define CADHeaderStringValue(code) CADHeaderValueType(code, \
+    const std::string&, CADHeaderSlotIs(STRING) ? \
+        header.strings[slot.value.index] : CADHeader::emptyString())
+#define CADHeaderHandleValue(code) CADHeaderValueType(code, const CADHandle&, \
+    CADHeaderSlotIs(HANDLE) ? header.handles[slot.value.index] : \
+                              CADHeader::emptyHandle())
+#define CADHeaderDateTimeValue(code) CADHeaderValueType(code, time_t, \
+    CADHeaderSlotIs(DATETIME) ? slot.value.dateTimeVal : 0)
+
+CADHeaderVectorValue(EXTMIN)
+CADHeaderVectorValue(EXTMAX)
+CADHeaderVectorValue(INSBASE)
+CADHeaderVectorValue(LIMMIN)
+CADHeaderVectorValue(LIMMAX)
+CADHeaderVectorValue(UCSORG)
+CADHeaderVectorValue(UCSXDIR)
+CADHeaderVectorValue(UCSYDIR)
+CADHeaderVectorValue(PEXTMIN)
+CADHeaderVectorValue(PEXTMAX)
+CADHeaderVectorValue(PINSBASE)
+CADHeaderVectorValue(PLIMMIN)
+CADHeaderVectorValue(PLIMMAX)
+CADHeaderVectorValue(PUCSORG)
+
+CADHeaderRealValue(ANGBASE)
+CADHeaderRealValue(CELTSCALE)
+CADHeaderRealValue(DIMSCALE)
+CADHeaderRealValue(ELEVATION)
+CADHeaderRealValue(FILLETRAD)
+CADHeaderRealValue(LTSCALE)
+CADHeaderRealValue(PDSIZE)
+CADHeaderRealValue(PELEVATION)
+CADHeaderRealValue(TEXTSIZE)
+CADHeaderRealValue(THICKNESS)
+
+CADHeaderDecimalValue(OPENCADVER)
+CADHeaderDecimalValue(DWGCODEPAGE)
+CADHeaderDecimalValue(ANGDIR)
+CADHeaderDecimalValue(ATTMODE)
+CADHeaderDecimalValue(AUNITS)
+CADHeaderDecimalValue(AUPREC)
+CADHeaderDecimalValue(INSUNITS)
+CADHeaderDecimalValue(LUNITS)
+CADHeaderDecimalValue(LUPREC)
+CADHeaderDecimalValue(PDMODE)
+
+CADHeaderStringValue(ACADVER)
+CADHeaderStringValue(ACADMAINTVER)
+CADHeaderStringValue(FINGERPRINTGUID)
+CADHeaderStringValue(HYPERLINKBASE)
+CADHeaderStringValue(MENU)
+CADHeaderStringValue(VERSIONGUID)
+
+CADHeaderHandleValue(CLAYER)
+CADHeaderHandleValue(CELTYPE)
+CADHeaderHandleValue(DIMSTYLE)
+CADHeaderHandleValue(HANDSEED)
+CADHeaderHandleValue(TEXTSTYLE)
+
+CADHeaderDateTimeValue(TDCREATE)
+CADHeaderDateTimeValue(TDUPDATE)
+
 #endif // CADHEADER_H
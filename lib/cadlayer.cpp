@@ -37,7 +37,7 @@ CADLayer::CADLayer(CADFile * const file) : frozen(false), on(true),
     frozenByDefault(false), locked(false), plotting(false), lineWeight(1),
     color(0), layerId(0), handle(0), geometryType(-2), pCADFile(file)
 {
-
+    transformations.push_back (Matrix());
 }
 
 string CADLayer::getName() const
@@ -141,10 +141,19 @@ void CADLayer::setHandle(long value)
 }
 
 void CADLayer::addHandle(long handle, CADObject::ObjectType type)
+{
+    addHandle (handle, type, 0);
+}
+
+void CADLayer::addHandle(long handle, CADObject::ObjectType type,
+                         size_t transformIndex)
 {
 #ifdef _DEBUG
     cout << "addHandle: " << handle << " type: " << type << endl;
 #endif //_DEBUG
+    if( !pCADFile->readFilter.acceptsType (type) )
+        return;
+
     if( type == CADObject::ATTRIB || type == CADObject::ATTDEF )
     {
         unique_ptr< CADObject > geometry( pCADFile->getObject ( handle, false ) );
@@ -154,8 +163,6 @@ void CADLayer::addHandle(long handle, CADObject::ObjectType type)
     }
 
     if( type == CADObject::INSERT){
-        // TODO: transform insert to block of objects (do we need to transform
-        // coordinates according to insert point)?
         unique_ptr< CADObject > insert( pCADFile->getObject ( handle, false ) );
         CADInsertObject *pInsert = static_cast<CADInsertObject *>(insert.get ());
         if(nullptr != pInsert){
@@ -170,19 +177,28 @@ void CADLayer::addHandle(long handle, CADObject::ObjectType type)
                    assert(0);
                }
 #endif //_DEBUG
+               // Block to WCS: insert OCS * shift * rotate * scale * -base point,
+               // composed with the transformation of the enclosing inserts.
+               Matrix mat = Matrix::fromExtrusion (pInsert->vectExtrusion);
+               mat.translate (pInsert->vertInsertionPoint);
+               mat.rotate (pInsert->dfRotation);
+               mat.scale (pInsert->vertScales);
+               const CADVector& basePoint = pBlockHeader->vertBasePoint;
+               mat.translate (CADVector(-basePoint.getX (), -basePoint.getY (),
+                                        -basePoint.getZ ()));
+               mat = transformations[transformIndex].multiply (mat);
+               size_t matIndex = transformations.size ();
+               transformations.push_back (mat);
+
                for(CADHandle entHandle : pBlockHeader->hEntities){
+                   // only the type is needed here, read CED && handles only
                    unique_ptr< CADObject > entity(
                                pCADFile->getObject ( entHandle.getAsLong (),
-                                                     false ) );
+                                                     true ) );
                    if(nullptr == entity)
                        continue;
-                   addHandle(entHandle.getAsLong (), entity->getType ());
-                   // add shift/scale/rotate to transform map
-                   Matrix mat;
-                   mat.translate (pInsert->vertInsertionPoint);
-                   mat.scale (pInsert->vertScales);
-                   mat.rotate (pInsert->dfRotation);
-                   transformations[entHandle.getAsLong ()] = mat;
+                   addHandle(entHandle.getAsLong (), entity->getType (),
+                             matIndex);
                }
             }
 
@@ -208,7 +224,10 @@ void CADLayer::addHandle(long handle, CADObject::ObjectType type)
         if(type == CADObject::IMAGE)
             imageHandles.push_back( handle );
         else
+        {
             geometryHandles.push_back( handle );
+            geometryTransforms.push_back( transformIndex );
+        }
         if( geometryType == -2 ) // if not inited set type for first geometry
             geometryType = type;
         else if( geometryType != type ) // if type differs from previous geometry this is geometry bag (geometry type any)
@@ -222,16 +241,33 @@ size_t CADLayer::getGeometryCount() const
 }
 
 CADGeometry *CADLayer::getGeometry(size_t index)
+{
+    return getGeometry (index, pCADFile->readFilter.projection);
+}
+
+CADGeometry *CADLayer::getGeometry(size_t index, int projection)
 {
     long nHandle = geometryHandles[index];
-    CADGeometry* pGeom = pCADFile->getGeometry(nHandle);
+    CADGeometry* pGeom = pCADFile->getGeometry(nHandle, projection);
     if(nullptr == pGeom)
         return nullptr;
-    auto iter = transformations.find(nHandle);
-    if(iter != transformations.end())
+    size_t transformIndex = geometryTransforms[index];
+    if(transformIndex != 0)
     {
-        // transform geometry if nHandle is in transformations
-        pGeom->transform (iter->second);
+        // transform geometry placed by an insert to WCS, the circle scaled
+        // non-uniformly is the ellipse there
+        const Matrix& matrix = transformations[transformIndex];
+        if((pGeom->getType () == CADGeometry::CIRCLE ||
+            pGeom->getType () == CADGeometry::ARC) &&
+           !static_cast<CADCircle*>(pGeom)->isTransformedToCircle (matrix))
+        {
+            CADGeometry* pEllipse = pGeom->getType () == CADGeometry::ARC ?
+                        new CADEllipse(*static_cast<CADArc*>(pGeom)) :
+                        new CADEllipse(CADArc(*static_cast<CADCircle*>(pGeom)));
+            delete pGeom;
+            pGeom = pEllipse;
+        }
+        pGeom->transform (matrix);
     }
     return pGeom;
 }
@@ -243,7 +279,8 @@ size_t CADLayer::getImageCount() const
 
 CADImage *CADLayer::getImage(size_t index)
 {
-    return static_cast<CADImage*>(pCADFile->getGeometry(imageHandles[index]));
+    return static_cast<CADImage*>(pCADFile->getGeometry(imageHandles[index],
+                                            pCADFile->readFilter.projection));
 }
 
 bool CADLayer::addAttribute(const CADObject *pObject)
@@ -77,6 +77,13 @@ public:
 
     size_t getGeometryCount () const;
     CADGeometry* getGeometry(size_t index);
+    /**
+     * @brief Get geometry with only the requested properties decoded
+     * @param index Geometry index
+     * @param projection CADFile::ProjectionFlags mask
+     * @return NULL if failed or pointer which mast be feed by user
+     */
+    CADGeometry* getGeometry(size_t index, int projection);
     size_t getImageCount () const;
     CADImage* getImage(size_t index);
 
@@ -87,6 +94,12 @@ public:
     short getGeometryType();
 
 protected:
+    /**
+     * @brief Adds the entity placed with the transformations[transformIndex]
+     * block to WCS matrix. Index 0 is the model space (no transformation).
+     */
+    void addHandle(long handle, enum CADObject::ObjectType type,
+                   size_t transformIndex);
     bool addAttribute(const CADObject* pObject);
 protected:
     string layerName;
@@ -102,9 +115,12 @@ protected:
     short geometryType; // if all geometry is same type set this type or -1
 
     vector<long> geometryHandles;
+    vector<size_t> geometryTransforms; // per geometry index in transformations
     vector<long> imageHandles;
     vector< pair< long, map< string, long > > > geometryAttributes;
-    map<long, Matrix> transformations;
+    // One matrix per insert instance, so the same block entity placed by
+    // several (or nested) inserts keeps every placement.
+    vector<Matrix> transformations;
 
     CADFile * const pCADFile;
 };
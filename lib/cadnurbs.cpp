@@ -0,0 +1,571 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadnurbs.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const size_t nBlockSize = 64; // parameters evaluated at once
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+static double getLength(double x, double y, double z)
+{
+    return sqrt(x * x + y * y + z * z);
+}
+
+static double getDistance(const CADVector& first, const CADVector& second)
+{
+    return getLength (first.getX () - second.getX (),
+                      first.getY () - second.getY (),
+                      first.getZ () - second.getZ ());
+}
+
+/**
+ * @brief Compute the degree + 1 nonzero basis functions at the parameter
+ * (The NURBS Book, A2.2)
+ */
+static void getBasisFunctions(const vector<double>& knots, size_t span,
+                              size_t degree, double param, double * basis)
+{
+    vector<double> left(degree + 1), right(degree + 1);
+    basis[0] = 1.0;
+    for( size_t j = 1; j <= degree; ++j )
+    {
+        left[j] = param - knots[span + 1 - j];
+        right[j] = knots[span + j] - param;
+        double saved = 0.0;
+        for( size_t r = 0; r < j; ++r )
+        {
+            double temp = basis[r] / (right[r + 1] + left[j - r]);
+            basis[r] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+        basis[j] = saved;
+    }
+}
+
+/**
+ * @brief Solve the banded system by the Gaussian elimination without
+ * pivoting, the B-spline collocation matrix is totally positive. The matrix
+ * row i holds columns i - band ... i + band.
+ * @return false if the matrix is singular
+ */
+static bool solveBanded(vector<double>& matrix, size_t nRows, size_t nBand,
+                        vector<double>& x, vector<double>& y,
+                        vector<double>& z)
+{
+    const size_t nWidth = 2 * nBand + 1;
+    auto at = [&](size_t i, size_t j) -> double& {
+        return matrix[i * nWidth + nBand + j - i];
+    };
+
+    for( size_t k = 0; k < nRows; ++k )
+    {
+        double pivot = at(k, k);
+        if( pivot == 0.0 || std::isnan (pivot) )
+            return false;
+        size_t nLast = min(k + nBand, nRows - 1);
+        for( size_t i = k + 1; i <= nLast; ++i )
+        {
+            double factor = at(i, k) / pivot;
+            if( factor == 0.0 )
+                continue;
+            for( size_t j = k; j <= nLast; ++j )
+                at(i, j) -= factor * at(k, j);
+            x[i] -= factor * x[k];
+            y[i] -= factor * y[k];
+            z[i] -= factor * z[k];
+        }
+    }
+
+    for( size_t k = nRows; k-- > 0; )
+    {
+        size_t nLast = min(k + nBand, nRows - 1);
+        for( size_t j = k + 1; j <= nLast; ++j )
+        {
+            x[k] -= at(k, j) * x[j];
+            y[k] -= at(k, j) * y[j];
+            z[k] -= at(k, j) * z[j];
+        }
+        x[k] /= at(k, k);
+        y[k] /= at(k, k);
+        z[k] /= at(k, k);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// CADNurbsEvaluator
+// ----------------------------------------------------------------------------
+
+CADNurbsEvaluator::CADNurbsEvaluator(CADSpline *spline) :
+    degree(spline->getDegree ()),
+    rational(false),
+    valid(false)
+{
+    const vector<CADVector>& ctrlPoints = spline->getControlPoints ();
+    if( !ctrlPoints.empty () )
+    {
+        if( degree < 1 || ctrlPoints.size () < size_t(degree + 1) )
+            return;
+        setControlPoints (ctrlPoints, spline->getControlPointsWeights ());
+        knots = spline->getKnots ();
+        const size_t nPoints = ctrlPoints.size ();
+        if( knots.size () != nPoints + degree + 1 )
+        {
+            // clamped uniform knots
+            knots.assign (nPoints + degree + 1, 0.0);
+            for( size_t i = degree + 1; i < nPoints; ++i )
+                knots[i] = double(i - degree) / (nPoints - degree);
+            for( size_t i = nPoints; i < knots.size (); ++i )
+                knots[i] = 1.0;
+        }
+    }
+    else
+    {
+        if( degree < 1 )
+            degree = 3;
+        if( !interpolate (spline->getFitPoints (), spline->getBegTangent (),
+                          spline->getEndTangent ()) )
+            return;
+    }
+
+    for( size_t i = 1; i < knots.size (); ++i )
+    {
+        // also false for NaN
+        if( !(knots[i - 1] <= knots[i]) )
+            return;
+    }
+    valid = getStartParameter () < getEndParameter ();
+}
+
+bool CADNurbsEvaluator::isValid() const
+{
+    return valid;
+}
+
+long CADNurbsEvaluator::getDegree() const
+{
+    return degree;
+}
+
+double CADNurbsEvaluator::getStartParameter() const
+{
+    return knots[degree];
+}
+
+double CADNurbsEvaluator::getEndParameter() const
+{
+    return knots[knots.size () - degree - 1];
+}
+
+const vector<double> &CADNurbsEvaluator::getKnots() const
+{
+    return knots;
+}
+
+vector<CADVector> CADNurbsEvaluator::getControlPoints() const
+{
+    vector<CADVector> points;
+    points.reserve (w.size ());
+    for( size_t i = 0; i < w.size (); ++i )
+        points.push_back (CADVector(wx[i] / w[i], wy[i] / w[i],
+                                    wz[i] / w[i]));
+    return points;
+}
+
+void CADNurbsEvaluator::evaluate(const double *params, size_t count,
+                                 double *xyz) const
+{
+    if( !valid )
+        return;
+    const double start = getStartParameter (), end = getEndParameter ();
+    vector<double> work((degree + 7) * nBlockSize);
+    double block[nBlockSize];
+
+    size_t i = 0;
+    while( i < count )
+    {
+        size_t span = findSpan (params[i]);
+        size_t nCount = 0;
+        // group the following parameters of the same span
+        while( i + nCount < count && nCount < nBlockSize )
+        {
+            double param = min(max(params[i + nCount], start), end);
+            if( nCount > 0 && !(knots[span] <= param &&
+                                param < knots[span + 1]) &&
+                findSpan (param) != span )
+                break;
+            block[nCount++] = param;
+        }
+        evaluateSpan (span, block, nCount, xyz + i * 3, work.data ());
+        i += nCount;
+    }
+}
+
+CADVector CADNurbsEvaluator::evaluate(double param) const
+{
+    double xyz[3] = { 0.0, 0.0, 0.0 };
+    evaluate (&param, 1, xyz);
+    return CADVector(xyz[0], xyz[1], xyz[2]);
+}
+
+size_t CADNurbsEvaluator::getSpanSegments(size_t span, double tolerance,
+                                          size_t maxSegments) const
+{
+    maxSegments = max(maxSegments, size_t(1));
+    if( degree == 1 )
+        return 1;
+    if( tolerance <= 0.0 )
+        return maxSegments;
+
+    // Bezier flatness bound: deviation <= p(p - 1) / 8 * max|second
+    // difference of the control points| / n^2
+    double maxDifference = 0.0;
+    double minWeight = w[span - degree], maxWeight = minWeight;
+    for( size_t i = span - degree + 1; i < span; ++i )
+    {
+        double dx = wx[i + 1] / w[i + 1] - 2 * wx[i] / w[i] +
+                wx[i - 1] / w[i - 1];
+        double dy = wy[i + 1] / w[i + 1] - 2 * wy[i] / w[i] +
+                wy[i - 1] / w[i - 1];
+        double dz = wz[i + 1] / w[i + 1] - 2 * wz[i] / w[i] +
+                wz[i - 1] / w[i - 1];
+        maxDifference = max(maxDifference, getLength (dx, dy, dz));
+    }
+    for( size_t i = span - degree; i <= span; ++i )
+    {
+        minWeight = min(minWeight, w[i]);
+        maxWeight = max(maxWeight, w[i]);
+    }
+    if( rational && minWeight > 0.0 )
+        maxDifference *= maxWeight / minWeight;
+
+    double segments = ceil(sqrt(degree * (degree - 1) * maxDifference /
+                                (8.0 * tolerance)));
+    if( !(segments < maxSegments) ) // NaN too
+        return maxSegments;
+    return max(static_cast<size_t>(segments), size_t(1));
+}
+
+size_t CADNurbsEvaluator::flatten(double tolerance, size_t maxSegments,
+                                  double *xyz, size_t capacity) const
+{
+    if( !valid )
+        return 0;
+    vector<double> work((degree + 7) * nBlockSize);
+    double params[nBlockSize];
+    double block[nBlockSize * 3];
+
+    const size_t nLastSpan = findSpan (getEndParameter ());
+    size_t nCount = 0;
+    for( size_t span = degree; span <= nLastSpan; ++span )
+    {
+        const double start = knots[span], end = knots[span + 1];
+        if( start == end )
+            continue;
+        const size_t nSegments = getSpanSegments (span, tolerance,
+                                                  maxSegments);
+        // the span end is the next span start, except for the last one
+        const size_t nPoints = span == nLastSpan ? nSegments + 1 : nSegments;
+        for( size_t first = 0; first < nPoints; first += nBlockSize )
+        {
+            size_t nBlock = min(nBlockSize, nPoints - first);
+            if( nullptr != xyz && nCount < capacity )
+            {
+                for( size_t i = 0; i < nBlock; ++i )
+                {
+                    size_t segment = first + i;
+                    params[i] = segment == nSegments ? end : start +
+                            (end - start) * segment / nSegments;
+                }
+                evaluateSpan (span, params, nBlock, block, work.data ());
+                size_t nCopy = min(nBlock, capacity - nCount);
+                copy(block, block + nCopy * 3, xyz + nCount * 3);
+            }
+            nCount += nBlock;
+        }
+    }
+    return nCount;
+}
+
+size_t CADNurbsEvaluator::flatten(double tolerance,
+                                  vector<CADVector> &vertexes,
+                                  size_t maxSegments) const
+{
+    size_t nCount = flatten (tolerance, maxSegments, nullptr, 0);
+    if( 0 == nCount )
+        return 0;
+    vector<double> xyz(nCount * 3);
+    flatten (tolerance, maxSegments, xyz.data (), nCount);
+    vertexes.reserve (vertexes.size () + nCount);
+    for( size_t i = 0; i < nCount; ++i )
+        vertexes.push_back (CADVector(xyz[i * 3], xyz[i * 3 + 1],
+                                      xyz[i * 3 + 2]));
+    return nCount;
+}
+
+void CADNurbsEvaluator::setControlPoints(const vector<CADVector> &points,
+                                         const vector<double> &weights)
+{
+    rational = weights.size () == points.size ();
+    if( rational )
+    {
+        rational = false;
+        for( double weight : weights )
+        {
+            if( weight != 1.0 )
+                rational = true;
+        }
+    }
+    wx.resize (points.size ());
+    wy.resize (points.size ());
+    wz.resize (points.size ());
+    w.resize (points.size ());
+    for( size_t i = 0; i < points.size (); ++i )
+    {
+        double weight = rational ? weights[i] : 1.0;
+        wx[i] = points[i].getX () * weight;
+        wy[i] = points[i].getY () * weight;
+        wz[i] = points[i].getZ () * weight;
+        w[i] = weight;
+    }
+}
+
+bool CADNurbsEvaluator::interpolate(const vector<CADVector> &fitPoints,
+                                    const CADVector &begTangent,
+                                    const CADVector &endTangent)
+{
+    vector<CADVector> points;
+    for( const CADVector& point : fitPoints )
+    {
+        if( points.empty () || getDistance (point, points.back ()) > 0.0 )
+            points.push_back (point);
+    }
+    if( points.size () < 2 )
+        return false;
+
+    // chord length parameters
+    const size_t nFit = points.size ();
+    vector<double> params(nFit, 0.0);
+    for( size_t i = 1; i < nFit; ++i )
+        params[i] = params[i - 1] + getDistance (points[i], points[i - 1]);
+    const double length = params.back ();
+    for( size_t i = 1; i < nFit; ++i )
+        params[i] /= length;
+    params.back () = 1.0;
+
+    const CADVector origin(0.0, 0.0, 0.0);
+    bool bBegTangent = degree > 1 && getDistance (begTangent, origin) > 0.0;
+    bool bEndTangent = degree > 1 && getDistance (endTangent, origin) > 0.0;
+    const size_t nPoints = nFit + (bBegTangent ? 1 : 0) + (bEndTangent ? 1 : 0);
+    degree = min(degree, long(nPoints - 1));
+    if( 1 == degree )
+        bBegTangent = bEndTangent = false;
+    const size_t nPointsUsed = nFit + (bBegTangent ? 1 : 0) +
+            (bEndTangent ? 1 : 0);
+    const size_t p = degree;
+
+    // rows: first point, start tangent, inner points, end tangent, last
+    // point. The tangent conditions repeat the end parameters.
+    vector<double> rowParams;
+    rowParams.reserve (nPointsUsed);
+    rowParams.push_back (params.front ());
+    if( bBegTangent )
+        rowParams.push_back (params.front ());
+    for( size_t i = 1; i + 1 < nFit; ++i )
+        rowParams.push_back (params[i]);
+    if( bEndTangent )
+        rowParams.push_back (params.back ());
+    rowParams.push_back (params.back ());
+
+    // averaged knots
+    knots.assign (nPointsUsed + p + 1, 0.0);
+    for( size_t j = 1; j + p < nPointsUsed; ++j )
+    {
+        double sum = 0.0;
+        for( size_t i = j; i < j + p; ++i )
+            sum += rowParams[i];
+        knots[j + p] = sum / p;
+    }
+    for( size_t i = nPointsUsed; i < knots.size (); ++i )
+        knots[i] = 1.0;
+
+    const size_t nBand = p + 1;
+    const size_t nWidth = 2 * nBand + 1;
+    vector<double> matrix(nPointsUsed * nWidth, 0.0);
+    vector<double> x(nPointsUsed), y(nPointsUsed), z(nPointsUsed);
+    vector<double> basis(p + 1);
+    auto set = [&](size_t i, size_t j, double value) -> bool {
+        if( j + nBand < i || j > i + nBand )
+            return false;
+        matrix[i * nWidth + nBand + j - i] = value;
+        return true;
+    };
+
+    size_t nFitIndex = 0;
+    for( size_t row = 0; row < nPointsUsed; ++row )
+    {
+        bool bBegRow = bBegTangent && row == 1;
+        bool bEndRow = bEndTangent && row == nPointsUsed - 2;
+        if( bBegRow || bEndRow )
+        {
+            // C'(0) = p / u[p + 1] * (P1 - P0),
+            // C'(1) = p / (1 - u[n - 1]) * (Pn - Pn-1)
+            const CADVector& tangent = bBegRow ? begTangent : endTangent;
+            double scale = length / getDistance (tangent, origin);
+            size_t col = bBegRow ? 0 : nPointsUsed - 2;
+            double factor = bBegRow ? p / knots[p + 1] :
+                                      p / (1.0 - knots[nPointsUsed - 1]);
+            set(row, col, -factor);
+            set(row, col + 1, factor);
+            x[row] = tangent.getX () * scale;
+            y[row] = tangent.getY () * scale;
+            z[row] = tangent.getZ () * scale;
+            continue;
+        }
+
+        const CADVector& point = points[nFitIndex];
+        double param = params[nFitIndex++];
+        size_t span = findSpan (param);
+        getBasisFunctions (knots, span, p, param, basis.data ());
+        for( size_t i = 0; i <= p; ++i )
+        {
+            if( basis[i] != 0.0 && !set(row, span - p + i, basis[i]) )
+                return false;
+        }
+        x[row] = point.getX ();
+        y[row] = point.getY ();
+        z[row] = point.getZ ();
+    }
+
+    if( !solveBanded (matrix, nPointsUsed, nBand, x, y, z) )
+        return false;
+
+    vector<CADVector> ctrlPoints;
+    ctrlPoints.reserve (nPointsUsed);
+    for( size_t i = 0; i < nPointsUsed; ++i )
+        ctrlPoints.push_back (CADVector(x[i], y[i], z[i]));
+    setControlPoints (ctrlPoints, vector<double>());
+    return true;
+}
+
+size_t CADNurbsEvaluator::findSpan(double param) const
+{
+    const size_t nPoints = knots.size () - degree - 1;
+    size_t span;
+    if( param >= knots[nPoints] )
+    {
+        span = nPoints - 1;
+        while( span > size_t(degree) && knots[span] == knots[span + 1] )
+            --span;
+        return span;
+    }
+    if( param <= knots[degree] )
+    {
+        span = degree;
+        while( span < nPoints - 1 && knots[span] == knots[span + 1] )
+            ++span;
+        return span;
+    }
+    span = upper_bound(knots.begin () + degree, knots.begin () + nPoints + 1,
+                       param) - knots.begin () - 1;
+    return span;
+}
+
+void CADNurbsEvaluator::evaluateSpan(size_t span, const double *params,
+                                     size_t count, double *xyz,
+                                     double *work) const
+{
+    // work rows: degree + 1 basis functions, saved, x, y, z, w
+    const size_t p = degree;
+    double * basis = work;
+    double * saved = work + (p + 1) * nBlockSize;
+    double * sumX = saved + nBlockSize;
+    double * sumY = sumX + nBlockSize;
+    double * sumZ = sumY + nBlockSize;
+    double * sumW = sumZ + nBlockSize;
+
+    // Cox - de Boor recurrence for all parameters at once, the denominators
+    // depend on the span only
+    for( size_t k = 0; k < count; ++k )
+        basis[k] = 1.0;
+    for( size_t j = 1; j <= p; ++j )
+    {
+        for( size_t k = 0; k < count; ++k )
+            saved[k] = 0.0;
+        for( size_t r = 0; r < j; ++r )
+        {
+            const double low = knots[span + 1 + r - j];
+            const double high = knots[span + 1 + r];
+            const double inverse = 1.0 / (high - low);
+            double * row = basis + r * nBlockSize;
+            for( size_t k = 0; k < count; ++k )
+            {
+                double temp = row[k] * inverse;
+                row[k] = saved[k] + (high - params[k]) * temp;
+                saved[k] = (params[k] - low) * temp;
+            }
+        }
+        double * row = basis + j * nBlockSize;
+        for( size_t k = 0; k < count; ++k )
+            row[k] = saved[k];
+    }
+
+    for( size_t k = 0; k < count; ++k )
+        sumX[k] = sumY[k] = sumZ[k] = sumW[k] = 0.0;
+    for( size_t j = 0; j <= p; ++j )
+    {
+        const size_t i = span - p + j;
+        const double cx = wx[i], cy = wy[i], cz = wz[i], cw = w[i];
+        const double * row = basis + j * nBlockSize;
+        for( size_t k = 0; k < count; ++k )
+        {
+            sumX[k] += row[k] * cx;
+            sumY[k] += row[k] * cy;
+            sumZ[k] += row[k] * cz;
+            sumW[k] += row[k] * cw;
+        }
+    }
+
+    for( size_t k = 0; k < count; ++k )
+    {
+        double inverse = rational ? 1.0 / sumW[k] : 1.0;
+        xyz[k * 3] = sumX[k] * inverse;
+        xyz[k * 3 + 1] = sumY[k] * inverse;
+        xyz[k * 3 + 2] = sumZ[k] * inverse;
+    }
+}
@@ -0,0 +1,135 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADNURBS_H
+#define CADNURBS_H
+
+#include "cadgeometry.h"
+
+#include <vector>
+
+/**
+ * @brief The NURBS evaluator of CADSpline. The control points splines are
+ * evaluated with their knots, weights are used for rational splines. The fit
+ * points only splines are interpolated first: chord length parameters,
+ * averaged knots and the start and end tangents if set.
+ *
+ * The parameters are evaluated in batches per knot span: the basis function
+ * denominators depend on the span only, so the Cox - de Boor recurrence and
+ * the control points sum run over all span parameters at once in loops the
+ * compiler vectorizes.
+ */
+class OCAD_EXTERN CADNurbsEvaluator
+{
+public:
+    /**
+     * @brief Prepare the spline evaluation. The spline is not referenced
+     * after the constructor.
+     * @param spline Spline to evaluate
+     */
+    explicit CADNurbsEvaluator(CADSpline * spline);
+
+    /**
+     * @brief Check if the spline can be evaluated
+     * @return false if there are not enough points, the knots are not
+     * ordered or the fit points interpolation failed
+     */
+    bool isValid() const;
+
+    long   getDegree() const;
+    double getStartParameter() const;
+    double getEndParameter() const;
+    /**
+     * @brief Get the knots, clamped uniform ones if the spline has no
+     * matching knots
+     */
+    const std::vector<double>& getKnots() const;
+    /**
+     * @brief Get the control points, the interpolated ones for the fit points
+     * spline
+     */
+    std::vector<CADVector> getControlPoints() const;
+
+    /**
+     * @brief Evaluate the points, the parameters out of the range are clamped
+     * @param params Parameters, evaluation is fastest if they are sorted
+     * @param count Parameters count
+     * @param xyz Buffer for count interleaved x, y, z
+     */
+    void evaluate(const double * params, size_t count, double * xyz) const;
+    CADVector evaluate(double param) const;
+
+    /**
+     * @brief Get the segments count of the knot span flattening
+     * @param span Knot span, getKnots()[span] < getKnots()[span + 1]
+     * @param tolerance Maximum distance between the curve and its chords, 0 -
+     * use maxSegments
+     * @param maxSegments Maximum segments count per span
+     */
+    size_t getSpanSegments(size_t span, double tolerance,
+                           size_t maxSegments) const;
+
+    /**
+     * @brief Flatten the spline to the chord tolerance, segments count of
+     * each knot span is estimated from its control points
+     * @param xyz Buffer for interleaved x, y, z or nullptr
+     * @param capacity Buffer capacity in vertexes
+     * @return vertexes count, 0 if the spline is not valid. Only capacity
+     * vertexes are written if the count is bigger.
+     */
+    size_t flatten(double tolerance, size_t maxSegments, double * xyz,
+                   size_t capacity) const;
+    size_t flatten(double tolerance, std::vector<CADVector>& vertexes,
+                   size_t maxSegments = 256) const;
+
+protected:
+    void   setControlPoints(const std::vector<CADVector>& points,
+                            const std::vector<double>& weights);
+    bool   interpolate(const std::vector<CADVector>& fitPoints,
+                       const CADVector& begTangent,
+                       const CADVector& endTangent);
+    size_t findSpan(double param) const;
+    /**
+     * @brief Evaluate up to 64 parameters of the span
+     * @param work Buffer of (degree + 7) * 64 doubles
+     */
+    void   evaluateSpan(size_t span, const double * params, size_t count,
+                        double * xyz, double * work) const;
+
+protected:
+    long                degree;
+    bool                rational;
+    bool                valid;
+    std::vector<double> knots;
+    // homogeneous control points, w * x, w * y, w * z, w
+    std::vector<double> wx, wy, wz, w;
+};
+
+#endif // CADNURBS_H
@@ -33,6 +33,7 @@
 
 #include <math.h>
 #include <algorithm>
+#include <limits>
 
 //------------------------------------------------------------------------------
 // CADVector
@@ -400,7 +401,7 @@ CADDictionaryObject::CADDictionaryObject()
 // CADLWPolylineObject
 //------------------------------------------------------------------------------
 
-CADLWPolylineObject::CADLWPolylineObject()
+CADLWPolylineObject::CADLWPolylineObject() : bClosed(false)
 {
     type = LWPOLYLINE;
 }
@@ -410,6 +411,8 @@ CADLWPolylineObject::CADLWPolylineObject()
 //------------------------------------------------------------------------------
 
 CADSplineObject::CADSplineObject() : nNumFitPts(0),
+    dfKnotTol(0.0),
+    dfCtrlTol(0.0),
     nNumKnots(0),
     nNumCtrlPts(0) // should be zeroed.
 {
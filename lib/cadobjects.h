@@ -36,36 +36,6 @@
 
 using namespace std;
 
-class CADVector
-{
-public:
-    CADVector();
-    CADVector( double dx, double dy);
-    CADVector( double dx, double dy, double dz);
-    CADVector(const CADVector& other);
-    bool operator == (const CADVector& second);
-    CADVector operator = (const CADVector& second);
-    double getX() const;
-    void setX(double value);
-
-    double getY() const;
-    void setY(double value);
-
-    double getZ() const;
-    void setZ(double value);
-
-    bool getBHasZ() const;
-    void setBHasZ(bool value);
-
-protected:
-    inline bool fcmp(double x, double y);
-protected:
-    double X;
-    double Y;
-    double Z;
-    bool bHasZ;
-};
-
 typedef struct _Eed
 {
     short dLength = 0;
@@ -245,6 +215,7 @@ struct CADCommonED
 
     bool bNoLinks;
     short nCMColor;
+    bool bColorBookHandlePresent; // R2004+
 
     double dfLTypeScale;
     unsigned char bbLTypeFlags;
@@ -860,6 +831,7 @@ public:
     vector<CADVector> avertVertexes;
     vector<double> adfBulges;
     vector<short> adVertexesID;
+    bool bClosed;
     vector<pair<double, double>> astWidths; // start, end.
 };
 
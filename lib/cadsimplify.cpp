@@ -0,0 +1,684 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadsimplify.h"
+#include "cadtessellate.h"
+#include "opencad_api.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <queue>
+
+using namespace std;
+
+static const char PyramidSignature[] = "OCADPYR1";
+
+// ----------------------------------------------------------------------------
+// CADSimplifier
+// ----------------------------------------------------------------------------
+
+static double getSegmentDistance(const CADVector& point, const CADVector& start,
+                                 const CADVector& end)
+{
+    double dx = end.getX () - start.getX ();
+    double dy = end.getY () - start.getY ();
+    double px = point.getX () - start.getX ();
+    double py = point.getY () - start.getY ();
+    double length = dx * dx + dy * dy;
+    if( length > 0.0 )
+    {
+        double t = max(0.0, min(1.0, (px * dx + py * dy) / length));
+        px -= t * dx;
+        py -= t * dy;
+    }
+    return sqrt(px * px + py * py);
+}
+
+static double getTriangleArea(const CADVector& a, const CADVector& b,
+                              const CADVector& c)
+{
+    return fabs((b.getX () - a.getX ()) * (c.getY () - a.getY ()) -
+                (c.getX () - a.getX ()) * (b.getY () - a.getY ())) / 2.0;
+}
+
+static double getOrientation(const CADVector& a, const CADVector& b,
+                             const CADVector& c)
+{
+    return (b.getX () - a.getX ()) * (c.getY () - a.getY ()) -
+           (b.getY () - a.getY ()) * (c.getX () - a.getX ());
+}
+
+static bool isProperCrossing(const CADVector& a, const CADVector& b,
+                             const CADVector& c, const CADVector& d)
+{
+    double o1 = getOrientation (a, b, c);
+    double o2 = getOrientation (a, b, d);
+    double o3 = getOrientation (c, d, a);
+    double o4 = getOrientation (c, d, b);
+    return ((o1 > 0.0 && o2 < 0.0) || (o1 < 0.0 && o2 > 0.0)) &&
+           ((o3 > 0.0 && o4 < 0.0) || (o3 < 0.0 && o4 > 0.0));
+}
+
+/**
+ * @brief Uniform grid of the simplified line segments. The segment is keyed by
+ * its start vertex. From the settled vertex it is the chord to the next kept
+ * vertex, from the other vertexes it is the original segment, the replaced
+ * segments are dropped on the query.
+ */
+class SegmentGrid
+{
+public:
+    SegmentGrid(const vector<CADVector>& vertexes, const vector<bool>& keep,
+                const vector<size_t>& next, const vector<bool>& settled);
+    void insert(size_t start, size_t end);
+    /**
+     * @brief Check if the first - last chord properly crosses any current
+     * segment, the original segments of the first - last span are skipped
+     */
+    bool crosses(size_t first, size_t last);
+
+private:
+    void getCells(size_t start, size_t end, size_t& minCol, size_t& minRow,
+                  size_t& maxCol, size_t& maxRow) const;
+    size_t getCell(double value, double origin) const;
+
+    const vector<CADVector>&              vertexes;
+    const vector<bool>&                   keep;
+    const vector<size_t>&                 next;
+    const vector<bool>&                   settled;
+    double                                minX, minY, cellSize;
+    size_t                                gridSize;
+    vector< vector< pair<size_t, size_t> > > cells;
+    vector<size_t>                        visited;
+    size_t                                stamp;
+};
+
+SegmentGrid::SegmentGrid(const vector<CADVector>& lineVertexes,
+                         const vector<bool>& keepVertexes,
+                         const vector<size_t>& nextVertexes,
+                         const vector<bool>& settledVertexes) :
+    vertexes(lineVertexes), keep(keepVertexes), next(nextVertexes),
+    settled(settledVertexes),
+    minX(0.0), minY(0.0), cellSize(1.0), stamp(0)
+{
+    double maxX = -numeric_limits<double>::infinity ();
+    double maxY = maxX;
+    minX = minY = numeric_limits<double>::infinity ();
+    for( const CADVector& vertex : vertexes )
+    {
+        minX = min(minX, vertex.getX ());
+        minY = min(minY, vertex.getY ());
+        maxX = max(maxX, vertex.getX ());
+        maxY = max(maxY, vertex.getY ());
+    }
+
+    // about one segment per cell
+    gridSize = max(size_t(1), static_cast<size_t>(
+                       ceil(sqrt(static_cast<double>(vertexes.size ())))));
+    double size = max(maxX - minX, maxY - minY);
+    if( size > 0.0 )
+        cellSize = size / gridSize;
+    cells.resize (gridSize * gridSize);
+    visited.assign (vertexes.size (), 0);
+}
+
+size_t SegmentGrid::getCell(double value, double origin) const
+{
+    double cell = floor((value - origin) / cellSize);
+    if( cell <= 0.0 )
+        return 0;
+    return min(gridSize - 1, static_cast<size_t>(cell));
+}
+
+void SegmentGrid::getCells(size_t start, size_t end, size_t& minCol,
+                           size_t& minRow, size_t& maxCol, size_t& maxRow) const
+{
+    const CADVector& a = vertexes[start];
+    const CADVector& b = vertexes[end];
+    minCol = getCell (min(a.getX (), b.getX ()), minX);
+    maxCol = getCell (max(a.getX (), b.getX ()), minX);
+    minRow = getCell (min(a.getY (), b.getY ()), minY);
+    maxRow = getCell (max(a.getY (), b.getY ()), minY);
+}
+
+void SegmentGrid::insert(size_t start, size_t end)
+{
+    size_t minCol, minRow, maxCol, maxRow;
+    getCells (start, end, minCol, minRow, maxCol, maxRow);
+    for( size_t row = minRow; row <= maxRow; ++row )
+        for( size_t col = minCol; col <= maxCol; ++col )
+            cells[row * gridSize + col].push_back (make_pair (start, end));
+}
+
+bool SegmentGrid::crosses(size_t first, size_t last)
+{
+    ++stamp;
+    size_t minCol, minRow, maxCol, maxRow;
+    getCells (first, last, minCol, minRow, maxCol, maxRow);
+    for( size_t row = minRow; row <= maxRow; ++row )
+        for( size_t col = minCol; col <= maxCol; ++col )
+        {
+            vector< pair<size_t, size_t> >& cell = cells[row * gridSize + col];
+            for( size_t i = 0; i < cell.size (); )
+            {
+                size_t start = cell[i].first;
+                size_t end = cell[i].second;
+                if( settled[start] ? !keep[start] || next[start] != end :
+                                     end != start + 1 )
+                {
+                    cell[i] = cell.back ();
+                    cell.pop_back ();
+                    continue; // replaced
+                }
+                ++i;
+                if( visited[start] == stamp ||
+                    (!settled[start] && start >= first && start < last) )
+                    continue;
+                visited[start] = stamp;
+                if( isProperCrossing (vertexes[first], vertexes[last],
+                                      vertexes[start], vertexes[end]) )
+                    return true;
+            }
+        }
+    return false;
+}
+
+static bool isClosed(const vector<CADVector>& vertexes)
+{
+    return vertexes.size () > 3 &&
+           vertexes.front ().getX () == vertexes.back ().getX () &&
+           vertexes.front ().getY () == vertexes.back ().getY ();
+}
+
+static void simplifyDouglasPeucker(const vector<CADVector>& vertexes,
+                                   double tolerance, bool preserveTopology,
+                                   vector<bool>& keep)
+{
+    const size_t nCount = vertexes.size ();
+    vector< pair<size_t, size_t> > spans;
+    vector<size_t> next(nCount, nCount - 1);
+
+    // closed lines are split at the farthest vertex, chord of the whole ring
+    // is a point
+    if( preserveTopology && isClosed (vertexes) )
+    {
+        size_t farthest = 1;
+        double maxDistance = -1.0;
+        for( size_t i = 1; i + 1 < nCount; ++i )
+        {
+            double distance = getSegmentDistance (vertexes[i], vertexes[0],
+                                                  vertexes[0]);
+            if( distance > maxDistance )
+            {
+                maxDistance = distance;
+                farthest = i;
+            }
+        }
+        keep[farthest] = true;
+        next[0] = farthest;
+        spans.push_back (make_pair (size_t(0), farthest));
+        spans.push_back (make_pair (farthest, nCount - 1));
+    }
+    else
+        spans.push_back (make_pair (size_t(0), nCount - 1));
+
+    // the accepted chords settle their spans, a chord is checked against the
+    // settled chords and the original segments of the pending spans
+    vector<bool> settled(nCount, false);
+    unique_ptr<SegmentGrid> grid;
+    if( preserveTopology )
+    {
+        grid.reset (new SegmentGrid(vertexes, keep, next, settled));
+        for( size_t i = 0; i + 1 < nCount; ++i )
+            grid->insert (i, i + 1);
+    }
+
+    while( !spans.empty () )
+    {
+        size_t first = spans.back ().first;
+        size_t last = spans.back ().second;
+        spans.pop_back ();
+        if( last <= first + 1 )
+        {
+            settled[first] = true;
+            continue;
+        }
+
+        size_t farthest = first + 1;
+        double maxDistance = -1.0;
+        for( size_t i = first + 1; i < last; ++i )
+        {
+            double distance = getSegmentDistance (vertexes[i], vertexes[first],
+                                                  vertexes[last]);
+            if( distance > maxDistance )
+            {
+                maxDistance = distance;
+                farthest = i;
+            }
+        }
+
+        if( maxDistance > tolerance ||
+            (nullptr != grid && grid->crosses (first, last)) )
+        {
+            keep[farthest] = true;
+            next[first] = farthest;
+            next[farthest] = last;
+            spans.push_back (make_pair (first, farthest));
+            spans.push_back (make_pair (farthest, last));
+        }
+        else if( nullptr != grid )
+        {
+            fill(settled.begin () + first, settled.begin () + last, true);
+            grid->insert (first, last);
+        }
+    }
+
+    // the ring of 3 vertexes is degenerated, keep one more
+    if( preserveTopology && isClosed (vertexes) &&
+        count(keep.begin (), keep.end (), true) < 4 )
+    {
+        size_t farthest = 0;
+        double maxDistance = -1.0;
+        size_t first = 0;
+        for( size_t i = 1; i < nCount; ++i )
+        {
+            if( !keep[i] )
+            {
+                size_t last = i;
+                while( !keep[last] )
+                    ++last;
+                double distance = getSegmentDistance (vertexes[i],
+                                                      vertexes[first],
+                                                      vertexes[last]);
+                if( distance > maxDistance )
+                {
+                    maxDistance = distance;
+                    farthest = i;
+                }
+            }
+            else
+                first = i;
+        }
+        if( farthest > 0 )
+            keep[farthest] = true;
+    }
+}
+
+static void simplifyVisvalingam(const vector<CADVector>& vertexes,
+                                double tolerance, bool preserveTopology,
+                                vector<bool>& keep)
+{
+    const size_t nCount = vertexes.size ();
+    fill(keep.begin (), keep.end (), true);
+
+    vector<size_t> previous(nCount), next(nCount);
+    vector<double> areas(nCount, numeric_limits<double>::infinity ());
+    typedef pair<double, size_t> AreaVertex;
+    priority_queue< AreaVertex, vector<AreaVertex>,
+                    greater<AreaVertex> > queue;
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        previous[i] = i == 0 ? 0 : i - 1;
+        next[i] = i + 1 == nCount ? i : i + 1;
+        if( i > 0 && i + 1 < nCount )
+        {
+            areas[i] = getTriangleArea (vertexes[i - 1], vertexes[i],
+                                        vertexes[i + 1]);
+            queue.push (make_pair (areas[i], i));
+        }
+    }
+
+    // the whole current line is settled
+    const vector<bool> settled(nCount, true);
+    unique_ptr<SegmentGrid> grid;
+    if( preserveTopology )
+    {
+        grid.reset (new SegmentGrid(vertexes, keep, next, settled));
+        for( size_t i = 0; i + 1 < nCount; ++i )
+            grid->insert (i, i + 1);
+    }
+
+    const double threshold = tolerance * tolerance;
+    const size_t minCount = preserveTopology && isClosed (vertexes) ? 4 : 2;
+    size_t nRemaining = nCount;
+    while( !queue.empty () && nRemaining > minCount )
+    {
+        double area = queue.top ().first;
+        size_t i = queue.top ().second;
+        queue.pop ();
+        if( !keep[i] || area != areas[i] )
+            continue; // removed or stale
+        if( area >= threshold )
+            break;
+        if( nullptr != grid && grid->crosses (previous[i], next[i]) )
+            continue; // vertex is locked
+
+        keep[i] = false;
+        --nRemaining;
+        next[previous[i]] = next[i];
+        previous[next[i]] = previous[i];
+        if( nullptr != grid )
+            grid->insert (previous[i], next[i]);
+
+        // neighbours area never drops below the removed one
+        for( size_t neighbour : { previous[i], next[i] } )
+        {
+            if( neighbour == 0 || neighbour + 1 == nCount )
+                continue;
+            areas[neighbour] = max(area, getTriangleArea (
+                                       vertexes[previous[neighbour]],
+                                       vertexes[neighbour],
+                                       vertexes[next[neighbour]]));
+            queue.push (make_pair (areas[neighbour], neighbour));
+        }
+    }
+}
+
+vector<size_t> CADSimplifier::simplify(const vector<CADVector> &vertexes,
+                                       double tolerance, Method method,
+                                       bool preserveTopology)
+{
+    vector<size_t> indexes;
+    if( vertexes.size () <= 2 )
+    {
+        for( size_t i = 0; i < vertexes.size (); ++i )
+            indexes.push_back (i);
+        return indexes;
+    }
+
+    vector<bool> keep(vertexes.size (), false);
+    keep.front () = true;
+    keep.back () = true;
+    if( method == VISVALINGAM )
+        simplifyVisvalingam (vertexes, tolerance, preserveTopology, keep);
+    else
+        simplifyDouglasPeucker (vertexes, tolerance, preserveTopology, keep);
+
+    for( size_t i = 0; i < keep.size (); ++i )
+        if( keep[i] )
+            indexes.push_back (i);
+    return indexes;
+}
+
+// ----------------------------------------------------------------------------
+// CADGeometryPyramid
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Get the line vertexes of the geometry, bulges and splines are
+ * tessellated
+ * @return false if the geometry is not a line
+ */
+static bool getLineVertexes(CADGeometry * geometry,
+                            const CADTessellator& tessellator,
+                            vector<CADVector>& vertexes)
+{
+    switch( geometry->getType () )
+    {
+        case CADGeometry::POLYLINE3D:
+        case CADGeometry::LWPOLYLINE:
+        case CADGeometry::SPLINE:
+            tessellator.tessellate (geometry, vertexes);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void setLineVertexes(CADGeometry * geometry,
+                            const vector<CADVector>& vertexes)
+{
+    switch( geometry->getType () )
+    {
+        case CADGeometry::LWPOLYLINE:
+        {
+            // widths and bulges are per vertex, the constant width is kept.
+            // The vertexes are tessellated, closing vertex included.
+            CADLWPolyline * polyline = static_cast<CADLWPolyline *>(geometry);
+            polyline->setWidths (vector< pair<double, double> >());
+            polyline->setBulges (vector<double>());
+            polyline->setClosed (false);
+            polyline->setVertexes (vertexes);
+            break;
+        }
+        case CADGeometry::POLYLINE3D:
+            static_cast<CADPolyline3D *>(geometry)->setVertexes (vertexes);
+            break;
+        case CADGeometry::SPLINE:
+        {
+            // the flattened spline is the linear fit points spline
+            CADSpline * spline = static_cast<CADSpline *>(geometry);
+            spline->getControlPoints ().clear ();
+            spline->getControlPointsWeights ().clear ();
+            spline->getKnots ().clear ();
+            spline->setScenario (2);
+            spline->setDegree (1);
+            spline->setRational (false);
+            spline->setClosed (false);
+            spline->setBegTangent (CADVector(0.0, 0.0, 0.0));
+            spline->setEndTangent (CADVector(0.0, 0.0, 0.0));
+            spline->getFitPoints () = vertexes;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+CADGeometryPyramid::CADGeometryPyramid(CADFile * const file,
+                                       const vector<double> &tolerances,
+                                       size_t minVertexCount,
+                                       CADSimplifier::Method method,
+                                       bool preserveTopology) :
+    pCADFile(file), levelTolerances(tolerances), minVertexes(minVertexCount),
+    simplifyMethod(method), keepTopology(preserveTopology)
+{
+    sort(levelTolerances.begin (), levelTolerances.end ());
+}
+
+int CADGeometryPyramid::build(CADFileCursor *cursor)
+{
+    levels.clear ();
+    // bulges and splines are tessellated finer than the first level
+    const CADTessellator tessellator(levelTolerances.empty () ? 0.0 :
+                                     levelTolerances.front () / 2);
+    for( size_t i = 0; i < pCADFile->getLayersCount (); ++i )
+    {
+        CADLayer &layer = pCADFile->getLayer (i);
+        for( size_t j = 0; j < layer.getGeometryCount (); ++j )
+        {
+            const int projection = CADFile::PROJECTION_COORDINATES;
+            unique_ptr<CADGeometry> geometry(nullptr != cursor ?
+                        cursor->getGeometry (i, j, projection) :
+                        layer.getGeometry (j, projection));
+            vector<CADVector> vertexes;
+            if( nullptr == geometry ||
+                !getLineVertexes (geometry.get (), tessellator, vertexes) ||
+                vertexes.size () < minVertexes )
+                continue;
+
+            Levels& geometryLevels = levels[make_pair (i, j)];
+            for( double tolerance : levelTolerances )
+            {
+                vector<size_t> indexes = CADSimplifier::simplify (
+                            vertexes, tolerance, simplifyMethod, keepTopology);
+                vector<CADVector> simplified;
+                simplified.reserve (indexes.size ());
+                for( size_t index : indexes )
+                    simplified.push_back (vertexes[index]);
+                geometryLevels.push_back (simplified);
+            }
+        }
+    }
+    return CADErrorCodes::SUCCESS;
+}
+
+int CADGeometryPyramid::getLevel(double tolerance) const
+{
+    int level = -1;
+    for( size_t i = 0; i < levelTolerances.size (); ++i )
+        if( levelTolerances[i] <= tolerance )
+            level = static_cast<int>(i);
+    return level;
+}
+
+const vector<CADVector> *CADGeometryPyramid::getVertexes(size_t layerIndex,
+                                                         size_t index,
+                                                         double tolerance) const
+{
+    int level = getLevel (tolerance);
+    if( level < 0 )
+        return nullptr;
+    auto it = levels.find (make_pair (layerIndex, index));
+    if( it == levels.end () )
+        return nullptr;
+    return &it->second[static_cast<size_t>(level)];
+}
+
+CADGeometry *CADGeometryPyramid::getGeometry(size_t layerIndex, size_t index,
+                                             double tolerance,
+                                             CADFileCursor *cursor) const
+{
+    CADGeometry * geometry = nullptr != cursor ?
+                cursor->getGeometry (layerIndex, index) :
+                pCADFile->getLayer (layerIndex).getGeometry (index);
+    if( nullptr == geometry )
+        return nullptr;
+
+    const vector<CADVector> * vertexes = getVertexes (layerIndex, index,
+                                                      tolerance);
+    if( nullptr != vertexes )
+        setLineVertexes (geometry, *vertexes);
+    return geometry;
+}
+
+int CADGeometryPyramid::save(const string &path) const
+{
+    ofstream stream(path.c_str (), ios_base::out | ios_base::binary);
+    if( !stream.is_open () )
+        return CADErrorCodes::FILE_OPEN_FAILED;
+
+    auto writeCount = [&stream](uint64_t value)
+    {
+        stream.write (reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+    auto writeDouble = [&stream](double value)
+    {
+        stream.write (reinterpret_cast<const char *>(&value), sizeof(value));
+    };
+
+    stream.write (PyramidSignature, sizeof(PyramidSignature) - 1);
+    writeCount (levelTolerances.size ());
+    for( double tolerance : levelTolerances )
+        writeDouble (tolerance);
+    writeCount (levels.size ());
+    for( const pair<const GeometryKey, Levels>& entry : levels )
+    {
+        writeCount (entry.first.first);
+        writeCount (entry.first.second);
+        for( const vector<CADVector>& vertexes : entry.second )
+        {
+            writeCount (vertexes.size ());
+            for( const CADVector& vertex : vertexes )
+            {
+                writeDouble (vertex.getX ());
+                writeDouble (vertex.getY ());
+                writeDouble (vertex.getZ ());
+            }
+        }
+    }
+
+    return stream.good () ? CADErrorCodes::SUCCESS :
+                            CADErrorCodes::FILE_OPEN_FAILED;
+}
+
+int CADGeometryPyramid::load(const string &path)
+{
+    ifstream stream(path.c_str (), ios_base::in | ios_base::binary);
+    if( !stream.is_open () )
+        return CADErrorCodes::FILE_OPEN_FAILED;
+
+    auto readCount = [&stream]() -> uint64_t
+    {
+        uint64_t value = 0;
+        stream.read (reinterpret_cast<char *>(&value), sizeof(value));
+        return value;
+    };
+    auto readDouble = [&stream]() -> double
+    {
+        double value = 0.0;
+        stream.read (reinterpret_cast<char *>(&value), sizeof(value));
+        return value;
+    };
+
+    char signature[sizeof(PyramidSignature) - 1];
+    stream.read (signature, sizeof(signature));
+    if( !stream.good () ||
+        memcmp(signature, PyramidSignature, sizeof(signature)) != 0 )
+        return CADErrorCodes::FILE_PARSE_FAILED;
+
+    if( readCount () != levelTolerances.size () )
+        return CADErrorCodes::FILE_PARSE_FAILED;
+    for( double tolerance : levelTolerances )
+        if( readDouble () != tolerance )
+            return CADErrorCodes::FILE_PARSE_FAILED;
+
+    map<GeometryKey, Levels> loaded;
+    uint64_t nEntries = readCount ();
+    for( uint64_t i = 0; i < nEntries && stream.good (); ++i )
+    {
+        size_t layerIndex = static_cast<size_t>(readCount ());
+        size_t index = static_cast<size_t>(readCount ());
+        Levels& geometryLevels = loaded[make_pair (layerIndex, index)];
+        for( size_t level = 0; level < levelTolerances.size (); ++level )
+        {
+            uint64_t nVertexes = readCount ();
+            vector<CADVector> vertexes;
+            for( uint64_t j = 0; j < nVertexes && stream.good (); ++j )
+            {
+                double x = readDouble ();
+                double y = readDouble ();
+                double z = readDouble ();
+                vertexes.push_back (CADVector(x, y, z));
+            }
+            geometryLevels.push_back (vertexes);
+        }
+    }
+    if( !stream.good () )
+        return CADErrorCodes::FILE_PARSE_FAILED;
+
+    levels.swap (loaded);
+    return CADErrorCodes::SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADSIMPLIFY_H
+#define CADSIMPLIFY_H
+
+#include "cadfile.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The line simplification algorithms
+ */
+class OCAD_EXTERN CADSimplifier
+{
+public:
+    /**
+     * @brief The simplification methods
+     */
+    enum Method
+    {
+        DOUGLAS_PEUCKER,    /**< keep vertexes farther than tolerance from chord */
+        VISVALINGAM         /**< drop vertexes with triangle area below tolerance^2 */
+    };
+
+    /**
+     * @brief Simplify the line in XY plane
+     * @param vertexes Line vertexes
+     * @param tolerance Simplification tolerance in drawing units
+     * @param method Simplification method
+     * @param preserveTopology If set, the simplified segments do not cross
+     * each other, and closed lines keep at least 4 vertexes. The segments are
+     * looked up in a uniform grid.
+     * @return indexes of the kept vertexes, ascending. The first and the last
+     * vertexes are always kept.
+     */
+    static std::vector<size_t> simplify(const std::vector<CADVector>& vertexes,
+                                        double tolerance,
+                                        Method method = DOUGLAS_PEUCKER,
+                                        bool preserveTopology = false);
+};
+
+/**
+ * @brief The multi-resolution cache of long lines. For each POLYLINE3D,
+ * LWPOLYLINE and SPLINE geometry with at least minimum vertexes count it
+ * keeps the line simplified with each of the pyramid tolerances.
+ * LWPOLYLINE bulges and splines are tessellated before the simplification,
+ * the simplified spline is returned as the linear fit points spline.
+ * The geometry requested at the tolerance is served from the coarsest level
+ * not exceeding it. The pyramid may be saved to and loaded from a file to
+ * skip building it next time.
+ */
+class OCAD_EXTERN CADGeometryPyramid
+{
+public:
+    /**
+     * @brief Create the pyramid
+     * @param file Parsed CAD file
+     * @param tolerances Level tolerances in drawing units
+     * @param minVertexCount Lines with less vertexes are not cached
+     * @param method Simplification method
+     * @param preserveTopology see CADSimplifier::simplify
+     */
+    CADGeometryPyramid(CADFile * const file,
+                       const std::vector<double>& tolerances,
+                       size_t minVertexCount = 64,
+                       CADSimplifier::Method method = CADSimplifier::DOUGLAS_PEUCKER,
+                       bool preserveTopology = false);
+
+    /**
+     * @brief Read all layers lines and simplify them
+     * @param cursor Cursor to read geometries with, nullptr - read with the
+     * file itself
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int build(CADFileCursor* cursor = nullptr);
+    /**
+     * @brief Get the layer geometry simplified to the tolerance. Geometries
+     * without cached levels are returned in full resolution.
+     * @param layerIndex Layer index
+     * @param index Geometry index in the layer
+     * @param tolerance Acceptable tolerance in drawing units
+     * @param cursor Cursor to read geometries with, nullptr - read with the
+     * file itself
+     * @return NULL if failed or pointer which mast be feed by user
+     */
+    CADGeometry* getGeometry(size_t layerIndex, size_t index, double tolerance,
+                             CADFileCursor* cursor = nullptr) const;
+    /**
+     * @brief Get the cached line vertexes without reading the file
+     * @param layerIndex Layer index
+     * @param index Geometry index in the layer
+     * @param tolerance Acceptable tolerance in drawing units
+     * @return vertexes or nullptr if there is no level for the tolerance
+     */
+    const std::vector<CADVector>* getVertexes(size_t layerIndex, size_t index,
+                                              double tolerance) const;
+    /**
+     * @brief Save the pyramid
+     * @param path File path
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int save(const std::string& path) const;
+    /**
+     * @brief Load the pyramid saved with the same tolerances
+     * @param path File path
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int load(const std::string& path);
+
+protected:
+    typedef std::pair<size_t, size_t> GeometryKey; // layer, geometry index
+    typedef std::vector< std::vector<CADVector> > Levels; // per tolerance
+
+    int getLevel(double tolerance) const;
+
+protected:
+    CADFile * const                 pCADFile;
+    std::vector<double>             levelTolerances; // ascending
+    size_t                          minVertexes;
+    CADSimplifier::Method           simplifyMethod;
+    bool                            keepTopology;
+    std::map<GeometryKey, Levels>   levels;
+};
+
+#endif // CADSIMPLIFY_H
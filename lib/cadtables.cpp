@@ -95,24 +95,12 @@ int CADTables::readLayersTable( CADFile  * const file, long index)
     {
         if ( !layerControl->hLayers[i].isNull())
         {
-            CADLayer layer(file);
-
             // Init CADLayer from objLayer properties
             unique_ptr<CADLayerObject> objLayer(
                         static_cast<CADLayerObject*>(file->getObject (
                                         layerControl->hLayers[i].getAsLong ())));
-
-            layer.setName (objLayer->sLayerName);
-            layer.setFrozen (objLayer->bFrozen);
-            layer.setOn (objLayer->bOn);
-            layer.setFrozenByDefault (objLayer->bFrozenInNewVPORT);
-            layer.setLocked (objLayer->bLocked);
-            layer.setLineWeight (objLayer->dLineWeight);
-            layer.setColor (objLayer->dCMColor);
-            layer.setId (layers.size () + 1);
-            layer.setHandle (objLayer->hObjectHandle.getAsLong ());
-
-            layers.push_back (layer);
+            if(nullptr != objLayer)
+                addLayer(file, objLayer.get ());
         }
     }
 
@@ -124,47 +112,55 @@ int CADTables::readLayersTable( CADFile  * const file, long index)
             static_cast<CADBlockHeaderObject *>(file->getObject (
                                                     it->second.getAsLong ())));
 
+    if( nullptr == pstModelSpace )
+        return CADErrorCodes::TABLE_READ_FAILED;
+
+    if( file->readFilter.scanObjectsMap )
+        return readModelSpaceEntities(file, pstModelSpace.get ());
+
+    // R2004+ entities are not linked, the block header lists all of them
+    if( file->getHeader ().get<CADHeader::OPENCADVER>() >=
+            CADVersions::DWG_R2004 )
+    {
+        for( const CADHandle& entHandle : pstModelSpace->hEntities )
+        {
+            unique_ptr<CADEntityObject> ent( static_cast<CADEntityObject *>(
+                    file->getObject (entHandle.getAsLong (), true)));
+            if( nullptr != ent )
+                fillLayer(file, ent.get ());
+        }
+        return CADErrorCodes::SUCCESS;
+    }
+
+    if( pstModelSpace->hEntities.size () < 2 )
+        return CADErrorCodes::SUCCESS;
     auto dCurrentEntHandle = pstModelSpace->hEntities[0].getAsLong ();
     auto dLastEntHandle    = pstModelSpace->hEntities[1].getAsLong ();
-    while ( true )
+    // broken links may loop, no more entities than objects can be linked
+    for( size_t i = 0; i < file->objectsMap.size (); ++i )
     {
         unique_ptr<CADEntityObject> ent( static_cast<CADEntityObject *>(
                                           file->getObject (dCurrentEntHandle,
                                                            true))); // true = read CED && handles only
 
-        if ( dCurrentEntHandle == dLastEntHandle )
+        /* If something goes wrong way the links can not be followed, some
+         * part of geometries is parsed. */
+        if ( ent == nullptr )
         {
-            ent.reset (static_cast<CADEntityObject *>(
-                               file->getObject (dCurrentEntHandle, true) ) );
-            if(nullptr != ent)
-                fillLayer(ent.get ());
-            else
-            {
-#ifdef _DEBUG
-                assert(0);
-#endif //_DEBUG
-            }
+            DebugMsg ("Failed to read the linked entity %ld\n",
+                      dCurrentEntHandle);
             break;
         }
 
-        /* TODO: this check is excessive, but if something goes wrong way -
-         * some part of geometries will be parsed. */
-        if ( ent != nullptr )
-        {
-            fillLayer(ent.get ());
+        fillLayer(file, ent.get ());
+        if ( dCurrentEntHandle == dLastEntHandle )
+            break;
 
-            if ( ent->stCed.bNoLinks )
-                ++dCurrentEntHandle;
-            else
-                dCurrentEntHandle = ent->stChed.hNextEntity.getAsLong (
-                            ent->stCed.hObjectHandle);
-        }
+        if ( ent->stCed.bNoLinks )
+            ++dCurrentEntHandle;
         else
-        {
-#ifdef _DEBUG
-            assert(0);
-#endif //_DEBUG
-        }
+            dCurrentEntHandle = ent->stChed.hNextEntity.getAsLong (
+                        ent->stCed.hObjectHandle);
     }
 
     DebugMsg ("Readed layers using LayerControl object count: %d\n",
@@ -173,23 +169,155 @@ int CADTables::readLayersTable( CADFile  * const file, long index)
     return CADErrorCodes::SUCCESS;
 }
 
-void CADTables::fillLayer(const CADEntityObject *ent)
+/**
+ * @brief Order the scanned entities as the model space lists or links them,
+ * the entities out of the order are left at the end
+ * @param file CAD file
+ * @param modelSpace Model space block header
+ * @param entities Model space entities in the handles order
+ */
+static void orderEntities(CADFile * const file,
+                          const CADBlockHeaderObject *modelSpace,
+                          vector<const CADFile::EntityHandles *> &entities)
 {
-    for ( CADLayer &layer : layers )
+    map<long, size_t> entityIndexes; // entity handle <-> index in entities
+    for( size_t i = 0; i < entities.size (); ++i )
+        entityIndexes[entities[i]->handle] = i;
+
+    vector<bool> ordered(entities.size (), false);
+    vector<const CADFile::EntityHandles *> orderedEntities;
+    orderedEntities.reserve (entities.size ());
+    auto addOrdered = [&](long handle) -> const CADFile::EntityHandles *
     {
-        if ( ent->stChed.hLayer.getAsLong (ent->stCed.hObjectHandle) ==
-             layer.getHandle () )
-        {
-            DebugMsg ("Object with type: %s is attached to layer named: %s\n",
-                      getNameByType(ent->getType()).c_str (),
-                      layer.getName ().c_str ());
+        auto it = entityIndexes.find (handle);
+        if( it == entityIndexes.end () || ordered[it->second] )
+            return nullptr;
+        ordered[it->second] = true;
+        orderedEntities.push_back (entities[it->second]);
+        return entities[it->second];
+    };
 
-            layer.addHandle (ent->stCed.hObjectHandle.getAsLong (),
-                             ent->getType());
-            break; // TODO: check if only can be add to one layer
+    // R2004+ block header lists all entities, earlier entities are linked
+    // from the first to the last one
+    if( file->getHeader ().get<CADHeader::OPENCADVER>() >=
+            CADVersions::DWG_R2004 )
+    {
+        for( const CADHandle& entHandle : modelSpace->hEntities )
+            addOrdered (entHandle.getAsLong ());
+    }
+    else if( modelSpace->hEntities.size () >= 2 )
+    {
+        long dCurrentEntHandle = modelSpace->hEntities[0].getAsLong ();
+        const long dLastEntHandle = modelSpace->hEntities[1].getAsLong ();
+        const CADFile::EntityHandles *entity;
+        while( nullptr != ( entity = addOrdered (dCurrentEntHandle) ) &&
+               dCurrentEntHandle != dLastEntHandle )
+        {
+            // entities without links follow each other
+            dCurrentEntHandle = 0 != entity->next ? entity->next :
+                                                    entity->handle + 1;
         }
     }
+
+    // entities out of the order are kept in the handles order
+    for( size_t i = 0; i < entities.size (); ++i )
+    {
+        if( !ordered[i] )
+            orderedEntities.push_back (entities[i]);
+    }
+    entities.swap (orderedEntities);
 }
 
+int CADTables::readModelSpaceEntities(CADFile * const file,
+                                      const CADBlockHeaderObject *modelSpace)
+{
+    vector<CADFile::EntityHandles> entities;
+    file->readEntitiesHandles (entities, file->readFilter.scanThreadCount);
+
+    // Model space entities have the entity mode 2, or 0 and the model space
+    // owner. The block begin and end entities are not linked to others.
+    const long modelSpaceHandle = modelSpace->hObjectHandle.getAsLong ();
+    vector<const CADFile::EntityHandles *> modelSpaceEntities;
+    for( const CADFile::EntityHandles& entity : entities )
+    {
+        if( entity.type == CADObject::BLOCK || entity.type == CADObject::ENDBLK )
+            continue;
+        if( entity.entMode == 2 ||
+            ( entity.entMode == 0 && entity.owner == modelSpaceHandle ) )
+            modelSpaceEntities.push_back (&entity);
+    }
 
+    if( file->readFilter.keepEntitiesOrder )
+        orderEntities (file, modelSpace, modelSpaceEntities);
 
+    for( const CADFile::EntityHandles *entity : modelSpaceEntities )
+        addEntity (file, entity->layer, entity->handle, entity->type);
+
+    DebugMsg ("Scanned model space entities count: %d\n",
+              modelSpaceEntities.size ());
+
+    return CADErrorCodes::SUCCESS;
+}
+
+bool CADTables::addLayer(CADFile * const file, const CADLayerObject *objLayer)
+{
+    if(!isLayerWanted(file, objLayer))
+        return false;
+
+    CADLayer layer(file);
+    layer.setName (objLayer->sLayerName);
+    layer.setFrozen (objLayer->bFrozen);
+    layer.setOn (objLayer->bOn);
+    layer.setFrozenByDefault (objLayer->bFrozenInNewVPORT);
+    layer.setLocked (objLayer->bLocked);
+    layer.setLineWeight (objLayer->dLineWeight);
+    layer.setColor (objLayer->dCMColor);
+    layer.setId (layers.size () + 1);
+    layer.setHandle (objLayer->hObjectHandle.getAsLong ());
+
+    layerIndexes[layer.getHandle ()] = layers.size ();
+    layers.push_back (layer);
+    return true;
+}
+
+void CADTables::fillLayer(CADFile * const file, const CADEntityObject *ent)
+{
+    addEntity (file, ent->stChed.hLayer.getAsLong (ent->stCed.hObjectHandle),
+               ent->stCed.hObjectHandle.getAsLong (), ent->getType ());
+}
+
+void CADTables::addEntity(CADFile * const file, long layerHandle, long handle,
+                          short type)
+{
+    // Entities of filtered out types and layers are dropped here, before
+    // any insert is expanded or handle stored.
+    if( !file->readFilter.acceptsType (type) )
+        return;
+
+    auto it = layerIndexes.find (layerHandle);
+    if( it == layerIndexes.end () )
+        return;
+
+    CADLayer &layer = layers[it->second];
+    DebugMsg ("Object with type: %s is attached to layer named: %s\n",
+              getNameByType(static_cast<CADObject::ObjectType>(type)).c_str (),
+              layer.getName ().c_str ());
+
+    layer.addHandle (handle, static_cast<CADObject::ObjectType>(type));
+}
+
+bool CADTables::isLayerWanted(CADFile * const file,
+                              const CADLayerObject *objLayer) const
+{
+    const CADFile::ReadFilter &filter = file->readFilter;
+    if( filter.skipFrozenLayers && objLayer->bFrozen )
+        return false;
+    if( filter.skipOffLayers && !objLayer->bOn )
+        return false;
+    if( filter.layerNames.empty () && filter.layerHandles.empty () )
+        return true;
+    // TV strings keep the terminating zero, compare up to it
+    return filter.layerNames.count (objLayer->sLayerName.c_str ()) != 0 ||
+           filter.layerHandles.count (
+                objLayer->hObjectHandle.getAsLong ()) != 0;
+}
@@ -75,13 +75,42 @@ public:
     int readTable(CADFile * const file, enum TableType eType);
     size_t getLayerCount() const;
     CADLayer& getLayer(size_t index);
+    /**
+     * @brief Add the layer if it passes the file read filter
+     * @param file CAD file
+     * @param objLayer Layer properties
+     * @return true if the layer is added
+     */
+    bool addLayer(CADFile * const file, const CADLayerObject* objLayer);
+    /**
+     * @brief Attach the model space entity to its layer. Entities of filtered
+     * out types and layers are dropped.
+     * @param file CAD file
+     * @param layerHandle Handle of the entity layer
+     * @param handle Entity handle
+     * @param type CADObject::ObjectType
+     */
+    void addEntity(CADFile * const file, long layerHandle, long handle,
+                   short type);
 
 protected:
     int readLayersTable(CADFile * const file, long index);
-    void fillLayer(const CADEntityObject* ent);
+    /**
+     * @brief Attach the model space entities to layers, the entities are
+     * found in the objects map instead of following their links
+     * @param file CAD file
+     * @param modelSpace Model space block header
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int readModelSpaceEntities(CADFile * const file,
+                               const CADBlockHeaderObject* modelSpace);
+    void fillLayer(CADFile * const file, const CADEntityObject* ent);
+    bool isLayerWanted(CADFile * const file,
+                       const CADLayerObject* objLayer) const;
 protected:
     map<enum TableType, CADHandle> tableMap;
     vector<CADLayer> layers;
+    map<long, size_t> layerIndexes; // layer handle <-> index in layers
 };
 
 #endif // CADTABLES_H
@@ -0,0 +1,320 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadtessellate.h"
+#include "cadnurbs.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+static const double dfPi = acos(-1.0);
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+struct Vec3
+{
+    double x, y, z;
+
+    Vec3(double dx, double dy, double dz) : x(dx), y(dy), z(dz) {}
+    explicit Vec3(const CADVector& vector) :
+        x(vector.getX ()), y(vector.getY ()), z(vector.getZ ()) {}
+
+    Vec3 operator + (const Vec3& other) const
+    {
+        return Vec3(x + other.x, y + other.y, z + other.z);
+    }
+    Vec3 operator - (const Vec3& other) const
+    {
+        return Vec3(x - other.x, y - other.y, z - other.z);
+    }
+    Vec3 operator * (double value) const
+    {
+        return Vec3(x * value, y * value, z * value);
+    }
+    Vec3 cross(const Vec3& other) const
+    {
+        return Vec3(y * other.z - z * other.y, z * other.x - x * other.z,
+                    x * other.y - y * other.x);
+    }
+    double length() const
+    {
+        return sqrt(x * x + y * y + z * z);
+    }
+};
+
+/**
+ * @brief Writes vertexes to the caller buffer, counts ones beyond capacity
+ */
+struct VertexWriter
+{
+    double * xyz;
+    size_t   capacity;
+    size_t   count;
+
+    void add(const Vec3& vertex)
+    {
+        if( nullptr != xyz && count < capacity )
+        {
+            xyz[count * 3] = vertex.x;
+            xyz[count * 3 + 1] = vertex.y;
+            xyz[count * 3 + 2] = vertex.z;
+        }
+        ++count;
+    }
+};
+
+static Vec3 getNormal(const CADVector& extrusion)
+{
+    Vec3 normal(extrusion);
+    double length = normal.length ();
+    if( length == 0.0 )
+        return Vec3(0.0, 0.0, 1.0);
+    return normal * (1.0 / length);
+}
+
+static double getSweep(double start, double end)
+{
+    double sweep = end - start;
+    while( sweep <= 0.0 )
+        sweep += 2 * dfPi;
+    while( sweep > 2 * dfPi )
+        sweep -= 2 * dfPi;
+    return sweep;
+}
+
+/**
+ * @brief Add the arc points by the rotation recurrence
+ * @param bFirst add the start point
+ * @param bLast add the end point
+ */
+static void addArc(VertexWriter& writer, const Vec3& center, const Vec3& major,
+                   const Vec3& minor, double start, double sweep,
+                   size_t nSegments, bool bFirst, bool bLast)
+{
+    const double step = sweep / nSegments;
+    const double cosStep = cos(step), sinStep = sin(step);
+    double c = cos(start), s = sin(start);
+    for( size_t i = 0; i <= nSegments; ++i )
+    {
+        if( i == nSegments )
+        {
+            if( !bLast )
+                break;
+            // exact end point, no recurrence drift
+            c = cos(start + sweep);
+            s = sin(start + sweep);
+        }
+        if( i > 0 || bFirst )
+            writer.add (center + major * c + minor * s);
+        double next = c * cosStep - s * sinStep;
+        s = s * cosStep + c * sinStep;
+        c = next;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// CADTessellator
+// ----------------------------------------------------------------------------
+
+CADTessellator::CADTessellator(double tolerance, size_t maxSegments) :
+    tolerance(tolerance),
+    minStep(2 * dfPi / max(maxSegments, size_t(4))),
+    maxSegments(max(maxSegments, size_t(4)))
+{
+
+}
+
+size_t CADTessellator::getArcSegments(double radius, double sweep) const
+{
+    double step = minStep;
+    if( radius > 0.0 && tolerance > 0.0 )
+    {
+        if( tolerance < radius )
+            step = max(step, 2.0 * acos(1.0 - tolerance / radius));
+        else
+            step = max(step, dfPi / 2);
+    }
+    size_t nSegments = static_cast<size_t>(ceil(fabs(sweep) / step));
+    return max(nSegments, size_t(1));
+}
+
+size_t CADTessellator::tessellateArc(const CADVector &center,
+                                     const CADVector &major,
+                                     const CADVector &minor, double start,
+                                     double sweep, double *xyz,
+                                     size_t capacity) const
+{
+    VertexWriter writer = { xyz, capacity, 0 };
+    Vec3 majorAxis(major), minorAxis(minor);
+    double radius = max(majorAxis.length (), minorAxis.length ());
+    addArc (writer, Vec3(center), majorAxis, minorAxis, start, sweep,
+            getArcSegments (radius, sweep), true, true);
+    return writer.count;
+}
+
+size_t CADTessellator::tessellate(CADGeometry *geometry, double *xyz,
+                                  size_t capacity) const
+{
+    VertexWriter writer = { xyz, capacity, 0 };
+    switch( geometry->getType () )
+    {
+        case CADGeometry::LINE:
+        {
+            CADLine * line = static_cast<CADLine *>(geometry);
+            writer.add (Vec3(line->getStart ().getPosition ()));
+            writer.add (Vec3(line->getEnd ().getPosition ()));
+            break;
+        }
+        case CADGeometry::LWPOLYLINE:
+        {
+            CADLWPolyline * polyline = static_cast<CADLWPolyline *>(geometry);
+            if( !polyline->getBulges ().empty () )
+                return tessellateBulges (polyline, xyz, capacity);
+            for( size_t i = 0; i < polyline->getVertexCount (); ++i )
+                writer.add (Vec3(polyline->getVertex (i)));
+            if( polyline->getClosed () && polyline->getVertexCount () > 0 )
+                writer.add (Vec3(polyline->getVertex (0)));
+            break;
+        }
+        case CADGeometry::POLYLINE3D:
+        {
+            CADPolyline3D * polyline = static_cast<CADPolyline3D *>(geometry);
+            for( size_t i = 0; i < polyline->getVertexCount (); ++i )
+                writer.add (Vec3(polyline->getVertex (i)));
+            break;
+        }
+        case CADGeometry::CIRCLE:
+        case CADGeometry::ARC:
+        {
+            // circles and arcs lie in their OCS XY plane
+            CADCircle * circle = static_cast<CADCircle *>(geometry);
+            double radius = circle->getRadius ();
+            Matrix ocs = Matrix::fromExtrusion (circle->getExtrusion ());
+            Vec3 major(ocs.multiply (CADVector(radius, 0.0, 0.0)));
+            Vec3 minor(ocs.multiply (CADVector(0.0, radius, 0.0)));
+            double start = 0.0, sweep = 2 * dfPi;
+            if( geometry->getType () == CADGeometry::ARC )
+            {
+                CADArc * arc = static_cast<CADArc *>(geometry);
+                start = arc->getStartingAngle ();
+                sweep = getSweep (start, arc->getEndingAngle ());
+            }
+            addArc (writer, Vec3(circle->getPosition ()), major, minor, start,
+                    sweep, getArcSegments (radius, sweep), true, true);
+            break;
+        }
+        case CADGeometry::ELLIPSE:
+        {
+            CADEllipse * ellipse = static_cast<CADEllipse *>(geometry);
+            Vec3 major(ellipse->getSMAxis ());
+            Vec3 minor = getNormal (ellipse->getExtrusion ()).cross (major) *
+                    ellipse->getAxisRatio ();
+            double start = ellipse->getStartingAngle ();
+            double sweep = getSweep (start, ellipse->getEndingAngle ());
+            addArc (writer, Vec3(ellipse->getPosition ()), major, minor, start,
+                    sweep, getArcSegments (major.length (), sweep), true, true);
+            break;
+        }
+        case CADGeometry::SPLINE:
+        {
+            CADSpline * spline = static_cast<CADSpline *>(geometry);
+            CADNurbsEvaluator evaluator(spline);
+            if( evaluator.isValid () )
+                return evaluator.flatten (tolerance, maxSegments, xyz,
+                                          capacity);
+            // not enough points or broken knots: the fit points or the
+            // control polygon
+            const vector<CADVector>& points = spline->getFitPoints ().empty () ?
+                        spline->getControlPoints () : spline->getFitPoints ();
+            for( const CADVector& point : points )
+                writer.add (Vec3(point));
+            break;
+        }
+        default:
+            break;
+    }
+    return writer.count;
+}
+
+size_t CADTessellator::tessellate(CADGeometry *geometry,
+                                  vector<CADVector> &vertexes) const
+{
+    size_t nCount = tessellate (geometry, nullptr, 0);
+    if( 0 == nCount )
+        return 0;
+    vector<double> xyz(nCount * 3);
+    tessellate (geometry, xyz.data (), nCount);
+    vertexes.reserve (vertexes.size () + nCount);
+    for( size_t i = 0; i < nCount; ++i )
+        vertexes.push_back (CADVector(xyz[i * 3], xyz[i * 3 + 1],
+                                      xyz[i * 3 + 2]));
+    return nCount;
+}
+
+size_t CADTessellator::tessellateBulges(CADLWPolyline *polyline, double *xyz,
+                                        size_t capacity) const
+{
+    VertexWriter writer = { xyz, capacity, 0 };
+    const size_t nVertexes = polyline->getVertexCount ();
+    if( 0 == nVertexes )
+        return 0;
+
+    const vector<double>& bulges = polyline->getBulges ();
+    const Vec3 normal = getNormal (polyline->getVectExtrusion ());
+    const size_t nSegments = polyline->getClosed () ? nVertexes : nVertexes - 1;
+
+    writer.add (Vec3(polyline->getVertex (0)));
+    for( size_t i = 0; i < nSegments; ++i )
+    {
+        Vec3 start(polyline->getVertex (i));
+        Vec3 end(polyline->getVertex ((i + 1) % nVertexes));
+        double bulge = i < bulges.size () ? bulges[i] : 0.0;
+        Vec3 chord = end - start;
+        double chordLength = chord.length ();
+        if( bulge != 0.0 && chordLength > 0.0 )
+        {
+            // bulge is tan(sweep / 4), positive - counterclockwise
+            double sweep = 4.0 * atan(bulge);
+            Vec3 left = normal.cross (chord) * (1.0 / chordLength);
+            Vec3 center = (start + end) * 0.5 +
+                    left * (chordLength / 2 / tan(sweep / 2));
+            Vec3 major = start - center;
+            Vec3 minor = normal.cross (major);
+            addArc (writer, center, major, minor, 0.0, sweep,
+                    getArcSegments (major.length (), sweep), false, false);
+        }
+        writer.add (end);
+    }
+    return writer.count;
+}
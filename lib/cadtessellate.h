@@ -0,0 +1,111 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADTESSELLATE_H
+#define CADTESSELLATE_H
+
+#include "cadgeometry.h"
+
+#include <vector>
+
+/**
+ * @brief The curves tessellation to the chord tolerance. Converts CIRCLE,
+ * ARC, ELLIPSE, SPLINE and LWPOLYLINE with bulges to vertexes, LINE,
+ * POLYLINE3D and LWPOLYLINE without bulges are passed through. The closed
+ * LWPOLYLINE ends with its first vertex. Splines are flattened by
+ * CADNurbsEvaluator with maxSegments per knot span.
+ *
+ * The arc points are generated by the rotation recurrence, one sin/cos pair
+ * per arc. The vertexes are written as interleaved x, y, z doubles to the
+ * caller buffer, so they may be passed to Matrix::multiply as is.
+ */
+class OCAD_EXTERN CADTessellator
+{
+public:
+    /**
+     * @brief Create the tessellator
+     * @param tolerance Maximum distance between the curve and its chords, 0 -
+     * use the maximum segments count
+     * @param maxSegments Maximum segments count per full turn
+     */
+    explicit CADTessellator(double tolerance, size_t maxSegments = 4096);
+
+    /**
+     * @brief Get the segments count for the arc
+     * @param radius Arc radius
+     * @param sweep Arc sweep angle in radians
+     * @return segments count, at least 1
+     */
+    size_t getArcSegments(double radius, double sweep) const;
+
+    /**
+     * @brief Tessellate the elliptical arc center + major * cos(t) +
+     * minor * sin(t), t from start to start + sweep
+     * @param xyz Buffer for interleaved x, y, z or nullptr
+     * @param capacity Buffer capacity in vertexes
+     * @return vertexes count. Only capacity vertexes are written if the count
+     * is bigger.
+     */
+    size_t tessellateArc(const CADVector& center, const CADVector& major,
+                         const CADVector& minor, double start, double sweep,
+                         double * xyz, size_t capacity) const;
+
+    /**
+     * @brief Tessellate the geometry
+     * @param geometry Geometry to tessellate
+     * @param xyz Buffer for interleaved x, y, z or nullptr
+     * @param capacity Buffer capacity in vertexes
+     * @return vertexes count, 0 for unsupported geometries. Only capacity
+     * vertexes are written if the count is bigger, call again with the
+     * bigger buffer.
+     */
+    size_t tessellate(CADGeometry * geometry, double * xyz,
+                      size_t capacity) const;
+
+    /**
+     * @brief Tessellate the geometry to the vector
+     * @param geometry Geometry to tessellate
+     * @param vertexes Vertexes appended to
+     * @return vertexes count, 0 for unsupported geometries
+     */
+    size_t tessellate(CADGeometry * geometry,
+                      std::vector<CADVector>& vertexes) const;
+
+protected:
+    size_t tessellateBulges(CADLWPolyline * polyline, double * xyz,
+                            size_t capacity) const;
+
+protected:
+    double tolerance;
+    double minStep; // minimum angle step
+    size_t maxSegments;
+};
+
+#endif // CADTESSELLATE_H
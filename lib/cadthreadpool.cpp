@@ -0,0 +1,85 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadthreadpool.h"
+
+CADThreadPool::CADThreadPool(size_t threadCount) : stopping(false)
+{
+    if(0 == threadCount)
+        threadCount = std::thread::hardware_concurrency ();
+    if(0 == threadCount)
+        threadCount = 1;
+    for(size_t i = 0; i < threadCount; ++i)
+        threads.push_back (std::thread(&CADThreadPool::run, this));
+}
+
+CADThreadPool::~CADThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    tasksCondition.notify_all ();
+    for(std::thread &thread : threads)
+        thread.join ();
+}
+
+void CADThreadPool::addTask(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push (std::move(task));
+    }
+    tasksCondition.notify_one ();
+}
+
+size_t CADThreadPool::getThreadCount() const
+{
+    return threads.size ();
+}
+
+void CADThreadPool::run()
+{
+    while(true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksCondition.wait (lock, [this]
+                                 { return stopping || !tasks.empty (); });
+            // serve the queued tasks before stop
+            if(tasks.empty ())
+                return;
+            task = std::move(tasks.front ());
+            tasks.pop ();
+        }
+        task();
+    }
+}
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADTHREADPOOL_H
+#define CADTHREADPOOL_H
+
+#include "opencad.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The pool of worker threads serving the queued tasks. One pool can be
+ * shared by the readers of several files, so the threads count does not grow
+ * with the opened files count. Freeing the pool waits for the queued tasks.
+ */
+class OCAD_EXTERN CADThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+public:
+    /**
+     * @brief Create the pool
+     * @param threadCount Worker threads count, 0 - the hardware concurrency
+     */
+    explicit CADThreadPool(size_t threadCount = 2);
+    virtual ~CADThreadPool();
+
+    /**
+     * @brief Queue the task, it is run by one of the pool threads
+     */
+    void    addTask(Task task);
+    size_t  getThreadCount() const;
+
+protected:
+    void    run();
+
+protected:
+    std::vector<std::thread> threads;
+    std::queue<Task>         tasks;
+    std::mutex               tasksMutex;
+    std::condition_variable  tasksCondition;
+    bool                     stopping;
+};
+
+#endif // CADTHREADPOOL_H
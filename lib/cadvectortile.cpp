@@ -0,0 +1,654 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "cadvectortile.h"
+#include "cadextents.h"
+#include "cadtessellate.h"
+#include "opencad_api.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+
+using namespace std;
+
+// ----------------------------------------------------------------------------
+// Geometry flattening
+// ----------------------------------------------------------------------------
+
+typedef vector< pair<double, double> > FlatPath;
+
+/**
+ * @brief The geometry flattened to 2D points or line strings
+ */
+struct FlatGeometry
+{
+    bool                points = false; // paths are points, not line strings
+    vector<FlatPath>    paths;
+    string              text;
+};
+
+static bool isUnbounded(const CADGeometry * geometry)
+{
+    return geometry->getType () == CADGeometry::RAY ||
+           geometry->getType () == CADGeometry::XLINE;
+}
+
+/**
+ * @brief Flatten the geometry
+ * @param geometry Geometry to flatten
+ * @param tessellator Curves tessellator
+ * @param rayLength Length of rays and xlines
+ * @param flat Flattened geometry
+ */
+static void flattenGeometry(CADGeometry * geometry,
+                            const CADTessellator& tessellator,
+                            double rayLength, FlatGeometry& flat)
+{
+    switch( geometry->getType () )
+    {
+        case CADGeometry::POINT:
+        {
+            CADVector pos = static_cast<CADPoint3D *>(geometry)->getPosition ();
+            flat.points = true;
+            flat.paths.push_back (FlatPath(1, make_pair (pos.getX (),
+                                                         pos.getY ())));
+            break;
+        }
+        case CADGeometry::TEXT:
+        case CADGeometry::MTEXT:
+        case CADGeometry::ATTRIB:
+        case CADGeometry::ATTDEF:
+        {
+            CADText * text = static_cast<CADText *>(geometry);
+            CADVector pos = text->getPosition ();
+            flat.points = true;
+            flat.paths.push_back (FlatPath(1, make_pair (pos.getX (),
+                                                         pos.getY ())));
+            flat.text = text->getTextValue ().c_str (); // up to the TV zero
+            break;
+        }
+        case CADGeometry::LINE:
+        case CADGeometry::POLYLINE3D:
+        case CADGeometry::LWPOLYLINE:
+        case CADGeometry::CIRCLE:
+        case CADGeometry::ARC:
+        case CADGeometry::ELLIPSE:
+        case CADGeometry::SPLINE:
+        {
+            vector<CADVector> vertexes;
+            tessellator.tessellate (geometry, vertexes);
+            FlatPath path;
+            path.reserve (vertexes.size ());
+            for( const CADVector& vertex : vertexes )
+                path.push_back (make_pair (vertex.getX (), vertex.getY ()));
+            flat.paths.push_back (path);
+            break;
+        }
+        case CADGeometry::FACE3D:
+        {
+            CADFace3D * face = static_cast<CADFace3D *>(geometry);
+            FlatPath path;
+            for( size_t i = 0; i <= 4; ++i )
+            {
+                CADVector corner = face->getCorner (i % 4);
+                path.push_back (make_pair (corner.getX (), corner.getY ()));
+            }
+            flat.paths.push_back (path);
+            break;
+        }
+        case CADGeometry::RAY:
+        case CADGeometry::XLINE:
+        {
+            CADRay * ray = static_cast<CADRay *>(geometry);
+            CADVector pos = ray->getPosition ();
+            CADVector dir = ray->getVectVector ();
+            double length = sqrt(dir.getX () * dir.getX () +
+                                 dir.getY () * dir.getY ());
+            if( length == 0.0 )
+                break;
+            double scale = rayLength / length;
+            double start = geometry->getType () == CADGeometry::XLINE ?
+                        -scale : 0.0;
+            FlatPath path;
+            path.push_back (make_pair (pos.getX () + dir.getX () * start,
+                                       pos.getY () + dir.getY () * start));
+            path.push_back (make_pair (pos.getX () + dir.getX () * scale,
+                                       pos.getY () + dir.getY () * scale));
+            flat.paths.push_back (path);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Clipping
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Liang-Barsky segment clipping
+ * @return false if the segment is outside of the rectangle
+ */
+static bool clipSegment(double& x0, double& y0, double& x1, double& y1,
+                        double minX, double minY, double maxX, double maxY)
+{
+    double t0 = 0.0, t1 = 1.0;
+    double dx = x1 - x0, dy = y1 - y0;
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { x0 - minX, maxX - x0, y0 - minY, maxY - y0 };
+    for( int i = 0; i < 4; ++i )
+    {
+        if( p[i] == 0.0 )
+        {
+            if( q[i] < 0.0 )
+                return false;
+            continue;
+        }
+        double t = q[i] / p[i];
+        if( p[i] < 0.0 )
+            t0 = max(t0, t);
+        else
+            t1 = min(t1, t);
+        if( t0 > t1 )
+            return false;
+    }
+    double sx = x0, sy = y0;
+    x0 = sx + t0 * dx;
+    y0 = sy + t0 * dy;
+    x1 = sx + t1 * dx;
+    y1 = sy + t1 * dy;
+    return true;
+}
+
+/**
+ * @brief Clip the line string, the parts outside of the rectangle split it
+ */
+static void clipPath(const FlatPath& path, double minX, double minY,
+                     double maxX, double maxY, vector<FlatPath>& clipped)
+{
+    bool bContinue = false;
+    for( size_t i = 1; i < path.size (); ++i )
+    {
+        double x0 = path[i - 1].first, y0 = path[i - 1].second;
+        double x1 = path[i].first, y1 = path[i].second;
+        if( !clipSegment (x0, y0, x1, y1, minX, minY, maxX, maxY) )
+        {
+            bContinue = false;
+            continue;
+        }
+        bool bStartClipped = x0 != path[i - 1].first ||
+                             y0 != path[i - 1].second;
+        if( !bContinue || bStartClipped )
+        {
+            clipped.push_back (FlatPath());
+            clipped.back ().push_back (make_pair (x0, y0));
+        }
+        clipped.back ().push_back (make_pair (x1, y1));
+        bContinue = x1 == path[i].first && y1 == path[i].second;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Protocol buffers encoding
+// ----------------------------------------------------------------------------
+
+enum MVTGeometryType
+{
+    MVT_POINT = 1,
+    MVT_LINESTRING = 2
+};
+
+enum MVTCommand
+{
+    MVT_MOVETO = 1,
+    MVT_LINETO = 2
+};
+
+static void writeVarint(string& out, uint64_t value)
+{
+    while( value >= 0x80 )
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+static void writeVarintField(string& out, int field, uint64_t value)
+{
+    writeVarint (out, static_cast<uint64_t>(field) << 3); // varint wire type 0
+    writeVarint (out, value);
+}
+
+static void writeBytesField(string& out, int field, const string& value)
+{
+    writeVarint (out, (static_cast<uint64_t>(field) << 3) | 2); // length delimited
+    writeVarint (out, value.size ());
+    out += value;
+}
+
+static void writePackedField(string& out, int field,
+                             const vector<uint32_t>& values)
+{
+    string packed;
+    for( uint32_t value : values )
+        writeVarint (packed, value);
+    writeBytesField (out, field, packed);
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^
+            static_cast<uint32_t>(value >> 31);
+}
+
+static uint32_t command(int id, size_t count)
+{
+    return static_cast<uint32_t>((id & 0x7) | (count << 3));
+}
+
+/**
+ * @brief The tile layer being encoded
+ */
+struct MVTLayer
+{
+    string                  features;
+    vector<string>          values;
+    map<string, uint32_t>   valueIndexes;
+
+    uint32_t getValueIndex(const string& value)
+    {
+        auto it = valueIndexes.find (value);
+        if( it != valueIndexes.end () )
+            return it->second;
+        uint32_t index = static_cast<uint32_t>(values.size ());
+        valueIndexes[value] = index;
+        values.push_back (value);
+        return index;
+    }
+};
+
+static const char * getGeometryTypeName(CADGeometry::GeometryType type)
+{
+    switch( type )
+    {
+        case CADGeometry::POINT: return "POINT";
+        case CADGeometry::CIRCLE: return "CIRCLE";
+        case CADGeometry::LWPOLYLINE: return "LWPOLYLINE";
+        case CADGeometry::ELLIPSE: return "ELLIPSE";
+        case CADGeometry::LINE: return "LINE";
+        case CADGeometry::POLYLINE3D: return "POLYLINE3D";
+        case CADGeometry::TEXT: return "TEXT";
+        case CADGeometry::ARC: return "ARC";
+        case CADGeometry::SPLINE: return "SPLINE";
+        case CADGeometry::RAY: return "RAY";
+        case CADGeometry::MTEXT: return "MTEXT";
+        case CADGeometry::XLINE: return "XLINE";
+        case CADGeometry::FACE3D: return "FACE3D";
+        case CADGeometry::ATTRIB: return "ATTRIB";
+        case CADGeometry::ATTDEF: return "ATTDEF";
+        default: return "UNDEFINED";
+    }
+}
+
+// ----------------------------------------------------------------------------
+// CADVectorTileGenerator
+// ----------------------------------------------------------------------------
+
+CADVectorTileGenerator::CADVectorTileGenerator(CADFile * const file,
+                                               unsigned int extent,
+                                               unsigned int buffer) :
+    pCADFile(file), tileExtent(extent), tileBuffer(buffer), boundsSet(false),
+    originX(0.0), originY(0.0), areaSize(0.0), pPyramid(nullptr), gridSize(0)
+{
+    gridBounds = Bounds{ 0.0, 0.0, 0.0, 0.0 };
+}
+
+int CADVectorTileGenerator::buildIndex()
+{
+    const double dfInfinity = numeric_limits<double>::infinity ();
+    geometries.clear ();
+    gridCells.clear ();
+    largeGeometries.clear ();
+    gridBounds = Bounds{ dfInfinity, dfInfinity, -dfInfinity, -dfInfinity };
+
+    for( size_t i = 0; i < pCADFile->getLayersCount (); ++i )
+    {
+        CADLayer &layer = pCADFile->getLayer (i);
+        for( size_t j = 0; j < layer.getGeometryCount (); ++j )
+        {
+            unique_ptr<CADGeometry> geometry(layer.getGeometry (j,
+                                            CADFile::PROJECTION_COORDINATES));
+            if( nullptr == geometry )
+                continue;
+
+            IndexedGeometry indexed = { i, j, { dfInfinity, dfInfinity,
+                                                -dfInfinity, -dfInfinity },
+                                        geometry->getType () };
+            if( isUnbounded (geometry.get ()) )
+            {
+                indexed.bounds = Bounds{ -dfInfinity, -dfInfinity,
+                                         dfInfinity, dfInfinity };
+                largeGeometries.push_back (geometries.size ());
+                geometries.push_back (indexed);
+                continue;
+            }
+
+            CADExtents extents;
+            extents.addGeometry (geometry.get ());
+            if( extents.isEmpty () )
+                continue; // nothing to draw
+            indexed.bounds = Bounds{ extents.getMin ().getX (),
+                                     extents.getMin ().getY (),
+                                     extents.getMax ().getX (),
+                                     extents.getMax ().getY () };
+
+            gridBounds.minX = min(gridBounds.minX, indexed.bounds.minX);
+            gridBounds.minY = min(gridBounds.minY, indexed.bounds.minY);
+            gridBounds.maxX = max(gridBounds.maxX, indexed.bounds.maxX);
+            gridBounds.maxY = max(gridBounds.maxY, indexed.bounds.maxY);
+            geometries.push_back (indexed);
+        }
+    }
+
+    if( gridBounds.minX > gridBounds.maxX )
+        gridBounds = Bounds{ 0.0, 0.0, 0.0, 0.0 };
+
+    if( !boundsSet )
+    {
+        double size = max(gridBounds.maxX - gridBounds.minX,
+                          gridBounds.maxY - gridBounds.minY);
+        originX = gridBounds.minX;
+        originY = gridBounds.minY;
+        areaSize = size > 0.0 ? size : 1.0;
+    }
+
+    // about 8 geometries per cell, no more than 1024x1024 cells
+    gridSize = 1;
+    while( gridSize < 1024 && gridSize * gridSize * 8 < geometries.size () )
+        gridSize *= 2;
+    gridCells.assign (gridSize * gridSize, vector<size_t>());
+
+    for( size_t i = 0; i < geometries.size (); ++i )
+    {
+        if( isinf(geometries[i].bounds.maxX) )
+            continue; // already in large geometries
+
+        size_t minCol, minRow, maxCol, maxRow;
+        getCells (geometries[i].bounds, minCol, minRow, maxCol, maxRow);
+        if( (maxCol - minCol + 1) * (maxRow - minRow + 1) > 64 )
+        {
+            largeGeometries.push_back (i);
+            continue;
+        }
+        for( size_t row = minRow; row <= maxRow; ++row )
+            for( size_t col = minCol; col <= maxCol; ++col )
+                gridCells[row * gridSize + col].push_back (i);
+    }
+
+    return CADErrorCodes::SUCCESS;
+}
+
+void CADVectorTileGenerator::setBounds(double minX, double minY, double size)
+{
+    originX = minX;
+    originY = minY;
+    areaSize = size;
+    boundsSet = true;
+}
+
+void CADVectorTileGenerator::setPyramid(const CADGeometryPyramid *pyramid)
+{
+    pPyramid = pyramid;
+}
+
+void CADVectorTileGenerator::getCells(const Bounds &bounds, size_t &minCol,
+                                      size_t &minRow, size_t &maxCol,
+                                      size_t &maxRow) const
+{
+    double cellWidth = (gridBounds.maxX - gridBounds.minX) / gridSize;
+    double cellHeight = (gridBounds.maxY - gridBounds.minY) / gridSize;
+    auto toCell = [this](double value, double origin, double cell) -> size_t
+    {
+        if( cell <= 0.0 )
+            return 0;
+        double index = floor((value - origin) / cell);
+        if( index < 0.0 )
+            return 0;
+        return min(static_cast<size_t>(index), gridSize - 1);
+    };
+    minCol = toCell (bounds.minX, gridBounds.minX, cellWidth);
+    maxCol = toCell (bounds.maxX, gridBounds.minX, cellWidth);
+    minRow = toCell (bounds.minY, gridBounds.minY, cellHeight);
+    maxRow = toCell (bounds.maxY, gridBounds.minY, cellHeight);
+}
+
+int CADVectorTileGenerator::getTile(int z, int x, int y, string &data,
+                                    CADFileCursor *cursor) const
+{
+    data.clear ();
+    if( z < 0 || z > 30 || x < 0 || y < 0 || x >= (1 << z) ||
+        y >= (1 << z) || areaSize <= 0.0 || gridSize == 0 )
+        return CADErrorCodes::INVALID_TILE;
+
+    const double tileSize = areaSize / (1 << z);
+    const double tileMinX = originX + x * tileSize;
+    const double tileMaxY = originY + areaSize - y * tileSize;
+    const double scale = tileExtent / tileSize;
+    const double buffer = tileBuffer / scale;
+    const Bounds query = { tileMinX - buffer, tileMaxY - tileSize - buffer,
+                           tileMinX + tileSize + buffer, tileMaxY + buffer };
+
+    // candidates from the grid cells and the large geometries list
+    vector<size_t> candidates(largeGeometries);
+    if( query.maxX >= gridBounds.minX && query.minX <= gridBounds.maxX &&
+        query.maxY >= gridBounds.minY && query.minY <= gridBounds.maxY )
+    {
+        size_t minCol, minRow, maxCol, maxRow;
+        getCells (query, minCol, minRow, maxCol, maxRow);
+        for( size_t row = minRow; row <= maxRow; ++row )
+            for( size_t col = minCol; col <= maxCol; ++col )
+            {
+                const vector<size_t>& cell = gridCells[row * gridSize + col];
+                candidates.insert (candidates.end (), cell.begin (), cell.end ());
+            }
+    }
+    sort(candidates.begin (), candidates.end ());
+    candidates.erase (unique(candidates.begin (), candidates.end ()),
+                      candidates.end ());
+
+    // half pixel chord tolerance, rays long enough to cross the tile
+    const double tolerance = 0.5 / scale;
+    const CADTessellator tessellator(tolerance);
+    const double clipMin = -static_cast<double>(tileBuffer);
+    const double clipMax = static_cast<double>(tileExtent + tileBuffer);
+
+    map<size_t, MVTLayer> layers;
+    for( size_t candidate : candidates )
+    {
+        const IndexedGeometry& indexed = geometries[candidate];
+        if( indexed.bounds.maxX < query.minX || indexed.bounds.minX > query.maxX ||
+            indexed.bounds.maxY < query.minY || indexed.bounds.minY > query.maxY )
+            continue;
+
+        FlatGeometry flat;
+        const vector<CADVector> * levelVertexes = nullptr != pPyramid ?
+                    pPyramid->getVertexes (indexed.layerIndex, indexed.index,
+                                           tolerance) : nullptr;
+        if( nullptr != levelVertexes )
+        {
+            // the line simplified for this zoom, no need to decode it
+            FlatPath path;
+            path.reserve (levelVertexes->size ());
+            for( const CADVector& vertex : *levelVertexes )
+                path.push_back (make_pair (vertex.getX (), vertex.getY ()));
+            flat.paths.push_back (path);
+        }
+        else
+        {
+            const int projection = CADFile::PROJECTION_TEXT;
+            unique_ptr<CADGeometry> geometry(nullptr != cursor ?
+                cursor->getGeometry (indexed.layerIndex, indexed.index,
+                                     projection) :
+                pCADFile->getLayer (indexed.layerIndex).getGeometry (
+                                     indexed.index, projection));
+            if( nullptr == geometry )
+                continue;
+
+            double rayLength = 0.0;
+            if( isUnbounded (geometry.get ()) )
+            {
+                CADVector pos = static_cast<CADRay *>(
+                            geometry.get ())->getPosition ();
+                double dx = pos.getX () - (tileMinX + tileSize / 2);
+                double dy = pos.getY () - (tileMaxY - tileSize / 2);
+                rayLength = sqrt(dx * dx + dy * dy) + 2 * tileSize;
+            }
+            flattenGeometry (geometry.get (), tessellator, rayLength, flat);
+        }
+
+        // to the tile grid, y down
+        for( FlatPath& path : flat.paths )
+            for( pair<double, double>& point : path )
+            {
+                point.first = (point.first - tileMinX) * scale;
+                point.second = (tileMaxY - point.second) * scale;
+            }
+
+        vector<uint32_t> commands;
+        int32_t cursorX = 0, cursorY = 0;
+        if( flat.points )
+        {
+            vector< pair<int32_t, int32_t> > points;
+            for( const FlatPath& path : flat.paths )
+            {
+                const pair<double, double>& point = path[0];
+                if( point.first < clipMin || point.first > clipMax ||
+                    point.second < clipMin || point.second > clipMax )
+                    continue;
+                points.push_back (make_pair (
+                                static_cast<int32_t>(lround(point.first)),
+                                static_cast<int32_t>(lround(point.second))));
+            }
+            if( points.empty () )
+                continue;
+            commands.push_back (command (MVT_MOVETO, points.size ()));
+            for( const pair<int32_t, int32_t>& point : points )
+            {
+                commands.push_back (zigzag (point.first - cursorX));
+                commands.push_back (zigzag (point.second - cursorY));
+                cursorX = point.first;
+                cursorY = point.second;
+            }
+        }
+        else
+        {
+            vector<FlatPath> clipped;
+            for( const FlatPath& path : flat.paths )
+                clipPath (path, clipMin, clipMin, clipMax, clipMax, clipped);
+
+            for( const FlatPath& path : clipped )
+            {
+                // quantised vertexes, the repeated ones are dropped
+                vector< pair<int32_t, int32_t> > vertexes;
+                for( const pair<double, double>& point : path )
+                {
+                    pair<int32_t, int32_t> vertex(
+                                static_cast<int32_t>(lround(point.first)),
+                                static_cast<int32_t>(lround(point.second)));
+                    if( vertexes.empty () || vertexes.back () != vertex )
+                        vertexes.push_back (vertex);
+                }
+                if( vertexes.size () < 2 )
+                    continue;
+
+                for( size_t i = 0; i < vertexes.size (); ++i )
+                {
+                    if( i == 0 )
+                        commands.push_back (command (MVT_MOVETO, 1));
+                    else if( i == 1 )
+                        commands.push_back (command (MVT_LINETO,
+                                                     vertexes.size () - 1));
+                    commands.push_back (zigzag (vertexes[i].first - cursorX));
+                    commands.push_back (zigzag (vertexes[i].second - cursorY));
+                    cursorX = vertexes[i].first;
+                    cursorY = vertexes[i].second;
+                }
+            }
+            if( commands.empty () )
+                continue;
+        }
+
+        MVTLayer& layer = layers[indexed.layerIndex];
+        vector<uint32_t> tags;
+        tags.push_back (0); // "type"
+        tags.push_back (layer.getValueIndex (getGeometryTypeName (
+                                                 indexed.type)));
+        if( !flat.text.empty () )
+        {
+            tags.push_back (1); // "text"
+            tags.push_back (layer.getValueIndex (flat.text));
+        }
+
+        string feature;
+        writeVarintField (feature, 1, indexed.index + 1);
+        writePackedField (feature, 2, tags);
+        writeVarintField (feature, 3, flat.points ? MVT_POINT : MVT_LINESTRING);
+        writePackedField (feature, 4, commands);
+        writeBytesField (layer.features, 2, feature);
+    }
+
+    for( const pair<const size_t, MVTLayer>& entry : layers )
+    {
+        const MVTLayer& layer = entry.second;
+        string encoded;
+        writeVarintField (encoded, 15, 2); // version
+        writeBytesField (encoded, 1,
+                         pCADFile->getLayer (entry.first).getName ().c_str ());
+        encoded += layer.features;
+        writeBytesField (encoded, 3, "type");
+        writeBytesField (encoded, 3, "text");
+        for( const string& value : layer.values )
+        {
+            string encodedValue;
+            writeBytesField (encodedValue, 1, value); // string_value
+            writeBytesField (encoded, 4, encodedValue);
+        }
+        writeVarintField (encoded, 5, tileExtent);
+        writeBytesField (data, 3, encoded);
+    }
+
+    return CADErrorCodes::SUCCESS;
+}
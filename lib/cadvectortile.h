@@ -0,0 +1,132 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#ifndef CADVECTORTILE_H
+#define CADVECTORTILE_H
+
+#include "cadfile.h"
+#include "cadsimplify.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief The Mapbox Vector Tile generator. Each CAD layer becomes a tile
+ * layer, each geometry becomes a feature with the "type" property and the
+ * "text" property for texts. The curves are flattened to the tile pixel
+ * tolerance, clipped to the tile with the buffer and quantised to the tile
+ * grid.
+ *
+ * The tile pyramid covers the square area in drawing coordinates, the 0/0/0
+ * tile is the whole area, y tile numbers grow down. The geometries bounds are
+ * indexed once by buildIndex(), a tile decodes only the geometries which
+ * bounds intersect it. With the geometry pyramid set, the long lines are
+ * taken from the pyramid level of the tile zoom without decoding them.
+ */
+class OCAD_EXTERN CADVectorTileGenerator
+{
+public:
+    /**
+     * @brief Create the tile generator
+     * @param file Parsed CAD file
+     * @param extent Tile grid size
+     * @param buffer Tile buffer in grid units
+     */
+    CADVectorTileGenerator(CADFile * const file, unsigned int extent = 4096,
+                           unsigned int buffer = 64);
+
+    /**
+     * @brief Read all layers geometries and index their bounds. Sets the
+     * pyramid area to the geometries extent if it was not set before.
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int buildIndex();
+    /**
+     * @brief Set the area covered by the 0/0/0 tile
+     * @param minX Left of the area
+     * @param minY Bottom of the area
+     * @param size Width and height of the area
+     */
+    void setBounds(double minX, double minY, double size);
+    /**
+     * @brief Set the simplified lines source. A tile takes the line from the
+     * coarsest level within half of its pixel, the lines without such level
+     * are decoded and flattened as usual.
+     * @param pyramid Built pyramid of the same file, must outlive the
+     * generator, nullptr - do not use the pyramid
+     */
+    void setPyramid(const CADGeometryPyramid * pyramid);
+    /**
+     * @brief Generate the tile
+     * @param z Zoom level
+     * @param x Tile column, from the left
+     * @param y Tile row, from the top
+     * @param data Encoded tile
+     * @param cursor Cursor to read geometries with, nullptr - read with the
+     * file itself. Tiles may be generated concurrently with own cursors.
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int getTile(int z, int x, int y, std::string& data,
+                CADFileCursor* cursor = nullptr) const;
+
+protected:
+    struct Bounds
+    {
+        double minX, minY, maxX, maxY;
+    };
+
+    struct IndexedGeometry
+    {
+        size_t layerIndex;
+        size_t index;
+        Bounds bounds;
+        CADGeometry::GeometryType type;
+    };
+
+    void getCells(const Bounds& bounds, size_t& minCol, size_t& minRow,
+                  size_t& maxCol, size_t& maxRow) const;
+
+protected:
+    CADFile * const                 pCADFile;
+    unsigned int                    tileExtent;
+    unsigned int                    tileBuffer;
+    bool                            boundsSet;
+    double                          originX, originY, areaSize;
+    const CADGeometryPyramid *      pPyramid;
+
+    std::vector<IndexedGeometry>    geometries;
+    size_t                          gridSize;   // cells per side
+    Bounds                          gridBounds;
+    std::vector< std::vector<size_t> > gridCells; // geometries per cell
+    std::vector<size_t>             largeGeometries; // rays, xlines and
+                                                     // geometries over many cells
+};
+
+#endif // CADVECTORTILE_H
@@ -32,6 +32,7 @@
 
 #include "io.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cstring>
 
@@ -723,6 +724,12 @@ CADHandle ReadHANDLE8BLENGTH ( const char * pabyInput,
     return result;
 }
 
+void skipHANDLE8BLENGTH(const char * pabyInput, size_t& nBitOffsetFromStart)
+{
+    unsigned char counter = ReadCHAR ( pabyInput, nBitOffsetFromStart );
+    nBitOffsetFromStart += counter * 8;
+}
+
 int ReadBITLONG( const char * pabyInput, size_t& nBitOffsetFromStart )
 {
     unsigned char   BITCODE = Read2B ( pabyInput, nBitOffsetFromStart );
@@ -806,6 +813,96 @@ void skipTV(const char *pabyInput, size_t &nBitOffsetFromStart)
     nBitOffsetFromStart += size_t(stringLength * 8);
 }
 
+std::string ReadTU ( const char * pabyInput, size_t& nBitOffsetFromStart )
+{
+    short stringLength = ReadBITSHORT ( pabyInput, nBitOffsetFromStart );
+
+    std::string result;
+    result.reserve ( static_cast<size_t>( std::max ( stringLength, short(0) ) ) );
+    for ( short i = 0; i < stringLength; ++i )
+    {
+        unsigned int code = static_cast<unsigned short>(
+                    ReadRAWSHORT ( pabyInput, nBitOffsetFromStart ) );
+        if ( code >= 0xD800 && code < 0xDC00 && i + 1 < stringLength )
+        {
+            size_t nNextOffset = nBitOffsetFromStart;
+            unsigned int low = static_cast<unsigned short>(
+                        ReadRAWSHORT ( pabyInput, nNextOffset ) );
+            if ( low >= 0xDC00 && low < 0xE000 )
+            {
+                code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                nBitOffsetFromStart = nNextOffset;
+                ++i;
+            }
+        }
+
+        if ( code == 0 )
+            continue;
+        if ( code < 0x80 )
+        {
+            result += static_cast<char>( code );
+        }
+        else if ( code < 0x800 )
+        {
+            result += static_cast<char>( 0xC0 | ( code >> 6 ) );
+            result += static_cast<char>( 0x80 | ( code & 0x3F ) );
+        }
+        else if ( code < 0x10000 )
+        {
+            result += static_cast<char>( 0xE0 | ( code >> 12 ) );
+            result += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+            result += static_cast<char>( 0x80 | ( code & 0x3F ) );
+        }
+        else
+        {
+            result += static_cast<char>( 0xF0 | ( code >> 18 ) );
+            result += static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+            result += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+            result += static_cast<char>( 0x80 | ( code & 0x3F ) );
+        }
+    }
+
+    return result;
+}
+
+void skipTU(const char *pabyInput, size_t &nBitOffsetFromStart)
+{
+    short stringLength = ReadBITSHORT ( pabyInput, nBitOffsetFromStart );
+    nBitOffsetFromStart += size_t(stringLength * 16);
+}
+
+// String stream of the data decoded by the current thread, nullptr for the
+// inline TV strings
+static thread_local DWGStringStream * stringStream = nullptr;
+
+DWGStringStreamScope::DWGStringStreamScope(DWGStringStream * stream) :
+    previous(stringStream)
+{
+    stringStream = stream;
+}
+
+DWGStringStreamScope::~DWGStringStreamScope()
+{
+    stringStream = previous;
+}
+
+std::string ReadText(const char *pabyInput, size_t &nBitOffsetFromStart)
+{
+    if( nullptr == stringStream )
+        return ReadTV ( pabyInput, nBitOffsetFromStart );
+    if( nullptr == stringStream->pabyInput )
+        return std::string();
+    return ReadTU ( stringStream->pabyInput, stringStream->nBitOffset );
+}
+
+void skipText(const char *pabyInput, size_t &nBitOffsetFromStart)
+{
+    if( nullptr == stringStream )
+        skipTV ( pabyInput, nBitOffsetFromStart );
+    else if( nullptr != stringStream->pabyInput )
+        skipTU ( stringStream->pabyInput, stringStream->nBitOffset );
+}
+
 void skipBITLONG(const char *pabyInput, size_t &nBitOffsetFromStart)
 {
     unsigned char   BITCODE = Read2B ( pabyInput, nBitOffsetFromStart );
@@ -849,6 +946,11 @@ void skipBIT(const char */*pabyInput*/, size_t &nBitOffsetFromStart)
     ++nBitOffsetFromStart;
 }
 
+void skipRAWDOUBLE(const char */*pabyInput*/, size_t &nBitOffsetFromStart)
+{
+    nBitOffsetFromStart += 64;
+}
+
 CADVector ReadVector(const char *pabyInput, size_t &nBitOffsetFromStart)
 {
     double x, y, z;
@@ -867,3 +969,663 @@ CADVector ReadRAWVector(const char *pabyInput, size_t &nBitOffsetFromStart)
 
     return CADVector(x, y);
 }
+
+// ----------------------------------------------------------------------------
+// R2004 pages
+// ----------------------------------------------------------------------------
+
+void DecryptR2004Header(char * pabyData, size_t nSize)
+{
+    unsigned int nRandSeed = 1;
+    for( size_t i = 0; i < nSize; ++i )
+    {
+        nRandSeed = nRandSeed * 0x343FD + 0x269EC3;
+        pabyData[i] ^= static_cast<char>( nRandSeed >> 16 );
+    }
+}
+
+/**
+ * @brief The LZ77 stream cursor. Each opcode checks its bounds once, so the
+ * literal and match copies run without per byte checks.
+ */
+struct DWGLZ77Stream
+{
+    const unsigned char * src;
+    const unsigned char * srcEnd;
+    bool                  corrupted;
+
+    unsigned char readByte()
+    {
+        if( src >= srcEnd )
+        {
+            corrupted = true;
+            return 0x11; // terminates the decompression
+        }
+        return *src++;
+    }
+
+    /**
+     * @brief Read literals count, if the byte is an opcode it is returned in
+     * opcode and the count is 0
+     */
+    size_t readLiteralLength(unsigned char& opcode)
+    {
+        unsigned char byte = readByte ();
+        opcode = 0;
+        if( byte >= 0x01 && byte <= 0x0F )
+            return byte + 3;
+        if( byte == 0 )
+        {
+            size_t total = 0x0F;
+            while( ( byte = readByte () ) == 0 && !corrupted )
+                total += 0xFF;
+            return total + byte + 3;
+        }
+        opcode = byte;
+        return 0;
+    }
+
+    size_t readLongCompressionOffset()
+    {
+        size_t total = 0;
+        unsigned char byte = readByte ();
+        if( byte == 0 )
+        {
+            total = 0xFF;
+            while( ( byte = readByte () ) == 0 && !corrupted )
+                total += 0xFF;
+        }
+        return total + byte;
+    }
+
+    size_t readTwoByteOffset(size_t& nLiteralCount)
+    {
+        unsigned char first = readByte ();
+        unsigned char second = readByte ();
+        nLiteralCount = first & 0x03;
+        return ( first >> 2 ) | ( static_cast<size_t>(second) << 6 );
+    }
+};
+
+/**
+ * @brief Copy the match, the source is before the destination by nDistance
+ * bytes. The far matches are copied by 8 bytes, the near ones overlap the
+ * destination and are copied by bytes.
+ */
+static inline void copyMatch(char * pabyDst, size_t nDistance, size_t nSize,
+                             const char * pabyDstEnd)
+{
+    const char * pabySrc = pabyDst - nDistance;
+    if( nDistance >= 8 &&
+        static_cast<size_t>(pabyDstEnd - pabyDst) >= nSize + 8 )
+    {
+        // may write up to 7 bytes after the match, they are overwritten later
+        const char * pabyEnd = pabyDst + nSize;
+        do
+        {
+            memcpy (pabyDst, pabySrc, 8);
+            pabyDst += 8;
+            pabySrc += 8;
+        } while( pabyDst < pabyEnd );
+        return;
+    }
+    for( size_t i = 0; i < nSize; ++i )
+        pabyDst[i] = pabySrc[i];
+}
+
+bool DecompressR2004(const char * pabySrc, size_t nSrcSize, char * pabyDst,
+                     size_t nDstSize, size_t& nDecompressedSize)
+{
+    DWGLZ77Stream stream;
+    stream.src = reinterpret_cast<const unsigned char *>(pabySrc);
+    stream.srcEnd = stream.src + nSrcSize;
+    stream.corrupted = false;
+
+    char * pabyOut = pabyDst;
+    const char * pabyDstEnd = pabyDst + nDstSize;
+    nDecompressedSize = 0;
+
+    unsigned char opcode1 = 0;
+    size_t nLiteralCount = stream.readLiteralLength (opcode1);
+    while( true )
+    {
+        if( nLiteralCount > 0 )
+        {
+            if( static_cast<size_t>(stream.srcEnd - stream.src) < nLiteralCount ||
+                static_cast<size_t>(pabyDstEnd - pabyOut) < nLiteralCount )
+                return false;
+            memcpy (pabyOut, stream.src, nLiteralCount);
+            pabyOut += nLiteralCount;
+            stream.src += nLiteralCount;
+        }
+
+        if( opcode1 == 0 )
+            opcode1 = stream.readByte ();
+        if( stream.corrupted )
+            return false;
+
+        size_t nCompressedBytes;
+        size_t nCompressedOffset;
+        if( opcode1 >= 0x40 )
+        {
+            nCompressedBytes = ( ( opcode1 & 0xF0 ) >> 4 ) - 1;
+            unsigned char opcode2 = stream.readByte ();
+            nCompressedOffset = ( static_cast<size_t>(opcode2) << 2 ) |
+                                ( ( opcode1 & 0x0C ) >> 2 );
+            nLiteralCount = opcode1 & 0x03;
+        }
+        else if( opcode1 >= 0x21 )
+        {
+            nCompressedBytes = opcode1 - 0x1E;
+            nCompressedOffset = stream.readTwoByteOffset (nLiteralCount);
+        }
+        else if( opcode1 == 0x20 )
+        {
+            nCompressedBytes = stream.readLongCompressionOffset () + 0x21;
+            nCompressedOffset = stream.readTwoByteOffset (nLiteralCount);
+        }
+        else if( opcode1 >= 0x12 )
+        {
+            nCompressedBytes = ( opcode1 & 0x0F ) + 2;
+            nCompressedOffset = stream.readTwoByteOffset (nLiteralCount) + 0x3FFF;
+        }
+        else if( opcode1 == 0x10 )
+        {
+            nCompressedBytes = stream.readLongCompressionOffset () + 9;
+            nCompressedOffset = stream.readTwoByteOffset (nLiteralCount) + 0x3FFF;
+        }
+        else if( opcode1 == 0x11 )
+        {
+            break;
+        }
+        else
+        {
+            return false;
+        }
+
+        opcode1 = 0;
+        if( nLiteralCount == 0 )
+            nLiteralCount = stream.readLiteralLength (opcode1);
+        if( stream.corrupted )
+            return false;
+
+        size_t nDistance = nCompressedOffset + 1;
+        if( static_cast<size_t>(pabyOut - pabyDst) < nDistance ||
+            static_cast<size_t>(pabyDstEnd - pabyOut) < nCompressedBytes )
+            return false;
+        copyMatch (pabyOut, nDistance, nCompressedBytes, pabyDstEnd);
+        pabyOut += nCompressedBytes;
+    }
+
+    nDecompressedSize = static_cast<size_t>(pabyOut - pabyDst);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// R2007 pages
+// ----------------------------------------------------------------------------
+
+static const size_t DWG2007CodeWordSize = 255;
+
+/**
+ * @brief GF(2^8) of the R2007 Reed-Solomon code, the field polynomial is
+ * x^8 + x^4 + x^3 + x^2 + 1
+ */
+struct DWGGaloisField
+{
+    unsigned char exp[512];
+    unsigned char log[256];
+
+    DWGGaloisField()
+    {
+        unsigned int x = 1;
+        for( int i = 0; i < 255; ++i )
+        {
+            exp[i] = static_cast<unsigned char>(x);
+            log[x] = static_cast<unsigned char>(i);
+            x <<= 1;
+            if( x & 0x100 )
+                x ^= 0x11D;
+        }
+        for( int i = 255; i < 512; ++i )
+            exp[i] = exp[i - 255];
+        log[0] = 0;
+    }
+
+    unsigned char mul(unsigned char a, unsigned char b) const
+    {
+        if( a == 0 || b == 0 )
+            return 0;
+        return exp[log[a] + log[b]];
+    }
+
+    unsigned char div(unsigned char a, unsigned char b) const
+    {
+        if( a == 0 )
+            return 0;
+        return exp[log[a] + 255 - log[b]];
+    }
+};
+
+static const DWGGaloisField& getGaloisField()
+{
+    static const DWGGaloisField field;
+    return field;
+}
+
+/**
+ * @brief Compute the syndromes S(j) = c(a^j) of the code word
+ * @return true if all syndromes are zero
+ */
+static bool computeSyndromes(const DWGGaloisField& gf,
+                             const unsigned char * pabyBlock, size_t nParity,
+                             unsigned char * pabySyndromes)
+{
+    bool bValid = true;
+    for( size_t j = 0; j < nParity; ++j )
+    {
+        unsigned char s = 0;
+        for( size_t i = 0; i < DWG2007CodeWordSize; ++i )
+            s = static_cast<unsigned char>(( s == 0 ? 0 :
+                                             gf.exp[gf.log[s] + j] ) ^
+                                           pabyBlock[i]);
+        pabySyndromes[j] = s;
+        bValid = bValid && s == 0;
+    }
+    return bValid;
+}
+
+bool CorrectReedSolomonR2007(char * pabyBlock, size_t nDataSize)
+{
+    const DWGGaloisField& gf = getGaloisField ();
+    unsigned char * pabyCodeWord = reinterpret_cast<unsigned char *>(pabyBlock);
+    const size_t nParity = DWG2007CodeWordSize - nDataSize;
+    const size_t nMaxParity = 16;
+    if( nParity == 0 || nParity > nMaxParity )
+        return false;
+
+    unsigned char abySyndromes[nMaxParity];
+    if( computeSyndromes (gf, pabyCodeWord, nParity, abySyndromes) )
+        return true;
+
+    // Berlekamp-Massey: error locator polynomial, the lowest degree first
+    unsigned char abyLocator[nMaxParity + 1] = { 1 };
+    unsigned char abyPrevious[nMaxParity + 1] = { 1 };
+    size_t nErrors = 0;
+    size_t nShift = 1;
+    unsigned char nPrevDiscrepancy = 1;
+    for( size_t n = 0; n < nParity; ++n )
+    {
+        unsigned char nDiscrepancy = abySyndromes[n];
+        for( size_t i = 1; i <= nErrors; ++i )
+            nDiscrepancy ^= gf.mul (abyLocator[i], abySyndromes[n - i]);
+        if( nDiscrepancy == 0 )
+        {
+            ++nShift;
+            continue;
+        }
+
+        unsigned char abyLocatorCopy[nMaxParity + 1];
+        memcpy (abyLocatorCopy, abyLocator, sizeof (abyLocator));
+        unsigned char nFactor = gf.div (nDiscrepancy, nPrevDiscrepancy);
+        for( size_t i = 0; i + nShift <= nParity; ++i )
+            abyLocator[i + nShift] ^= gf.mul (nFactor, abyPrevious[i]);
+        if( 2 * nErrors <= n )
+        {
+            nErrors = n + 1 - nErrors;
+            memcpy (abyPrevious, abyLocatorCopy, sizeof (abyPrevious));
+            nPrevDiscrepancy = nDiscrepancy;
+            nShift = 1;
+        }
+        else
+        {
+            ++nShift;
+        }
+    }
+    if( 2 * nErrors > nParity )
+        return false;
+
+    // error evaluator polynomial: syndromes * locator mod x^nParity
+    unsigned char abyEvaluator[nMaxParity] = { 0 };
+    for( size_t k = 0; k < nParity; ++k )
+        for( size_t i = 0; i <= k && i <= nErrors; ++i )
+            abyEvaluator[k] ^= gf.mul (abyLocator[i], abySyndromes[k - i]);
+
+    // Chien search for the locator roots, the byte i is the coefficient of
+    // x^(254 - i). Forney gives the error value at the root.
+    size_t nFound = 0;
+    for( size_t i = 0; i < DWG2007CodeWordSize; ++i )
+    {
+        const size_t nDegree = DWG2007CodeWordSize - 1 - i;
+        const size_t nInverse = ( 255 - nDegree ) % 255;
+        unsigned char nLocator = 0;
+        unsigned char nDerivative = 0;
+        for( size_t k = 0; k <= nErrors; ++k )
+        {
+            unsigned char nTerm = gf.mul (abyLocator[k],
+                                          gf.exp[( nInverse * k ) % 255]);
+            nLocator ^= nTerm;
+            if( k % 2 == 1 )
+                nDerivative ^= gf.mul (abyLocator[k],
+                                       gf.exp[( nInverse * ( k - 1 ) ) % 255]);
+        }
+        if( nLocator != 0 )
+            continue;
+        if( nDerivative == 0 )
+            return false;
+
+        unsigned char nEvaluator = 0;
+        for( size_t k = 0; k < nParity; ++k )
+            nEvaluator ^= gf.mul (abyEvaluator[k],
+                                  gf.exp[( nInverse * k ) % 255]);
+        pabyCodeWord[i] ^= gf.mul (gf.exp[nDegree],
+                                   gf.div (nEvaluator, nDerivative));
+        ++nFound;
+    }
+    if( nFound != nErrors )
+        return false;
+
+    return computeSyndromes (gf, pabyCodeWord, nParity, abySyndromes);
+}
+
+size_t DeinterleaveR2007(const char * pabySrc, size_t nBlockCount,
+                         size_t nDataSize, char * pabyDst)
+{
+    size_t nUncorrected = 0;
+    // the byte j of the block i is at j * nBlockCount + i. The source is
+    // read by 8 bytes which belong to 8 neighbour blocks.
+    char abyBlocks[8][DWG2007CodeWordSize];
+    for( size_t i = 0; i < nBlockCount; i += 8 )
+    {
+        const size_t nGroup = min (nBlockCount - i, size_t(8));
+        const char * pabyColumn = pabySrc + i;
+        if( nGroup == 8 )
+        {
+            for( size_t j = 0; j < DWG2007CodeWordSize;
+                 ++j, pabyColumn += nBlockCount )
+            {
+                char abyBytes[8];
+                memcpy (abyBytes, pabyColumn, 8);
+                for( size_t k = 0; k < 8; ++k )
+                    abyBlocks[k][j] = abyBytes[k];
+            }
+        }
+        else
+        {
+            for( size_t j = 0; j < DWG2007CodeWordSize;
+                 ++j, pabyColumn += nBlockCount )
+                for( size_t k = 0; k < nGroup; ++k )
+                    abyBlocks[k][j] = pabyColumn[k];
+        }
+
+        // the block which can not be corrected is kept as read
+        for( size_t k = 0; k < nGroup; ++k )
+        {
+            char abyCorrected[DWG2007CodeWordSize];
+            memcpy (abyCorrected, abyBlocks[k], DWG2007CodeWordSize);
+            if( CorrectReedSolomonR2007 (abyCorrected, nDataSize) )
+                memcpy (abyBlocks[k], abyCorrected, nDataSize);
+            else
+                ++nUncorrected;
+            memcpy (pabyDst + ( i + k ) * nDataSize, abyBlocks[k], nDataSize);
+        }
+    }
+    return nUncorrected;
+}
+
+static size_t readLiteralLengthR2007(DWGLZ77Stream& stream, unsigned char opcode)
+{
+    size_t length = opcode + 8;
+    if( length == 0x17 )
+    {
+        size_t n = stream.readByte ();
+        length += n;
+        if( n == 0xFF )
+        {
+            do
+            {
+                n = stream.readByte ();
+                n |= static_cast<size_t>(stream.readByte ()) << 8;
+                length += n;
+            } while( n == 0xFFFF && !stream.corrupted );
+        }
+    }
+    return length;
+}
+
+static void readInstructionsR2007(DWGLZ77Stream& stream, unsigned char& opcode,
+                                  size_t& offset, size_t& length)
+{
+    switch( opcode >> 4 )
+    {
+        case 0:
+            length = ( opcode & 0x0F ) + 0x13;
+            offset = stream.readByte ();
+            opcode = stream.readByte ();
+            length = ( ( opcode >> 3 ) & 0x10 ) + length;
+            offset = ( ( opcode & 0x78 ) << 5 ) + 1 + offset;
+            break;
+        case 1:
+            length = ( opcode & 0x0F ) + 3;
+            offset = stream.readByte ();
+            opcode = stream.readByte ();
+            offset = ( ( opcode & 0xF8 ) << 5 ) + 1 + offset;
+            break;
+        case 2:
+            offset = stream.readByte ();
+            offset |= static_cast<size_t>(stream.readByte ()) << 8;
+            length = opcode & 0x07;
+            if( ( opcode & 0x08 ) == 0 )
+            {
+                opcode = stream.readByte ();
+                length = ( opcode & 0xF8 ) + length;
+            }
+            else
+            {
+                ++offset;
+                length = ( static_cast<size_t>(stream.readByte ()) << 3 ) + length;
+                opcode = stream.readByte ();
+                length = ( ( ( opcode & 0xF8 ) << 8 ) + length ) + 0x100;
+            }
+            break;
+        default:
+            length = opcode >> 4;
+            offset = opcode & 0x0F;
+            opcode = stream.readByte ();
+            offset = ( ( ( opcode & 0xF8 ) << 1 ) + offset ) + 1;
+            break;
+    }
+}
+
+/**
+ * @brief Copy R2007 literals. The literals are stored by 32 byte runs of
+ * 8 byte words in reverse order, the tail order is specific for each length.
+ */
+static void copyLiteralsR2007(char * pabyDst, const char * pabySrc, size_t nSize)
+{
+    auto copy = [&pabyDst, pabySrc](size_t nOffset, size_t nCount)
+    {
+        memcpy (pabyDst, pabySrc + nOffset, nCount);
+        pabyDst += nCount;
+    };
+    auto copyReversed = [&pabyDst, pabySrc](size_t nOffset, size_t nCount)
+    {
+        for( size_t i = nCount; i > 0; --i )
+            *pabyDst++ = pabySrc[nOffset + i - 1];
+    };
+    auto copy16 = [&copy](size_t nOffset)
+    {
+        copy (nOffset + 8, 8);
+        copy (nOffset, 8);
+    };
+
+    while( nSize >= 32 )
+    {
+        copy16 (16);
+        copy16 (0);
+        pabySrc += 32;
+        nSize -= 32;
+    }
+
+    switch( nSize )
+    {
+        case 0: break;
+        case 1: copy (0, 1); break;
+        case 2: copyReversed (0, 2); break;
+        case 3: copyReversed (0, 3); break;
+        case 4: copy (0, 4); break;
+        case 5: copy (4, 1); copy (0, 4); break;
+        case 6: copy (5, 1); copy (1, 4); copy (0, 1); break;
+        case 7: copyReversed (5, 2); copy (1, 4); copy (0, 1); break;
+        case 8: copy (0, 8); break;
+        case 9: copy (8, 1); copy (0, 8); break;
+        case 10: copy (9, 1); copy (1, 8); copy (0, 1); break;
+        case 11: copyReversed (9, 2); copy (1, 8); copy (0, 1); break;
+        case 12: copy (8, 4); copy (0, 8); break;
+        case 13: copy (12, 1); copy (8, 4); copy (0, 8); break;
+        case 14: copy (13, 1); copy (9, 4); copy (1, 8); copy (0, 1); break;
+        case 15: copyReversed (13, 2); copy (9, 4); copy (1, 8); copy (0, 1);
+                 break;
+        case 16: copy16 (0); break;
+        case 17: copy (9, 8); copy (8, 1); copy (0, 8); break;
+        case 18: copy (17, 1); copy16 (1); copy (0, 1); break;
+        case 19: copyReversed (16, 3); copy16 (0); break;
+        case 20: copy (16, 4); copy (8, 8); copy (0, 8); break;
+        case 21: copy (20, 1); copy (16, 4); copy (8, 8); copy (0, 8); break;
+        case 22: copyReversed (20, 2); copy (16, 4); copy (8, 8); copy (0, 8);
+                 break;
+        case 23: copyReversed (20, 3); copy (16, 4); copy (8, 8); copy (0, 8);
+                 break;
+        case 24: copy (16, 8); copy16 (0); break;
+        case 25: copy (17, 8); copy (16, 1); copy16 (0); break;
+        case 26: copy (25, 1); copy (17, 8); copy (16, 1); copy16 (0); break;
+        case 27: copyReversed (25, 2); copy (17, 8); copy (16, 1); copy16 (0);
+                 break;
+        case 28: copy (24, 4); copy (16, 8); copy (8, 8); copy (0, 8); break;
+        case 29: copy (28, 1); copy (24, 4); copy (16, 8); copy (8, 8);
+                 copy (0, 8); break;
+        case 30: copyReversed (28, 2); copy (24, 4); copy (16, 8); copy (8, 8);
+                 copy (0, 8); break;
+        case 31: copy (30, 1); copy (26, 4); copy (18, 8); copy (10, 8);
+                 copy (2, 8); copyReversed (0, 2); break;
+    }
+}
+
+bool DecompressR2007(const char * pabySrc, size_t nSrcSize, char * pabyDst,
+                     size_t nDstSize, size_t& nDecompressedSize)
+{
+    DWGLZ77Stream stream;
+    stream.src = reinterpret_cast<const unsigned char *>(pabySrc);
+    stream.srcEnd = stream.src + nSrcSize;
+    stream.corrupted = false;
+
+    char * pabyOut = pabyDst;
+    const char * pabyDstEnd = pabyDst + nDstSize;
+    nDecompressedSize = 0;
+
+    size_t nLength = 0;
+    size_t nOffset = 0;
+    unsigned char opcode = stream.readByte ();
+    if( ( opcode & 0xF0 ) == 0x20 )
+    {
+        stream.readByte ();
+        stream.readByte ();
+        nLength = stream.readByte () & 0x07;
+    }
+
+    while( stream.src < stream.srcEnd && !stream.corrupted )
+    {
+        if( nLength == 0 )
+            nLength = readLiteralLengthR2007 (stream, opcode);
+        if( stream.corrupted ||
+            static_cast<size_t>(stream.srcEnd - stream.src) < nLength ||
+            static_cast<size_t>(pabyDstEnd - pabyOut) < nLength )
+            return false;
+        copyLiteralsR2007 (pabyOut, reinterpret_cast<const char *>(stream.src),
+                           nLength);
+        pabyOut += nLength;
+        stream.src += nLength;
+        nLength = 0;
+        if( stream.src >= stream.srcEnd )
+            break;
+
+        opcode = stream.readByte ();
+        readInstructionsR2007 (stream, opcode, nOffset, nLength);
+        while( true )
+        {
+            if( stream.corrupted || nOffset == 0 ||
+                static_cast<size_t>(pabyOut - pabyDst) < nOffset ||
+                static_cast<size_t>(pabyDstEnd - pabyOut) < nLength )
+                return false;
+            copyMatch (pabyOut, nOffset, nLength, pabyDstEnd);
+            pabyOut += nLength;
+
+            nLength = opcode & 0x07;
+            if( nLength != 0 || stream.src >= stream.srcEnd )
+                break;
+            opcode = stream.readByte ();
+            if( ( opcode >> 4 ) == 0 )
+                break;
+            if( ( opcode >> 4 ) == 0x0F )
+                opcode &= 0x0F;
+            readInstructionsR2007 (stream, opcode, nOffset, nLength);
+        }
+    }
+    if( stream.corrupted )
+        return false;
+
+    nDecompressedSize = static_cast<size_t>(pabyOut - pabyDst);
+    return true;
+}
+
+bool FindStringStream(const char * pabyInput, size_t nStartBitOffset,
+                      size_t nEndBitOffset, size_t& nStringStreamOffset)
+{
+    if( nEndBitOffset < nStartBitOffset + 17 )
+        return false;
+    size_t nOffset = nEndBitOffset - 1;
+    size_t nReadOffset = nOffset;
+    if( !ReadBIT (pabyInput, nReadOffset) )
+        return false;
+
+    nOffset -= 16;
+    nReadOffset = nOffset;
+    size_t nSize = static_cast<unsigned short>(ReadRAWSHORT (pabyInput,
+                                                             nReadOffset));
+    if( nSize & 0x8000 )
+    {
+        if( nOffset < nStartBitOffset + 16 )
+            return false;
+        nOffset -= 16;
+        nReadOffset = nOffset;
+        size_t nHiSize = static_cast<unsigned short>(ReadRAWSHORT (pabyInput,
+                                                                   nReadOffset));
+        nSize = ( nSize & 0x7FFF ) | ( nHiSize << 15 );
+    }
+    if( nOffset < nStartBitOffset + nSize )
+        return false;
+    nStringStreamOffset = nOffset - nSize;
+    return true;
+}
+
+void CopyBits(const char * pabySrc, size_t nSrcBitOffset, size_t nBits,
+              char * pabyDst, size_t nDstBitOffset)
+{
+    const size_t nDstShift = nDstBitOffset % 8;
+    unsigned char * pabyOut = reinterpret_cast<unsigned char *>(pabyDst) +
+                              nDstBitOffset / 8;
+    for( ; nBits >= 8; nBits -= 8 )
+    {
+        unsigned char byte = ReadCHAR (pabySrc, nSrcBitOffset);
+        *pabyOut++ |= static_cast<unsigned char>( byte >> nDstShift );
+        if( nDstShift != 0 )
+            *pabyOut |= static_cast<unsigned char>( byte << ( 8 - nDstShift ) );
+    }
+    size_t nBit = static_cast<size_t>(pabyOut -
+                    reinterpret_cast<unsigned char *>(pabyDst)) * 8 + nDstShift;
+    for( ; nBits > 0; --nBits, ++nBit )
+    {
+        if( ReadBIT (pabySrc, nSrcBitOffset) )
+            pabyDst[nBit / 8] |= static_cast<char>( 0x80 >> ( nBit % 8 ) );
+    }
+}
@@ -146,11 +146,13 @@ long            ReadRAWLONGLONG ( const char * pabyInput, size_t& nBitOffsetFrom
 int             ReadRAWLONG ( const char * pabyInput, size_t& nBitOffsetFromStart );
 short           ReadRAWSHORT ( const char * pabyInput, size_t& nBitOffsetFromStart );
 double          ReadRAWDOUBLE ( const char * pabyInput, size_t& nBitOffsetFromStart );
+void            skipRAWDOUBLE(const char * pabyInput, size_t& nBitOffsetFromStart);
 unsigned char   Read2B ( const char * pabyInput, size_t& nBitOffsetFromStart );
 unsigned char   Read3B ( const char * pabyInput, size_t& nBitOffsetFromStart );
 unsigned char   Read4B ( const char * pabyInput, size_t& nBitOffsetFromStart );
 CADHandle       ReadHANDLE ( const char * pabyInput, size_t& nBitOffsetFromStart );
 CADHandle       ReadHANDLE8BLENGTH ( const char * pabyInput, size_t & nBitOffsetFromStart );
+void            skipHANDLE8BLENGTH(const char * pabyInput, size_t& nBitOffsetFromStart);
 void            skipHANDLE(const char * pabyInput, size_t& nBitOffsetFromStart);
 bool            ReadBIT ( const char * pabyInput, size_t& nBitOffsetFromStart );
 void            skipBIT(const char * pabyInput, size_t& nBitOffsetFromStart);
@@ -166,10 +168,126 @@ long            ReadUMCHAR ( const char * pabyInput, size_t& nBitOffsetFromStart
 unsigned int    ReadMSHORT ( const char * pabyInput, size_t& nBitOffsetFromStart );
 std::string     ReadTV ( const char * pabyInput, size_t& nBitOffsetFromStart );
 void            skipTV(const char * pabyInput, size_t& nBitOffsetFromStart);
+/**
+ * @brief Read R2007+ TU string, UTF-16 characters are converted to UTF-8
+ */
+std::string     ReadTU ( const char * pabyInput, size_t& nBitOffsetFromStart );
+void            skipTU(const char * pabyInput, size_t& nBitOffsetFromStart);
+
+/**
+ * @brief R2007+ string stream. The strings are stored as TU after the data,
+ * not inline as TV.
+ */
+struct DWGStringStream
+{
+    const char * pabyInput  = nullptr; // nullptr if the data has no strings
+    size_t       nBitOffset = 0;
+};
+
+/**
+ * @brief Sets the string stream of the current thread for the scope, nullptr
+ * for the inline TV strings
+ */
+class DWGStringStreamScope
+{
+public:
+    explicit DWGStringStreamScope(DWGStringStream * stream);
+    ~DWGStringStreamScope();
+
+private:
+    DWGStringStream * previous;
+};
+
+/**
+ * @brief Read the text from the string stream of the current thread, or the
+ * inline TV if there is no stream
+ */
+std::string     ReadText ( const char * pabyInput, size_t& nBitOffsetFromStart );
+void            skipText(const char * pabyInput, size_t& nBitOffsetFromStart);
 void            skipBITLONG(const char * pabyInput, size_t& nBitOffsetFromStart);
 void            skipBITSHORT(const char * pabyInput, size_t& nBitOffsetFromStart);
 
 CADVector       ReadVector(const char * pabyInput, size_t& nBitOffsetFromStart);
 CADVector       ReadRAWVector(const char * pabyInput, size_t& nBitOffsetFromStart);
 
+/**
+ * @brief Decrypt R2004+ file header data, XOR with the pseudo random sequence
+ * @param pabyData Data to decrypt in place, starts at the 0x80 file offset
+ * @param nSize Data size, 0x6C bytes
+ */
+void            DecryptR2004Header(char * pabyData, size_t nSize);
+
+/**
+ * @brief Decompress R2004+ LZ77 section page
+ * @param pabySrc Compressed data
+ * @param nSrcSize Compressed data size
+ * @param pabyDst Buffer for the decompressed data
+ * @param nDstSize Buffer size
+ * @param nDecompressedSize Decompressed data size
+ * @return false if the compressed data is corrupted or does not fit the buffer
+ */
+bool            DecompressR2004(const char * pabySrc, size_t nSrcSize,
+                                char * pabyDst, size_t nDstSize,
+                                size_t& nDecompressedSize);
+
+/**
+ * @brief Check and correct R2007+ Reed-Solomon code word of 255 bytes. The
+ * data is followed by the parity, the first byte is the highest degree
+ * coefficient and the generator roots are a^0 ... a^(parity - 1).
+ * @param pabyBlock Code word, corrected in place
+ * @param nDataSize Data size, 239 or 251 bytes, so up to 8 or 2 wrong bytes
+ * are corrected
+ * @return false if the code word has more errors than can be corrected
+ */
+bool            CorrectReedSolomonR2007(char * pabyBlock, size_t nDataSize);
+
+/**
+ * @brief De-interleave R2007+ Reed-Solomon encoded page. The page is the
+ * nBlockCount blocks of 255 bytes stored byte by byte in turn, the data is
+ * the first nDataSize bytes of each block. The blocks are checked and
+ * corrected by their parity.
+ * @param pabySrc Encoded page, nBlockCount * 255 bytes
+ * @param nBlockCount Blocks count
+ * @param nDataSize Data size of the block, 239 for the system pages and 251
+ * for the data pages
+ * @param pabyDst Buffer for nBlockCount * nDataSize bytes of data
+ * @return count of the blocks which can not be corrected, their data is
+ * copied as read. The code parameters are not confirmed by the AutoCAD
+ * saved files yet, so the wrong blocks are not fatal.
+ */
+size_t          DeinterleaveR2007(const char * pabySrc, size_t nBlockCount,
+                                  size_t nDataSize, char * pabyDst);
+
+/**
+ * @brief Decompress R2007+ LZ77 page
+ * @param pabySrc Compressed data
+ * @param nSrcSize Compressed data size
+ * @param pabyDst Buffer for the decompressed data
+ * @param nDstSize Buffer size
+ * @param nDecompressedSize Decompressed data size
+ * @return false if the compressed data is corrupted or does not fit the buffer
+ */
+bool            DecompressR2007(const char * pabySrc, size_t nSrcSize,
+                                char * pabyDst, size_t nDstSize,
+                                size_t& nDecompressedSize);
+
+/**
+ * @brief Find R2007+ string stream. It is stored at the end of the data
+ * followed by its size and the presence flag.
+ * @param pabyInput Data
+ * @param nStartBitOffset Data start
+ * @param nEndBitOffset Data end, the presence flag is the last bit
+ * @param nStringStreamOffset Bit offset of the string stream
+ * @return false if the data has no string stream
+ */
+bool            FindStringStream(const char * pabyInput, size_t nStartBitOffset,
+                                 size_t nEndBitOffset,
+                                 size_t& nStringStreamOffset);
+
+/**
+ * @brief Copy bits, the destination bits should be zero
+ */
+void            CopyBits(const char * pabySrc, size_t nSrcBitOffset,
+                         size_t nBits, char * pabyDst, size_t nDstBitOffset);
+
 #endif // DWG_IO_H
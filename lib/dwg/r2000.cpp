@@ -31,14 +31,20 @@
 
 #include "r2000.h"
 #include "io.h"
+#include "schema.h"
 #include "cadgeometry.h"
 #include "cadobjects.h"
 #include "opencad_api.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
 #include <cstring>
 #include <cassert>
+#include <chrono>
 #include <memory>
+#include <set>
+#include <utility>
 
 #ifdef __APPLE__
 #include <MacTypes.h>
@@ -60,15 +66,303 @@
 #define UNKNOWN14 CADHeader::MAX_HEADER_CONSTANT + 14
 #define UNKNOWN15 CADHeader::MAX_HEADER_CONSTANT + 15
 
+// CADFile::ProjectionFlags of the geometry decoded by the current thread, set
+// by getGeometry for the nested object reads
+static thread_local int decodeProjection = CADFile::PROJECTION_ALL;
+
+// ----------------------------------------------------------------------------
+// Colors
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Get ACI color index from the R2004+ color RGB value, the high byte is
+ * the color method
+ */
+static short getColorIndex(short dIndex, unsigned int dRGB)
+{
+    switch( dRGB >> 24 )
+    {
+        case 0xC0:
+            return 256; // ByLayer
+        case 0xC1:
+            return 0;   // ByBlock
+        case 0xC3:
+            return static_cast<short>(dRGB & 0xFF);
+        default:
+            return dIndex;
+    }
+}
+
+/**
+ * @brief Read CMC color of the given version
+ * @return ACI color index
+ */
+static short ReadCMC(const char * pabyInput, size_t& nBitOffsetFromStart,
+                     int nVersion)
+{
+    short dIndex = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    if( nVersion < CADVersions::DWG_R2004 )
+        return dIndex;
+
+    unsigned int dRGB = static_cast<unsigned int>(ReadBITLONG (pabyInput,
+                                                      nBitOffsetFromStart));
+    unsigned char dFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    if( dFlags & 0x01 )
+        skipText (pabyInput, nBitOffsetFromStart); // color name
+    if( dFlags & 0x02 )
+        skipText (pabyInput, nBitOffsetFromStart); // book name
+    return getColorIndex (dIndex, dRGB);
+}
+
+/**
+ * @brief Read R2004+ ENC entity color: the index with flags, optional RGB
+ * value and transparency
+ * @param bColorBookHandle set if the color book handle is in the handles data
+ * @return ACI color index
+ */
+static short ReadENC(const char * pabyInput, size_t& nBitOffsetFromStart,
+                     bool& bColorBookHandle)
+{
+    unsigned short dColor = static_cast<unsigned short>(ReadBITSHORT (pabyInput,
+                                                       nBitOffsetFromStart));
+    short dIndex = static_cast<short>(dColor & 0x1FF);
+    bColorBookHandle = ( dColor & 0x4000 ) != 0;
+    if( dColor & 0x8000 )
+        dIndex = getColorIndex (dIndex, static_cast<unsigned int>(
+                                ReadBITLONG (pabyInput, nBitOffsetFromStart)));
+    if( dColor & 0x2000 )
+        skipBITLONG (pabyInput, nBitOffsetFromStart); // transparency
+    return dIndex;
+}
+
+// ----------------------------------------------------------------------------
+// Header variables reader
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief The header variables decoded by the READ_FAST and READ_FASTEST modes
+ * if no header codes were set in the read filter
+ */
+static const std::set<short>& getDefaultFastHeaderCodes()
+{
+    static const std::set<short> codes = {
+        CADHeader::ATTMODE, CADHeader::PDMODE, CADHeader::LTSCALE,
+        CADHeader::TEXTSIZE, CADHeader::TRACEWID, CADHeader::SKETCHINC,
+        CADHeader::FILLETRAD, CADHeader::THICKNESS, CADHeader::ANGBASE,
+        CADHeader::PDSIZE, CADHeader::PLINEWID, CADHeader::TDCREATE,
+        CADHeader::TDUPDATE, CADHeader::TDINDWG, CADHeader::TDUSRTIMER,
+        CADHeader::CECOLOR, CADHeader::HANDSEED, CADHeader::CLAYER,
+        CADHeader::TEXTSTYLE, CADHeader::CELTYPE, CADHeader::DIMSTYLE,
+        CADHeader::CMLSTYLE, CADHeader::PSVPSCALE, CADHeader::PINSBASE,
+        CADHeader::PEXTMIN, CADHeader::PEXTMAX, CADHeader::PLIMMIN,
+        CADHeader::PLIMMAX, CADHeader::PELEVATION, CADHeader::PUCSORG,
+        CADHeader::PUCSXDIR, CADHeader::PUCSYDIR, CADHeader::PUCSNAME,
+        CADHeader::PUCSORTHOREF, CADHeader::PUCSORTHOVIEW, CADHeader::PUCSBASE,
+        CADHeader::PUCSORGTOP, CADHeader::PUCSORGBOTTOM, CADHeader::PUCSORGLEFT,
+        CADHeader::PUCSORGRIGHT, CADHeader::PUCSORGFRONT, CADHeader::PUCSORGBACK,
+        CADHeader::INSBASE, CADHeader::EXTMIN, CADHeader::EXTMAX,
+        CADHeader::LIMMIN, CADHeader::LIMMAX, CADHeader::ELEVATION,
+        CADHeader::UCSORG, CADHeader::UCSXDIR, CADHeader::UCSYDIR,
+        CADHeader::UCSNAME, CADHeader::UCSORTHOREF, CADHeader::UCSORTHOVIEW,
+        CADHeader::UCSBASE, CADHeader::UCSORGTOP, CADHeader::UCSORGBOTTOM,
+        CADHeader::UCSORGLEFT, CADHeader::UCSORGRIGHT, CADHeader::UCSORGFRONT,
+        CADHeader::UCSORGBACK, CADHeader::HYPERLINKBASE, CADHeader::STYLESHEET,
+        CADHeader::INSUNITS, CADHeader::CEPSNTYPE, CADHeader::CEPSNID,
+        CADHeader::FINGERPRINTGUID, CADHeader::VERSIONGUID
+    };
+    return codes;
+}
+
+/**
+ * @brief Decodes the wanted header variables into CADHeader and steps over
+ * the rest with the skip* primitives, so no value is constructed for them
+ */
+class DWGHeaderReader
+{
+public:
+    DWGHeaderReader(CADHeader& header, const char* pabyBuf,
+                    size_t& nBitOffsetFromStart,
+                    const std::set<short>* wantedCodes, int nVersion) :
+        header(header), pabyBuf(pabyBuf),
+        nBitOffsetFromStart(nBitOffsetFromStart), wantedCodes(wantedCodes),
+        nVersion(nVersion), bHandleStream(false), nHandleOffset(0)
+    {
+    }
+
+    /**
+     * @brief Check if the header variable should be decoded
+     * @param code Header variable code
+     * @return true if code is wanted, all codes are wanted without a filter
+     */
+    bool isWanted(short code) const
+    {
+        return nullptr == wantedCodes ||
+               wantedCodes->find (code) != wantedCodes->end ();
+    }
+
+    void readBIT(short code)
+    {
+        if(isWanted (code))
+            header.addValue (code, ReadBIT (pabyBuf, nBitOffsetFromStart));
+        else
+            skipBIT (pabyBuf, nBitOffsetFromStart);
+    }
+
+    void readCHAR(short code)
+    {
+        unsigned char value = ReadCHAR (pabyBuf, nBitOffsetFromStart);
+        if(isWanted (code))
+            header.addValue (code, static_cast<short>(value));
+    }
+
+    void readCMC(short code)
+    {
+        short value = ReadCMC (pabyBuf, nBitOffsetFromStart, nVersion);
+        if(isWanted (code))
+            header.addValue (code, value);
+    }
+
+    void readBITSHORT(short code)
+    {
+        if(isWanted (code))
+            header.addValue (code, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
+        else
+            skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+    }
+
+    void readBITLONG(short code)
+    {
+        if(isWanted (code))
+            header.addValue (code, ReadBITLONG (pabyBuf, nBitOffsetFromStart));
+        else
+            skipBITLONG (pabyBuf, nBitOffsetFromStart);
+    }
+
+    void readBITDOUBLE(short code)
+    {
+        if(isWanted (code))
+            header.addValue (code, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
+        else
+            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+    }
+
+    void readTV(short code)
+    {
+        if(isWanted (code))
+            header.addValue (code, ReadText (pabyBuf, nBitOffsetFromStart));
+        else
+            skipText (pabyBuf, nBitOffsetFromStart);
+    }
+
+    void readHANDLE(short code)
+    {
+        if(isWanted (code))
+            header.addValue (code, ReadHANDLE (pabyBuf, handleOffset ()));
+        else
+            ::skipHANDLE (pabyBuf, handleOffset ());
+    }
+
+    CADHandle readHANDLE()
+    {
+        return ReadHANDLE (pabyBuf, handleOffset ());
+    }
+
+    void skipHANDLE()
+    {
+        ::skipHANDLE (pabyBuf, handleOffset ());
+    }
+
+    /**
+     * @brief Set R2007+ handle stream, the handles except HANDSEED are read
+     * from it instead of the data stream
+     * @param nOffset Handle stream bit offset
+     */
+    void setHandleStream(size_t nOffset)
+    {
+        bHandleStream = true;
+        nHandleOffset = nOffset;
+    }
+
+    void readHANDLE8BLENGTH(short code)
+    {
+        if(isWanted (code))
+            header.addValue (code, ReadHANDLE8BLENGTH (pabyBuf,
+                                                       nBitOffsetFromStart));
+        else
+            skipHANDLE8BLENGTH (pabyBuf, nBitOffsetFromStart);
+    }
+
+    void read3BITDOUBLE(short code)
+    {
+        if(isWanted (code))
+        {
+            double dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+            double dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+            double dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+            header.addValue (code, dX, dY, dZ);
+        }
+        else
+        {
+            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+        }
+    }
+
+    void read2RAWDOUBLE(short code)
+    {
+        if(isWanted (code))
+        {
+            double dX = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
+            double dY = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
+            header.addValue (code, dX, dY);
+        }
+        else
+        {
+            skipRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
+            skipRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
+        }
+    }
+
+    void readDateTime(short code)
+    {
+        if(isWanted (code))
+        {
+            long juliandate = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
+            long millisec = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
+            header.addValue (code, juliandate, millisec);
+        }
+        else
+        {
+            skipBITLONG (pabyBuf, nBitOffsetFromStart);
+            skipBITLONG (pabyBuf, nBitOffsetFromStart);
+        }
+    }
+
+protected:
+    CADHeader&              header;
+    const char*             pabyBuf;
+    size_t&                 nBitOffsetFromStart;
+    const std::set<short>*  wantedCodes;
+    int                     nVersion;
+    bool                    bHandleStream;
+    size_t                  nHandleOffset;
+
+    size_t& handleOffset()
+    {
+        return bHandleStream ? nHandleOffset : nBitOffsetFromStart;
+    }
+};
+
 int DWGFileR2000::readHeader (OpenOptions eOptions)
 {
-    char buffer[255];
     char * pabyBuf;
-    size_t dHeaderVarsSectionLength = 0;
+    unsigned int dHeaderVarsSectionLength = 0;
 
-    fileIO->Seek (sectionLocatorRecords[0].dSeeker, CADFileIO::SeekOrigin::BEG);
-    fileIO->Read (buffer, DWGSentinelLength);
-    if ( memcmp (buffer, DWGHeaderVariablesStart, DWGSentinelLength) )
+    vector<char> sectionData;
+    if( readSectionData (0, sectionData) != CADErrorCodes::SUCCESS ||
+        sectionData.size () < DWGSentinelLength + 4 ||
+        memcmp (sectionData.data (), DWGHeaderVariablesStart, DWGSentinelLength) )
     {
         DebugMsg("File is corrupted (wrong pointer to HEADER_VARS section,"
                         "or HEADERVARS starting sentinel corrupted.)");
@@ -76,564 +370,571 @@ int DWGFileR2000::readHeader (OpenOptions eOptions)
         return CADErrorCodes::HEADER_SECTION_READ_FAILED;
     }
 
-    fileIO->Read (&dHeaderVarsSectionLength, 4);
+    memcpy (&dHeaderVarsSectionLength, sectionData.data () + DWGSentinelLength, 4);
     DebugMsg("Header variables section length: %ld\n", dHeaderVarsSectionLength);
+    size_t nSectionOffset = DWGSentinelLength + 4;
+    if( sectionData.size () < nSectionOffset + dHeaderVarsSectionLength + 2 +
+                              DWGSentinelLength )
+        return CADErrorCodes::HEADER_SECTION_READ_FAILED;
 
     size_t nBitOffsetFromStart = 0;
     pabyBuf = new char[dHeaderVarsSectionLength + 4];
-    fileIO->Read ( pabyBuf, dHeaderVarsSectionLength + 2 );
+    memcpy (pabyBuf, sectionData.data () + nSectionOffset,
+            dHeaderVarsSectionLength + 2);
+    nSectionOffset += dHeaderVarsSectionLength + 2;
 
-    if(eOptions == OpenOptions::READ_ALL)
+    // READ_ALL decodes everything, fast modes decode only the wanted codes
+    const std::set<short>* wantedCodes = nullptr;
+    if(eOptions != OpenOptions::READ_ALL)
     {
-        header.addValue(UNKNOWN1, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN2, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN3, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN4, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN5, ReadTV (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN6, ReadTV (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN7, ReadTV (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN8, ReadTV (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN9, ReadBITLONG (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN10, ReadBITLONG (pabyBuf, nBitOffsetFromStart));
+        if(readFilter.headerCodes.empty ())
+            wantedCodes = &getDefaultFastHeaderCodes ();
+        else
+            wantedCodes = &readFilter.headerCodes;
     }
-    else
+    DWGHeaderReader headerReader(header, pabyBuf, nBitOffsetFromStart,
+                                 wantedCodes, dwgVersion);
+
+    // R2007+ data is followed by the string and handle streams
+    DWGStringStream stHeaderStrings;
+    if( dwgVersion >= CADVersions::DWG_R2007 )
     {
-        skipBITDOUBLE(pabyBuf, nBitOffsetFromStart);
-        skipBITDOUBLE(pabyBuf, nBitOffsetFromStart);
-        skipBITDOUBLE(pabyBuf, nBitOffsetFromStart);
-        skipBITDOUBLE(pabyBuf, nBitOffsetFromStart);
-        skipTV(pabyBuf, nBitOffsetFromStart);
-        skipTV(pabyBuf, nBitOffsetFromStart);
-        skipTV(pabyBuf, nBitOffsetFromStart);
-        skipTV(pabyBuf, nBitOffsetFromStart);
-        skipBITLONG(pabyBuf, nBitOffsetFromStart);
-        skipBITLONG(pabyBuf, nBitOffsetFromStart);
-    }
-
-    CADHandle stCurrentViewportTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
-    tables.addTable (CADTables::CurrentViewportTable,
-                        stCurrentViewportTable);
-
-    if(eOptions == OpenOptions::READ_ALL)
-    {
-        header.addValue(CADHeader::DIMASO, ReadBIT (pabyBuf, nBitOffsetFromStart));     // 1
-        header.addValue(CADHeader::DIMSHO, ReadBIT (pabyBuf, nBitOffsetFromStart));     // 2
-        header.addValue(CADHeader::PLINEGEN, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 3
-        header.addValue(CADHeader::ORTHOMODE, ReadBIT (pabyBuf, nBitOffsetFromStart));  // 4
-        header.addValue(CADHeader::REGENMODE, ReadBIT (pabyBuf, nBitOffsetFromStart));  // 5
-        header.addValue(CADHeader::FILLMODE, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 6
-        header.addValue(CADHeader::QTEXTMODE, ReadBIT (pabyBuf, nBitOffsetFromStart));  // 7
-        header.addValue(CADHeader::PSLTSCALE, ReadBIT (pabyBuf, nBitOffsetFromStart));  // 8
-        header.addValue(CADHeader::LIMCHECK, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 9
-        header.addValue(CADHeader::USRTIMER, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 10
-        header.addValue(CADHeader::SKPOLY, ReadBIT (pabyBuf, nBitOffsetFromStart));     // 11
-        header.addValue(CADHeader::ANGDIR, ReadBIT (pabyBuf, nBitOffsetFromStart));     // 12
-        header.addValue(CADHeader::SPLFRAME, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 13
-        header.addValue(CADHeader::MIRRTEXT, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 14
-        header.addValue(CADHeader::WORDLVIEW, ReadBIT (pabyBuf, nBitOffsetFromStart));  // 15
-        header.addValue(CADHeader::TILEMODE, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 16
-        header.addValue(CADHeader::PLIMCHECK, ReadBIT (pabyBuf, nBitOffsetFromStart));  // 17
-        header.addValue(CADHeader::VISRETAIN, ReadBIT (pabyBuf, nBitOffsetFromStart));  // 18
-        header.addValue(CADHeader::DISPSILH, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 19
-        header.addValue(CADHeader::PELLIPSE, ReadBIT (pabyBuf, nBitOffsetFromStart));   // 20
+        size_t nSizeInBits = static_cast<unsigned int>(ReadRAWLONG (pabyBuf,
+                                                        nBitOffsetFromStart));
+        if( nSizeInBits > size_t(dHeaderVarsSectionLength) * 8 )
+        {
+            delete[] pabyBuf;
+            return CADErrorCodes::HEADER_SECTION_READ_FAILED;
+        }
+        size_t nStringsOffset = 0;
+        if( FindStringStream (pabyBuf, nBitOffsetFromStart, nSizeInBits,
+                              nStringsOffset) )
+        {
+            stHeaderStrings.pabyInput = pabyBuf;
+            stHeaderStrings.nBitOffset = nStringsOffset;
+        }
+        headerReader.setHandleStream (nSizeInBits);
     }
-    else
+    DWGStringStreamScope stringsScope(dwgVersion >= CADVersions::DWG_R2007 ?
+                                      &stHeaderStrings : nullptr);
+
+    headerReader.readBITDOUBLE(UNKNOWN1);
+    headerReader.readBITDOUBLE(UNKNOWN2);
+    headerReader.readBITDOUBLE(UNKNOWN3);
+    headerReader.readBITDOUBLE(UNKNOWN4);
+    headerReader.readTV(UNKNOWN5);
+    headerReader.readTV(UNKNOWN6);
+    headerReader.readTV(UNKNOWN7);
+    headerReader.readTV(UNKNOWN8);
+    headerReader.readBITLONG(UNKNOWN9);
+    headerReader.readBITLONG(UNKNOWN10);
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart); // unknown
+
+    if( dwgVersion < CADVersions::DWG_R2004 )
     {
-        nBitOffsetFromStart += 20;
+        CADHandle stCurrentViewportTable = ReadHANDLE (pabyBuf,
+                                                       nBitOffsetFromStart);
+        tables.addTable (CADTables::CurrentViewportTable,
+                         stCurrentViewportTable);
     }
 
-    if(eOptions == OpenOptions::READ_ALL)
+    headerReader.readBIT(CADHeader::DIMASO);     // 1
+    headerReader.readBIT(CADHeader::DIMSHO);     // 2
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBIT (pabyBuf, nBitOffsetFromStart); // DIMSAV
+    headerReader.readBIT(CADHeader::PLINEGEN);   // 3
+    headerReader.readBIT(CADHeader::ORTHOMODE);  // 4
+    headerReader.readBIT(CADHeader::REGENMODE);  // 5
+    headerReader.readBIT(CADHeader::FILLMODE);   // 6
+    headerReader.readBIT(CADHeader::QTEXTMODE);  // 7
+    headerReader.readBIT(CADHeader::PSLTSCALE);  // 8
+    headerReader.readBIT(CADHeader::LIMCHECK);   // 9
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBIT (pabyBuf, nBitOffsetFromStart); // BLIPMODE
+    if( dwgVersion >= CADVersions::DWG_R2004 )
+        skipBIT (pabyBuf, nBitOffsetFromStart); // undocumented
+    headerReader.readBIT(CADHeader::USRTIMER);   // 10
+    headerReader.readBIT(CADHeader::SKPOLY);     // 11
+    headerReader.readBIT(CADHeader::ANGDIR);     // 12
+    headerReader.readBIT(CADHeader::SPLFRAME);   // 13
+    if( dwgVersion < CADVersions::DWG_R2000 )
     {
-        header.addValue(CADHeader::PROXYGRAPHICS, ReadBITSHORT (pabyBuf, nBitOffsetFromStart)); // 1
-        header.addValue(CADHeader::TREEDEPTH, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));     // 2
-        header.addValue(CADHeader::LUNITS, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));        // 3
-        header.addValue(CADHeader::LUPREC, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));        // 4
-        header.addValue(CADHeader::AUNITS, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));        // 5
-        header.addValue(CADHeader::AUPREC, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));        // 6
+        headerReader.readBIT(CADHeader::ATTREQ);
+        headerReader.readBIT(CADHeader::ATTDIA);
     }
-    else
+    headerReader.readBIT(CADHeader::MIRRTEXT);   // 14
+    headerReader.readBIT(CADHeader::WORDLVIEW);  // 15
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBIT (pabyBuf, nBitOffsetFromStart); // WIREFRAME
+    headerReader.readBIT(CADHeader::TILEMODE);   // 16
+    headerReader.readBIT(CADHeader::PLIMCHECK);  // 17
+    headerReader.readBIT(CADHeader::VISRETAIN);  // 18
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBIT (pabyBuf, nBitOffsetFromStart); // DELOBJ
+    headerReader.readBIT(CADHeader::DISPSILH);   // 19
+    headerReader.readBIT(CADHeader::PELLIPSE);   // 20
+
+    headerReader.readBITSHORT(CADHeader::PROXYGRAPHICS); // 1
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart);   // DRAGMODE
+    headerReader.readBITSHORT(CADHeader::TREEDEPTH);     // 2
+    headerReader.readBITSHORT(CADHeader::LUNITS);        // 3
+    headerReader.readBITSHORT(CADHeader::LUPREC);        // 4
+    headerReader.readBITSHORT(CADHeader::AUNITS);        // 5
+    headerReader.readBITSHORT(CADHeader::AUPREC);        // 6
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart); // OSMODE
+
+    headerReader.readBITSHORT(CADHeader::ATTMODE);
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart); // COORDS
+    headerReader.readBITSHORT(CADHeader::PDMODE);
+    if( dwgVersion < CADVersions::DWG_R2000 )
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart); // PICKSTYLE
+    if( dwgVersion >= CADVersions::DWG_R2004 )
     {
-        for(char i = 0; i < 6; ++i)
-            skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+        skipBITLONG (pabyBuf, nBitOffsetFromStart); // unknown
+        skipBITLONG (pabyBuf, nBitOffsetFromStart); // unknown
+        skipBITLONG (pabyBuf, nBitOffsetFromStart); // unknown
     }
 
-    header.addValue(CADHeader::ATTMODE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::PDMODE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-
-    if(eOptions == OpenOptions::READ_ALL)
-    {
-        header.addValue(CADHeader::USERI1, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));    // 1
-        header.addValue(CADHeader::USERI2, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));    // 2
-        header.addValue(CADHeader::USERI3, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));    // 3
-        header.addValue(CADHeader::USERI4, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));    // 4
-        header.addValue(CADHeader::USERI5, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));    // 5
-        header.addValue(CADHeader::SPLINESEGS, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));// 6
-        header.addValue(CADHeader::SURFU, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));     // 7
-        header.addValue(CADHeader::SURFV, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));     // 8
-        header.addValue(CADHeader::SURFTYPE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 9
-        header.addValue(CADHeader::SURFTAB1, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 10
-        header.addValue(CADHeader::SURFTAB2, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 11
-        header.addValue(CADHeader::SPLINETYPE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));// 12
-        header.addValue(CADHeader::SHADEDGE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 13
-        header.addValue(CADHeader::SHADEDIF, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 14
-        header.addValue(CADHeader::UNITMODE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 15
-        header.addValue(CADHeader::MAXACTVP, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 16
-        header.addValue(CADHeader::ISOLINES, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 17
-        header.addValue(CADHeader::CMLJUST, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 18
-        header.addValue(CADHeader::TEXTQLTY, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 19
-    }
-    else
+    headerReader.readBITSHORT(CADHeader::USERI1);    // 1
+    headerReader.readBITSHORT(CADHeader::USERI2);    // 2
+    headerReader.readBITSHORT(CADHeader::USERI3);    // 3
+    headerReader.readBITSHORT(CADHeader::USERI4);    // 4
+    headerReader.readBITSHORT(CADHeader::USERI5);    // 5
+    headerReader.readBITSHORT(CADHeader::SPLINESEGS);// 6
+    headerReader.readBITSHORT(CADHeader::SURFU);     // 7
+    headerReader.readBITSHORT(CADHeader::SURFV);     // 8
+    headerReader.readBITSHORT(CADHeader::SURFTYPE);  // 9
+    headerReader.readBITSHORT(CADHeader::SURFTAB1);  // 10
+    headerReader.readBITSHORT(CADHeader::SURFTAB2);  // 11
+    headerReader.readBITSHORT(CADHeader::SPLINETYPE);// 12
+    headerReader.readBITSHORT(CADHeader::SHADEDGE);  // 13
+    headerReader.readBITSHORT(CADHeader::SHADEDIF);  // 14
+    headerReader.readBITSHORT(CADHeader::UNITMODE);  // 15
+    headerReader.readBITSHORT(CADHeader::MAXACTVP);  // 16
+    headerReader.readBITSHORT(CADHeader::ISOLINES);  // 17
+    headerReader.readBITSHORT(CADHeader::CMLJUST);   // 18
+    headerReader.readBITSHORT(CADHeader::TEXTQLTY);  // 19
+
+    headerReader.readBITDOUBLE(CADHeader::LTSCALE);
+    headerReader.readBITDOUBLE(CADHeader::TEXTSIZE);
+    headerReader.readBITDOUBLE(CADHeader::TRACEWID);
+    headerReader.readBITDOUBLE(CADHeader::SKETCHINC);
+    headerReader.readBITDOUBLE(CADHeader::FILLETRAD);
+    headerReader.readBITDOUBLE(CADHeader::THICKNESS);
+    headerReader.readBITDOUBLE(CADHeader::ANGBASE);
+    headerReader.readBITDOUBLE(CADHeader::PDSIZE);
+    headerReader.readBITDOUBLE(CADHeader::PLINEWID);
+
+    headerReader.readBITDOUBLE(CADHeader::USERR1);   // 1
+    headerReader.readBITDOUBLE(CADHeader::USERR2);   // 2
+    headerReader.readBITDOUBLE(CADHeader::USERR3);   // 3
+    headerReader.readBITDOUBLE(CADHeader::USERR4);   // 4
+    headerReader.readBITDOUBLE(CADHeader::USERR5);   // 5
+    headerReader.readBITDOUBLE(CADHeader::CHAMFERA); // 6
+    headerReader.readBITDOUBLE(CADHeader::CHAMFERB); // 7
+    headerReader.readBITDOUBLE(CADHeader::CHAMFERC); // 8
+    headerReader.readBITDOUBLE(CADHeader::CHAMFERD); // 9
+    headerReader.readBITDOUBLE(CADHeader::FACETRES); // 10
+    headerReader.readBITDOUBLE(CADHeader::CMLSCALE); // 11
+    headerReader.readBITDOUBLE(CADHeader::CELTSCALE);// 12
+
+    if( dwgVersion < CADVersions::DWG_R2007 )
+        headerReader.readTV(CADHeader::MENU);
+
+    headerReader.readDateTime(CADHeader::TDCREATE);
+    headerReader.readDateTime(CADHeader::TDUPDATE);
+    if( dwgVersion >= CADVersions::DWG_R2004 )
     {
-        for(char i = 0; i < 19; ++i)
-            skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+        skipBITLONG (pabyBuf, nBitOffsetFromStart); // unknown
+        skipBITLONG (pabyBuf, nBitOffsetFromStart); // unknown
+        skipBITLONG (pabyBuf, nBitOffsetFromStart); // unknown
     }
+    headerReader.readDateTime(CADHeader::TDINDWG);
+    headerReader.readDateTime(CADHeader::TDUSRTIMER);
 
-    header.addValue(CADHeader::LTSCALE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::TEXTSIZE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::TRACEWID, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::SKETCHINC, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::FILLETRAD, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::THICKNESS, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::ANGBASE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::PDSIZE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::PLINEWID, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-
-    if(eOptions == OpenOptions::READ_ALL)
-    {
-        header.addValue(CADHeader::USERR1, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 1
-        header.addValue(CADHeader::USERR2, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 2
-        header.addValue(CADHeader::USERR3, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 3
-        header.addValue(CADHeader::USERR4, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 4
-        header.addValue(CADHeader::USERR5, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 5
-        header.addValue(CADHeader::CHAMFERA, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart)); // 6
-        header.addValue(CADHeader::CHAMFERB, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart)); // 7
-        header.addValue(CADHeader::CHAMFERC, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart)); // 8
-        header.addValue(CADHeader::CHAMFERD, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart)); // 9
-        header.addValue(CADHeader::FACETRES, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart)); // 10
-        header.addValue(CADHeader::CMLSCALE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart)); // 11
-        header.addValue(CADHeader::CELTSCALE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));// 12
-
-        header.addValue(CADHeader::MENU, ReadTV (pabyBuf, nBitOffsetFromStart));
-    }
-    else
-    {
-        for(char i = 0; i < 12; ++i)
-            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-        skipTV (pabyBuf, nBitOffsetFromStart);
-    }
-
-    long juliandate, millisec;
-    juliandate = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    millisec = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::TDCREATE, juliandate, millisec);
-    juliandate = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    millisec = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::TDUPDATE, juliandate, millisec);
-    juliandate = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    millisec = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::TDINDWG, juliandate, millisec);
-    juliandate = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    millisec = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::TDUSRTIMER, juliandate, millisec);
-
-    header.addValue(CADHeader::CECOLOR, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::HANDSEED, ReadHANDLE8BLENGTH (pabyBuf, nBitOffsetFromStart)); // CHECK THIS CASE.
-
-    header.addValue(CADHeader::CLAYER, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::TEXTSTYLE, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::CELTYPE, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMSTYLE, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::CMLSTYLE, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::PSVPSCALE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-    double dX, dY, dZ;
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PINSBASE, dX, dY, dZ);
-
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PEXTMIN, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PEXTMAX, dX, dY, dZ);
-    dX = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PLIMMIN, dX, dY);
-    dX = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PLIMMAX, dX, dY);
-
-    header.addValue(CADHeader::PELEVATION, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));
-
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSORG, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSXDIR, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSYDIR, dX, dY, dZ);
-
-    header.addValue(CADHeader::PUCSNAME, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::PUCSORTHOREF, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::PUCSORTHOVIEW, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::PUCSBASE, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSORGTOP, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSORGBOTTOM, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSORGLEFT, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSORGRIGHT, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSORGFRONT, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::PUCSORGBACK, dX, dY, dZ);
-
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::INSBASE, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::EXTMIN, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::EXTMAX, dX, dY, dZ);
-    dX = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::LIMMIN, dX, dY);
-    dX = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadRAWDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::LIMMAX, dX, dY);
-
-    header.addValue(CADHeader::ELEVATION, ReadBITDOUBLE (pabyBuf,
-                                                         nBitOffsetFromStart));
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSORG, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSXDIR, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSYDIR, dX, dY, dZ);
-
-    header.addValue(CADHeader::UCSNAME, ReadHANDLE (pabyBuf,
-                                                    nBitOffsetFromStart));
-    header.addValue(CADHeader::UCSORTHOREF, ReadHANDLE (pabyBuf,
-                                                        nBitOffsetFromStart));
+    headerReader.readCMC(CADHeader::CECOLOR);
 
-    header.addValue(CADHeader::UCSORTHOVIEW, ReadBITSHORT (pabyBuf,
-                                                           nBitOffsetFromStart));
+    headerReader.readHANDLE8BLENGTH(CADHeader::HANDSEED); // CHECK THIS CASE.
 
-    header.addValue(CADHeader::UCSBASE, ReadHANDLE (pabyBuf,
-                                                    nBitOffsetFromStart));
+    headerReader.readHANDLE(CADHeader::CLAYER);
+    headerReader.readHANDLE(CADHeader::TEXTSTYLE);
+    headerReader.readHANDLE(CADHeader::CELTYPE);
+    if( dwgVersion >= CADVersions::DWG_R2007 )
+        headerReader.skipHANDLE (); // CMATERIAL
+    headerReader.readHANDLE(CADHeader::DIMSTYLE);
+    headerReader.readHANDLE(CADHeader::CMLSTYLE);
 
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSORGTOP, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSORGBOTTOM, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSORGLEFT, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSORGRIGHT, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSORGFRONT, dX, dY, dZ);
-    dX = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dY = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    dZ = ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::UCSORGBACK, dX, dY, dZ);
-
-    if(eOptions == OpenOptions::READ_ALL){
-    header.addValue(CADHeader::DIMPOST, ReadTV (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMAPOST, ReadTV (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMSCALE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart)); // 1
-    header.addValue(CADHeader::DIMASZ, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 2
-    header.addValue(CADHeader::DIMEXO, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 3
-    header.addValue(CADHeader::DIMDLI, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 4
-    header.addValue(CADHeader::DIMEXE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 5
-    header.addValue(CADHeader::DIMRND, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 6
-    header.addValue(CADHeader::DIMDLE, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 7
-    header.addValue(CADHeader::DIMTP, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));    // 8
-    header.addValue(CADHeader::DIMTM, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));    // 9
-
-    header.addValue(CADHeader::DIMTOL, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMLIM, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMTIH, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMTOH, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMSE1, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMSE2, ReadBIT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMTAD, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMZIN, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMAZIN, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMTXT, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 1
-    header.addValue(CADHeader::DIMCEN, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 2
-    header.addValue(CADHeader::DIMTSZ, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 3
-    header.addValue(CADHeader::DIMALTF, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));  // 4
-    header.addValue(CADHeader::DIMLFAC, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));  // 5
-    header.addValue(CADHeader::DIMTVP, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 6
-    header.addValue(CADHeader::DIMTFAC, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));  // 7
-    header.addValue(CADHeader::DIMGAP, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));   // 8
-    header.addValue(CADHeader::DIMALTRND, ReadBITDOUBLE (pabyBuf, nBitOffsetFromStart));// 9
-
-    header.addValue(CADHeader::DIMALT, ReadBIT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMALTD, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMTOFL, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMSAH, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMTIX, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMSOXD, ReadBIT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMCLRD, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 1
-    header.addValue(CADHeader::DIMCLRE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 2
-    header.addValue(CADHeader::DIMCLRT, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 3
-    header.addValue(CADHeader::DIMADEC, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 4
-    header.addValue(CADHeader::DIMDEC, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));    // 5
-    header.addValue(CADHeader::DIMTDEC, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 6
-    header.addValue(CADHeader::DIMALTU, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 7
-    header.addValue(CADHeader::DIMALTTD, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 8
-    header.addValue(CADHeader::DIMAUNIT, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 9
-    header.addValue(CADHeader::DIMFRAC, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 10
-    header.addValue(CADHeader::DIMLUNIT, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 11
-    header.addValue(CADHeader::DIMDSEP, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 12
-    header.addValue(CADHeader::DIMTMOVE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));  // 13
-    header.addValue(CADHeader::DIMJUST, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));   // 14
-
-    header.addValue(CADHeader::DIMSD1, ReadBIT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMSD2, ReadBIT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMTOLJ, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMTZIN, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMALTZ, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMALTTZ, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMUPT, ReadBIT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMATFIT, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMTXSTY, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMLDRBLK, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMBLK, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMBLK1, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMBLK2, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::DIMLWD, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::DIMLWE, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    }
-    else
+    if( dwgVersion >= CADVersions::DWG_R2000 )
+        headerReader.readBITDOUBLE(CADHeader::PSVPSCALE);
+    headerReader.read3BITDOUBLE(CADHeader::PINSBASE);
+
+    headerReader.read3BITDOUBLE(CADHeader::PEXTMIN);
+    headerReader.read3BITDOUBLE(CADHeader::PEXTMAX);
+    headerReader.read2RAWDOUBLE(CADHeader::PLIMMIN);
+    headerReader.read2RAWDOUBLE(CADHeader::PLIMMAX);
+
+    headerReader.readBITDOUBLE(CADHeader::PELEVATION);
+
+    headerReader.read3BITDOUBLE(CADHeader::PUCSORG);
+    headerReader.read3BITDOUBLE(CADHeader::PUCSXDIR);
+    headerReader.read3BITDOUBLE(CADHeader::PUCSYDIR);
+
+    headerReader.readHANDLE(CADHeader::PUCSNAME);
+    if( dwgVersion >= CADVersions::DWG_R2000 )
     {
-        skipTV(pabyBuf, nBitOffsetFromStart);
-        skipTV(pabyBuf, nBitOffsetFromStart);
+        headerReader.readHANDLE(CADHeader::PUCSORTHOREF);
 
-        for(char i = 0; i < 9; ++i)
-            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+        headerReader.readBITSHORT(CADHeader::PUCSORTHOVIEW);
+        headerReader.readHANDLE(CADHeader::PUCSBASE);
 
-        nBitOffsetFromStart += 6;
+        headerReader.read3BITDOUBLE(CADHeader::PUCSORGTOP);
+        headerReader.read3BITDOUBLE(CADHeader::PUCSORGBOTTOM);
+        headerReader.read3BITDOUBLE(CADHeader::PUCSORGLEFT);
+        headerReader.read3BITDOUBLE(CADHeader::PUCSORGRIGHT);
+        headerReader.read3BITDOUBLE(CADHeader::PUCSORGFRONT);
+        headerReader.read3BITDOUBLE(CADHeader::PUCSORGBACK);
+    }
 
-        for(char i = 0; i < 3; ++i)
-            skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+    headerReader.read3BITDOUBLE(CADHeader::INSBASE);
+    headerReader.read3BITDOUBLE(CADHeader::EXTMIN);
+    headerReader.read3BITDOUBLE(CADHeader::EXTMAX);
+    headerReader.read2RAWDOUBLE(CADHeader::LIMMIN);
+    headerReader.read2RAWDOUBLE(CADHeader::LIMMAX);
 
-        for(char i = 0; i < 9; ++i)
-            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+    headerReader.readBITDOUBLE(CADHeader::ELEVATION);
+    headerReader.read3BITDOUBLE(CADHeader::UCSORG);
+    headerReader.read3BITDOUBLE(CADHeader::UCSXDIR);
+    headerReader.read3BITDOUBLE(CADHeader::UCSYDIR);
 
-        nBitOffsetFromStart++;
+    headerReader.readHANDLE(CADHeader::UCSNAME);
+    if( dwgVersion >= CADVersions::DWG_R2000 )
+    {
+        headerReader.readHANDLE(CADHeader::UCSORTHOREF);
 
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+        headerReader.readBITSHORT(CADHeader::UCSORTHOVIEW);
 
-        nBitOffsetFromStart += 4;
+        headerReader.readHANDLE(CADHeader::UCSBASE);
 
-        for(char i = 0; i < 14; ++i)
-            skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+        headerReader.read3BITDOUBLE(CADHeader::UCSORGTOP);
+        headerReader.read3BITDOUBLE(CADHeader::UCSORGBOTTOM);
+        headerReader.read3BITDOUBLE(CADHeader::UCSORGLEFT);
+        headerReader.read3BITDOUBLE(CADHeader::UCSORGRIGHT);
+        headerReader.read3BITDOUBLE(CADHeader::UCSORGFRONT);
+        headerReader.read3BITDOUBLE(CADHeader::UCSORGBACK);
 
-        nBitOffsetFromStart += 2;
+        headerReader.readTV(CADHeader::DIMPOST);
+        headerReader.readTV(CADHeader::DIMAPOST);
+    }
+    else
+    {
+        // R13-R14 dimension variables are stored in a different order
+        headerReader.readBIT(CADHeader::DIMTOL);
+        headerReader.readBIT(CADHeader::DIMLIM);
+        headerReader.readBIT(CADHeader::DIMTIH);
+        headerReader.readBIT(CADHeader::DIMTOH);
+        headerReader.readBIT(CADHeader::DIMSE1);
+        headerReader.readBIT(CADHeader::DIMSE2);
+        headerReader.readBIT(CADHeader::DIMALT);
+        headerReader.readBIT(CADHeader::DIMTOFL);
+        headerReader.readBIT(CADHeader::DIMSAH);
+        headerReader.readBIT(CADHeader::DIMTIX);
+        headerReader.readBIT(CADHeader::DIMSOXD);
+        headerReader.readCHAR(CADHeader::DIMALTD);
+        headerReader.readCHAR(CADHeader::DIMZIN);
+        headerReader.readBIT(CADHeader::DIMSD1);
+        headerReader.readBIT(CADHeader::DIMSD2);
+        headerReader.readCHAR(CADHeader::DIMTOLJ);
+        headerReader.readCHAR(CADHeader::DIMJUST);
+        nBitOffsetFromStart += 8;                    // DIMFIT
+        headerReader.readBIT(CADHeader::DIMUPT);
+        headerReader.readCHAR(CADHeader::DIMTZIN);
+        headerReader.readCHAR(CADHeader::DIMALTZ);
+        headerReader.readCHAR(CADHeader::DIMALTTZ);
+        headerReader.readCHAR(CADHeader::DIMTAD);
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart); // DIMUNIT
+        headerReader.readBITSHORT(CADHeader::DIMAUNIT);
+        headerReader.readBITSHORT(CADHeader::DIMDEC);
+        headerReader.readBITSHORT(CADHeader::DIMTDEC);
+        headerReader.readBITSHORT(CADHeader::DIMALTU);
+        headerReader.readBITSHORT(CADHeader::DIMALTTD);
+        headerReader.readHANDLE(CADHeader::DIMTXSTY);
+    }
 
-        for(char i = 0; i < 4; ++i)
-            skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+    headerReader.readBITDOUBLE(CADHeader::DIMSCALE); // 1
+    headerReader.readBITDOUBLE(CADHeader::DIMASZ);   // 2
+    headerReader.readBITDOUBLE(CADHeader::DIMEXO);   // 3
+    headerReader.readBITDOUBLE(CADHeader::DIMDLI);   // 4
+    headerReader.readBITDOUBLE(CADHeader::DIMEXE);   // 5
+    headerReader.readBITDOUBLE(CADHeader::DIMRND);   // 6
+    headerReader.readBITDOUBLE(CADHeader::DIMDLE);   // 7
+    headerReader.readBITDOUBLE(CADHeader::DIMTP);    // 8
+    headerReader.readBITDOUBLE(CADHeader::DIMTM);    // 9
+    if( dwgVersion >= CADVersions::DWG_R2007 )
+    {
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // DIMFXL
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // DIMJOGANG
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart);  // DIMTFILL
+        ReadCMC (pabyBuf, nBitOffsetFromStart, dwgVersion); // DIMTFILLCLR
+    }
+
+    if( dwgVersion >= CADVersions::DWG_R2000 )
+    {
+        headerReader.readBIT(CADHeader::DIMTOL);
+        headerReader.readBIT(CADHeader::DIMLIM);
+        headerReader.readBIT(CADHeader::DIMTIH);
+        headerReader.readBIT(CADHeader::DIMTOH);
+        headerReader.readBIT(CADHeader::DIMSE1);
+        headerReader.readBIT(CADHeader::DIMSE2);
+
+        headerReader.readBITSHORT(CADHeader::DIMTAD);
+        headerReader.readBITSHORT(CADHeader::DIMZIN);
+        headerReader.readBITSHORT(CADHeader::DIMAZIN);
+    }
+    if( dwgVersion >= CADVersions::DWG_R2007 )
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart); // DIMARCSYM
+
+    headerReader.readBITDOUBLE(CADHeader::DIMTXT);   // 1
+    headerReader.readBITDOUBLE(CADHeader::DIMCEN);   // 2
+    headerReader.readBITDOUBLE(CADHeader::DIMTSZ);   // 3
+    headerReader.readBITDOUBLE(CADHeader::DIMALTF);  // 4
+    headerReader.readBITDOUBLE(CADHeader::DIMLFAC);  // 5
+    headerReader.readBITDOUBLE(CADHeader::DIMTVP);   // 6
+    headerReader.readBITDOUBLE(CADHeader::DIMTFAC);  // 7
+    headerReader.readBITDOUBLE(CADHeader::DIMGAP);   // 8
+    if( dwgVersion < CADVersions::DWG_R2000 )
+    {
+        headerReader.readTV(CADHeader::DIMPOST);
+        headerReader.readTV(CADHeader::DIMAPOST);
+        headerReader.readTV(CADHeader::DIMBLK);
+        headerReader.readTV(CADHeader::DIMBLK1);
+        headerReader.readTV(CADHeader::DIMBLK2);
+    }
+    else
+    {
+        headerReader.readBITDOUBLE(CADHeader::DIMALTRND);// 9
+
+        headerReader.readBIT(CADHeader::DIMALT);
 
-        nBitOffsetFromStart++;
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+        headerReader.readBITSHORT(CADHeader::DIMALTD);
+
+        headerReader.readBIT(CADHeader::DIMTOFL);
+        headerReader.readBIT(CADHeader::DIMSAH);
+        headerReader.readBIT(CADHeader::DIMTIX);
+        headerReader.readBIT(CADHeader::DIMSOXD);
+    }
 
-        for(char i = 0; i < 5; ++i)
-            skipHANDLE (pabyBuf, nBitOffsetFromStart);
+    headerReader.readCMC(CADHeader::DIMCLRD);        // 1
+    headerReader.readCMC(CADHeader::DIMCLRE);        // 2
+    headerReader.readCMC(CADHeader::DIMCLRT);        // 3
+    if( dwgVersion >= CADVersions::DWG_R2000 )
+    {
+        headerReader.readBITSHORT(CADHeader::DIMADEC);   // 4
+        headerReader.readBITSHORT(CADHeader::DIMDEC);    // 5
+        headerReader.readBITSHORT(CADHeader::DIMTDEC);   // 6
+        headerReader.readBITSHORT(CADHeader::DIMALTU);   // 7
+        headerReader.readBITSHORT(CADHeader::DIMALTTD);  // 8
+        headerReader.readBITSHORT(CADHeader::DIMAUNIT);  // 9
+        headerReader.readBITSHORT(CADHeader::DIMFRAC);   // 10
+        headerReader.readBITSHORT(CADHeader::DIMLUNIT);  // 11
+        headerReader.readBITSHORT(CADHeader::DIMDSEP);   // 12
+        headerReader.readBITSHORT(CADHeader::DIMTMOVE);  // 13
+        headerReader.readBITSHORT(CADHeader::DIMJUST);   // 14
+
+        headerReader.readBIT(CADHeader::DIMSD1);
+        headerReader.readBIT(CADHeader::DIMSD2);
+
+        headerReader.readBITSHORT(CADHeader::DIMTOLJ);
+        headerReader.readBITSHORT(CADHeader::DIMTZIN);
+        headerReader.readBITSHORT(CADHeader::DIMALTZ);
+        headerReader.readBITSHORT(CADHeader::DIMALTTZ);
+
+        headerReader.readBIT(CADHeader::DIMUPT);
+
+        headerReader.readBITSHORT(CADHeader::DIMATFIT);
+        if( dwgVersion >= CADVersions::DWG_R2007 )
+            skipBIT (pabyBuf, nBitOffsetFromStart); // DIMFXLON
+
+        headerReader.readHANDLE(CADHeader::DIMTXSTY);
+        headerReader.readHANDLE(CADHeader::DIMLDRBLK);
+        headerReader.readHANDLE(CADHeader::DIMBLK);
+        headerReader.readHANDLE(CADHeader::DIMBLK1);
+        headerReader.readHANDLE(CADHeader::DIMBLK2);
+        if( dwgVersion >= CADVersions::DWG_R2007 )
+        {
+            headerReader.skipHANDLE (); // DIMLTYPE
+            headerReader.skipHANDLE (); // DIMLTEX1
+            headerReader.skipHANDLE (); // DIMLTEX2
+        }
 
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+        headerReader.readBITSHORT(CADHeader::DIMLWD);
+        headerReader.readBITSHORT(CADHeader::DIMLWE);
     }
 
-    CADHandle stBlocksTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stBlocksTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::BlocksTable, stBlocksTable);
 
-    CADHandle stLayersTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stLayersTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::LayersTable, stLayersTable);
 
-    CADHandle stStyleTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stStyleTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::StyleTable, stStyleTable);
 
-    CADHandle stLineTypesTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stLineTypesTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::LineTypesTable, stLineTypesTable);
 
-    CADHandle stViewTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stViewTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::ViewTable, stViewTable);
 
-    CADHandle stUCSTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stUCSTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::UCSTable, stUCSTable);
 
-    CADHandle stViewportTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stViewportTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::ViewportTable, stViewportTable);
 
-    CADHandle stAPPIDTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stAPPIDTable = headerReader.readHANDLE ();
     tables.addTable (CADTables::APPIDTable, stAPPIDTable);
 
-    if(eOptions == OpenOptions::READ_ALL)
-    {
-        header.addValue(CADHeader::DIMSTYLE, ReadHANDLE (pabyBuf,
-                                                        nBitOffsetFromStart));
-    }
-    else
+    headerReader.readHANDLE(CADHeader::DIMSTYLE);
+
+    if( dwgVersion < CADVersions::DWG_R2004 )
     {
-        skipHANDLE (pabyBuf, nBitOffsetFromStart);
+        CADHandle stEntityTable = headerReader.readHANDLE ();
+        tables.addTable (CADTables::EntityTable, stEntityTable);
     }
 
-    CADHandle stEntityTable = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
-    tables.addTable (CADTables::EntityTable, stEntityTable);
-
-    CADHandle stACADGroupDict = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stACADGroupDict = headerReader.readHANDLE ();
     tables.addTable (CADTables::ACADGroupDict, stACADGroupDict);
 
-    CADHandle stACADMLineStyleDict = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stACADMLineStyleDict = headerReader.readHANDLE ();
     tables.addTable (CADTables::ACADMLineStyleDict, stACADMLineStyleDict);
 
-    CADHandle stNamedObjectsDict = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stNamedObjectsDict = headerReader.readHANDLE ();
     tables.addTable (CADTables::NamedObjectsDict, stNamedObjectsDict);
 
-    if(eOptions == OpenOptions::READ_ALL)
+    if( dwgVersion >= CADVersions::DWG_R2000 )
     {
-        header.addValue(CADHeader::TSTACKALIGN, ReadBITSHORT (pabyBuf,
-                                                        nBitOffsetFromStart));
-        header.addValue(CADHeader::TSTACKSIZE, ReadBITSHORT (pabyBuf,
-                                                        nBitOffsetFromStart));
-    }
-    else{
-       skipBITSHORT (pabyBuf, nBitOffsetFromStart);
-       skipBITSHORT (pabyBuf, nBitOffsetFromStart);
-    }
-    header.addValue(CADHeader::HYPERLINKBASE, ReadTV (pabyBuf,
-                                                         nBitOffsetFromStart));
-    header.addValue(CADHeader::STYLESHEET, ReadTV (pabyBuf,
-                                                      nBitOffsetFromStart));
+        headerReader.readBITSHORT(CADHeader::TSTACKALIGN);
+        headerReader.readBITSHORT(CADHeader::TSTACKSIZE);
+        headerReader.readTV(CADHeader::HYPERLINKBASE);
+        headerReader.readTV(CADHeader::STYLESHEET);
 
-    CADHandle stLayoutsDict = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
-    tables.addTable (CADTables::LayoutsDict, stLayoutsDict);
+        CADHandle stLayoutsDict = headerReader.readHANDLE ();
+        tables.addTable (CADTables::LayoutsDict, stLayoutsDict);
 
-    CADHandle stPlotSettingsDict = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
-    tables.addTable (CADTables::PlotSettingsDict, stPlotSettingsDict);
+        CADHandle stPlotSettingsDict = headerReader.readHANDLE ();
+        tables.addTable (CADTables::PlotSettingsDict, stPlotSettingsDict);
 
-    CADHandle stPlotStylesDict = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
-    tables.addTable (CADTables::PlotStylesDict, stPlotStylesDict);
+        CADHandle stPlotStylesDict = headerReader.readHANDLE ();
+        tables.addTable (CADTables::PlotStylesDict, stPlotStylesDict);
+
+        if( dwgVersion >= CADVersions::DWG_R2004 )
+        {
+            headerReader.skipHANDLE (); // DICTIONARY (MATERIALS)
+            headerReader.skipHANDLE (); // DICTIONARY (COLORS)
+        }
+        if( dwgVersion >= CADVersions::DWG_R2007 )
+            headerReader.skipHANDLE (); // DICTIONARY (VISUALSTYLE)
 
-    if(eOptions == OpenOptions::READ_ALL)
-    {
         int Flags = ReadBITLONG (pabyBuf, nBitOffsetFromStart);
-        header.addValue(CADHeader::CELWEIGHT, Flags & 0x001F);
-        header.addValue(CADHeader::ENDCAPS, static_cast<bool>(Flags & 0x0060));
-        header.addValue(CADHeader::JOINSTYLE, static_cast<bool>(Flags & 0x0180));
-        header.addValue(CADHeader::LWDISPLAY, static_cast<bool>(!(Flags & 0x0200)));
-        header.addValue(CADHeader::XEDIT, static_cast<bool>(!(Flags & 0x0400)));
-        header.addValue(CADHeader::EXTNAMES, static_cast<bool>(Flags & 0x0800));
-        header.addValue(CADHeader::PSTYLEMODE, static_cast<bool>(Flags & 0x2000));
-        header.addValue(CADHeader::OLESTARTUP, static_cast<bool>(Flags & 0x4000));
+        if(headerReader.isWanted (CADHeader::CELWEIGHT))
+            header.addValue(CADHeader::CELWEIGHT, Flags & 0x001F);
+        if(headerReader.isWanted (CADHeader::ENDCAPS))
+            header.addValue(CADHeader::ENDCAPS, static_cast<bool>(Flags & 0x0060));
+        if(headerReader.isWanted (CADHeader::JOINSTYLE))
+            header.addValue(CADHeader::JOINSTYLE, static_cast<bool>(Flags & 0x0180));
+        if(headerReader.isWanted (CADHeader::LWDISPLAY))
+            header.addValue(CADHeader::LWDISPLAY, static_cast<bool>(!(Flags & 0x0200)));
+        if(headerReader.isWanted (CADHeader::XEDIT))
+            header.addValue(CADHeader::XEDIT, static_cast<bool>(!(Flags & 0x0400)));
+        if(headerReader.isWanted (CADHeader::EXTNAMES))
+            header.addValue(CADHeader::EXTNAMES, static_cast<bool>(Flags & 0x0800));
+        if(headerReader.isWanted (CADHeader::PSTYLEMODE))
+            header.addValue(CADHeader::PSTYLEMODE, static_cast<bool>(Flags & 0x2000));
+        if(headerReader.isWanted (CADHeader::OLESTARTUP))
+            header.addValue(CADHeader::OLESTARTUP, static_cast<bool>(Flags & 0x4000));
+
+        headerReader.readBITSHORT(CADHeader::INSUNITS);
+        // CEPSNTYPE is always decoded as it tells if CEPSNID is present
+        short nCEPSNTYPE = ReadBITSHORT (pabyBuf, nBitOffsetFromStart);
+        if(headerReader.isWanted (CADHeader::CEPSNTYPE))
+            header.addValue(CADHeader::CEPSNTYPE, nCEPSNTYPE);
+
+        if ( nCEPSNTYPE == 3 )
+            headerReader.readHANDLE(CADHeader::CEPSNID);
+
+        headerReader.readTV(CADHeader::FINGERPRINTGUID);
+        headerReader.readTV(CADHeader::VERSIONGUID);
     }
-    else
+
+    if( dwgVersion >= CADVersions::DWG_R2004 )
     {
-        skipBITLONG (pabyBuf, nBitOffsetFromStart);
+        headerReader.readCHAR(CADHeader::SORTENTS);
+        headerReader.readCHAR(CADHeader::INDEXCTL);
+        headerReader.readCHAR(CADHeader::HIDETEXT);
+        headerReader.readCHAR(CADHeader::XCLIPFRAME);
+        headerReader.readCHAR(CADHeader::DIMASSOC);
+        headerReader.readCHAR(CADHeader::HALOGAP);
+        headerReader.readBITSHORT(CADHeader::OBSCOLOR);
+        headerReader.readBITSHORT(CADHeader::INTERSECTIONCOLOR);
+        headerReader.readCHAR(CADHeader::OBSLTYPE);
+        headerReader.readCHAR(CADHeader::INTERSECTIONDISPLAY);
+        headerReader.readTV(CADHeader::PROJECTNAME);
     }
 
-    header.addValue(CADHeader::INSUNITS, ReadBITSHORT (pabyBuf,
-                                                       nBitOffsetFromStart));
-    short nCEPSNTYPE = ReadBITSHORT (pabyBuf, nBitOffsetFromStart);
-    header.addValue(CADHeader::CEPSNTYPE, nCEPSNTYPE);
-
-    if ( nCEPSNTYPE == 3 )
-        header.addValue(CADHeader::CEPSNID, ReadHANDLE (pabyBuf, nBitOffsetFromStart));
-
-    header.addValue(CADHeader::FINGERPRINTGUID, ReadTV (pabyBuf, nBitOffsetFromStart));
-    header.addValue(CADHeader::VERSIONGUID, ReadTV (pabyBuf, nBitOffsetFromStart));
-
-    CADHandle stBlockRecordPaperSpace = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stBlockRecordPaperSpace = headerReader.readHANDLE ();
     tables.addTable (CADTables::BlockRecordPaperSpace,
                         stBlockRecordPaperSpace);
     // TODO: is this part of the header?
-    CADHandle stBlockRecordModelSpace = ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    CADHandle stBlockRecordModelSpace = headerReader.readHANDLE ();
     tables.addTable (CADTables::BlockRecordModelSpace, stBlockRecordModelSpace);
 
-    if(eOptions == OpenOptions::READ_ALL)
-    {
-        // Is this part of the header?
+    // Is this part of the header?
 
-        /*CADHandle LTYPE_BYLAYER = */ReadHANDLE (pabyBuf, nBitOffsetFromStart);
-        /*CADHandle LTYPE_BYBLOCK = */ReadHANDLE (pabyBuf, nBitOffsetFromStart);
-        /*CADHandle LTYPE_CONTINUOUS = */ReadHANDLE (pabyBuf, nBitOffsetFromStart);
+    headerReader.skipHANDLE (); // LTYPE_BYLAYER
+    headerReader.skipHANDLE (); // LTYPE_BYBLOCK
+    headerReader.skipHANDLE (); // LTYPE_CONTINUOUS
 
-        header.addValue(UNKNOWN11, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN12, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN13, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-        header.addValue(UNKNOWN14, ReadBITSHORT (pabyBuf, nBitOffsetFromStart));
-    }
-    else
+    if( dwgVersion >= CADVersions::DWG_R2007 )
     {
-        skipHANDLE (pabyBuf, nBitOffsetFromStart);
-        skipHANDLE (pabyBuf, nBitOffsetFromStart);
-        skipHANDLE (pabyBuf, nBitOffsetFromStart);
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
-        skipBITSHORT (pabyBuf, nBitOffsetFromStart);
+        skipBIT (pabyBuf, nBitOffsetFromStart);       // CAMERADISPLAY
+        skipBITLONG (pabyBuf, nBitOffsetFromStart);   // unknown
+        skipBITLONG (pabyBuf, nBitOffsetFromStart);   // unknown
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // unknown
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // STEPSPERSEC
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // STEPSIZE
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // 3DDWFPREC
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // LENSLENGTH
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // CAMERAHEIGHT
+        nBitOffsetFromStart += 16;                    // SOLIDHIST, SHOWHIST
+        // PSOLWIDTH, PSOLHEIGHT, LOFTANG1, LOFTANG2, LOFTMAG1, LOFTMAG2
+        for( int i = 0; i < 6; ++i )
+            skipBITDOUBLE (pabyBuf, nBitOffsetFromStart);
+        skipBITSHORT (pabyBuf, nBitOffsetFromStart);  // LOFTPARAM
+        nBitOffsetFromStart += 8;                     // LOFTNORMALS
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // LATITUDE
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // LONGITUDE
+        skipBITDOUBLE (pabyBuf, nBitOffsetFromStart); // NORTHDIRECTION
+        skipBITLONG (pabyBuf, nBitOffsetFromStart);   // TIMEZONE
+        // LIGHTGLYPHDISPLAY, TILEMODELIGHTSYNCH, DWFFRAME, DGNFRAME
+        nBitOffsetFromStart += 32;
+        skipBIT (pabyBuf, nBitOffsetFromStart);       // REALWORLDSCALE
+        headerReader.readCMC(CADHeader::INTERFERECOLOR);
+        headerReader.readHANDLE(CADHeader::INTERFEREOBJVS);
+        headerReader.readHANDLE(CADHeader::INTERFEREVPVS);
+        headerReader.readHANDLE(CADHeader::DRAGVS);
+        headerReader.readCHAR(CADHeader::CSHADOW);
+        headerReader.readBITDOUBLE(CADHeader::SHADOWPLANELOCATION);
     }
 
+    headerReader.readBITSHORT(UNKNOWN11);
+    headerReader.readBITSHORT(UNKNOWN12);
+    headerReader.readBITSHORT(UNKNOWN13);
+    headerReader.readBITSHORT(UNKNOWN14);
+
     /*short nCRC =*/ ReadRAWSHORT (pabyBuf, nBitOffsetFromStart);
     unsigned short initial = 0xC0C1;
     /*short calculated_crc = */ CalculateCRC8 (initial, pabyBuf,
@@ -641,8 +942,8 @@ int DWGFileR2000::readHeader (OpenOptions eOptions)
 
 
     int returnCode = CADErrorCodes::SUCCESS;
-    fileIO->Read (pabyBuf, DWGSentinelLength);
-    if ( memcmp (pabyBuf, DWGHeaderVariablesEnd, DWGSentinelLength) )
+    if ( memcmp (sectionData.data () + nSectionOffset, DWGHeaderVariablesEnd,
+                 DWGSentinelLength) )
     {
         DebugMsg("File is corrupted (HEADERVARS section ending sentinel "
                  "doesnt match.)");
@@ -659,14 +960,13 @@ int DWGFileR2000::readClasses (enum OpenOptions eOptions)
 {
     if(eOptions == OpenOptions::READ_ALL || eOptions == OpenOptions::READ_FAST ){
         char    *pabySectionContent;
-        char    buffer[255];
-        size_t dSectionSize = 0;
+        unsigned int dSectionSize = 0;
         size_t nBitOffsetFromStart = 0;
 
-        fileIO->Seek (sectionLocatorRecords[1].dSeeker, CADFileIO::SeekOrigin::BEG);
-
-        fileIO->Read (buffer, DWGSentinelLength);
-        if ( memcmp (buffer, DWGDSClassesStart, DWGSentinelLength) )
+        vector<char> sectionData;
+        if( readSectionData (1, sectionData) != CADErrorCodes::SUCCESS ||
+            sectionData.size () < DWGSentinelLength + 4 ||
+            memcmp (sectionData.data (), DWGDSClassesStart, DWGSentinelLength) )
         {
             cerr << "File is corrupted (wrong pointer to CLASSES section,"
                     "or CLASSES starting sentinel corrupted.)\n";
@@ -674,38 +974,83 @@ int DWGFileR2000::readClasses (enum OpenOptions eOptions)
             return CADErrorCodes::CLASSES_SECTION_READ_FAILED;
         }
 
-        fileIO->Read (&dSectionSize, 4);
+        memcpy (&dSectionSize, sectionData.data () + DWGSentinelLength, 4);
         DebugMsg ("Classes section length: %d\n", dSectionSize);
+        size_t nSectionOffset = DWGSentinelLength + 4;
+        if( sectionData.size () < nSectionOffset + dSectionSize + 2 +
+                                  DWGSentinelLength )
+            return CADErrorCodes::CLASSES_SECTION_READ_FAILED;
 
         pabySectionContent = new char[dSectionSize + 4];
-        fileIO->Read (pabySectionContent, dSectionSize);
+        memcpy (pabySectionContent, sectionData.data () + nSectionOffset,
+                dSectionSize);
+        nSectionOffset += dSectionSize;
+
+        // R2007+ data is followed by the string stream
+        DWGStringStream stClassesStrings;
+        if( dwgVersion >= CADVersions::DWG_R2007 )
+        {
+            size_t nSizeInBits = static_cast<unsigned int>(ReadRAWLONG (
+                                    pabySectionContent, nBitOffsetFromStart));
+            size_t nStringsOffset = 0;
+            if( nSizeInBits <= size_t(dSectionSize) * 8 &&
+                FindStringStream (pabySectionContent, nBitOffsetFromStart,
+                                  nSizeInBits, nStringsOffset) )
+            {
+                stClassesStrings.pabyInput = pabySectionContent;
+                stClassesStrings.nBitOffset = nStringsOffset;
+            }
+        }
+        DWGStringStreamScope stringsScope(dwgVersion >= CADVersions::DWG_R2007 ?
+                                          &stClassesStrings : nullptr);
 
-        while ( ( nBitOffsetFromStart / 8 ) + 1 < dSectionSize )
+        // R2004+ section tells the classes count, the end is found by the
+        // size before
+        size_t nClassesCount = std::numeric_limits<size_t>::max ();
+        if( dwgVersion >= CADVersions::DWG_R2004 )
+        {
+            short dMaxClassNum = ReadBITSHORT (pabySectionContent,
+                                               nBitOffsetFromStart);
+            nClassesCount = dMaxClassNum >= 500 ? size_t(dMaxClassNum - 499) : 0;
+            nBitOffsetFromStart += 16; // two zero RC
+            skipBIT (pabySectionContent, nBitOffsetFromStart);
+        }
+
+        for ( size_t i = 0; i < nClassesCount &&
+                            ( nBitOffsetFromStart / 8 ) + 1 < dSectionSize; ++i )
         {
             CADClass stClass;
             stClass.dClassNum = ReadBITSHORT (pabySectionContent,
                                               nBitOffsetFromStart);
             stClass.dProxyCapFlag = ReadBITSHORT (pabySectionContent,
                                                 nBitOffsetFromStart);
-            stClass.sApplicationName = ReadTV (pabySectionContent,
+            stClass.sApplicationName = ReadText (pabySectionContent,
+                                                 nBitOffsetFromStart);
+            stClass.sCppClassName = ReadText (pabySectionContent,
+                                              nBitOffsetFromStart);
+            stClass.sDXFRecordName = ReadText (pabySectionContent,
                                                nBitOffsetFromStart);
-            stClass.sCppClassName = ReadTV (pabySectionContent,
-                                            nBitOffsetFromStart);
-            stClass.sDXFRecordName = ReadTV (pabySectionContent,
-                                             nBitOffsetFromStart);
             stClass.bWasZombie = ReadBIT (pabySectionContent, nBitOffsetFromStart);
             stClass.bIsEntity  = ReadBITSHORT (pabySectionContent,
                                         nBitOffsetFromStart) == 0x1F2 ? true : false;
+            if( dwgVersion >= CADVersions::DWG_R2004 )
+            {
+                skipBITLONG (pabySectionContent, nBitOffsetFromStart); // instances count
+                skipBITSHORT (pabySectionContent, nBitOffsetFromStart); // DWG version
+                skipBITSHORT (pabySectionContent, nBitOffsetFromStart); // maintenance version
+                skipBITLONG (pabySectionContent, nBitOffsetFromStart);
+                skipBITLONG (pabySectionContent, nBitOffsetFromStart);
+            }
 
             classes.addClass (stClass);
         }
 
         delete [] pabySectionContent;
 
-        fileIO->Read (buffer, 2); // CLASSES CRC!. TODO: add CRC computing & checking feature.
+        nSectionOffset += 2; // CLASSES CRC!. TODO: add CRC computing & checking feature.
 
-        fileIO->Read (buffer, DWGSentinelLength);
-        if ( memcmp (buffer, DWGDSClassesEnd, DWGSentinelLength) )
+        if ( memcmp (sectionData.data () + nSectionOffset, DWGDSClassesEnd,
+                     DWGSentinelLength) )
         {
             cerr << "File is corrupted (CLASSES section ending sentinel "
                          "doesnt match.)\n";
@@ -731,29 +1076,36 @@ int DWGFileR2000::createFileMap ()
 
     objectsMap.clear ();
 
-    // seek to the begining of the objects map
-    fileIO->Seek (sectionLocatorRecords[2].dSeeker, CADFileIO::SeekOrigin::BEG);
+    vector<char> sectionData;
+    if( readSectionData (2, sectionData) != CADErrorCodes::SUCCESS )
+        return CADErrorCodes::OBJECTS_SECTION_READ_FAILED;
 
-    while ( true )
+    size_t nSectionOffset = 0;
+    while ( nSectionOffset + 2 <= sectionData.size () )
     {
         dSectionSize = 0;
 
         // read section size
-        fileIO->Read (&dSectionSize, 2);
+        memcpy (&dSectionSize, sectionData.data () + nSectionOffset, 2);
         SwapEndianness (dSectionSize, sizeof (dSectionSize));
+        nSectionOffset += 2;
 
         DebugMsg ("Object map section #%d size: %d\n", ++nSection,
                   dSectionSize);
 
-        if ( dSectionSize == 2 )
+        if ( dSectionSize <= 2 )
             break; // last section is empty.
+        if ( nSectionOffset + dSectionSize > sectionData.size () )
+            return CADErrorCodes::OBJECTS_SECTION_READ_FAILED;
 
         pabySectionContent = new char[dSectionSize + 4];
         nBitOffsetFromStart = 0;
         nRecordsInSection = 0;
 
         // read section data
-        fileIO->Read (pabySectionContent, dSectionSize);
+        memcpy (pabySectionContent, sectionData.data () + nSectionOffset,
+                dSectionSize);
+        nSectionOffset += dSectionSize;
 
         while ( ( nBitOffsetFromStart / 8 ) < ( dSectionSize - 2 ) )
         {
@@ -786,277 +1138,428 @@ int DWGFileR2000::createFileMap ()
     return CADErrorCodes::SUCCESS;
 }
 
+CADObject * DWGFileR2000::getObject (long index, bool bHandlesOnly)
+{
+    return (this->*objectReader)(index, bHandlesOnly);
+}
+
+DWGFileR2000::ObjectReader DWGFileR2000::getObjectReader(int nVersion)
+{
+    switch( nVersion )
+    {
+        case CADVersions::DWG_R13:
+            return &DWGFileR2000::readObject<DWGR13Traits>;
+        case CADVersions::DWG_R14:
+            return &DWGFileR2000::readObject<DWGR14Traits>;
+        case CADVersions::DWG_R2004:
+            return &DWGFileR2000::readObject<DWGR2004Traits>;
+        case CADVersions::DWG_R2007:
+            return &DWGFileR2000::readObject<DWGR2007Traits>;
+        default:
+            return &DWGFileR2000::readObject<DWGR2000Traits>;
+    }
+}
+
 //TODO: fast extracting handles/CED works for entities,
 //can we implement same capability for non-entities?
-CADObject * DWGFileR2000::getObject (long index, bool bHandlesOnly)
+template<class Traits>
+CADObject * DWGFileR2000::readObject (long index, bool bHandlesOnly)
 {
     CADObject * readed_object = nullptr;
 
-    char pabyObjectSize[8];
+    auto objectOffset = objectsMap.find (index);
+    if( objectOffset == objectsMap.end () )
+        return nullptr;
+
+    char pabyObjectSize[8] = { 0 };
     size_t nBitOffsetFromStart = 0;
-    fileIO->Seek (objectsMap[index], CADFileIO::SeekOrigin::BEG);
-    fileIO->Read (pabyObjectSize, 8);
+    readData (objectOffset->second, pabyObjectSize, 8);
     unsigned int dObjectSize = ReadMSHORT (pabyObjectSize, nBitOffsetFromStart);
 
-    // And read whole data chunk into memory for future parsing.
+    // And read whole data chunk into memory for future parsing, the file in
+    // memory is decoded in place.
     // + nBitOffsetFromStart/8 + 2 is because dObjectSize doesn't cover CRC and itself.
     size_t nSectionSize = dObjectSize + nBitOffsetFromStart/8 + 2;
-    unique_ptr<char[]> sectionContentPtr(new char[nSectionSize + 4]);
-    char* pabySectionContent = sectionContentPtr.get ();
-    fileIO->Seek (objectsMap[index], CADFileIO::SeekOrigin::BEG);
-    fileIO->Read (pabySectionContent, nSectionSize);
+    unique_ptr<char[]> sectionContentPtr;
+    const char* pabySectionContent = mapData (objectOffset->second,
+                                              nSectionSize + 4);
+    if( nullptr == pabySectionContent )
+    {
+        sectionContentPtr.reset (new char[nSectionSize + 4]);
+        if( readData (objectOffset->second, sectionContentPtr.get (),
+                      nSectionSize) != nSectionSize )
+            return nullptr;
+        pabySectionContent = sectionContentPtr.get ();
+    }
 
     nBitOffsetFromStart = 0;
     dObjectSize = ReadMSHORT (pabySectionContent, nBitOffsetFromStart);
-    short dObjectType = ReadBITSHORT (pabySectionContent, nBitOffsetFromStart);
 
-    if(dObjectType >= 500){
-        CADClass cadClass = classes.getClassByNum (dObjectType);
-        if(cadClass.sCppClassName == "AcDbRasterImage"){
-            dObjectType = CADObject::IMAGE;
-        }
-        else if(cadClass.sCppClassName == "AcDbRasterImageDef"){
-            dObjectType = CADObject::IMAGEDEF;
-        }
-        else if(cadClass.sCppClassName == "AcDbRasterImageDefReactor"){
-            dObjectType = CADObject::IMAGEDEFREACTOR;
+    // R2007+ object data is followed by the string stream, the handles start
+    // at the object size in bits. The data and handles are joined, so the
+    // decoders read them one after another as in R2000.
+    DWGStringStream stObjectStrings;
+    unique_ptr<char[]> joinedContentPtr;
+    size_t nJoinedDataSize = 0;
+    if( Traits::hasStringStream )
+    {
+        const size_t nDataStart = nBitOffsetFromStart;
+        size_t nSizeOffset = nDataStart;
+        skipBITSHORT (pabySectionContent, nSizeOffset); // type
+        const size_t nHandlesOffset = nDataStart + static_cast<unsigned int>(
+                    ReadRAWLONG (pabySectionContent, nSizeOffset));
+        const size_t nObjectEnd = nDataStart + size_t(dObjectSize) * 8;
+        if( nHandlesOffset <= nSizeOffset || nHandlesOffset > nObjectEnd )
+            return nullptr;
+
+        size_t nDataEnd = nHandlesOffset - 1;
+        if( FindStringStream (pabySectionContent, nSizeOffset, nHandlesOffset,
+                              nDataEnd) )
+        {
+            stObjectStrings.pabyInput = pabySectionContent;
+            stObjectStrings.nBitOffset = nDataEnd;
         }
+
+        joinedContentPtr.reset (new char[nSectionSize + 4]());
+        CopyBits (pabySectionContent, 0, nDataEnd, joinedContentPtr.get (), 0);
+        CopyBits (pabySectionContent, nHandlesOffset,
+                  nObjectEnd - nHandlesOffset, joinedContentPtr.get (),
+                  nDataEnd);
+        pabySectionContent = joinedContentPtr.get ();
+        nJoinedDataSize = nDataEnd - nDataStart;
     }
+    DWGStringStreamScope stringsScope(Traits::hasStringStream ?
+                                      &stObjectStrings : nullptr);
 
-    // Entities handling
-    if ( isCommonEntityType(dObjectType) )
-    {
-        struct CADCommonED stCommonEntityData; // common for all entities
+    short dObjectType = ReadBITSHORT (pabySectionContent, nBitOffsetFromStart);
 
-        stCommonEntityData.nObjectSizeInBits = ReadRAWLONG (pabySectionContent,
-                                                            nBitOffsetFromStart);
-        stCommonEntityData.hObjectHandle = ReadHANDLE (pabySectionContent,
-                                                       nBitOffsetFromStart);
+    if(dObjectType >= 500)
+        dObjectType = classes.getObjectType (dObjectType);
 
-        short dEEDSize;
-        CADEed dwgEed;
-        while ( (dEEDSize = ReadBITSHORT (pabySectionContent,
-                                          nBitOffsetFromStart)) != 0 )
-        {
-            dwgEed.dLength = dEEDSize;
-            dwgEed.hApplication = ReadHANDLE (pabySectionContent,
-                                              nBitOffsetFromStart);
+    const ObjectDecoders * decoders = getObjectDecoders<Traits> (dObjectType);
+    if(nullptr == decoders)
+        return nullptr;
 
-            for ( short i = 0; i < dEEDSize; ++i )
-            {
-                dwgEed.acData.push_back(ReadCHAR (pabySectionContent,
-                                                  nBitOffsetFromStart));
-            }
+    chrono::steady_clock::time_point decodeStart;
+    if(statisticsEnabled)
+        decodeStart = chrono::steady_clock::now ();
 
-            stCommonEntityData.aEED.push_back (dwgEed);
-        }
+    // Entities handling
+    if ( nullptr != decoders->entity )
+    {
+        struct CADCommonED stCommonEntityData; // common for all entities
 
-        stCommonEntityData.bGraphicsPresented = ReadBIT (pabySectionContent,
-                                                         nBitOffsetFromStart);
-        if(stCommonEntityData.bGraphicsPresented){
-            size_t nGraphicsDataSize = static_cast<size_t>(ReadRAWLONG (
-                                                    pabySectionContent,
-                                                    nBitOffsetFromStart));
-            // skip read graphics data
-            nBitOffsetFromStart += nGraphicsDataSize * 8;
-        }
-        stCommonEntityData.bbEntMode = Read2B (pabySectionContent,
-                                               nBitOffsetFromStart);
-        stCommonEntityData.nNumReactors = ReadBITLONG (pabySectionContent,
-                                                       nBitOffsetFromStart);
-        stCommonEntityData.bNoLinks = ReadBIT (pabySectionContent,
-                                               nBitOffsetFromStart);
-        stCommonEntityData.nCMColor = ReadBITSHORT (pabySectionContent,
-                                                    nBitOffsetFromStart);
-        stCommonEntityData.dfLTypeScale = ReadBITDOUBLE (pabySectionContent,
-                                                         nBitOffsetFromStart);
-        stCommonEntityData.bbLTypeFlags = Read2B (pabySectionContent,
-                                                  nBitOffsetFromStart);
-        stCommonEntityData.bbPlotStyleFlags = Read2B (pabySectionContent,
-                                                      nBitOffsetFromStart);
-        stCommonEntityData.nInvisibility = ReadBITSHORT (pabySectionContent,
-                                                         nBitOffsetFromStart);
-        stCommonEntityData.nLineWeight = ReadCHAR (pabySectionContent,
-                                                   nBitOffsetFromStart);
+        readCommonEntityData<Traits> (stCommonEntityData, pabySectionContent,
+                                      nBitOffsetFromStart);
+        // the joined handles follow the data as in R2000
+        if( Traits::hasStringStream )
+            stCommonEntityData.nObjectSizeInBits =
+                    static_cast<long>(nJoinedDataSize);
 
         // Skip entitity-specific data, we dont need it if bHandlesOnly == true
         if( bHandlesOnly == true )
-        {
-            return getEntity(dObjectType, dObjectSize, stCommonEntityData,
-                             pabySectionContent, nBitOffsetFromStart);
-        }
+            readed_object = getEntity<Traits>(dObjectType, dObjectSize,
+                                      std::move(stCommonEntityData),
+                                      pabySectionContent, nBitOffsetFromStart);
+        else
+            readed_object = decoders->entity(this, dObjectType, dObjectSize,
+                                             std::move(stCommonEntityData),
+                                             pabySectionContent,
+                                             nBitOffsetFromStart);
+    }
+    else
+    {
+        readed_object = decoders->object(this, dObjectSize, pabySectionContent,
+                                         nBitOffsetFromStart);
+    }
 
-        switch ( dObjectType )
-        {
-        case CADObject::BLOCK:
-            return getBlock(dObjectSize, stCommonEntityData,
-                            pabySectionContent, nBitOffsetFromStart);
+    if(statisticsEnabled)
+    {
+        chrono::duration<double> decodeTime = chrono::steady_clock::now () -
+                decodeStart;
+        addStatistics (dObjectType, nSectionSize, decodeTime.count ());
+    }
 
-        case CADObject::ELLIPSE:
-            return getEllipse(dObjectSize, stCommonEntityData,
-                              pabySectionContent, nBitOffsetFromStart);
+    return readed_object;
+}
 
-        case CADObject::MLINE:
-            return getMLine(dObjectSize, stCommonEntityData,
-                            pabySectionContent, nBitOffsetFromStart);
+int DWGFileR2000::getObjectCensus(ObjectCensus &census, bool bLayers)
+{
+    census = ObjectCensus();
 
-        case CADObject::SOLID:
-            return getSolid(dObjectSize, stCommonEntityData,
-                            pabySectionContent, nBitOffsetFromStart);
+    // Visit the objects in the file order, so the reads only go forward
+    vector<long> objectOffsets;
+    objectOffsets.reserve (objectsMap.size ());
+    for( const auto& object : objectsMap )
+        objectOffsets.push_back (object.second);
+    sort (objectOffsets.begin (), objectOffsets.end ());
 
-        case CADObject::POINT:
-            return getPoint(dObjectSize, stCommonEntityData,
-                            pabySectionContent, nBitOffsetFromStart);
+    vector<char> objectData;
+    for( long objectOffset : objectOffsets )
+    {
+        CADEntityObject objectHeader;
+        bool bEntity = false;
+        if( !(this->*objectHeaderReader)(objectOffset, bLayers, objectData,
+                                          objectHeader, bEntity) )
+        {
+            ++census.failed;
+            continue;
+        }
 
-        case CADObject::POLYLINE3D:
-            return getPolyLine3D(dObjectSize, stCommonEntityData,
-                            pabySectionContent, nBitOffsetFromStart);
+        CensusEntry& typeEntry = census.types[objectHeader.getType ()];
+        ++typeEntry.count;
+        typeEntry.bytes += objectHeader.getSize ();
 
-        case CADObject::RAY:
-            return getRay(dObjectSize, stCommonEntityData,
-                            pabySectionContent, nBitOffsetFromStart);
+        if( !bLayers || !bEntity )
+            continue;
 
-        case CADObject::XLINE:
-            return getXLine(dObjectSize, stCommonEntityData,
-                            pabySectionContent, nBitOffsetFromStart);
+        CensusEntry& layerEntry = census.layers[
+                objectHeader.stChed.hLayer.getAsLong (
+                    objectHeader.stCed.hObjectHandle)];
+        ++layerEntry.count;
+        layerEntry.bytes += objectHeader.getSize ();
+    }
 
-        case CADObject::LINE:
-            return getLine(dObjectSize, stCommonEntityData,
-                           pabySectionContent, nBitOffsetFromStart);
+    return CADErrorCodes::SUCCESS;
+}
 
-        case CADObject::TEXT:
-            return getText(dObjectSize, stCommonEntityData,
-                           pabySectionContent, nBitOffsetFromStart);
+CADEntityObject *DWGFileR2000::getEntityHandles(long index)
+{
+    auto objectOffset = objectsMap.find (index);
+    if( objectOffset == objectsMap.end () )
+        return nullptr;
 
-        case CADObject::VERTEX3D:
-            return getVertex3D(dObjectSize, stCommonEntityData,
-                           pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::CIRCLE:
-            return getCircle(dObjectSize, stCommonEntityData,
-                             pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::ENDBLK:
-            return getEndBlock(dObjectSize, stCommonEntityData,
-                               pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::POLYLINE2D:
-            return getPolyline2D(dObjectSize, stCommonEntityData,
-                                 pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::ATTRIB:
-            return getAttributes(dObjectSize, stCommonEntityData,
-                                 pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::ATTDEF:
-            return getAttributesDefn(dObjectSize, stCommonEntityData,
-                                 pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::LWPOLYLINE:
-            return getLWPolyLine(dObjectSize, stCommonEntityData,
-                                 pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::ARC:
-            return getArc(dObjectSize, stCommonEntityData,
-                          pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::SPLINE:
-            return getSpline(dObjectSize, stCommonEntityData,
-                             pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::POLYLINE_PFACE:
-            return getPolylinePFace (dObjectSize, stCommonEntityData,
-                                     pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::IMAGE:
-            return getImage (dObjectSize, stCommonEntityData,
-                             pabySectionContent, nBitOffsetFromStart);
-
-        case CADObject::FACE3D:
-            return get3DFace (dObjectSize, stCommonEntityData,
-                              pabySectionContent, nBitOffsetFromStart);
+    vector<char> objectData;
+    unique_ptr<CADEntityObject> entity(new CADEntityObject());
+    bool bEntity = false;
+    if( !(this->*objectHeaderReader)(objectOffset->second, true, objectData,
+                                      *entity, bEntity) || !bEntity )
+        return nullptr;
+    return entity.release ();
+}
 
-        case CADObject::VERTEX_MESH:
-            return getVertexMesh (dObjectSize, stCommonEntityData,
-                                  pabySectionContent, nBitOffsetFromStart);
+DWGFileR2000::ObjectHeaderReader DWGFileR2000::getObjectHeaderReader(
+        int nVersion)
+{
+    switch( nVersion )
+    {
+        case CADVersions::DWG_R13:
+            return &DWGFileR2000::readObjectHeader<DWGR13Traits>;
+        case CADVersions::DWG_R14:
+            return &DWGFileR2000::readObjectHeader<DWGR14Traits>;
+        case CADVersions::DWG_R2004:
+            return &DWGFileR2000::readObjectHeader<DWGR2004Traits>;
+        case CADVersions::DWG_R2007:
+            return &DWGFileR2000::readObjectHeader<DWGR2007Traits>;
+        default:
+            return &DWGFileR2000::readObjectHeader<DWGR2000Traits>;
+    }
+}
 
-        case CADObject::VERTEX_PFACE:
-            return getVertexPFace (dObjectSize, stCommonEntityData,
-                                   pabySectionContent, nBitOffsetFromStart);
+template<class Traits>
+bool DWGFileR2000::readObjectHeader(long objectOffset, bool bEntityHandles,
+                                    vector<char> &objectData,
+                                    CADEntityObject &objectHeader,
+                                    bool &bEntity)
+{
+    // The MS size and the BS type take 6 bytes at most
+    char pabyObjectStart[8] = { 0 };
+    size_t nBitOffsetFromStart = 0;
+    if( readData (objectOffset, pabyObjectStart, 8) != 8 )
+        return false;
+    unsigned int dObjectSize = ReadMSHORT (pabyObjectStart, nBitOffsetFromStart);
+    const size_t nDataStart = nBitOffsetFromStart;
+    short dObjectType = ReadBITSHORT (pabyObjectStart, nBitOffsetFromStart);
+    // dObjectSize doesn't cover CRC and itself
+    size_t nSectionSize = dObjectSize + nDataStart/8 + 2;
+
+    bEntity = false;
+    if( dObjectType >= 500 )
+    {
+        short dClassType = classes.getObjectType (dObjectType);
+        if( dClassType == dObjectType )
+            bEntity = classes.getClassByNum (dObjectType).bIsEntity;
+        dObjectType = dClassType;
+    }
+    if( !bEntity )
+    {
+        const ObjectDecoders * decoders = getObjectDecoders<Traits> (dObjectType);
+        bEntity = nullptr != decoders && nullptr != decoders->entity;
+    }
 
-        case CADObject::MTEXT:
-            return getMText (dObjectSize, stCommonEntityData,
-                                   pabySectionContent, nBitOffsetFromStart);
+    objectHeader.setType (static_cast<CADObject::ObjectType>(dObjectType));
+    objectHeader.setSize (static_cast<long>(nSectionSize));
+    if( !bEntityHandles || !bEntity )
+        return true;
 
-        case CADObject::DIMENSION_RADIUS:
-        case CADObject::DIMENSION_DIAMETER:
-        case CADObject::DIMENSION_ALIGNED:
-        case CADObject::DIMENSION_ANG_3PT:
-        case CADObject::DIMENSION_ANG_2LN:
-        case CADObject::DIMENSION_ORDINATE:
-        case CADObject::DIMENSION_LINEAR:
-            return getDimension (dObjectType, dObjectSize, stCommonEntityData,
-                                   pabySectionContent, nBitOffsetFromStart);
+    // The handles are at the end of the object, read it whole
+    const char* pabyObject = mapData (objectOffset, nSectionSize + 4);
+    if( nullptr == pabyObject )
+    {
+        objectData.assign (nSectionSize + 4, 0);
+        if( readData (objectOffset, objectData.data (), nSectionSize) !=
+                nSectionSize )
+            return false;
+        pabyObject = objectData.data ();
+    }
 
-        case CADObject::INSERT:
-            return getInsert(dObjectType, dObjectSize, stCommonEntityData,
-                             pabySectionContent, nBitOffsetFromStart);
+    // EED is not needed for the handles
+    int previousProjection = decodeProjection;
+    decodeProjection = PROJECTION_COORDINATES;
+    readCommonEntityData<Traits> (objectHeader.stCed, pabyObject,
+                                  nBitOffsetFromStart);
+    decodeProjection = previousProjection;
+
+    // R2007+ handles follow the string stream, the offset is the same
+    nBitOffsetFromStart = nDataStart +
+            static_cast<size_t>(objectHeader.stCed.nObjectSizeInBits);
+    if( objectHeader.stCed.nObjectSizeInBits <= 0 ||
+        nBitOffsetFromStart >= nSectionSize * 8 )
+        return false;
+    fillCommonEntityHandleData<Traits>(&objectHeader, pabyObject,
+                                nBitOffsetFromStart);
+    return true;
+}
 
-        default:
-            return getEntity(dObjectType, dObjectSize, stCommonEntityData,
-                             pabySectionContent, nBitOffsetFromStart);
-        }
+// ----------------------------------------------------------------------------
+// Object decoders
+// ----------------------------------------------------------------------------
+
+#define DWG_ENTITY_DECODER(method) \
+    [](DWGFileR2000 * file, short /*dObjectType*/, long dObjectSize, \
+       CADCommonED &&stCommonEntityData, const char * pabyInput, \
+       size_t &nBitOffsetFromStart) -> CADObject * \
+    { \
+        return file->method<Traits>(dObjectSize, \
+                                    std::move(stCommonEntityData), \
+                                    pabyInput, nBitOffsetFromStart); \
     }
-    else
-    {
-        switch ( dObjectType )
-        {
-        case CADObject::DICTIONARY:
-            return getDictionary(dObjectSize, pabySectionContent,
-                                 nBitOffsetFromStart);
 
-        case CADObject::LAYER:
-            return getLayerObject(dObjectSize, pabySectionContent,
-                            nBitOffsetFromStart);
+#define DWG_TYPED_ENTITY_DECODER(method) \
+    [](DWGFileR2000 * file, short dObjectType, long dObjectSize, \
+       CADCommonED &&stCommonEntityData, const char * pabyInput, \
+       size_t &nBitOffsetFromStart) -> CADObject * \
+    { \
+        return file->method<Traits>(dObjectType, dObjectSize, \
+                                    std::move(stCommonEntityData), \
+                                    pabyInput, nBitOffsetFromStart); \
+    }
 
-        case CADObject::LAYER_CONTROL_OBJ:
-            return getLayerControl(dObjectSize, pabySectionContent,
-                                   nBitOffsetFromStart);
+#define DWG_OBJECT_DECODER(method) \
+    [](DWGFileR2000 * file, long dObjectSize, const char * pabyInput, \
+       size_t &nBitOffsetFromStart) -> CADObject * \
+    { \
+        return file->method<Traits>(dObjectSize, pabyInput, \
+                                    nBitOffsetFromStart); \
+    }
 
-        case CADObject::BLOCK_CONTROL_OBJ:
-            return getBlockControl(dObjectSize, pabySectionContent,
-                                   nBitOffsetFromStart);
+template<class Traits>
+vector<DWGFileR2000::ObjectDecoders> DWGFileR2000::createObjectDecoders()
+{
+    vector<ObjectDecoders> decoders(CADObject::XRECORD_UNFIXED + 1,
+                                    ObjectDecoders{ nullptr, nullptr });
 
-        case CADObject::BLOCK_HEADER:
-            return getBlockHeader(dObjectSize, pabySectionContent,
-                                  nBitOffsetFromStart);
+    // Entities without own decoder have common data and handles read only
+    for( size_t i = 0; i < decoders.size (); ++i )
+    {
+        if( isCommonEntityType (static_cast<short>(i)) )
+            decoders[i].entity = DWG_TYPED_ENTITY_DECODER(getEntity);
+    }
 
-        case CADObject::LTYPE_CONTROL_OBJ:
-            return getLineTypeControl(dObjectSize, pabySectionContent,
-                                 nBitOffsetFromStart);
+    decoders[CADObject::BLOCK].entity = DWG_ENTITY_DECODER(getBlock);
+    decoders[CADObject::ELLIPSE].entity = DWG_ENTITY_DECODER(getEllipse);
+    decoders[CADObject::MLINE].entity = DWG_ENTITY_DECODER(getMLine);
+    decoders[CADObject::SOLID].entity = DWG_ENTITY_DECODER(getSolid);
+    decoders[CADObject::POINT].entity = DWG_ENTITY_DECODER(getPoint);
+    decoders[CADObject::POLYLINE3D].entity = DWG_ENTITY_DECODER(getPolyLine3D);
+    decoders[CADObject::RAY].entity = DWG_ENTITY_DECODER(getRay);
+    decoders[CADObject::XLINE].entity = DWG_ENTITY_DECODER(getXLine);
+    decoders[CADObject::LINE].entity = DWG_ENTITY_DECODER(getLine);
+    decoders[CADObject::TEXT].entity = DWG_ENTITY_DECODER(getText);
+    decoders[CADObject::VERTEX3D].entity = DWG_ENTITY_DECODER(getVertex3D);
+    decoders[CADObject::CIRCLE].entity = DWG_ENTITY_DECODER(getCircle);
+    decoders[CADObject::ENDBLK].entity = DWG_ENTITY_DECODER(getEndBlock);
+    decoders[CADObject::POLYLINE2D].entity = DWG_ENTITY_DECODER(getPolyline2D);
+    decoders[CADObject::ATTRIB].entity = DWG_ENTITY_DECODER(getAttributes);
+    decoders[CADObject::ATTDEF].entity = DWG_ENTITY_DECODER(getAttributesDefn);
+    decoders[CADObject::LWPOLYLINE].entity = DWG_ENTITY_DECODER(getLWPolyLine);
+    decoders[CADObject::ARC].entity = DWG_ENTITY_DECODER(getArc);
+    decoders[CADObject::SPLINE].entity = DWG_ENTITY_DECODER(getSpline);
+    decoders[CADObject::POLYLINE_PFACE].entity = DWG_ENTITY_DECODER(getPolylinePFace);
+    decoders[CADObject::IMAGE].entity = DWG_ENTITY_DECODER(getImage);
+    decoders[CADObject::FACE3D].entity = DWG_ENTITY_DECODER(get3DFace);
+    decoders[CADObject::VERTEX_MESH].entity = DWG_ENTITY_DECODER(getVertexMesh);
+    decoders[CADObject::VERTEX_PFACE].entity = DWG_ENTITY_DECODER(getVertexPFace);
+    decoders[CADObject::MTEXT].entity = DWG_ENTITY_DECODER(getMText);
+    decoders[CADObject::DIMENSION_RADIUS].entity = DWG_TYPED_ENTITY_DECODER(getDimension);
+    decoders[CADObject::DIMENSION_DIAMETER].entity = DWG_TYPED_ENTITY_DECODER(getDimension);
+    decoders[CADObject::DIMENSION_ALIGNED].entity = DWG_TYPED_ENTITY_DECODER(getDimension);
+    decoders[CADObject::DIMENSION_ANG_3PT].entity = DWG_TYPED_ENTITY_DECODER(getDimension);
+    decoders[CADObject::DIMENSION_ANG_2LN].entity = DWG_TYPED_ENTITY_DECODER(getDimension);
+    decoders[CADObject::DIMENSION_ORDINATE].entity = DWG_TYPED_ENTITY_DECODER(getDimension);
+    decoders[CADObject::DIMENSION_LINEAR].entity = DWG_TYPED_ENTITY_DECODER(getDimension);
+    decoders[CADObject::INSERT].entity = DWG_TYPED_ENTITY_DECODER(getInsert);
+
+    decoders[CADObject::DICTIONARY].object = DWG_OBJECT_DECODER(getDictionary);
+    decoders[CADObject::LAYER].object = DWG_OBJECT_DECODER(getLayerObject);
+    decoders[CADObject::LAYER_CONTROL_OBJ].object = DWG_OBJECT_DECODER(getLayerControl);
+    decoders[CADObject::BLOCK_CONTROL_OBJ].object = DWG_OBJECT_DECODER(getBlockControl);
+    decoders[CADObject::BLOCK_HEADER].object = DWG_OBJECT_DECODER(getBlockHeader);
+    decoders[CADObject::LTYPE_CONTROL_OBJ].object = DWG_OBJECT_DECODER(getLineTypeControl);
+    decoders[CADObject::LTYPE1].object = DWG_OBJECT_DECODER(getLineType1);
+    decoders[CADObject::IMAGEDEF].object = DWG_OBJECT_DECODER(getImageDef);
+    decoders[CADObject::IMAGEDEFREACTOR].object = DWG_OBJECT_DECODER(getImageDefReactor);
+    decoders[CADObject::XRECORD].object = DWG_OBJECT_DECODER(getXRecord);
+
+    return decoders;
+}
 
-        case CADObject::LTYPE1:
-            return getLineType1(dObjectSize, pabySectionContent,
-                             nBitOffsetFromStart);
+#undef DWG_ENTITY_DECODER
+#undef DWG_TYPED_ENTITY_DECODER
+#undef DWG_OBJECT_DECODER
 
-        case CADObject::IMAGEDEF:
-            return getImageDef (dObjectSize, pabySectionContent,
-                                nBitOffsetFromStart);
+template<class Traits>
+const DWGFileR2000::ObjectDecoders *DWGFileR2000::getObjectDecoders(
+        short dObjectType)
+{
+    // one table per version instantiation
+    static const vector<ObjectDecoders> decoders =
+            createObjectDecoders<Traits> ();
+    if( dObjectType < 0 || static_cast<size_t>(dObjectType) >= decoders.size () )
+        return nullptr;
 
-        case CADObject::IMAGEDEFREACTOR:
-            return getImageDefReactor (dObjectSize, pabySectionContent,
-                                       nBitOffsetFromStart);
+    const ObjectDecoders& typeDecoders = decoders[dObjectType];
+    if( nullptr == typeDecoders.entity && nullptr == typeDecoders.object )
+        return nullptr;
+    return &typeDecoders;
+}
 
-        case CADObject::XRECORD:
-            return getXRecord (dObjectSize, pabySectionContent,
-                                nBitOffsetFromStart);
-            }
-        }
+/**
+ * @brief Moves the geometry from the entity OCS to WCS using its extrusion.
+ * The elevation is the OCS Z for entities stored with 2D coordinates. The
+ * planar geometries get their extrusion from the transformation, so the
+ * exact extrusion is set after the move.
+ */
+static void transformOCSToWCS(CADGeometry *geometry, const CADVector &extrusion,
+                              double elevation = 0.0)
+{
+    Matrix ocs = Matrix::fromExtrusion (extrusion);
+    if( elevation != 0.0 )
+        ocs.translate (CADVector(0.0, 0.0, elevation));
+    if( !ocs.isIdentity () )
+        geometry->transform (ocs);
+}
 
-    return readed_object;
+CADGeometry *DWGFileR2000::getGeometry(long index, int projection)
+{
+    int previousProjection = decodeProjection;
+    decodeProjection = projection;
+    CADGeometry * geometry = readGeometry (index);
+    decodeProjection = previousProjection;
+    return geometry;
 }
 
-CADGeometry *DWGFileR2000::getGeometry(long index)
+CADGeometry *DWGFileR2000::readGeometry(long index)
 {
     unique_ptr<CADEntityObject> readedObject( ( CADEntityObject* ) getObject(index) );
 
@@ -1185,12 +1688,13 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
 
         arc->setColor (cadArc->stCed.nCMColor);
         arc->setPosition (cadArc->vertPosition);
-        arc->setExtrusion (cadArc->vectExtrusion);
         arc->setRadius (cadArc->dfRadius);
         arc->setThickness(cadArc->dfThickness);
         arc->setStartingAngle (cadArc->dfStartAngle);
         arc->setEndingAngle (cadArc->dfEndAngle);
         arc->setEED( asEED );
+        transformOCSToWCS (arc, cadArc->vectExtrusion);
+        arc->setExtrusion (cadArc->vectExtrusion);
 
         return arc;
     }
@@ -1222,6 +1726,18 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         // TODO: code can be much simplified if CADHandle will be used.
         // to do so, == and ++ operators should be implemented.
         unique_ptr<CADVertex3DObject> vertex;
+        if ( dwgVersion >= CADVersions::DWG_R2004 )
+        {
+            // all vertexes are listed by the polyline
+            for ( const CADHandle& vertexHandle : cadPolyline3D->hVertexes )
+            {
+                vertex.reset (static_cast<CADVertex3DObject*>(
+                                  getObject (vertexHandle.getAsLong ())));
+                if ( vertex != nullptr )
+                    polyline->addVertex ( vertex->vertPosition );
+            }
+            return polyline;
+        }
         long currentVertexH = cadPolyline3D->hVertexes[0].getAsLong ();
         while ( currentVertexH != 0 )
         {
@@ -1266,9 +1782,13 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         lwPolyline->setElevation (cadlwPolyline->dfElevation);
         for(const CADVector& vertex : cadlwPolyline->avertVertexes)
             lwPolyline->addVertex (vertex);
-        lwPolyline->setVectExtrusion (cadlwPolyline->vectExtrusion);
         lwPolyline->setWidths (cadlwPolyline->astWidths);
+        lwPolyline->setBulges (cadlwPolyline->adfBulges);
+        lwPolyline->setClosed (cadlwPolyline->bClosed);
         lwPolyline->setEED( asEED );
+        transformOCSToWCS (lwPolyline, cadlwPolyline->vectExtrusion,
+                           cadlwPolyline->dfElevation);
+        lwPolyline->setVectExtrusion (cadlwPolyline->vectExtrusion);
 
         return lwPolyline;
     }
@@ -1281,10 +1801,11 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
 
         circle->setColor (cadCircle->stCed.nCMColor);
         circle->setPosition (cadCircle->vertPosition);
-        circle->setExtrusion (cadCircle->vectExtrusion);
         circle->setRadius (cadCircle->dfRadius);
         circle->setThickness(cadCircle->dfThickness);
         circle->setEED( asEED );
+        transformOCSToWCS (circle, cadCircle->vectExtrusion);
+        circle->setExtrusion (cadCircle->vectExtrusion);
 
         return circle;
     }
@@ -1308,6 +1829,8 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         attrib->setTextValue (cadAttrib->sTextValue);
         attrib->setThickness (cadAttrib->dfThickness);
         attrib->setEED( asEED );
+        transformOCSToWCS (attrib, cadAttrib->vectExtrusion,
+                           cadAttrib->dfElevation);
 
         return attrib;
     }
@@ -1331,6 +1854,8 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         attdef->setTextValue (cadAttrib->sTextValue);
         attdef->setThickness (cadAttrib->dfThickness);
         attdef->setEED( asEED );
+        transformOCSToWCS (attdef, cadAttrib->vectExtrusion,
+                           cadAttrib->dfElevation);
 
         return attdef;
     }
@@ -1344,6 +1869,7 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         ellipse->setColor (cadEllipse->stCed.nCMColor);
         ellipse->setPosition (cadEllipse->vertPosition);
         ellipse->setSMAxis (cadEllipse->vectSMAxis);
+        ellipse->setExtrusion (cadEllipse->vectExtrusion);
         ellipse->setAxisRatio (cadEllipse->dfAxisRatio);
         ellipse->setEndingAngle (cadEllipse->dfEndAngle);
         ellipse->setStartingAngle (cadEllipse->dfBegAngle);
@@ -1395,6 +1921,8 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         if ( spline->getScenario() == 2 )
         {
             spline->setFitTollerance (cadSpline->dfFitTol);
+            spline->setBegTangent (cadSpline->vectBegTangDir);
+            spline->setEndTangent (cadSpline->vectEndTangDir);
         }
         else if ( spline->getScenario() == 1 )
         {
@@ -1411,6 +1939,9 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         for(const CADVector &pt : cadSpline->avertCtrlPoints)
             spline->addControlPoint(pt);
 
+        for(double knot : cadSpline->adfKnots)
+            spline->addKnot (knot);
+
         return spline;
     }
 
@@ -1428,6 +1959,8 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         text->setThickness(cadText->dfThickness);
         text->setHeight (cadText->dfElevation);
         text->setEED( asEED );
+        transformOCSToWCS (text, cadText->vectExtrusion,
+                           cadText->dfElevation);
 
         return text;
     }
@@ -1445,6 +1978,8 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
             solid->addAverCorner (corner) ;
         solid->setExtrusion (cadSolid->vectExtrusion);
         solid->setEED( asEED );
+        transformOCSToWCS (solid, cadSolid->vectExtrusion,
+                           cadSolid->dfElevation);
 
         return solid;
     }
@@ -1536,6 +2071,17 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
         polyline->setColor (cadpolyPface->stCed.nCMColor);
         polyline->setEED( asEED );
         unique_ptr<CADVertexPFaceObject> vertex;
+        if ( dwgVersion >= CADVersions::DWG_R2004 )
+        {
+            for ( const CADHandle& vertexHandle : cadpolyPface->hVertexes )
+            {
+                vertex.reset (static_cast<CADVertexPFaceObject*>(
+                                  getObject (vertexHandle.getAsLong ())));
+                if ( vertex != nullptr )
+                    polyline->addVertex (vertex->vertPosition);
+            }
+            return polyline;
+        }
         auto dCurrentEntHandle = cadpolyPface->hVertexes[0].getAsLong ();
         auto dLastEntHandle    = cadpolyPface->hVertexes[1].getAsLong ();
         while ( true )
@@ -1612,62 +2158,208 @@ CADGeometry *DWGFileR2000::getGeometry(long index)
     return nullptr;
 }
 
-CADBlockObject *DWGFileR2000::getBlock(long dObjectSize,
-                                       struct CADCommonED stCommonEntityData,
-                                       const char * pabyInput,
-                                       size_t& nBitOffsetFromStart)
+// ----------------------------------------------------------------------------
+// Object schemas
+// ----------------------------------------------------------------------------
+
+typedef DWGSchema<
+    DWG_FIELD(DWGVectorField, CADEllipseObject, vertPosition),
+    DWG_FIELD(DWGVectorField, CADEllipseObject, vectSMAxis),
+    DWG_FIELD(DWGVectorField, CADEllipseObject, vectExtrusion),
+    DWG_FIELD(DWGBitDoubleField, CADEllipseObject, dfAxisRatio),
+    DWG_FIELD(DWGBitDoubleField, CADEllipseObject, dfBegAngle),
+    DWG_FIELD(DWGBitDoubleField, CADEllipseObject, dfEndAngle)
+    > DWGEllipseSchema;
+
+typedef DWGSchema<
+    DWG_FIELD(DWGVectorField, CADPointObject, vertPosition),
+    DWG_FIELD(DWGThicknessField, CADPointObject, dfThickness),
+    DWG_FIELD(DWGExtrusionField, CADPointObject, vectExtrusion),
+    DWG_FIELD(DWGBitDoubleField, CADPointObject, dfXAxisAng)
+    > DWGPointSchema;
+
+typedef DWGSchema<
+    DWG_FIELD(DWGVectorField, CADRayObject, vertPosition),
+    DWG_FIELD(DWGVectorField, CADRayObject, vectVector)
+    > DWGRaySchema;
+
+typedef DWGSchema<
+    DWG_FIELD(DWGVectorField, CADXLineObject, vertPosition),
+    DWG_FIELD(DWGVectorField, CADXLineObject, vectVector)
+    > DWGXLineSchema;
+
+typedef DWGSchema<
+    DWGUnusedField<DWGCharField>, // Flags
+    DWG_FIELD(DWGVectorField, CADVertex3DObject, vertPosition)
+    > DWGVertex3DSchema;
+
+typedef DWGSchema<
+    DWG_FIELD(DWGVectorField, CADCircleObject, vertPosition),
+    DWG_FIELD(DWGBitDoubleField, CADCircleObject, dfRadius),
+    DWG_FIELD(DWGThicknessField, CADCircleObject, dfThickness),
+    DWG_FIELD(DWGExtrusionField, CADCircleObject, vectExtrusion)
+    > DWGCircleSchema;
+
+typedef DWGSchema<
+    DWG_FIELD(DWGVectorField, CADArcObject, vertPosition),
+    DWG_FIELD(DWGBitDoubleField, CADArcObject, dfRadius),
+    DWG_FIELD(DWGThicknessField, CADArcObject, dfThickness),
+    DWG_FIELD(DWGExtrusionField, CADArcObject, vectExtrusion),
+    DWG_FIELD(DWGBitDoubleField, CADArcObject, dfStartAngle),
+    DWG_FIELD(DWGBitDoubleField, CADArcObject, dfEndAngle)
+    > DWGArcSchema;
+
+typedef DWGSchema<
+    DWG_PROJECTED_FIELD(DWGTextField, CADAttribObject, sTag,
+                        CADFile::PROJECTION_TEXT),
+    DWG_FIELD(DWGBitShortField, CADAttribObject, nFieldLength),
+    DWG_FIELD(DWGCharField, CADAttribObject, nFlags)
+    > DWGAttribSchema;
+
+typedef DWGSchema<
+    DWG_PROJECTED_FIELD(DWGTextField, CADAttribObject, sTag,
+                        CADFile::PROJECTION_TEXT),
+    DWG_FIELD(DWGBitShortField, CADAttribObject, nFieldLength),
+    DWG_FIELD(DWGCharField, CADAttribObject, nFlags),
+    DWG_PROJECTED_FIELD(DWGTextField, CADAttdefObject, sPrompt,
+                        CADFile::PROJECTION_TEXT)
+    > DWGAttdefSchema;
+
+typedef DWGSchema<
+    DWG_PROJECTED_FIELD(DWGBitDoubleField, CADSplineObject, dfKnotTol,
+                        CADFile::PROJECTION_DETAILS),
+    DWG_PROJECTED_FIELD(DWGBitDoubleField, CADSplineObject, dfCtrlTol,
+                        CADFile::PROJECTION_DETAILS)
+    > DWGSplineTolerancesSchema;
+
+// Text values, tags and dimension text stored by several layouts
+typedef DWGProjectedField<DWGTextField, CADFile::PROJECTION_TEXT>
+    DWGProjectedText;
+
+/**
+ * @brief Reads the text data shared by TEXT, ATTRIB and ATTDEF. R2000+ data
+ * flags tell which values are stored, R13-R14 store all of them.
+ */
+template<class Traits, class Object>
+static void readTextData(Object *text, const char *pabyInput,
+                         size_t &nBitOffsetFromStart)
 {
-    CADBlockObject * pBlock = new CADBlockObject();
+    if( !Traits::hasCompressedData )
+    {
+        text->DataFlags = 0;
+        text->dfElevation = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        text->vertInsetionPoint = ReadRAWVector (pabyInput,
+                                                 nBitOffsetFromStart);
+        text->vertAlignmentPoint = ReadRAWVector (pabyInput,
+                                                  nBitOffsetFromStart);
+        text->vectExtrusion = ReadVector (pabyInput, nBitOffsetFromStart);
+        text->dfThickness = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        text->dfObliqueAng = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        text->dfRotationAng = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        text->dfHeight = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        text->dfWidthFactor = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        DWGProjectedText::read<Traits::version> (text->sTextValue, pabyInput,
+                                                 nBitOffsetFromStart,
+                                                 decodeProjection);
+        text->dGeneration = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+        text->dHorizAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+        text->dVertAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+        return;
+    }
 
-    pBlock->setSize(dObjectSize);
-    pBlock->stCed = stCommonEntityData;
+    text->DataFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
 
-    pBlock->sBlockName = ReadTV (pabyInput, nBitOffsetFromStart);
+    if ( !( text->DataFlags & 0x01 ) )
+        text->dfElevation = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
 
-    fillCommonEntityHandleData(pBlock, pabyInput, nBitOffsetFromStart);
+    CADVector vertInsetionPoint = ReadRAWVector (pabyInput,
+                                                 nBitOffsetFromStart);
 
-    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
-    pBlock->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
+    text->vertInsetionPoint = vertInsetionPoint;
 
-#ifdef _DEBUG
-    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
-        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
-            __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
-#endif // _DEBUG
+    if ( !( text->DataFlags & 0x02 ) )
+    {
+        double x, y;
+        x = ReadBITDOUBLEWD (pabyInput,
+                             nBitOffsetFromStart, vertInsetionPoint.getX());
+        y = ReadBITDOUBLEWD (pabyInput,
+                             nBitOffsetFromStart, vertInsetionPoint.getY());
+        CADVector vertAlignmentPoint(x, y);
+        text->vertAlignmentPoint = vertAlignmentPoint;
+    }
 
-    return pBlock;
+    text->vectExtrusion = DWGExtrusionField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
+    text->dfThickness = DWGThicknessField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
+
+    if ( !( text->DataFlags & 0x04 ) )
+        text->dfObliqueAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+    if ( !( text->DataFlags & 0x08 ) )
+        text->dfRotationAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+
+    text->dfHeight = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+
+    if ( !( text->DataFlags & 0x10 ) )
+        text->dfWidthFactor = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+
+    DWGProjectedText::read<Traits::version> (text->sTextValue, pabyInput,
+                                             nBitOffsetFromStart,
+                                             decodeProjection);
+
+    if ( !( text->DataFlags & 0x20 ) )
+        text->dGeneration = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    if ( !( text->DataFlags & 0x40 ) )
+        text->dHorizAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    if ( !( text->DataFlags & 0x80 ) )
+        text->dVertAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
 }
 
-CADEllipseObject *DWGFileR2000::getEllipse(long dObjectSize,
-                                         CADCommonED stCommonEntityData,
-                                         const char *pabyInput,
-                                         size_t &nBitOffsetFromStart)
+template<class Traits, class Schema, class Object>
+Object *DWGFileR2000::readEntity(long dObjectSize,
+                                 CADCommonED &&stCommonEntityData,
+                                 const char *pabyInput,
+                                 size_t &nBitOffsetFromStart)
 {
-    CADEllipseObject * ellipse = new CADEllipseObject();
+    Object * entity = new Object();
 
-    ellipse->setSize(dObjectSize);
-    ellipse->stCed = stCommonEntityData;
+    entity->setSize(dObjectSize);
+    entity->stCed = std::move(stCommonEntityData);
 
-    CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
+    Schema::template read<Traits::version>(entity, pabyInput,
+                                           nBitOffsetFromStart,
+                                           decodeProjection);
 
-    ellipse->vertPosition = vertPosition;
+    fillCommonEntityHandleData<Traits>(entity, pabyInput, nBitOffsetFromStart);
 
-    CADVector vectSMAxis = ReadVector(pabyInput, nBitOffsetFromStart);
+    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
+    entity->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
 
-    ellipse->vectSMAxis = vectSMAxis;
+#ifdef _DEBUG
+    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
+        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
+                  __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
+#endif // _DEBUG
+    return entity;
+}
 
-    CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
+template<class Traits>
+CADBlockObject *DWGFileR2000::getBlock(long dObjectSize,
+                                       CADCommonED &&stCommonEntityData,
+                                       const char * pabyInput,
+                                       size_t& nBitOffsetFromStart)
+{
+    CADBlockObject * pBlock = new CADBlockObject();
 
-    ellipse->vectExtrusion = vectExtrusion;
+    pBlock->setSize(dObjectSize);
+    pBlock->stCed = std::move(stCommonEntityData);
 
-    ellipse->dfAxisRatio = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    ellipse->dfBegAngle = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    ellipse->dfEndAngle = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    pBlock->sBlockName = ReadText (pabyInput, nBitOffsetFromStart);
 
-    fillCommonEntityHandleData(ellipse, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(pBlock, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
-    ellipse->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
+    pBlock->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
 
 #ifdef _DEBUG
     if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
@@ -1675,21 +2367,33 @@ CADEllipseObject *DWGFileR2000::getEllipse(long dObjectSize,
             __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
 #endif // _DEBUG
 
-    return ellipse;
+    return pBlock;
 }
 
+template<class Traits>
+CADEllipseObject *DWGFileR2000::getEllipse(long dObjectSize,
+                                           CADCommonED &&stCommonEntityData,
+                                           const char *pabyInput,
+                                           size_t &nBitOffsetFromStart)
+{
+    return readEntity<Traits, DWGEllipseSchema, CADEllipseObject>(dObjectSize,
+                        std::move(stCommonEntityData), pabyInput,
+                        nBitOffsetFromStart);
+}
+
+template<class Traits>
 CADSolidObject *DWGFileR2000::getSolid(long dObjectSize,
-                                         CADCommonED stCommonEntityData,
+                                         CADCommonED &&stCommonEntityData,
                                          const char *pabyInput,
                                          size_t &nBitOffsetFromStart)
 {
     CADSolidObject * solid = new CADSolidObject();
 
     solid->setSize( dObjectSize );
-    solid->stCed = stCommonEntityData;
+    solid->stCed = std::move(stCommonEntityData);
 
-    solid->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                         0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    solid->dfThickness = DWGThicknessField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
 
     solid->dfElevation = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
@@ -1701,18 +2405,10 @@ CADSolidObject *DWGFileR2000::getSolid(long dObjectSize,
         solid->avertCorners.push_back ( oCorner );
     }
 
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        solid->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        solid->vectExtrusion = vectExtrusion;
-    }
-
+    solid->vectExtrusion = DWGExtrusionField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
 
-    fillCommonEntityHandleData(solid, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(solid, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     solid->setCRC( ReadRAWSHORT (pabyInput, nBitOffsetFromStart) );
@@ -1726,269 +2422,42 @@ CADSolidObject *DWGFileR2000::getSolid(long dObjectSize,
     return solid;
 }
 
+template<class Traits>
 CADPointObject *DWGFileR2000::getPoint(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
 {
-
-    CADPointObject * point = new CADPointObject();
-
-    point->setSize( dObjectSize );
-    point->stCed = stCommonEntityData;
-
-    CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
-
-    point->vertPosition = vertPosition;
-
-    point->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                          0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        point->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        point->vectExtrusion = vectExtrusion;
-    }
-
-    point->dfXAxisAng = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    fillCommonEntityHandleData(point, pabyInput, nBitOffsetFromStart);
-
-    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
-    point->setCRC( ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
-
-#ifdef _DEBUG
-    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
-        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
-                  __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
-#endif // _DEBUG
-
-    return point;
+    return readEntity<Traits, DWGPointSchema, CADPointObject>(dObjectSize,
+                        std::move(stCommonEntityData), pabyInput,
+                        nBitOffsetFromStart);
 }
 
+template<class Traits>
 CADPolyline3DObject *DWGFileR2000::getPolyLine3D(long dObjectSize,
-                                           CADCommonED stCommonEntityData,
+                                           CADCommonED &&stCommonEntityData,
                                            const char *pabyInput,
                                            size_t &nBitOffsetFromStart)
 {
     CADPolyline3DObject * polyline = new CADPolyline3DObject();
 
     polyline->setSize(dObjectSize);
-    polyline->stCed = stCommonEntityData;
-
-    polyline->SplinedFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
-    polyline->ClosedFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
-
-    fillCommonEntityHandleData(polyline, pabyInput, nBitOffsetFromStart);
-
-    polyline->hVertexes.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) ); // 1st vertex
-    polyline->hVertexes.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) ); // last vertex
-
-    polyline->hSeqend = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-
-    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
-    polyline->setCRC( ReadRAWSHORT (pabyInput, nBitOffsetFromStart) );
-
-#ifdef _DEBUG
-    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
-        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
-                  __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
-#endif // _DEBUG
-
-    return polyline;
-}
-
-CADRayObject *DWGFileR2000::getRay(long dObjectSize,
-                                   CADCommonED stCommonEntityData,
-                                   const char *pabyInput,
-                                   size_t &nBitOffsetFromStart)
-{
-    CADRayObject * ray = new CADRayObject();
-
-    ray->setSize(dObjectSize);
-    ray->stCed = stCommonEntityData;
-
-    CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
-
-    ray->vertPosition = vertPosition;
-
-    CADVector vectVector = ReadVector(pabyInput, nBitOffsetFromStart);
-    ray->vectVector = vectVector;
-
-    fillCommonEntityHandleData(ray, pabyInput, nBitOffsetFromStart);
-
-    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
-    ray->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
-
-#ifdef _DEBUG
-    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
-        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
-                  __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
-#endif //_DEBUG
-
-    return ray;
-}
-
-CADXLineObject *DWGFileR2000::getXLine(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
-                                       const char *pabyInput,
-                                       size_t &nBitOffsetFromStart)
-{
-    CADXLineObject * xline = new CADXLineObject();
-
-    xline->setSize( dObjectSize );
-    xline->stCed = stCommonEntityData;
-
-    CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
-
-    xline->vertPosition = vertPosition;
-
-    CADVector vectVector = ReadVector(pabyInput, nBitOffsetFromStart);
-    xline->vectVector = vectVector;
-
-    fillCommonEntityHandleData(xline, pabyInput, nBitOffsetFromStart);
-
-    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
-    xline->setCRC( ReadRAWSHORT (pabyInput, nBitOffsetFromStart) );
-
-#ifdef _DEBUG
-    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
-        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
-                  __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
-#endif // _DEBUG
-
-    return xline;
-}
-
-CADLineObject *DWGFileR2000::getLine(long dObjectSize,
-                                     CADCommonED stCommonEntityData,
-                                     const char *pabyInput,
-                                     size_t &nBitOffsetFromStart)
-{
-    CADLineObject * line = new CADLineObject();
-
-    line->setSize(dObjectSize);
-    line->stCed = stCommonEntityData;
-
-    bool bZsAreZeros = ReadBIT (pabyInput, nBitOffsetFromStart);
-
-    CADVector vertStart, vertEnd;
-    vertStart.setX (ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart));
-    vertEnd.setX (ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                                   vertStart.getX()));
-    vertStart.setY (ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart));
-    vertEnd.setY (ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                                   vertStart.getY()));
-
-    if ( !bZsAreZeros )
-    {
-        vertStart.setZ(ReadBITDOUBLE (pabyInput, nBitOffsetFromStart));
-        vertEnd.setZ(ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                                      vertStart.getZ()));
-    }
-
-    line->vertStart = vertStart;
-    line->vertEnd   = vertEnd;
-
-    line->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                        0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        line->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        line->vectExtrusion = vectExtrusion;
-    }
-
-    fillCommonEntityHandleData(line, pabyInput, nBitOffsetFromStart);
-
-    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
-    line->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
-
-#ifdef _DEBUG
-    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
-        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
-                  __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
-#endif // _DEBUG
-    return line;
-}
-
-CADTextObject *DWGFileR2000::getText(long dObjectSize,
-                                     CADCommonED stCommonEntityData,
-                                     const char *pabyInput,
-                                     size_t &nBitOffsetFromStart)
-{
-    CADTextObject * text = new CADTextObject();
-
-    text->setSize (dObjectSize);
-    text->stCed = stCommonEntityData;
-
-    text->DataFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
-
-    if ( !( text->DataFlags & 0x01 ) )
-        text->dfElevation = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    CADVector vertInsetionPoint = ReadRAWVector (pabyInput,
-                                                 nBitOffsetFromStart);
-
-    text->vertInsetionPoint = vertInsetionPoint;
-
-    if ( !( text->DataFlags & 0x02 ) )
-    {
-        double x, y;
-        x = ReadBITDOUBLEWD (pabyInput,
-                             nBitOffsetFromStart, vertInsetionPoint.getX());
-        y = ReadBITDOUBLEWD (pabyInput,
-                             nBitOffsetFromStart, vertInsetionPoint.getY());
-        CADVector vertAlignmentPoint(x, y);
-        text->vertAlignmentPoint = vertAlignmentPoint;
-    }
-
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        text->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        text->vectExtrusion = vectExtrusion;
-    }
-
-    text->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                          0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    if ( !( text->DataFlags & 0x04 ) )
-        text->dfObliqueAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    if ( !( text->DataFlags & 0x08 ) )
-        text->dfRotationAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    text->dfHeight = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    if ( !( text->DataFlags & 0x10 ) )
-        text->dfWidthFactor = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    text->sTextValue = ReadTV (pabyInput, nBitOffsetFromStart);
-
-    if ( !( text->DataFlags & 0x20 ) )
-        text->dGeneration = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    if ( !( text->DataFlags & 0x40 ) )
-        text->dHorizAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    if ( !( text->DataFlags & 0x80 ) )
-        text->dVertAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    polyline->stCed = std::move(stCommonEntityData);
 
-    fillCommonEntityHandleData(text, pabyInput, nBitOffsetFromStart);
+    polyline->SplinedFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    polyline->ClosedFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    polyline->nObjectsOwned = Traits::hasOwnedHandles ?
+                ReadBITLONG (pabyInput, nBitOffsetFromStart) : 0;
 
-    text->hStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(polyline, pabyInput, nBitOffsetFromStart);
+
+    readOwnedHandles<Traits> (polyline->nObjectsOwned, polyline->hVertexes,
+                              pabyInput, nBitOffsetFromStart);
+
+    polyline->hSeqend = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
-    text->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
+    polyline->setCRC( ReadRAWSHORT (pabyInput, nBitOffsetFromStart) );
 
 #ifdef _DEBUG
     if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
@@ -1996,87 +2465,151 @@ CADTextObject *DWGFileR2000::getText(long dObjectSize,
                   __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
 #endif // _DEBUG
 
-    return text;
+    return polyline;
 }
 
-CADVertex3DObject *DWGFileR2000::getVertex3D(long dObjectSize,
-                                             CADCommonED stCommonEntityData,
-                                             const char *pabyInput,
-                                             size_t &nBitOffsetFromStart)
+template<class Traits>
+CADRayObject *DWGFileR2000::getRay(long dObjectSize,
+                                   CADCommonED &&stCommonEntityData,
+                                   const char *pabyInput,
+                                   size_t &nBitOffsetFromStart)
 {
-    CADVertex3DObject * vertex = new CADVertex3DObject();
+    return readEntity<Traits, DWGRaySchema, CADRayObject>(dObjectSize,
+                        std::move(stCommonEntityData), pabyInput,
+                        nBitOffsetFromStart);
+}
 
-    vertex->setSize(dObjectSize);
-    vertex->stCed = stCommonEntityData;
+template<class Traits>
+CADXLineObject *DWGFileR2000::getXLine(long dObjectSize,
+                                       CADCommonED &&stCommonEntityData,
+                                       const char *pabyInput,
+                                       size_t &nBitOffsetFromStart)
+{
+    return readEntity<Traits, DWGXLineSchema, CADXLineObject>(dObjectSize,
+                        std::move(stCommonEntityData), pabyInput,
+                        nBitOffsetFromStart);
+}
 
-    /*unsigned char Flags = */ReadCHAR (pabyInput, nBitOffsetFromStart);
+template<class Traits>
+CADLineObject *DWGFileR2000::getLine(long dObjectSize,
+                                     CADCommonED &&stCommonEntityData,
+                                     const char *pabyInput,
+                                     size_t &nBitOffsetFromStart)
+{
+    CADLineObject * line = new CADLineObject();
 
-    CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);;
-    vertex->vertPosition = vertPosition;
+    line->setSize(dObjectSize);
+    line->stCed = std::move(stCommonEntityData);
+
+    if ( Traits::hasCompressedData )
+    {
+        bool bZsAreZeros = ReadBIT (pabyInput, nBitOffsetFromStart);
 
-    fillCommonEntityHandleData(vertex, pabyInput, nBitOffsetFromStart);
+        CADVector vertStart, vertEnd;
+        vertStart.setX (ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart));
+        vertEnd.setX (ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                       vertStart.getX()));
+        vertStart.setY (ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart));
+        vertEnd.setY (ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                       vertStart.getY()));
+
+        if ( !bZsAreZeros )
+        {
+            vertStart.setZ(ReadBITDOUBLE (pabyInput, nBitOffsetFromStart));
+            vertEnd.setZ(ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                          vertStart.getZ()));
+        }
+
+        line->vertStart = vertStart;
+        line->vertEnd   = vertEnd;
+    }
+    else
+    {
+        line->vertStart = ReadVector (pabyInput, nBitOffsetFromStart);
+        line->vertEnd = ReadVector (pabyInput, nBitOffsetFromStart);
+    }
+
+    line->dfThickness = DWGThicknessField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
+    line->vectExtrusion = DWGExtrusionField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
+
+    fillCommonEntityHandleData<Traits>(line, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
-    vertex->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
+    line->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
 
 #ifdef _DEBUG
     if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
         DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
                   __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
 #endif // _DEBUG
-    return vertex;
+    return line;
 }
 
-CADCircleObject *DWGFileR2000::getCircle(long dObjectSize,
-                                         CADCommonED stCommonEntityData,
-                                         const char *pabyInput,
-                                         size_t &nBitOffsetFromStart)
+template<class Traits>
+CADTextObject *DWGFileR2000::getText(long dObjectSize,
+                                     CADCommonED &&stCommonEntityData,
+                                     const char *pabyInput,
+                                     size_t &nBitOffsetFromStart)
 {
-    CADCircleObject * circle = new CADCircleObject();
+    CADTextObject * text = new CADTextObject();
 
-    circle->setSize(dObjectSize);
-    circle->stCed = stCommonEntityData;
+    text->setSize (dObjectSize);
+    text->stCed = std::move(stCommonEntityData);
 
-    CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
-    circle->vertPosition = vertPosition;
-    circle->dfRadius    = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    circle->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                          0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    readTextData<Traits> (text, pabyInput, nBitOffsetFromStart);
 
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        circle->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        circle->vectExtrusion = vectExtrusion;
-    }
+    fillCommonEntityHandleData<Traits>(text, pabyInput, nBitOffsetFromStart);
 
-    fillCommonEntityHandleData(circle, pabyInput, nBitOffsetFromStart);
+    text->hStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
-    circle->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
+    text->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
 
 #ifdef _DEBUG
     if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
         DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
                   __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
 #endif // _DEBUG
-    return circle;
+
+    return text;
 }
 
+template<class Traits>
+CADVertex3DObject *DWGFileR2000::getVertex3D(long dObjectSize,
+                                             CADCommonED &&stCommonEntityData,
+                                             const char *pabyInput,
+                                             size_t &nBitOffsetFromStart)
+{
+    return readEntity<Traits, DWGVertex3DSchema, CADVertex3DObject>(dObjectSize,
+                        std::move(stCommonEntityData), pabyInput,
+                        nBitOffsetFromStart);
+}
+
+template<class Traits>
+CADCircleObject *DWGFileR2000::getCircle(long dObjectSize,
+                                         CADCommonED &&stCommonEntityData,
+                                         const char *pabyInput,
+                                         size_t &nBitOffsetFromStart)
+{
+    return readEntity<Traits, DWGCircleSchema, CADCircleObject>(dObjectSize,
+                        std::move(stCommonEntityData), pabyInput,
+                        nBitOffsetFromStart);
+}
+
+template<class Traits>
 CADEndblkObject *DWGFileR2000::getEndBlock(long dObjectSize,
-                                           CADCommonED stCommonEntityData,
+                                           CADCommonED &&stCommonEntityData,
                                            const char *pabyInput,
                                            size_t &nBitOffsetFromStart)
 {
     CADEndblkObject * endblk = new CADEndblkObject();
 
     endblk->setSize(dObjectSize);
-    endblk->stCed = stCommonEntityData;
+    endblk->stCed = std::move(stCommonEntityData);
 
-    fillCommonEntityHandleData(endblk, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(endblk, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     endblk->setCRC(ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -2089,15 +2622,16 @@ CADEndblkObject *DWGFileR2000::getEndBlock(long dObjectSize,
     return endblk;
 }
 
+template<class Traits>
 CADPolyline2DObject *DWGFileR2000::getPolyline2D(long dObjectSize,
-                                                 CADCommonED stCommonEntityData,
+                                                 CADCommonED &&stCommonEntityData,
                                                  const char *pabyInput,
                                                  size_t &nBitOffsetFromStart)
 {
     CADPolyline2DObject * polyline = new CADPolyline2DObject();
 
     polyline->setSize (dObjectSize);
-    polyline->stCed = stCommonEntityData;
+    polyline->stCed = std::move(stCommonEntityData);
 
     polyline->dFlags = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     polyline->dCurveNSmoothSurfType = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
@@ -2105,25 +2639,20 @@ CADPolyline2DObject *DWGFileR2000::getPolyline2D(long dObjectSize,
     polyline->dfStartWidth = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     polyline->dfEndWidth = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
-    polyline->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                            0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    polyline->dfThickness = DWGThicknessField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
 
     polyline->dfElevation = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        polyline->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        polyline->vectExtrusion = vectExtrusion;
-    }
+    polyline->vectExtrusion = DWGExtrusionField::read<Traits::version>(
+                pabyInput, nBitOffsetFromStart);
+    polyline->nObjectsOwned = Traits::hasOwnedHandles ?
+                ReadBITLONG (pabyInput, nBitOffsetFromStart) : 0;
 
-    fillCommonEntityHandleData(polyline, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(polyline, pabyInput, nBitOffsetFromStart);
 
-    polyline->hVertexes.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) ); // 1st vertex
-    polyline->hVertexes.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) ); // last vertex
+    readOwnedHandles<Traits> (polyline->nObjectsOwned, polyline->hVertexes,
+                              pabyInput, nBitOffsetFromStart);
 
     polyline->hSeqend = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
@@ -2138,67 +2667,22 @@ CADPolyline2DObject *DWGFileR2000::getPolyline2D(long dObjectSize,
     return polyline;
 }
 
+template<class Traits>
 CADAttribObject *DWGFileR2000::getAttributes(long dObjectSize,
-                                            CADCommonED stCommonEntityData,
+                                            CADCommonED &&stCommonEntityData,
                                             const char *pabyInput,
                                             size_t &nBitOffsetFromStart)
 {
     CADAttribObject * attrib = new CADAttribObject();
 
-    attrib->stCed = stCommonEntityData;
-    attrib->DataFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
-
-    if ( !(attrib->DataFlags & 0x01) )
-        attrib->dfElevation = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    double x, y;
-
-    CADVector vertInsetionPoint = ReadRAWVector(pabyInput, nBitOffsetFromStart);
-    attrib->vertInsetionPoint = vertInsetionPoint;
-
-    if ( !(attrib->DataFlags & 0x02) )
-    {
-        x = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                             vertInsetionPoint.getX());
-        y = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                             vertInsetionPoint.getY());
-        CADVector vertAlignmentPoint(x, y);
-        attrib->vertAlignmentPoint = vertAlignmentPoint;
-    }
-
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        attrib->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        attrib->vectExtrusion = vectExtrusion;
-    }
-
-    attrib->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                        0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    if ( !(attrib->DataFlags & 0x04) )
-        attrib->dfObliqueAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    if ( !(attrib->DataFlags & 0x08) )
-        attrib->dfRotationAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    attrib->dfHeight = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    if ( !(attrib->DataFlags & 0x10) )
-        attrib->dfWidthFactor = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    attrib->sTextValue = ReadTV (pabyInput, nBitOffsetFromStart);
-    if ( !(attrib->DataFlags & 0x20) )
-        attrib->dGeneration = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    if ( !(attrib->DataFlags & 0x40) )
-        attrib->dHorizAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    if ( !(attrib->DataFlags & 0x80) )
-        attrib->dVertAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    attrib->stCed = std::move(stCommonEntityData);
+    readTextData<Traits> (attrib, pabyInput, nBitOffsetFromStart);
 
-    attrib->sTag = ReadTV (pabyInput, nBitOffsetFromStart);
-    attrib->nFieldLength = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    attrib->nFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    DWGAttribSchema::read<Traits::version> (attrib, pabyInput,
+                                            nBitOffsetFromStart,
+                                            decodeProjection);
 
-    fillCommonEntityHandleData(attrib, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(attrib, pabyInput, nBitOffsetFromStart);
 
     attrib->hStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
@@ -2213,66 +2697,21 @@ CADAttribObject *DWGFileR2000::getAttributes(long dObjectSize,
     return attrib;
 }
 
+template<class Traits>
 CADAttdefObject *DWGFileR2000::getAttributesDefn(long dObjectSize,
-                                                 CADCommonED stCommonEntityData,
+                                                 CADCommonED &&stCommonEntityData,
                                                  const char *pabyInput,
                                                  size_t &nBitOffsetFromStart)
 {
     CADAttdefObject * attdef = new CADAttdefObject();
-    attdef->stCed = stCommonEntityData;
-    attdef->DataFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
-
-    if ( !(attdef->DataFlags & 0x01) )
-        attdef->dfElevation = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    CADVector vertInsetionPoint = ReadRAWVector(pabyInput, nBitOffsetFromStart);
-    attdef->vertInsetionPoint = vertInsetionPoint;
-
-    if ( !(attdef->DataFlags & 0x02) )
-    {
-        double x = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                                    vertInsetionPoint.getX());
-        double y = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                                    vertInsetionPoint.getY());
-        CADVector vertAlignmentPoint(x, y);
-        attdef->vertAlignmentPoint = vertAlignmentPoint;
-    }
-
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        attdef->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        attdef->vectExtrusion = vectExtrusion;
-    }
-
-    attdef->dfThickness = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                          0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    if ( !(attdef->DataFlags & 0x04) )
-        attdef->dfObliqueAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    if ( !(attdef->DataFlags & 0x08) )
-        attdef->dfRotationAng = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    attdef->dfHeight = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    if ( !(attdef->DataFlags & 0x10) )
-        attdef->dfWidthFactor = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-    attdef->sTextValue = ReadTV (pabyInput, nBitOffsetFromStart);
-    if ( !(attdef->DataFlags & 0x20) )
-        attdef->dGeneration = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    if ( !(attdef->DataFlags & 0x40) )
-        attdef->dHorizAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    if ( !(attdef->DataFlags & 0x80) )
-        attdef->dVertAlign = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-
-    attdef->sTag = ReadTV (pabyInput, nBitOffsetFromStart);
-    attdef->nFieldLength = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    attdef->nFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    attdef->stCed = std::move(stCommonEntityData);
+    readTextData<Traits> (attdef, pabyInput, nBitOffsetFromStart);
 
-    attdef->sPrompt = ReadTV (pabyInput, nBitOffsetFromStart);
+    DWGAttdefSchema::read<Traits::version> (attdef, pabyInput,
+                                            nBitOffsetFromStart,
+                                            decodeProjection);
 
-    fillCommonEntityHandleData(attdef, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(attdef, pabyInput, nBitOffsetFromStart);
 
     attdef->hStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
@@ -2287,18 +2726,20 @@ CADAttdefObject *DWGFileR2000::getAttributesDefn(long dObjectSize,
     return  attdef;
             }
 
+template<class Traits>
 CADLWPolylineObject *DWGFileR2000::getLWPolyLine(long dObjectSize,
-                                                 CADCommonED stCommonEntityData,
+                                                 CADCommonED &&stCommonEntityData,
                                                  const char *pabyInput,
                                                  size_t &nBitOffsetFromStart)
 {
     CADLWPolylineObject * polyline   = new CADLWPolylineObject ();
     polyline->setSize(dObjectSize);
-    polyline->stCed = stCommonEntityData;
+    polyline->stCed = std::move(stCommonEntityData);
 
     double x, y;
     int vertixesCount  = 0, nBulges = 0, nNumWidths = 0;
     short dataFlag = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    polyline->bClosed = (dataFlag & 512) != 0;
     if ( dataFlag & 4 )
         polyline->dfConstWidth = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     if ( dataFlag & 8 )
@@ -2324,22 +2765,32 @@ CADLWPolylineObject *DWGFileR2000::getLWPolyLine(long dObjectSize,
         nNumWidths = ReadBITLONG (pabyInput, nBitOffsetFromStart);
     }
 
-    // First of all, read first vertex.
-    CADVector vertex = ReadRAWVector(pabyInput, nBitOffsetFromStart);
-    polyline->avertVertexes.push_back (vertex);
-
-    // All the others are not raw doubles; bitdoubles with default instead,
-    // where default is previous point coords.
-    size_t prev;
-    for ( int i = 1; i < vertixesCount; ++i )
+    if ( Traits::hasCompressedData )
     {
-        prev = size_t(i - 1);
-        x = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                                           polyline->avertVertexes[prev].getX());
-        y = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                                           polyline->avertVertexes[prev].getY());
-        CADVector vertex(x, y);
+        // First of all, read first vertex.
+        CADVector vertex = ReadRAWVector(pabyInput, nBitOffsetFromStart);
         polyline->avertVertexes.push_back (vertex);
+
+        // All the others are not raw doubles; bitdoubles with default instead,
+        // where default is previous point coords.
+        size_t prev;
+        for ( int i = 1; i < vertixesCount; ++i )
+        {
+            prev = size_t(i - 1);
+            x = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                 polyline->avertVertexes[prev].getX());
+            y = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                 polyline->avertVertexes[prev].getY());
+            CADVector vertex(x, y);
+            polyline->avertVertexes.push_back (vertex);
+        }
+    }
+    else
+    {
+        // R13-R14 vertexes are raw doubles
+        for ( int i = 0; i < vertixesCount; ++i )
+            polyline->avertVertexes.push_back (ReadRAWVector (pabyInput,
+                                                    nBitOffsetFromStart));
     }
 
     for ( int i = 0; i < nBulges; ++i )
@@ -2355,7 +2806,7 @@ CADLWPolylineObject *DWGFileR2000::getLWPolyLine(long dObjectSize,
         polyline->astWidths.push_back ( make_pair ( dfStartWidth, dfEndWidth ) );
     }
 
-    fillCommonEntityHandleData(polyline, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(polyline, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     polyline->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -2368,54 +2819,26 @@ CADLWPolylineObject *DWGFileR2000::getLWPolyLine(long dObjectSize,
     return polyline;
 }
 
+template<class Traits>
 CADArcObject *DWGFileR2000::getArc(long dObjectSize,
-                                   CADCommonED stCommonEntityData,
+                                   CADCommonED &&stCommonEntityData,
                                    const char *pabyInput,
                                    size_t &nBitOffsetFromStart)
 {
-    CADArcObject * arc = new CADArcObject();
-
-    arc->stCed = stCommonEntityData;
-
-    CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
-    arc->vertPosition    = vertPosition;
-    arc->dfRadius        = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    arc->dfThickness     = ReadBIT (pabyInput, nBitOffsetFromStart) ?
-                           0.0f : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    if ( ReadBIT (pabyInput, nBitOffsetFromStart) )
-    {
-        arc->vectExtrusion = CADVector(0.0f, 0.0f, 1.0f);
-    }
-    else
-    {
-        CADVector vectExtrusion = ReadVector(pabyInput, nBitOffsetFromStart);
-        arc->vectExtrusion = vectExtrusion;
-    }
-
-    arc->dfStartAngle = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    arc->dfEndAngle   = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-
-    fillCommonEntityHandleData(arc, pabyInput, nBitOffsetFromStart);
-
-    nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
-    arc->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
-#ifdef _DEBUG
-    if ( (nBitOffsetFromStart/8) != (dObjectSize + 4) )
-        DebugMsg ("Assertion failed at %d in %s\nSize difference: %d\n",
-                  __LINE__, __FILE__, (nBitOffsetFromStart/8 - dObjectSize - 4));
-#endif // _DEBUG
-    return arc;
+    return readEntity<Traits, DWGArcSchema, CADArcObject>(dObjectSize,
+                        std::move(stCommonEntityData), pabyInput,
+                        nBitOffsetFromStart);
 }
 
+template<class Traits>
 CADSplineObject *DWGFileR2000::getSpline(long dObjectSize,
-                                         CADCommonED stCommonEntityData,
+                                         CADCommonED &&stCommonEntityData,
                                          const char *pabyInput,
                                          size_t &nBitOffsetFromStart)
 {
     CADSplineObject * spline = new CADSplineObject();
     spline->setSize(dObjectSize);
-    spline->stCed = stCommonEntityData;
+    spline->stCed = std::move(stCommonEntityData);
     spline->dScenario = ReadBITLONG (pabyInput, nBitOffsetFromStart);
     spline->dDegree  = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
@@ -2435,8 +2858,9 @@ CADSplineObject *DWGFileR2000::getSpline(long dObjectSize,
         spline->bRational = ReadBIT (pabyInput, nBitOffsetFromStart);
         spline->bClosed = ReadBIT (pabyInput, nBitOffsetFromStart);
         spline->bPeriodic = ReadBIT (pabyInput, nBitOffsetFromStart);
-        spline->dfKnotTol = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-        spline->dfCtrlTol = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        DWGSplineTolerancesSchema::read<Traits::version> (spline, pabyInput,
+                                                          nBitOffsetFromStart,
+                                                          decodeProjection);
 
         spline->nNumKnots = ReadBITLONG (pabyInput, nBitOffsetFromStart);
         spline->adfKnots.reserve( spline->nNumKnots );
@@ -2469,7 +2893,7 @@ CADSplineObject *DWGFileR2000::getSpline(long dObjectSize,
         spline->averFitPoints.push_back ( vertex );
     }
 
-    fillCommonEntityHandleData(spline, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(spline, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     spline->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -2482,9 +2906,10 @@ CADSplineObject *DWGFileR2000::getSpline(long dObjectSize,
     return spline;
 }
 
+template<class Traits>
 CADEntityObject *DWGFileR2000::getEntity(int dObjectType,
                                          long dObjectSize,
-                                         CADCommonED stCommonEntityData,
+                                         CADCommonED &&stCommonEntityData,
                                          const char *pabyInput,
                                          size_t &nBitOffsetFromStart)
 {
@@ -2492,12 +2917,12 @@ CADEntityObject *DWGFileR2000::getEntity(int dObjectType,
 
     entity->setType (static_cast<CADObject::ObjectType>(dObjectType));
     entity->setSize (dObjectSize);
-    entity->stCed = stCommonEntityData;
+    entity->stCed = std::move(stCommonEntityData);
 
     nBitOffsetFromStart = static_cast<size_t>(
                 entity->stCed.nObjectSizeInBits + 16);
 
-    fillCommonEntityHandleData(entity, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(entity, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     entity->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -2509,8 +2934,9 @@ CADEntityObject *DWGFileR2000::getEntity(int dObjectType,
     return entity;
 }
 
+template<class Traits>
 CADInsertObject *DWGFileR2000::getInsert(int dObjectType, long dObjectSize,
-                                         CADCommonED stCommonEntityData,
+                                         CADCommonED &&stCommonEntityData,
                                          const char *pabyInput,
                                          size_t &nBitOffsetFromStart)
 {
@@ -2518,14 +2944,21 @@ CADInsertObject *DWGFileR2000::getInsert(int dObjectType, long dObjectSize,
 
     insert->setType (static_cast<CADObject::ObjectType>(dObjectType));
     insert->setSize (dObjectSize);
-    insert->stCed = stCommonEntityData;
+    insert->stCed = std::move(stCommonEntityData);
 
     insert->vertInsertionPoint = ReadVector(pabyInput, nBitOffsetFromStart);
-    unsigned char dataFlags = Read2B(pabyInput, nBitOffsetFromStart);
+    // R13-R14 scales are not compressed
+    unsigned char dataFlags = Traits::hasCompressedData ?
+                Read2B(pabyInput, nBitOffsetFromStart) : 0xFF;
     double val41 = 1.0;
     double val42 = 1.0;
     double val43 = 1.0;
-    if(dataFlags == 0){
+    if(dataFlags == 0xFF){
+        val41 = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        val42 = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        val43 = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+    else if(dataFlags == 0){
         val41 = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
         val42 = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart, val41);
         val43 = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart, val41);
@@ -2544,13 +2977,16 @@ CADInsertObject *DWGFileR2000::getInsert(int dObjectType, long dObjectSize,
     insert->dfRotation = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     insert->vectExtrusion = ReadVector (pabyInput, nBitOffsetFromStart);
     insert->bHasAttribs = ReadBIT (pabyInput, nBitOffsetFromStart);
+    insert->nObjectsOwned = 0;
+    if(insert->bHasAttribs && Traits::hasOwnedHandles)
+        insert->nObjectsOwned = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
-    fillCommonEntityHandleData(insert, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(insert, pabyInput, nBitOffsetFromStart);
 
     insert->hBlockHeader = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     if(insert->bHasAttribs){
-        insert->hAtrribs.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart));
-        insert->hAtrribs.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart));
+        readOwnedHandles<Traits> (insert->nObjectsOwned, insert->hAtrribs,
+                                  pabyInput, nBitOffsetFromStart);
         insert->hSeqend = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     }
 
@@ -2565,6 +3001,7 @@ CADInsertObject *DWGFileR2000::getInsert(int dObjectType, long dObjectSize,
     return insert;
 }
 
+template<class Traits>
 CADDictionaryObject *DWGFileR2000::getDictionary(long dObjectSize,
                                                  const char *pabyInput,
                                                  size_t &nBitOffsetFromStart)
@@ -2578,7 +3015,8 @@ CADDictionaryObject *DWGFileR2000::getDictionary(long dObjectSize,
     CADDictionaryObject * dictionary = new CADDictionaryObject();
 
     dictionary->setSize (dObjectSize);
-    dictionary->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        dictionary->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     dictionary->hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize = 0;
@@ -2595,22 +3033,32 @@ CADDictionaryObject *DWGFileR2000::getDictionary(long dObjectSize,
 
         dictionary->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        dictionary->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     dictionary->nNumReactors = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    dictionary->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
     dictionary->nNumItems = ReadBITLONG (pabyInput, nBitOffsetFromStart);
-    dictionary->dCloningFlag = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    dictionary->dHardOwnerFlag = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    if( Traits::version == CADVersions::DWG_R14 )
+        nBitOffsetFromStart += 8; // unknown RC
+    if( Traits::hasPlotStyle )
+    {
+        dictionary->dCloningFlag = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+        dictionary->dHardOwnerFlag = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    }
 
     for ( long i = 0; i < dictionary->nNumItems; ++i )
-        dictionary->sItemNames.push_back ( ReadTV (pabyInput,
-                                                   nBitOffsetFromStart) );
+        dictionary->sItemNames.push_back ( ReadText (pabyInput,
+                                                     nBitOffsetFromStart) );
 
     dictionary->hParentHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     for ( long i = 0; i < dictionary->nNumReactors; ++i )
         dictionary->hReactors.push_back (ReadHANDLE (pabyInput,
                                                      nBitOffsetFromStart) );
-    dictionary->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !dictionary->bNoXDictionaryPresent )
+        dictionary->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     for ( long i = 0; i < dictionary->nNumItems; ++i )
         dictionary->hItemHandles.push_back ( ReadHANDLE (pabyInput,
                                                          nBitOffsetFromStart) );
@@ -2626,6 +3074,7 @@ CADDictionaryObject *DWGFileR2000::getDictionary(long dObjectSize,
     return dictionary;
 }
 
+template<class Traits>
 CADLayerObject *DWGFileR2000::getLayerObject(long dObjectSize,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
@@ -2633,7 +3082,8 @@ CADLayerObject *DWGFileR2000::getLayerObject(long dObjectSize,
     CADLayerObject * layer = new CADLayerObject();
 
     layer->setSize (dObjectSize);
-    layer->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        layer->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     layer->hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize = 0;
@@ -2650,27 +3100,46 @@ CADLayerObject *DWGFileR2000::getLayerObject(long dObjectSize,
 
         layer->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        layer->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     layer->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
-    layer->sLayerName = ReadTV (pabyInput, nBitOffsetFromStart);
+    layer->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
+    layer->sLayerName = ReadText (pabyInput, nBitOffsetFromStart);
     layer->b64Flag = ReadBIT (pabyInput, nBitOffsetFromStart);
     layer->dXRefIndex = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     layer->bXDep = ReadBIT (pabyInput, nBitOffsetFromStart);
 
-    short dFlags = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-                layer->bFrozen = dFlags & 0x01;
-                layer->bOn     = dFlags & 0x02;
-                layer->bFrozenInNewVPORT = dFlags & 0x04;
-                layer->bLocked = dFlags & 0x08;
-                layer->bPlottingFlag = dFlags & 0x10;
-                layer->dLineWeight = dFlags & 0x03E0;
-    layer->dCMColor = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasPlotStyle )
+    {
+        short dFlags = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+                    layer->bFrozen = dFlags & 0x01;
+                    layer->bOn     = dFlags & 0x02;
+                    layer->bFrozenInNewVPORT = dFlags & 0x04;
+                    layer->bLocked = dFlags & 0x08;
+                    layer->bPlottingFlag = dFlags & 0x10;
+                    layer->dLineWeight = dFlags & 0x03E0;
+    }
+    else
+    {
+        // R13-R14 store the flags as separate bits
+        layer->bFrozen = ReadBIT (pabyInput, nBitOffsetFromStart);
+        layer->bOn = ReadBIT (pabyInput, nBitOffsetFromStart);
+        layer->bFrozenInNewVPORT = ReadBIT (pabyInput, nBitOffsetFromStart);
+        layer->bLocked = ReadBIT (pabyInput, nBitOffsetFromStart);
+    }
+    layer->dCMColor = readCMC<Traits> (pabyInput, nBitOffsetFromStart);
     layer->hLayerControl = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     for ( long i = 0; i < layer->nNumReactors; ++i )
         layer->hReactors.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart) );
-    layer->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !layer->bNoXDictionaryPresent )
+        layer->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     layer->hExternalRefBlockHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-    layer->hPlotStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasPlotStyle )
+        layer->hPlotStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasMaterials )
+        skipHANDLE (pabyInput, nBitOffsetFromStart); // material
     layer->hLType = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     /*
@@ -2692,6 +3161,7 @@ CADLayerObject *DWGFileR2000::getLayerObject(long dObjectSize,
     return layer;
 }
 
+template<class Traits>
 CADLayerControlObject *DWGFileR2000::getLayerControl(long dObjectSize,
                                                      const char *pabyInput,
                                                      size_t &nBitOffsetFromStart)
@@ -2699,7 +3169,8 @@ CADLayerControlObject *DWGFileR2000::getLayerControl(long dObjectSize,
     CADLayerControlObject * layerControl = new CADLayerControlObject();
 
     layerControl->setSize (dObjectSize);
-    layerControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        layerControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     layerControl->hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize = 0;
@@ -2717,11 +3188,16 @@ CADLayerControlObject *DWGFileR2000::getLayerControl(long dObjectSize,
 
         layerControl->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        layerControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     layerControl->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
+    layerControl->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
     layerControl->nNumEntries = ReadBITLONG (pabyInput, nBitOffsetFromStart);
     layerControl->hNull = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-    layerControl->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !layerControl->bNoXDictionaryPresent )
+        layerControl->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     for ( long i = 0; i < layerControl->nNumEntries; ++i )
         layerControl->hLayers.push_back( ReadHANDLE (pabyInput, nBitOffsetFromStart) );
 
@@ -2735,6 +3211,7 @@ CADLayerControlObject *DWGFileR2000::getLayerControl(long dObjectSize,
     return layerControl;
 }
 
+template<class Traits>
 CADBlockControlObject *DWGFileR2000::getBlockControl(long dObjectSize,
                                                      const char *pabyInput,
                                                      size_t &nBitOffsetFromStart)
@@ -2742,7 +3219,8 @@ CADBlockControlObject *DWGFileR2000::getBlockControl(long dObjectSize,
     CADBlockControlObject * blockControl = new CADBlockControlObject();
 
     blockControl->setSize (dObjectSize);
-    blockControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        blockControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     blockControl->hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize = 0;
@@ -2759,12 +3237,17 @@ CADBlockControlObject *DWGFileR2000::getBlockControl(long dObjectSize,
 
         blockControl->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        blockControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     blockControl->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
+    blockControl->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
     blockControl->nNumEntries = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
     blockControl->hNull = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-    blockControl->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !blockControl->bNoXDictionaryPresent )
+        blockControl->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     for ( long i = 0; i < blockControl->nNumEntries + 2; ++i )
     {
@@ -2781,6 +3264,7 @@ CADBlockControlObject *DWGFileR2000::getBlockControl(long dObjectSize,
     return blockControl;
 }
 
+template<class Traits>
 CADBlockHeaderObject *DWGFileR2000::getBlockHeader(long dObjectSize,
                                                    const char *pabyInput,
                                                    size_t &nBitOffsetFromStart)
@@ -2788,7 +3272,8 @@ CADBlockHeaderObject *DWGFileR2000::getBlockHeader(long dObjectSize,
     CADBlockHeaderObject * blockHeader = new CADBlockHeaderObject();
 
     blockHeader->setSize (dObjectSize);
-    blockHeader->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        blockHeader->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     blockHeader->hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize;
@@ -2805,9 +3290,13 @@ CADBlockHeaderObject *DWGFileR2000::getBlockHeader(long dObjectSize,
 
         blockHeader->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        blockHeader->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     blockHeader->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
-    blockHeader->sEntryName = ReadTV (pabyInput, nBitOffsetFromStart);
+    blockHeader->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
+    blockHeader->sEntryName = ReadText (pabyInput, nBitOffsetFromStart);
     blockHeader->b64Flag = ReadBIT (pabyInput, nBitOffsetFromStart);
     blockHeader->dXRefIndex = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     blockHeader->bXDep = ReadBIT (pabyInput, nBitOffsetFromStart);
@@ -2815,40 +3304,59 @@ CADBlockHeaderObject *DWGFileR2000::getBlockHeader(long dObjectSize,
     blockHeader->bHasAtts = ReadBIT (pabyInput, nBitOffsetFromStart);
     blockHeader->bBlkisXRef = ReadBIT (pabyInput, nBitOffsetFromStart);
     blockHeader->bXRefOverlaid = ReadBIT (pabyInput, nBitOffsetFromStart);
-    blockHeader->bLoadedBit = ReadBIT (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasPlotStyle )
+        blockHeader->bLoadedBit = ReadBIT (pabyInput, nBitOffsetFromStart);
+    blockHeader->nOwnedObjectsCount = 0;
+    if ( Traits::hasOwnedHandles &&
+         !blockHeader->bBlkisXRef && !blockHeader->bXRefOverlaid )
+        blockHeader->nOwnedObjectsCount = ReadBITLONG (pabyInput,
+                                                       nBitOffsetFromStart);
 
     CADVector vertBasePoint = ReadVector(pabyInput, nBitOffsetFromStart);
     blockHeader->vertBasePoint = vertBasePoint;
-    blockHeader->sXRefPName = ReadTV (pabyInput, nBitOffsetFromStart);
-    unsigned char Tmp;
-    do
-    {
-        Tmp = ReadCHAR (pabyInput, nBitOffsetFromStart );
-                    blockHeader->adInsertCount.push_back(Tmp);
-    } while ( Tmp != 0 );
-
-    blockHeader->sBlockDescription = ReadTV (pabyInput, nBitOffsetFromStart);
-    blockHeader->nSizeOfPreviewData = ReadBITLONG (pabyInput, nBitOffsetFromStart);
-    for ( long i = 0; i < blockHeader->nSizeOfPreviewData; ++i )
-        blockHeader->abyBinaryPreviewData.push_back ( ReadCHAR (pabyInput,
-                                                        nBitOffsetFromStart) );
+    blockHeader->sXRefPName = ReadText (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasPlotStyle )
+    {
+        unsigned char Tmp;
+        do
+        {
+            Tmp = ReadCHAR (pabyInput, nBitOffsetFromStart );
+                        blockHeader->adInsertCount.push_back(Tmp);
+        } while ( Tmp != 0 );
+
+        blockHeader->sBlockDescription = ReadText (pabyInput, nBitOffsetFromStart);
+        blockHeader->nSizeOfPreviewData = ReadBITLONG (pabyInput, nBitOffsetFromStart);
+        for ( long i = 0; i < blockHeader->nSizeOfPreviewData; ++i )
+            blockHeader->abyBinaryPreviewData.push_back ( ReadCHAR (pabyInput,
+                                                            nBitOffsetFromStart) );
+    }
+    if( Traits::hasMaterials )
+    {
+        skipBITSHORT (pabyInput, nBitOffsetFromStart); // insert units
+        skipBIT (pabyInput, nBitOffsetFromStart);      // explodable
+        nBitOffsetFromStart += 8;                      // block scaling
+    }
 
     blockHeader->hBlockControl = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     for ( long i = 0; i < blockHeader->nNumReactors; ++i )
         blockHeader->hReactors.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) );
-    blockHeader->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !blockHeader->bNoXDictionaryPresent )
+        blockHeader->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     blockHeader->hNull = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     blockHeader->hBlockEntity = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     if ( !blockHeader->bBlkisXRef && !blockHeader->bXRefOverlaid )
-    {
-        blockHeader->hEntities.push_back ( ReadHANDLE(pabyInput, nBitOffsetFromStart) ); // first
-        blockHeader->hEntities.push_back ( ReadHANDLE(pabyInput, nBitOffsetFromStart) ); // last
-    }
+        readOwnedHandles<Traits> (blockHeader->nOwnedObjectsCount,
+                                  blockHeader->hEntities, pabyInput,
+                                  nBitOffsetFromStart);
 
     blockHeader->hEndBlk = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-    for ( size_t i = 0; i < blockHeader->adInsertCount.size() - 1; ++i )
-        blockHeader->hInsertHandles.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) );
-    blockHeader->hLayout = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasPlotStyle )
+    {
+        for ( size_t i = 1; i < blockHeader->adInsertCount.size(); ++i )
+            blockHeader->hInsertHandles.push_back ( ReadHANDLE (pabyInput,
+                                                        nBitOffsetFromStart) );
+        blockHeader->hLayout = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    }
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     blockHeader->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -2860,13 +3368,15 @@ CADBlockHeaderObject *DWGFileR2000::getBlockHeader(long dObjectSize,
     return blockHeader;
 }
 
+template<class Traits>
 CADLineTypeControlObject *DWGFileR2000::getLineTypeControl(long dObjectSize,
                                                            const char *pabyInput,
                                                            size_t &nBitOffsetFromStart)
 {
     CADLineTypeControlObject * ltypeControl = new CADLineTypeControlObject();
     ltypeControl->setSize (dObjectSize);
-    ltypeControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        ltypeControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     ltypeControl->hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize = 0;
@@ -2883,12 +3393,17 @@ CADLineTypeControlObject *DWGFileR2000::getLineTypeControl(long dObjectSize,
 
         ltypeControl->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        ltypeControl->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     ltypeControl->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
+    ltypeControl->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
     ltypeControl->nNumEntries = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
     ltypeControl->hNull = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-    ltypeControl->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !ltypeControl->bNoXDictionaryPresent )
+        ltypeControl->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     // hLTypes ends with BYLAYER and BYBLOCK
     for ( long i = 0; i < ltypeControl->nNumEntries + 2; ++i )
@@ -2906,6 +3421,7 @@ CADLineTypeControlObject *DWGFileR2000::getLineTypeControl(long dObjectSize,
     return ltypeControl;
 }
 
+template<class Traits>
 CADLineTypeObject *DWGFileR2000::getLineType1(long dObjectSize,
                                               const char *pabyInput,
                                               size_t &nBitOffsetFromStart)
@@ -2913,7 +3429,8 @@ CADLineTypeObject *DWGFileR2000::getLineType1(long dObjectSize,
     CADLineTypeObject * ltype = new CADLineTypeObject();
 
     ltype->setSize (dObjectSize);
-    ltype->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        ltype->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     ltype->hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     short dEEDSize = 0;
     CADEed dwgEed;
@@ -2929,13 +3446,17 @@ CADLineTypeObject *DWGFileR2000::getLineType1(long dObjectSize,
 
         ltype->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        ltype->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     ltype->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
-    ltype->sEntryName = ReadTV (pabyInput, nBitOffsetFromStart);
+    ltype->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
+    ltype->sEntryName = ReadText (pabyInput, nBitOffsetFromStart);
     ltype->b64Flag = ReadBIT (pabyInput, nBitOffsetFromStart);
     ltype->dXRefIndex = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     ltype->bXDep = ReadBIT (pabyInput, nBitOffsetFromStart);
-    ltype->sDescription = ReadTV (pabyInput, nBitOffsetFromStart);
+    ltype->sDescription = ReadText (pabyInput, nBitOffsetFromStart);
     ltype->dfPatternLen = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     ltype->dAlignment = ReadCHAR (pabyInput, nBitOffsetFromStart);
     ltype->nNumDashes = ReadCHAR (pabyInput, nBitOffsetFromStart);
@@ -2954,7 +3475,18 @@ CADLineTypeObject *DWGFileR2000::getLineType1(long dObjectSize,
         ltype->astDashes.push_back ( dash );
     }
 
-    for ( short i = 0; i < 256; ++i )
+    // R2007+ text area is present only if the shapes have text
+    short nTextAreaSize = 256;
+    if( Traits::hasStringStream )
+    {
+        nTextAreaSize = 0;
+        for( const CADDash& stDash : ltype->astDashes )
+        {
+            if( stDash.dShapeflag & 0x02 )
+                nTextAreaSize = 512;
+        }
+    }
+    for ( short i = 0; i < nTextAreaSize; ++i )
         ltype->abyTextArea.push_back ( ReadCHAR (pabyInput, nBitOffsetFromStart ) );
 
     ltype->hLTControl = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -2962,7 +3494,8 @@ CADLineTypeObject *DWGFileR2000::getLineType1(long dObjectSize,
     for ( long i = 0; i < ltype->nNumReactors; ++i )
         ltype->hReactors.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) );
 
-    ltype->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !ltype->bNoXDictionaryPresent )
+        ltype->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     ltype->hXRefBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     // TODO: shapefile for dash/shape (1 each). Does it mean that we have nNumDashes * 2 handles, or what?
@@ -2978,15 +3511,16 @@ CADLineTypeObject *DWGFileR2000::getLineType1(long dObjectSize,
     return ltype;
 }
 
+template<class Traits>
 CADMLineObject *DWGFileR2000::getMLine(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
 {
     CADMLineObject * mline = new CADMLineObject();
 
     mline->setSize (dObjectSize);
-    mline->stCed = stCommonEntityData;
+    mline->stCed = std::move(stCommonEntityData);
 
     mline->dfScale = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     mline->dJust = ReadCHAR (pabyInput, nBitOffsetFromStart);
@@ -3028,28 +3562,7 @@ CADMLineObject *DWGFileR2000::getMLine(long dObjectSize,
         mline->avertVertexes.push_back (stVertex);
     }
 
-    if ( mline->stCed.bbEntMode == 0 )
-        mline->stChed.hOwner = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-
-    for ( long i = 0; i < mline->stCed.nNumReactors; ++i )
-        mline->stChed.hReactors.push_back (
-                    ReadHANDLE (pabyInput, nBitOffsetFromStart));
-
-    mline->stChed.hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-
-    if ( !mline->stCed.bNoLinks )
-    {
-        mline->stChed.hPrevEntity = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-        mline->stChed.hNextEntity = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-    }
-
-    mline->stChed.hLayer = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-
-    if ( mline->stCed.bbLTypeFlags == 0x03 )
-        mline->stChed.hLType = ReadHANDLE (pabyInput, nBitOffsetFromStart);
-
-    if ( mline->stCed.bbPlotStyleFlags == 0x03 )
-        mline->stChed.hPlotStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(mline, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     mline->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -3062,23 +3575,26 @@ CADMLineObject *DWGFileR2000::getMLine(long dObjectSize,
     return mline;
 }
 
+template<class Traits>
 CADPolylinePFaceObject *DWGFileR2000::getPolylinePFace(long dObjectSize,
-                                                       CADCommonED stCommonEntityData,
+                                                       CADCommonED &&stCommonEntityData,
                                                        const char *pabyInput,
                                                        size_t &nBitOffsetFromStart)
 {
     CADPolylinePFaceObject * polyline = new CADPolylinePFaceObject();
 
     polyline->setSize (dObjectSize);
-    polyline->stCed = stCommonEntityData;
+    polyline->stCed = std::move(stCommonEntityData);
 
     polyline->nNumVertexes = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     polyline->nNumFaces = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    polyline->nObjectsOwned = Traits::hasOwnedHandles ?
+                ReadBITLONG (pabyInput, nBitOffsetFromStart) : 0;
 
-    fillCommonEntityHandleData(polyline, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(polyline, pabyInput, nBitOffsetFromStart);
 
-    polyline->hVertexes.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) ); // 1st vertex
-    polyline->hVertexes.push_back ( ReadHANDLE (pabyInput, nBitOffsetFromStart) ); // last vertex
+    readOwnedHandles<Traits> (polyline->nObjectsOwned, polyline->hVertexes,
+                              pabyInput, nBitOffsetFromStart);
 
     polyline->hSeqend = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
@@ -3093,15 +3609,16 @@ CADPolylinePFaceObject *DWGFileR2000::getPolylinePFace(long dObjectSize,
     return polyline;
 }
 
+template<class Traits>
 CADImageObject *DWGFileR2000::getImage(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
 {
     CADImageObject * image = new CADImageObject();
 
     image->setSize (dObjectSize);
-    image->stCed = stCommonEntityData;
+    image->stCed = std::move(stCommonEntityData);
 
     image->dClassVersion = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
@@ -3144,7 +3661,7 @@ CADImageObject *DWGFileR2000::getImage(long dObjectSize,
         }
     }
 
-    fillCommonEntityHandleData(image, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(image, pabyInput, nBitOffsetFromStart);
 
     image->hImageDef = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     image->hImageDefReactor = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3161,44 +3678,58 @@ CADImageObject *DWGFileR2000::getImage(long dObjectSize,
     return image;
 }
 
+template<class Traits>
 CAD3DFaceObject *DWGFileR2000::get3DFace(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
 {
     CAD3DFaceObject * face = new CAD3DFaceObject();
 
     face->setSize (dObjectSize);
-    face->stCed = stCommonEntityData;
+    face->stCed = std::move(stCommonEntityData);
 
-    face->bHasNoFlagInd = ReadBIT (pabyInput, nBitOffsetFromStart);
-    face->bZZero = ReadBIT (pabyInput, nBitOffsetFromStart);
+    if ( Traits::hasCompressedData )
+    {
+        face->bHasNoFlagInd = ReadBIT (pabyInput, nBitOffsetFromStart);
+        face->bZZero = ReadBIT (pabyInput, nBitOffsetFromStart);
 
-    double x, y, z;
+        double x, y, z;
 
-    CADVector vertex = ReadRAWVector(pabyInput, nBitOffsetFromStart);
-    if ( !face->bZZero ){
-        z = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
-        vertex.setZ (z);
-    }
-    face->avertCorners.push_back (vertex);
-    for ( size_t i = 1; i < 4; ++i )
-    {
-        x = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                             face->avertCorners[i-1].getX());
-        y = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                             face->avertCorners[i-1].getY());
-        z = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
-                             face->avertCorners[i-1].getZ());
+        CADVector vertex = ReadRAWVector(pabyInput, nBitOffsetFromStart);
+        if ( !face->bZZero ){
+            z = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+            vertex.setZ (z);
+        }
+        face->avertCorners.push_back (vertex);
+        for ( size_t i = 1; i < 4; ++i )
+        {
+            x = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                 face->avertCorners[i-1].getX());
+            y = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                 face->avertCorners[i-1].getY());
+            z = ReadBITDOUBLEWD (pabyInput, nBitOffsetFromStart,
+                                 face->avertCorners[i-1].getZ());
+
+            CADVector corner(x, y, z);
+            face->avertCorners.push_back (corner);
+        }
 
-        CADVector corner(x, y, z);
-        face->avertCorners.push_back (corner);
+        if ( !face->bHasNoFlagInd )
+            face->dInvisFlags = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     }
-
-    if ( !face->bHasNoFlagInd )
+    else
+    {
+        // R13-R14 corners are not compressed, invisibility flags are stored
+        face->bHasNoFlagInd = false;
+        face->bZZero = false;
+        for ( size_t i = 0; i < 4; ++i )
+            face->avertCorners.push_back (ReadVector (pabyInput,
+                                                      nBitOffsetFromStart));
         face->dInvisFlags = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    }
 
-    fillCommonEntityHandleData(face, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(face, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
     face->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -3211,21 +3742,22 @@ CAD3DFaceObject *DWGFileR2000::get3DFace(long dObjectSize,
     return face;
 }
 
+template<class Traits>
 CADVertexMeshObject *DWGFileR2000::getVertexMesh(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
 {
     CADVertexMeshObject * vertex = new CADVertexMeshObject();
 
     vertex->setSize (dObjectSize);
-    vertex->stCed = stCommonEntityData;
+    vertex->stCed = std::move(stCommonEntityData);
 
     /*unsigned char Flags = */ReadCHAR (pabyInput, nBitOffsetFromStart);
     CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
     vertex->vertPosition = vertPosition;
 
-    fillCommonEntityHandleData(vertex, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(vertex, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
     vertex->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -3238,21 +3770,22 @@ CADVertexMeshObject *DWGFileR2000::getVertexMesh(long dObjectSize,
     return vertex;
 }
 
+template<class Traits>
 CADVertexPFaceObject *DWGFileR2000::getVertexPFace(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
 {
     CADVertexPFaceObject * vertex = new CADVertexPFaceObject();
 
     vertex->setSize (dObjectSize);
-    vertex->stCed = stCommonEntityData;
+    vertex->stCed = std::move(stCommonEntityData);
 
     /*unsigned char Flags = */ReadCHAR (pabyInput, nBitOffsetFromStart);
     CADVector vertPosition = ReadVector(pabyInput, nBitOffsetFromStart);
     vertex->vertPosition = vertPosition;
 
-    fillCommonEntityHandleData(vertex, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(vertex, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 ); // padding bits to next byte boundary
     vertex->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -3264,15 +3797,16 @@ CADVertexPFaceObject *DWGFileR2000::getVertexPFace(long dObjectSize,
     return vertex;
 }
 
+template<class Traits>
 CADMTextObject *DWGFileR2000::getMText(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                                        const char *pabyInput,
                                        size_t &nBitOffsetFromStart)
 {
     CADMTextObject * text = new CADMTextObject();
 
     text->setSize (dObjectSize);
-    text->stCed = stCommonEntityData;
+    text->stCed = std::move(stCommonEntityData);
 
     CADVector vertInsertionPoint = ReadVector(pabyInput, nBitOffsetFromStart);
     text->vertInsertionPoint = vertInsertionPoint;
@@ -3283,18 +3817,35 @@ CADMTextObject *DWGFileR2000::getMText(long dObjectSize,
     CADVector vectXAxisDir = ReadVector(pabyInput, nBitOffsetFromStart);
     text->vectXAxisDir = vectXAxisDir;
 
+    if( Traits::hasMaterials )
+        skipBITDOUBLE (pabyInput, nBitOffsetFromStart); // rect height
     text->dfRectWidth = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     text->dfTextHeight = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     text->dAttachment = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     text->dDrawingDir = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
     text->dfExtents = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     text->dfExtentsWidth = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    text->sTextValue = ReadTV (pabyInput, nBitOffsetFromStart);
-    text->dLineSpacingStyle = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    text->dLineSpacingFactor = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    text->bUnknownBit = ReadBIT (pabyInput, nBitOffsetFromStart);
+    DWGProjectedText::read<Traits::version> (text->sTextValue, pabyInput,
+                                             nBitOffsetFromStart,
+                                             decodeProjection);
+    if( Traits::hasPlotStyle )
+    {
+        text->dLineSpacingStyle = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+        text->dLineSpacingFactor = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        text->bUnknownBit = ReadBIT (pabyInput, nBitOffsetFromStart);
+    }
+    if( Traits::hasOwnedHandles )
+    {
+        // background fill: flags, scale, color and transparency
+        if( ReadBITLONG (pabyInput, nBitOffsetFromStart) & 0x01 )
+        {
+            skipBITLONG (pabyInput, nBitOffsetFromStart);
+            readCMC<Traits> (pabyInput, nBitOffsetFromStart);
+            skipBITLONG (pabyInput, nBitOffsetFromStart);
+        }
+    }
 
-    fillCommonEntityHandleData(text, pabyInput, nBitOffsetFromStart);
+    fillCommonEntityHandleData<Traits>(text, pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     text->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -3306,8 +3857,9 @@ CADMTextObject *DWGFileR2000::getMText(long dObjectSize,
     return text;
 }
 
+template<class Traits>
 CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSize,
-                                               CADCommonED stCommonEntityData,
+                                               CADCommonED &&stCommonEntityData,
                                                const char *pabyInput,
                                                size_t &nBitOffsetFromStart)
 {
@@ -3322,7 +3874,9 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
     stCDD.dfElevation = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     stCDD.dFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
 
-    stCDD.sUserText = ReadTV (pabyInput, nBitOffsetFromStart);
+    DWGProjectedText::read<Traits::version> (stCDD.sUserText, pabyInput,
+                                             nBitOffsetFromStart,
+                                             decodeProjection);
     stCDD.dfTextRotation = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     stCDD.dfHorizDir = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
@@ -3331,10 +3885,21 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
     stCDD.dfInsZScale = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
     stCDD.dfInsRotation = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
-    stCDD.dAttachmentPoint = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    stCDD.dLineSpacingStyle = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
-    stCDD.dfLineSpacingFactor = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
-    stCDD.dfActualMeasurement = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasPlotStyle )
+    {
+        stCDD.dAttachmentPoint = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+        stCDD.dLineSpacingStyle = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+        stCDD.dfLineSpacingFactor = ReadBITDOUBLE (pabyInput,
+                                                   nBitOffsetFromStart);
+        stCDD.dfActualMeasurement = ReadBITDOUBLE (pabyInput,
+                                                   nBitOffsetFromStart);
+    }
+    if( Traits::hasMaterials )
+    {
+        skipBIT (pabyInput, nBitOffsetFromStart); // unknown
+        skipBIT (pabyInput, nBitOffsetFromStart); // flip arrow 1
+        skipBIT (pabyInput, nBitOffsetFromStart); // flip arrow 2
+    }
 
     CADVector vert12Pt = ReadRAWVector(pabyInput, nBitOffsetFromStart);
     stCDD.vert12Pt = vert12Pt;
@@ -3347,7 +3912,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
                     new CADDimensionOrdinateObject();
 
             dimension->setSize (dObjectSize);
-            dimension->stCed = stCommonEntityData;
+            dimension->stCed = std::move(stCommonEntityData);
             dimension->cdd = stCDD;
 
             CADVector vert10pt = ReadVector(pabyInput, nBitOffsetFromStart);
@@ -3361,7 +3926,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
 
             dimension->Flags2 = ReadCHAR (pabyInput, nBitOffsetFromStart);
 
-            fillCommonEntityHandleData(dimension, pabyInput, nBitOffsetFromStart);
+            fillCommonEntityHandleData<Traits>(dimension, pabyInput, nBitOffsetFromStart);
 
             dimension->hDimstyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
             dimension->hAnonymousBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3381,7 +3946,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
             CADDimensionLinearObject * dimension = new CADDimensionLinearObject();
 
             dimension->setSize (dObjectSize);
-            dimension->stCed = stCommonEntityData;
+            dimension->stCed = std::move(stCommonEntityData);
             dimension->cdd = stCDD;
 
             CADVector vert13pt = ReadVector(pabyInput, nBitOffsetFromStart);
@@ -3396,7 +3961,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
             dimension->dfExtLnRot = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
             dimension->dfDimRot = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
-            fillCommonEntityHandleData(dimension, pabyInput, nBitOffsetFromStart);
+            fillCommonEntityHandleData<Traits>(dimension, pabyInput, nBitOffsetFromStart);
 
             dimension->hDimstyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
             dimension->hAnonymousBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3417,7 +3982,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
                     new CADDimensionAlignedObject();
 
             dimension->setSize (dObjectSize);
-            dimension->stCed = stCommonEntityData;
+            dimension->stCed = std::move(stCommonEntityData);
             dimension->cdd = stCDD;
 
             CADVector vert13pt = ReadVector(pabyInput, nBitOffsetFromStart);
@@ -3432,7 +3997,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
             dimension->dfExtLnRot =
                     ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
-            fillCommonEntityHandleData(dimension, pabyInput, nBitOffsetFromStart);
+            fillCommonEntityHandleData<Traits>(dimension, pabyInput, nBitOffsetFromStart);
 
             dimension->hDimstyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
             dimension->hAnonymousBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3453,7 +4018,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
                     new CADDimensionAngular3PtObject();
 
             dimension->setSize (dObjectSize);
-            dimension->stCed = stCommonEntityData;
+            dimension->stCed = std::move(stCommonEntityData);
             dimension->cdd = stCDD;
 
             CADVector vert10pt = ReadVector(pabyInput, nBitOffsetFromStart);
@@ -3468,7 +4033,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
             CADVector vert15pt = ReadVector(pabyInput, nBitOffsetFromStart);
             dimension->vert15pt = vert15pt;
 
-            fillCommonEntityHandleData(dimension, pabyInput, nBitOffsetFromStart);
+            fillCommonEntityHandleData<Traits>(dimension, pabyInput, nBitOffsetFromStart);
 
             dimension->hDimstyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
             dimension->hAnonymousBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3489,7 +4054,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
                     new CADDimensionAngular2LnObject();
 
             dimension->setSize (dObjectSize);
-            dimension->stCed = stCommonEntityData;
+            dimension->stCed = std::move(stCommonEntityData);
             dimension->cdd = stCDD;
 
             CADVector vert16pt = ReadVector(pabyInput, nBitOffsetFromStart);
@@ -3507,7 +4072,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
             CADVector vert10pt = ReadVector(pabyInput, nBitOffsetFromStart);
             dimension->vert10pt = vert10pt;
 
-            fillCommonEntityHandleData(dimension, pabyInput, nBitOffsetFromStart);
+            fillCommonEntityHandleData<Traits>(dimension, pabyInput, nBitOffsetFromStart);
 
             dimension->hDimstyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
             dimension->hAnonymousBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3528,7 +4093,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
                     new CADDimensionRadiusObject();
 
             dimension->setSize (dObjectSize);
-            dimension->stCed = stCommonEntityData;
+            dimension->stCed = std::move(stCommonEntityData);
             dimension->cdd = stCDD;
 
             CADVector vert10pt = ReadVector(pabyInput, nBitOffsetFromStart);
@@ -3539,7 +4104,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
 
             dimension->dfLeaderLen = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
-            fillCommonEntityHandleData(dimension, pabyInput, nBitOffsetFromStart);
+            fillCommonEntityHandleData<Traits>(dimension, pabyInput, nBitOffsetFromStart);
 
             dimension->hDimstyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
             dimension->hAnonymousBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3560,7 +4125,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
                     new CADDimensionDiameterObject();
 
             dimension->setSize (dObjectSize);
-            dimension->stCed = stCommonEntityData;
+            dimension->stCed = std::move(stCommonEntityData);
             dimension->cdd = stCDD;
 
             CADVector vert15pt = ReadVector(pabyInput, nBitOffsetFromStart);
@@ -3571,7 +4136,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
 
             dimension->dfLeaderLen = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
 
-            fillCommonEntityHandleData(dimension, pabyInput, nBitOffsetFromStart);
+            fillCommonEntityHandleData<Traits>(dimension, pabyInput, nBitOffsetFromStart);
 
             dimension->hDimstyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
             dimension->hAnonymousBlock = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3589,6 +4154,7 @@ CADDimensionObject *DWGFileR2000::getDimension(short dObjectType,long dObjectSiz
     return nullptr;
 }
 
+template<class Traits>
 CADImageDefObject *DWGFileR2000::getImageDef(long dObjectSize,
                                              const char *pabyInput,
                                              size_t &nBitOffsetFromStart)
@@ -3596,7 +4162,8 @@ CADImageDefObject *DWGFileR2000::getImageDef(long dObjectSize,
     CADImageDefObject * imagedef = new CADImageDefObject();
 
     imagedef->setSize (dObjectSize);
-    imagedef->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        imagedef->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     imagedef->hObjectHandle = ReadHANDLE8BLENGTH (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize = 0;
@@ -3613,14 +4180,18 @@ CADImageDefObject *DWGFileR2000::getImageDef(long dObjectSize,
 
         imagedef->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        imagedef->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     imagedef->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
+    imagedef->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
     imagedef->dClassVersion = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
     imagedef->dfXImageSizeInPx = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
     imagedef->dfYImageSizeInPx = ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
 
-    imagedef->sFilePath = ReadTV (pabyInput, nBitOffsetFromStart);
+    imagedef->sFilePath = ReadText (pabyInput, nBitOffsetFromStart);
     imagedef->bIsLoaded = ReadBIT (pabyInput, nBitOffsetFromStart);
 
     imagedef->dResUnits = ReadCHAR (pabyInput, nBitOffsetFromStart);
@@ -3633,7 +4204,8 @@ CADImageDefObject *DWGFileR2000::getImageDef(long dObjectSize,
     for ( long i = 0; i < imagedef->nNumReactors; ++i )
         imagedef->hReactors.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart) );
 
-    imagedef->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !imagedef->bNoXDictionaryPresent )
+        imagedef->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     imagedef->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -3646,6 +4218,7 @@ CADImageDefObject *DWGFileR2000::getImageDef(long dObjectSize,
     return imagedef;
 }
 
+template<class Traits>
 CADImageDefReactorObject *DWGFileR2000::getImageDefReactor(long dObjectSize,
                                              const char *pabyInput,
                                              size_t &nBitOffsetFromStart)
@@ -3654,7 +4227,8 @@ CADImageDefReactorObject *DWGFileR2000::getImageDefReactor(long dObjectSize,
     CADImageDefReactorObject * imagedefreactor = new CADImageDefReactorObject();
 
     imagedefreactor->setSize (dObjectSize);
-    imagedefreactor->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    if( !Traits::objectSizeAfterEED )
+        imagedefreactor->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     imagedefreactor->hObjectHandle = ReadHANDLE8BLENGTH (pabyInput, nBitOffsetFromStart);
 
     short dEEDSize = 0;
@@ -3671,8 +4245,12 @@ CADImageDefReactorObject *DWGFileR2000::getImageDefReactor(long dObjectSize,
 
         imagedefreactor->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        imagedefreactor->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     imagedefreactor->nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
+    imagedefreactor->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
     imagedefreactor->dClassVersion = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
     imagedefreactor->hParentHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
@@ -3680,7 +4258,8 @@ CADImageDefReactorObject *DWGFileR2000::getImageDefReactor(long dObjectSize,
     for ( long i = 0; i < imagedefreactor->nNumReactors; ++i )
         imagedefreactor->hReactors.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart) );
 
-    imagedefreactor->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !imagedefreactor->bNoXDictionaryPresent )
+        imagedefreactor->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     nBitOffsetFromStart += 8 - ( nBitOffsetFromStart % 8 );
     imagedefreactor->setCRC (ReadRAWSHORT (pabyInput, nBitOffsetFromStart));
@@ -3693,6 +4272,7 @@ CADImageDefReactorObject *DWGFileR2000::getImageDefReactor(long dObjectSize,
     return imagedefreactor;
 }
 
+template<class Traits>
 CADXRecordObject *DWGFileR2000::getXRecord(long dObjectSize,
                                            const char *pabyInput,
                                            size_t &nBitOffsetFromStart)
@@ -3701,7 +4281,8 @@ CADXRecordObject *DWGFileR2000::getXRecord(long dObjectSize,
     CADXRecordObject * xrecord = new CADXRecordObject();
 
     xrecord->setSize (dObjectSize);
-    xrecord->nObjectSizeInBits = ReadRAWLONG( pabyInput, nBitOffsetFromStart );
+    if( !Traits::objectSizeAfterEED )
+        xrecord->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
     xrecord->hObjectHandle = ReadHANDLE8BLENGTH( pabyInput, nBitOffsetFromStart );
 
     short dEEDSize = 0;
@@ -3718,8 +4299,12 @@ CADXRecordObject *DWGFileR2000::getXRecord(long dObjectSize,
 
         xrecord->aEED.push_back (dwgEed);
     }
+    if( Traits::objectSizeAfterEED )
+        xrecord->nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
 
     xrecord->nNumReactors = ReadBITLONG( pabyInput, nBitOffsetFromStart );
+    xrecord->bNoXDictionaryPresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
     xrecord->nNumDataBytes = ReadBITLONG (pabyInput, nBitOffsetFromStart);
 
     for( long i = 0; i < xrecord->nNumDataBytes; ++i )
@@ -3727,7 +4312,8 @@ CADXRecordObject *DWGFileR2000::getXRecord(long dObjectSize,
         xrecord->abyDataBytes.push_back( ReadCHAR(pabyInput, nBitOffsetFromStart) );
     }
 
-    xrecord->dCloningFlag = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
+    if( Traits::hasPlotStyle )
+        xrecord->dCloningFlag = ReadBITSHORT( pabyInput, nBitOffsetFromStart );
 
     short dIndicatorNumber = ReadRAWSHORT( pabyInput, nBitOffsetFromStart );
     if( dIndicatorNumber == 1 )
@@ -3759,7 +4345,8 @@ CADXRecordObject *DWGFileR2000::getXRecord(long dObjectSize,
     for ( long i = 0; i < xrecord->nNumReactors; ++i )
         xrecord->hReactors.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart) );
 
-    xrecord->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !xrecord->bNoXDictionaryPresent )
+        xrecord->hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     while( nBitOffsetFromStart / 8 < (dObjectSize + 4) )
     {
@@ -3777,6 +4364,7 @@ CADXRecordObject *DWGFileR2000::getXRecord(long dObjectSize,
     return xrecord;
 }
 
+template<class Traits>
 void DWGFileR2000::fillCommonEntityHandleData(CADEntityObject* pEnt,
                                               const char *pabyInput,
                                               size_t &nBitOffsetFromStart)
@@ -3788,26 +4376,168 @@ void DWGFileR2000::fillCommonEntityHandleData(CADEntityObject* pEnt,
         pEnt->stChed.hReactors.push_back (ReadHANDLE (pabyInput,
                                                         nBitOffsetFromStart));
 
-    pEnt->stChed.hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    if ( !pEnt->stCed.bNoXDictionaryHandlePresent )
+        pEnt->stChed.hXDictionary = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
-    if ( !pEnt->stCed.bNoLinks )
+    // R13-R14 store the layer and line type before the links
+    if ( !Traits::hasPlotStyle )
+    {
+        pEnt->stChed.hLayer = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+        if ( pEnt->stCed.bbLTypeFlags == 0x03 )
+            pEnt->stChed.hLType = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    }
+
+    // R2004+ entities have no links, owners list their handles
+    if ( !Traits::hasOwnedHandles && !pEnt->stCed.bNoLinks )
     {
         pEnt->stChed.hPrevEntity = ReadHANDLE (pabyInput, nBitOffsetFromStart);
         pEnt->stChed.hNextEntity = ReadHANDLE (pabyInput, nBitOffsetFromStart);
     }
 
+    if ( !Traits::hasPlotStyle )
+        return;
+
+    if ( pEnt->stCed.bColorBookHandlePresent )
+        skipHANDLE (pabyInput, nBitOffsetFromStart);
+
     pEnt->stChed.hLayer = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
     if ( pEnt->stCed.bbLTypeFlags == 0x03 )
         pEnt->stChed.hLType = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 
+    // R2007+ material handle goes before the plot style one
+    if ( pEnt->stCed.bbMaterialFlags == 0x03 )
+        pEnt->stChed.hMaterial = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+
     if ( pEnt->stCed.bbPlotStyleFlags == 0x03 )
         pEnt->stChed.hPlotStyle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
 }
 
-DWGFileR2000::DWGFileR2000(CADFileIO* poFileIO) : CADFile(poFileIO)
+template<class Traits>
+void DWGFileR2000::readCommonEntityData(CADCommonED &stCed,
+                                        const char *pabyInput,
+                                        size_t &nBitOffsetFromStart)
+{
+    if( !Traits::objectSizeAfterEED )
+        stCed.nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    stCed.hObjectHandle = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+
+    short dEEDSize;
+    CADEed dwgEed;
+    while ( (dEEDSize = ReadBITSHORT (pabyInput, nBitOffsetFromStart)) != 0 )
+    {
+        if( !(decodeProjection & PROJECTION_EED) )
+        {
+            skipHANDLE (pabyInput, nBitOffsetFromStart);
+            nBitOffsetFromStart += dEEDSize * 8;
+            continue;
+        }
+
+        dwgEed.dLength = dEEDSize;
+        dwgEed.hApplication = ReadHANDLE (pabyInput, nBitOffsetFromStart);
+
+        for ( short i = 0; i < dEEDSize; ++i )
+        {
+            dwgEed.acData.push_back(ReadCHAR (pabyInput, nBitOffsetFromStart));
+        }
+
+        stCed.aEED.push_back (dwgEed);
+    }
+
+    stCed.bGraphicsPresented = ReadBIT (pabyInput, nBitOffsetFromStart);
+    if(stCed.bGraphicsPresented){
+        size_t nGraphicsDataSize = static_cast<size_t>(
+                    ReadRAWLONG (pabyInput, nBitOffsetFromStart));
+        // skip read graphics data
+        nBitOffsetFromStart += nGraphicsDataSize * 8;
+    }
+    if( Traits::objectSizeAfterEED )
+        stCed.nObjectSizeInBits = ReadRAWLONG (pabyInput, nBitOffsetFromStart);
+    stCed.bbEntMode = Read2B (pabyInput, nBitOffsetFromStart);
+    stCed.nNumReactors = ReadBITLONG (pabyInput, nBitOffsetFromStart);
+    stCed.bNoXDictionaryHandlePresent =
+            readNoXDictionaryFlag<Traits> (pabyInput, nBitOffsetFromStart);
+    // R13-R14 line type is either by layer or set by the handle
+    bool bByLayerLType = false;
+    if( !Traits::hasPlotStyle )
+        bByLayerLType = ReadBIT (pabyInput, nBitOffsetFromStart);
+    stCed.bNoLinks = ReadBIT (pabyInput, nBitOffsetFromStart);
+    stCed.bColorBookHandlePresent = false;
+    if( Traits::hasOwnedHandles )
+        stCed.nCMColor = ReadENC (pabyInput, nBitOffsetFromStart,
+                                  stCed.bColorBookHandlePresent);
+    else
+        stCed.nCMColor = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    if( !(decodeProjection & PROJECTION_COLOR) )
+        stCed.nCMColor = 256; // ByLayer
+    stCed.dfLTypeScale = ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    if( Traits::hasPlotStyle )
+    {
+        stCed.bbLTypeFlags = Read2B (pabyInput, nBitOffsetFromStart);
+        stCed.bbPlotStyleFlags = Read2B (pabyInput, nBitOffsetFromStart);
+    }
+    else
+    {
+        // 3 means the line type handle is present, as in R2000
+        stCed.bbLTypeFlags = bByLayerLType ? 0 : 3;
+        stCed.bbPlotStyleFlags = 0; // ByLayer
+    }
+    stCed.bbMaterialFlags = 0;
+    stCed.nShadowFlags = 0;
+    if( Traits::hasMaterials )
+    {
+        stCed.bbMaterialFlags = Read2B (pabyInput, nBitOffsetFromStart);
+        stCed.nShadowFlags = ReadCHAR (pabyInput, nBitOffsetFromStart);
+    }
+    stCed.nInvisibility = ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    stCed.nLineWeight = 29; // ByLayer
+    if( Traits::hasPlotStyle )
+        stCed.nLineWeight = ReadCHAR (pabyInput, nBitOffsetFromStart);
+}
+
+template<class Traits>
+bool DWGFileR2000::readNoXDictionaryFlag(const char *pabyInput,
+                                         size_t &nBitOffsetFromStart)
+{
+    if( !Traits::hasNoXDictionaryFlag )
+        return false;
+    return ReadBIT (pabyInput, nBitOffsetFromStart);
+}
+
+template<class Traits>
+short DWGFileR2000::readCMC(const char *pabyInput, size_t &nBitOffsetFromStart)
 {
-    header.addValue(CADHeader::OPENCADVER, CADVersions::DWG_R2000);
+    return ReadCMC (pabyInput, nBitOffsetFromStart, Traits::version);
+}
+
+template<class Traits>
+void DWGFileR2000::readOwnedHandles(long nOwnedObjectsCount,
+                                    CADHandleArray &handles,
+                                    const char *pabyInput,
+                                    size_t &nBitOffsetFromStart)
+{
+    if( !Traits::hasOwnedHandles )
+    {
+        handles.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart)); // first
+        handles.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart)); // last
+        return;
+    }
+
+    for( long i = 0; i < nOwnedObjectsCount; ++i )
+        handles.push_back (ReadHANDLE (pabyInput, nBitOffsetFromStart));
+}
+
+DWGFileR2000::DWGFileR2000(CADFileIO* poFileIO) :
+    DWGFileR2000(poFileIO, CADVersions::DWG_R2000)
+{
+}
+
+DWGFileR2000::DWGFileR2000(CADFileIO* poFileIO, int nVersion) :
+    CADFile(poFileIO), dwgVersion(nVersion),
+    objectReader(getObjectReader(nVersion)),
+    objectHeaderReader(getObjectHeaderReader(nVersion)), imageSeeker(0)
+{
+    header.addValue(CADHeader::OPENCADVER, nVersion);
 }
 
 DWGFileR2000::~DWGFileR2000()
@@ -3860,6 +4590,21 @@ int DWGFileR2000::readSectionLocator()
     return CADErrorCodes::SUCCESS;
 }
 
+int DWGFileR2000::readSectionData(size_t nSection, vector<char>& data)
+{
+    if( nSection >= sectionLocatorRecords.size () ||
+        sectionLocatorRecords[nSection].dSize <= 0 )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    // the whole section is read at once, not by small chunks
+    data.resize (static_cast<size_t>(sectionLocatorRecords[nSection].dSize));
+    if( fileIO->Seek (sectionLocatorRecords[nSection].dSeeker,
+                      CADFileIO::SeekOrigin::BEG) != 0 ||
+        fileIO->Read (data.data (), data.size ()) != data.size () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    return CADErrorCodes::SUCCESS;
+}
+
 // TODO: code is really bad. Just for test purposes only, will fix later.
 string DWGFileR2000::getESRISpatialRef()
 {
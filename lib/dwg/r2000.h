@@ -33,6 +33,7 @@
 #define DWG_R2000_H_H
 
 #include "cadfile.h"
+#include "traits.h"
 
 struct SectionLocatorRecord
 {
@@ -79,9 +80,20 @@ class DWGFileR2000 : public CADFile
 {
 public:
     DWGFileR2000(CADFileIO* poFileIO);
+    /**
+     * @brief Constructor for the versions which share the R2000 objects
+     * layout: R13 and R14 files have the same structure, later versions
+     * derive their own file classes. OpenCADFile does not open R13 and R14
+     * files yet, their layouts are not checked on real drawings.
+     * @param poFileIO File in/out
+     * @param nVersion File version, one of CADVersions
+     */
+    DWGFileR2000(CADFileIO* poFileIO, int nVersion);
     virtual             ~DWGFileR2000();
 
     string              getESRISpatialRef() override;
+    int                 getObjectCensus(ObjectCensus& census,
+                                        bool bLayers = true) override;
 protected:
     virtual int         readSectionLocator() override;
     virtual int         readHeader(enum OpenOptions eOptions) override;
@@ -89,96 +101,255 @@ protected:
     virtual int         createFileMap() override;
 
     CADObject *         getObject(long index, bool bHandlesOnly = false) override;
-    CADGeometry *       getGeometry(long index) override;
+    CADEntityObject *   getEntityHandles(long index) override;
+    CADGeometry *       getGeometry(long index, int projection) override;
+    CADGeometry *       readGeometry(long index);
+
+    /**
+     * @brief Read the whole section: start sentinel, size, data, CRC and end
+     * sentinel for the header variables and classes, chunks for the objects
+     * map
+     * @param nSection Section locator record number: 0 - header variables,
+     * 1 - classes, 2 - objects map
+     * @param data Section data
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    virtual int         readSectionData(size_t nSection, std::vector<char>& data);
 
 protected:
-    CADBlockObject *getBlock(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADBlockObject *getBlock(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADEllipseObject *getEllipse(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADEllipseObject *getEllipse(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADSolidObject *getSolid(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADSolidObject *getSolid(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADPointObject *getPoint(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADPointObject *getPoint(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADPolyline3DObject *getPolyLine3D(long dObjectSize,
-                                       CADCommonED stCommonEntityData,
+                                       CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADRayObject *getRay(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADRayObject *getRay(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADXLineObject *getXLine(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADXLineObject *getXLine(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADLineObject *getLine(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADLineObject *getLine(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADTextObject *getText(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADTextObject *getText(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADVertex3DObject *getVertex3D(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADVertex3DObject *getVertex3D(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADCircleObject *getCircle(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADCircleObject *getCircle(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADEndblkObject *getEndBlock(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADEndblkObject *getEndBlock(long dObjectSize, CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADPolyline2DObject *getPolyline2D(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADPolyline2DObject *getPolyline2D(long dObjectSize, CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADAttribObject *getAttributes(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADAttribObject *getAttributes(long dObjectSize, CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADAttdefObject *getAttributesDefn(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADAttdefObject *getAttributesDefn(long dObjectSize, CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADLWPolylineObject *getLWPolyLine(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADLWPolylineObject *getLWPolyLine(long dObjectSize, CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADArcObject *getArc(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADArcObject *getArc(long dObjectSize, CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADSplineObject *getSpline(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADSplineObject *getSpline(long dObjectSize, CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADEntityObject *getEntity(int dObjectType, long dObjectSize,
-                               CADCommonED stCommonEntityData,
+                               CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADInsertObject *getInsert(int dObjectType, long dObjectSize,
-                               CADCommonED stCommonEntityData,
+                               CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADDictionaryObject *getDictionary(long dObjectSize,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADXRecordObject *getXRecord(long dObjectSize,
                                 const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADLayerObject *getLayerObject(long dObjectSize,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADLayerControlObject *getLayerControl(long dObjectSize,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADBlockControlObject *getBlockControl(long dObjectSize,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADBlockHeaderObject *getBlockHeader(long dObjectSize,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADLineTypeControlObject *getLineTypeControl(long dObjectSize,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADLineTypeObject *getLineType1(long dObjectSize,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADMLineObject *getMLine(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADMLineObject *getMLine(long dObjectSize, CADCommonED &&stCommonEntityData,
                              const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADPolylinePFaceObject *getPolylinePFace(long dObjectSize,
-                                             CADCommonED stCommonEntityData,
+                                             CADCommonED &&stCommonEntityData,
                                              const char *pabyInput,
                                              size_t &nBitOffsetFromStart);
-    CADImageObject *getImage(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADImageObject *getImage(long dObjectSize, CADCommonED &&stCommonEntityData,
                             const char *pabyInput, size_t &nBitOffsetFromStart);
-    CAD3DFaceObject *get3DFace(long dObjectSize,  CADCommonED stCommonEntityData,
+    template<class Traits>
+    CAD3DFaceObject *get3DFace(long dObjectSize,  CADCommonED &&stCommonEntityData,
                                const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADVertexMeshObject *getVertexMesh(long dObjectSize,  CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADVertexMeshObject *getVertexMesh(long dObjectSize,  CADCommonED &&stCommonEntityData,
                                        const char *pabyInput, size_t &nBitOffsetFromStart);
-    CADVertexPFaceObject *getVertexPFace(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADVertexPFaceObject *getVertexPFace(long dObjectSize, CADCommonED &&stCommonEntityData,
                                          const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADDimensionObject *getDimension(short dObjectType, long dObjectSize,
-                                           CADCommonED stCommonEntityData,
+                                           CADCommonED &&stCommonEntityData,
                                            const char *pabyInput,
                                            size_t &nBitOffsetFromStart);
-    CADMTextObject *getMText(long dObjectSize, CADCommonED stCommonEntityData,
+    template<class Traits>
+    CADMTextObject *getMText(long dObjectSize, CADCommonED &&stCommonEntityData,
                             const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADImageDefObject *getImageDef(long dObjectSize,
                             const char *pabyInput, size_t &nBitOffsetFromStart);
+    template<class Traits>
     CADImageDefReactorObject *getImageDefReactor(long dObjectSize,
                                                  const char *pabyInput,
                                                  size_t &nBitOffsetFromStart);
+    /**
+     * @brief Decode entity described by schema, then common handles and CRC
+     */
+    template<class Traits, class Schema, class Object>
+    Object *readEntity(long dObjectSize, CADCommonED &&stCommonEntityData,
+                       const char *pabyInput, size_t &nBitOffsetFromStart);
+    /**
+     * @brief Read the common entity handles which follow the entity fields
+     */
+    template<class Traits>
     void fillCommonEntityHandleData(CADEntityObject *pEnt, const char *pabyInput,
                                     size_t &nBitOffsetFromStart);
+    /**
+     * @brief Read the common entity data which precedes the entity fields
+     * @param stCed Common entity data to fill
+     */
+    template<class Traits>
+    void readCommonEntityData(CADCommonED &stCed, const char *pabyInput,
+                              size_t &nBitOffsetFromStart);
+    /**
+     * @brief Read the R2004+ XDic missing flag of the common object data
+     * @return true if the object has no extension dictionary handle
+     */
+    template<class Traits>
+    bool readNoXDictionaryFlag(const char *pabyInput, size_t &nBitOffsetFromStart);
+    /**
+     * @brief Read CMC color, R2004+ colors have RGB value and names
+     * @return ACI color index
+     */
+    template<class Traits>
+    short readCMC(const char *pabyInput, size_t &nBitOffsetFromStart);
+    /**
+     * @brief Read the handles of owned entities: the first and the last ones
+     * linked to each other before R2004, all of them since R2004
+     * @param nOwnedObjectsCount R2004+ owned objects count
+     * @param handles Handles array to fill
+     */
+    template<class Traits>
+    void readOwnedHandles(long nOwnedObjectsCount, CADHandleArray &handles,
+                          const char *pabyInput, size_t &nBitOffsetFromStart);
+protected:
+    typedef CADObject * (*EntityDecoder)(DWGFileR2000 * file, short dObjectType,
+                                         long dObjectSize,
+                                         CADCommonED &&stCommonEntityData,
+                                         const char *pabyInput,
+                                         size_t &nBitOffsetFromStart);
+    typedef CADObject * (*ObjectDecoder)(DWGFileR2000 * file, long dObjectSize,
+                                         const char *pabyInput,
+                                         size_t &nBitOffsetFromStart);
+    /**
+     * @brief The object type decoders, entity decoder is set for entities
+     */
+    struct ObjectDecoders
+    {
+        EntityDecoder   entity;
+        ObjectDecoder   object;
+    };
+
+    /**
+     * @brief Get the version decoders for the object type
+     * @param dObjectType Object type
+     * @return pointer to decoders or nullptr if object type is not supported
+     */
+    template<class Traits>
+    static const ObjectDecoders *getObjectDecoders(short dObjectType);
+    template<class Traits>
+    static std::vector<ObjectDecoders> createObjectDecoders();
+
+    typedef CADObject * (DWGFileR2000::*ObjectReader)(long index,
+                                                      bool bHandlesOnly);
+    /**
+     * @brief Read the object with the version decoders
+     */
+    template<class Traits>
+    CADObject *readObject(long index, bool bHandlesOnly);
+    /**
+     * @brief Get the object reader instantiated for the file version
+     * @param nVersion File version, one of CADVersions
+     */
+    static ObjectReader getObjectReader(int nVersion);
+
+    typedef bool (DWGFileR2000::*ObjectHeaderReader)(long objectOffset,
+                                                     bool bEntityHandles,
+                                                     std::vector<char> &objectData,
+                                                     CADEntityObject &objectHeader,
+                                                     bool &bEntity);
+    /**
+     * @brief Read the object type and size, and the common data and handles
+     * if the object is an entity. The object fields are not decoded.
+     * @param objectOffset Object file offset
+     * @param bEntityHandles true to read the entity common data and handles
+     * @param objectData Buffer for the object data, if the file is not in
+     * memory
+     * @param objectHeader Object header to fill
+     * @param bEntity Set to true if the object is an entity
+     * @return true if OK, false if the object data could not be read
+     */
+    template<class Traits>
+    bool readObjectHeader(long objectOffset, bool bEntityHandles,
+                          std::vector<char> &objectData,
+                          CADEntityObject &objectHeader, bool &bEntity);
+    /**
+     * @brief Get the object header reader instantiated for the file version
+     * @param nVersion File version, one of CADVersions
+     */
+    static ObjectHeaderReader getObjectHeaderReader(int nVersion);
+
 protected:
+    int                                 dwgVersion; // CADVersions
+    ObjectReader                        objectReader;
+    ObjectHeaderReader                  objectHeaderReader;
     int                                 imageSeeker;
     std::vector<SectionLocatorRecord>   sectionLocatorRecords;
 };
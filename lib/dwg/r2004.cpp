@@ -0,0 +1,374 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#include "r2004.h"
+#include "io.h"
+#include "opencad_api.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+static const char DWG2004FileIdString[] = "AcFssFcAJMB";
+static const size_t DWG2004HeaderOffset = 0x80;
+static const size_t DWG2004HeaderSize = 0x6C;
+static const size_t DWG2004SystemPageHeaderSize = 20;
+static const size_t DWG2004DataPageHeaderSize = 32;
+static const size_t DWG2004SectionNameSize = 64;
+static const unsigned int DWG2004PageMapType = 0x41630E3B;
+static const unsigned int DWG2004SectionMapType = 0x4163003B;
+static const unsigned int DWG2004DataPageType = 0x4163043B;
+static const unsigned int DWG2004DataPageMask = 0x4164536B;
+
+template<class T>
+static T getValue(const vector<char>& data, size_t nOffset)
+{
+    T value = 0;
+    memcpy (&value, data.data () + nOffset, sizeof (T));
+    return value;
+}
+
+DWGFileR2004::DWGFileR2004(CADFileIO* poFileIO) :
+    DWGFileR2004(poFileIO, CADVersions::DWG_R2004)
+{
+}
+
+DWGFileR2004::DWGFileR2004(CADFileIO* poFileIO, int nVersion) :
+    DWGFileR2000(poFileIO, nVersion)
+{
+}
+
+DWGFileR2004::~DWGFileR2004()
+{
+}
+
+// ----------------------------------------------------------------------------
+// Page and section maps
+// ----------------------------------------------------------------------------
+
+int DWGFileR2004::readSectionLocator()
+{
+    char abyBuf[DWG2004HeaderOffset + DWG2004HeaderSize];
+
+    fileIO->Rewind ();
+    if( fileIO->Read (abyBuf, sizeof (abyBuf)) != sizeof (abyBuf) )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    readFileStart (abyBuf);
+
+    vector<char> fileHeader(abyBuf + DWG2004HeaderOffset,
+                            abyBuf + DWG2004HeaderOffset + DWG2004HeaderSize);
+    DecryptR2004Header (fileHeader.data (), fileHeader.size ());
+    if( memcmp (fileHeader.data (), DWG2004FileIdString,
+                sizeof (DWG2004FileIdString)) )
+    {
+        DebugMsg ("File is corrupted (wrong R2004 file header)\n");
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    }
+
+    long long nPageMapAddress = getValue<long long>(fileHeader, 0x54) + 0x100;
+    int nSectionMapId = getValue<int>(fileHeader, 0x5C);
+
+    // page map: number and size of all pages, they are stored one after
+    // another from the 0x100 offset
+    vector<char> pageMap;
+    int nResult = readSystemPage (nPageMapAddress, DWG2004PageMapType, pageMap);
+    if( nResult != CADErrorCodes::SUCCESS )
+        return nResult;
+
+    pageAddresses.clear ();
+    long long nAddress = 0x100;
+    size_t nOffset = 0;
+    while( nOffset + 8 <= pageMap.size () )
+    {
+        int nNumber = getValue<int>(pageMap, nOffset);
+        int nSize = getValue<int>(pageMap, nOffset + 4);
+        nOffset += 8;
+        if( nNumber < 0 )
+            nOffset += 16; // gap: parent, left, right and 0
+        else
+            pageAddresses[nNumber] = nAddress;
+        nAddress += nSize;
+    }
+
+    auto sectionMapAddress = pageAddresses.find (nSectionMapId);
+    if( sectionMapAddress == pageAddresses.end () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    vector<char> sectionMap;
+    nResult = readSystemPage (sectionMapAddress->second, DWG2004SectionMapType,
+                              sectionMap);
+    if( nResult != CADErrorCodes::SUCCESS )
+        return nResult;
+    if( sectionMap.size () < 20 )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    // descriptions count, 0x02, 0x7400, 0x00, unknown
+    int nSectionsCount = getValue<int>(sectionMap, 0);
+    DebugMsg ("Sections count: %d\n", nSectionsCount);
+    sections.clear ();
+    nOffset = 20;
+    for( int i = 0; i < nSectionsCount; ++i )
+    {
+        const size_t nDescriptionSize = 32 + DWG2004SectionNameSize;
+        if( nOffset + nDescriptionSize > sectionMap.size () )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+        DWG2004Section section;
+        section.nSize = getValue<long long>(sectionMap, nOffset);
+        int nPagesCount = getValue<int>(sectionMap, nOffset + 8);
+        section.nMaxDecompressed = getValue<int>(sectionMap, nOffset + 12);
+        section.nCompressed = getValue<int>(sectionMap, nOffset + 20);
+        section.nId = getValue<int>(sectionMap, nOffset + 24);
+        section.nEncrypted = getValue<int>(sectionMap, nOffset + 28);
+        const char * pszName = sectionMap.data () + nOffset + 32;
+        section.sName.assign (pszName, strnlen (pszName, DWG2004SectionNameSize));
+        nOffset += nDescriptionSize;
+
+        if( nPagesCount < 0 ||
+            nOffset + static_cast<size_t>(nPagesCount) * 16 > sectionMap.size () )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+        for( int j = 0; j < nPagesCount; ++j )
+        {
+            DWG2004SectionPage page;
+            page.nPageNumber = getValue<int>(sectionMap, nOffset);
+            page.nDataSize = getValue<int>(sectionMap, nOffset + 4);
+            page.nStartOffset = getValue<long long>(sectionMap, nOffset + 8);
+            section.pages.push_back (page);
+            nOffset += 16;
+        }
+
+        DebugMsg ("  Section %s : %lld bytes in %d pages\n",
+                  section.sName.c_str (), section.nSize, nPagesCount);
+        sections.push_back (section);
+    }
+
+    return CADErrorCodes::SUCCESS;
+}
+
+void DWGFileR2004::readFileStart(const char* pabyData)
+{
+    char abyVersion[DWG_VERSION_STR_SIZE + 1] = {0};
+    memcpy (abyVersion, pabyData, DWG_VERSION_STR_SIZE);
+    header.addValue (CADHeader::ACADVER, abyVersion);
+    char abyMaintenance[8] = {0};
+    memcpy (abyMaintenance, pabyData + DWG_VERSION_STR_SIZE, 7);
+    header.addValue (CADHeader::ACADMAINTVER, abyMaintenance);
+    memcpy (&imageSeeker, pabyData + 0x0D, 4);
+    DebugMsg ("Image seeker readed: %d\n", imageSeeker);
+    short dCodePage;
+    memcpy (&dCodePage, pabyData + 0x13, 2);
+    header.addValue (CADHeader::DWGCODEPAGE, dCodePage);
+    DebugMsg ("DWG Code page: %d\n", dCodePage);
+}
+
+int DWGFileR2004::readSystemPage(long long nAddress, unsigned int nType,
+                                 vector<char>& data)
+{
+    // type, decompressed size, compressed size, compression type, checksum
+    vector<char> pageHeader(DWG2004SystemPageHeaderSize);
+    if( fileIO->Seek (nAddress, CADFileIO::SeekOrigin::BEG) != 0 ||
+        fileIO->Read (pageHeader.data (), pageHeader.size ()) !=
+            pageHeader.size () ||
+        getValue<unsigned int>(pageHeader, 0) != nType )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    int nDecompressedSize = getValue<int>(pageHeader, 4);
+    int nCompressedSize = getValue<int>(pageHeader, 8);
+    int nCompressionType = getValue<int>(pageHeader, 12);
+    if( nDecompressedSize < 0 || nCompressedSize < 0 )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    vector<char> compressed(static_cast<size_t>(nCompressedSize));
+    if( fileIO->Read (compressed.data (), compressed.size ()) !=
+            compressed.size () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    if( nCompressionType != 2 )
+    {
+        data.swap (compressed);
+        return CADErrorCodes::SUCCESS;
+    }
+
+    data.resize (static_cast<size_t>(nDecompressedSize));
+    size_t nSize = 0;
+    if( !DecompressR2004 (compressed.data (), compressed.size (), data.data (),
+                          data.size (), nSize) )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    data.resize (nSize);
+    return CADErrorCodes::SUCCESS;
+}
+
+// ----------------------------------------------------------------------------
+// Sections
+// ----------------------------------------------------------------------------
+
+int DWGFileR2004::readSection(const char* pszName, vector<char>& data)
+{
+    auto section = find_if (sections.begin (), sections.end (),
+                            [pszName](const DWG2004Section& item)
+                            { return item.sName == pszName; });
+    if( section == sections.end () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    if( section->nEncrypted != 0 )
+    {
+        DebugMsg ("Encrypted section %s is not supported\n", pszName);
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    }
+
+    // the pages are read one by one, the file in/out is not shared
+    const size_t nPagesCount = section->pages.size ();
+    const size_t nMaxDecompressed = static_cast<size_t>(section->nMaxDecompressed);
+    size_t nDataSize = static_cast<size_t>(max (section->nSize, 0LL));
+    vector< vector<char> > pages(nPagesCount);
+    for( size_t i = 0; i < nPagesCount; ++i )
+    {
+        const DWG2004SectionPage& page = section->pages[i];
+        auto address = pageAddresses.find (page.nPageNumber);
+        if( address == pageAddresses.end () || page.nStartOffset < 0 )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+        unsigned int anHeader[DWG2004DataPageHeaderSize / 4];
+        if( fileIO->Seek (address->second, CADFileIO::SeekOrigin::BEG) != 0 ||
+            fileIO->Read (anHeader, sizeof (anHeader)) != sizeof (anHeader) )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+        const unsigned int nMask = DWG2004DataPageMask ^
+                static_cast<unsigned int>(address->second);
+        for( unsigned int& value : anHeader )
+            value ^= nMask;
+        // type, section id, compressed size, page size, start offset,
+        // header checksum, data checksum, unknown
+        if( anHeader[0] != DWG2004DataPageType )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+        pages[i].resize (anHeader[2]);
+        if( fileIO->Read (pages[i].data (), pages[i].size ()) != pages[i].size () )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+        nDataSize = max (nDataSize, static_cast<size_t>(page.nStartOffset) +
+                                    nMaxDecompressed);
+    }
+
+    data.assign (nDataSize, 0);
+    bool bDecoded = decodePages (nPagesCount, [&](size_t nPage)
+    {
+        const vector<char>& page = pages[nPage];
+        size_t nStartOffset =
+                static_cast<size_t>(section->pages[nPage].nStartOffset);
+        char * pabyDst = data.data () + nStartOffset;
+        size_t nDstSize = min (nMaxDecompressed, nDataSize - nStartOffset);
+        if( section->nCompressed != 2 )
+        {
+            if( page.size () > nDstSize )
+                return false;
+            memcpy (pabyDst, page.data (), page.size ());
+            return true;
+        }
+        size_t nSize = 0;
+        return DecompressR2004 (page.data (), page.size (), pabyDst, nDstSize,
+                                nSize);
+    });
+
+    if( !bDecoded )
+    {
+        DebugMsg ("Section %s is corrupted\n", pszName);
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    }
+    return CADErrorCodes::SUCCESS;
+}
+
+bool DWGFileR2004::decodePages(size_t nPagesCount,
+                               const function<bool(size_t)>& decodePage)
+{
+    size_t threadCount = max (thread::hardware_concurrency (), 1u);
+    threadCount = min (threadCount, nPagesCount);
+
+    atomic<size_t> nextPage(0);
+    atomic<bool> failed(false);
+    auto worker = [&]()
+    {
+        while( !failed )
+        {
+            size_t nPage = nextPage.fetch_add (1);
+            if( nPage >= nPagesCount )
+                break;
+            if( !decodePage (nPage) )
+                failed = true;
+        }
+    };
+
+    vector<thread> threads;
+    for( size_t i = 1; i < threadCount; ++i )
+        threads.push_back (thread(worker));
+    worker ();
+    for( thread& item : threads )
+        item.join ();
+    return !failed;
+}
+
+int DWGFileR2004::readSectionData(size_t nSection, vector<char>& data)
+{
+    static const char * const apszSectionNames[] = {
+        "AcDb:Header", "AcDb:Classes", "AcDb:Handles" };
+    if( nSection >= sizeof (apszSectionNames) / sizeof (apszSectionNames[0]) )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    return readSection (apszSectionNames[nSection], data);
+}
+
+int DWGFileR2004::createFileMap()
+{
+    // object map offsets are relative to the decompressed objects section
+    if( readSection ("AcDb:AcDbObjects", objectsData) !=
+            CADErrorCodes::SUCCESS )
+        return CADErrorCodes::OBJECTS_SECTION_READ_FAILED;
+    return DWGFileR2000::createFileMap ();
+}
+
+size_t DWGFileR2004::readData(long offset, void* ptr, size_t size)
+{
+    if( offset < 0 || static_cast<size_t>(offset) >= objectsData.size () )
+        return 0;
+    size = min (size, objectsData.size () - static_cast<size_t>(offset));
+    memcpy (ptr, objectsData.data () + offset, size);
+    return size;
+}
+
+const char* DWGFileR2004::mapData(long offset, size_t size) const
+{
+    if( offset < 0 || static_cast<size_t>(offset) > objectsData.size () ||
+        size > objectsData.size () - static_cast<size_t>(offset) )
+        return nullptr;
+    return objectsData.data () + offset;
+}
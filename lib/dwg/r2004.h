@@ -0,0 +1,136 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#ifndef DWG_R2004_H_H
+#define DWG_R2004_H_H
+
+#include "r2000.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The R2004 section page, the part of the section data
+ */
+struct DWG2004SectionPage
+{
+    int         nPageNumber   = 0;
+    int         nDataSize     = 0;
+    long long   nStartOffset  = 0;
+};
+
+/**
+ * @brief The R2004 section description from the section map
+ */
+struct DWG2004Section
+{
+    std::string sName;
+    long long   nSize            = 0;
+    int         nMaxDecompressed = 0;
+    int         nCompressed      = 0; // 2 - compressed, 1 - not
+    int         nId              = 0;
+    int         nEncrypted       = 0;
+    std::vector<DWG2004SectionPage> pages;
+};
+
+/**
+ * @brief R2004 DWG file. The objects are stored as in R2000, but the sections
+ * are split to the LZ77 compressed pages listed in the page and section maps.
+ */
+class DWGFileR2004 : public DWGFileR2000
+{
+public:
+    DWGFileR2004(CADFileIO* poFileIO);
+    virtual             ~DWGFileR2004();
+
+protected:
+    /**
+     * @brief Constructor for the later versions with the paged sections
+     * @param poFileIO File in/out
+     * @param nVersion File version, one of CADVersions
+     */
+    DWGFileR2004(CADFileIO* poFileIO, int nVersion);
+
+    virtual int         readSectionLocator() override;
+    virtual int         createFileMap() override;
+    virtual int         readSectionData(size_t nSection,
+                                        std::vector<char>& data) override;
+    /**
+     * @brief Read the object data from the decompressed objects section
+     */
+    virtual size_t      readData(long offset, void* ptr, size_t size) override;
+    /**
+     * @brief Get the object data in the decompressed objects section
+     */
+    virtual const char* mapData(long offset, size_t size) const override;
+
+protected:
+    /**
+     * @brief Read the version, image seeker and code page from the file start
+     * @param pabyData The first 0x80 bytes of the file
+     */
+    void                readFileStart(const char* pabyData);
+    /**
+     * @brief Read and decompress the system page: page map or section map
+     * @param nAddress Page file offset
+     * @param nType Expected page type
+     * @param data Decompressed data
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int                 readSystemPage(long long nAddress, unsigned int nType,
+                                       std::vector<char>& data);
+    /**
+     * @brief Read all pages of the named section. The pages are read one by
+     * one and decompressed in parallel.
+     * @param pszName Section name, i.e. AcDb:Header
+     * @param data Decompressed section data
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    virtual int         readSection(const char* pszName,
+                                    std::vector<char>& data);
+    /**
+     * @brief Decode the pages in parallel
+     * @param nPagesCount Pages count
+     * @param decodePage Page decoder, returns false if the page is corrupted
+     * @return false if any page is corrupted
+     */
+    static bool         decodePages(size_t nPagesCount,
+                                    const std::function<bool(size_t)>& decodePage);
+
+protected:
+    std::map<int, long long>            pageAddresses;
+    std::vector<DWG2004Section>         sections;
+    std::vector<char>                   objectsData;
+};
+
+#endif // DWG_R2004_H_H
@@ -0,0 +1,317 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#include "r2007.h"
+#include "io.h"
+#include "opencad_api.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+static const size_t DWG2007HeaderOffset = 0x80;
+static const size_t DWG2007HeaderSize = 0x3D8;
+static const size_t DWG2007PagesOffset = 0x480;
+static const size_t DWG2007BlockSize = 255;
+static const size_t DWG2007SystemBlockDataSize = 239;
+static const size_t DWG2007DataBlockDataSize = 251;
+static const size_t DWG2007FileHeaderSize = 0x110;
+// the number of 64 bit values in the section description and section page
+static const size_t DWG2007SectionValues = 8;
+static const size_t DWG2007SectionPageValues = 7;
+
+template<class T>
+static T getValue(const vector<char>& data, size_t nOffset)
+{
+    T value = 0;
+    memcpy (&value, data.data () + nOffset, sizeof (T));
+    return value;
+}
+
+/**
+ * @brief Get the encoded page size, the page is aligned to 8 bytes
+ */
+static size_t getEncodedSize(size_t nBlockCount)
+{
+    return ( nBlockCount * DWG2007BlockSize + 7 ) & ~size_t(7);
+}
+
+/**
+ * @brief De-interleave and decompress the page data
+ */
+static bool decodePage(const vector<char>& page, size_t nBlockCount,
+                       size_t nBlockDataSize, size_t nCompressedSize,
+                       char * pabyDst, size_t nDstSize)
+{
+    if( page.size () < nBlockCount * DWG2007BlockSize )
+        return false;
+    vector<char> data(nBlockCount * nBlockDataSize);
+    if( DeinterleaveR2007 (page.data (), nBlockCount, nBlockDataSize,
+                           data.data ()) != 0 )
+        DebugMsg ("R2007 page has blocks which can not be corrected\n");
+
+    if( nCompressedSize < nDstSize )
+    {
+        size_t nSize = 0;
+        return DecompressR2007 (data.data (), min (nCompressedSize, data.size ()),
+                                pabyDst, nDstSize, nSize);
+    }
+    if( data.size () < nDstSize )
+        return false;
+    memcpy (pabyDst, data.data (), nDstSize);
+    return true;
+}
+
+DWGFileR2007::DWGFileR2007(CADFileIO* poFileIO) :
+    DWGFileR2004(poFileIO, CADVersions::DWG_R2007)
+{
+}
+
+DWGFileR2007::~DWGFileR2007()
+{
+}
+
+// ----------------------------------------------------------------------------
+// Page and section maps
+// ----------------------------------------------------------------------------
+
+int DWGFileR2007::readSectionLocator()
+{
+    vector<char> fileStart(DWG2007HeaderOffset + DWG2007HeaderSize);
+    fileIO->Rewind ();
+    if( fileIO->Read (fileStart.data (), fileStart.size ()) != fileStart.size () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    readFileStart (fileStart.data ());
+
+    // 3 blocks: the CRCs, the compressed size and the file header
+    vector<char> headerData(3 * DWG2007SystemBlockDataSize);
+    if( DeinterleaveR2007 (fileStart.data () + DWG2007HeaderOffset, 3,
+                           DWG2007SystemBlockDataSize, headerData.data ()) != 0 )
+        DebugMsg ("R2007 file header has blocks which can not be corrected\n");
+    int nCompressedSize = getValue<int>(headerData, 24);
+    vector<char> fileHeader(DWG2007FileHeaderSize);
+    if( nCompressedSize > 0 )
+    {
+        size_t nSize = 0;
+        if( 32 + static_cast<size_t>(nCompressedSize) > headerData.size () ||
+            !DecompressR2007 (headerData.data () + 32,
+                              static_cast<size_t>(nCompressedSize),
+                              fileHeader.data (), fileHeader.size (), nSize) )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    }
+    else
+    {
+        memcpy (fileHeader.data (), headerData.data () + 32, fileHeader.size ());
+    }
+
+    auto headerValue = [&fileHeader](size_t nIndex)
+    {
+        return getValue<long long>(fileHeader, nIndex * 8);
+    };
+
+    // page map: size and id of all pages, they are stored one after another
+    vector<char> pageMapData;
+    int nResult = readSystemPage (DWG2007PagesOffset + headerValue (7),
+                                  headerValue (10), headerValue (11),
+                                  headerValue (3), pageMapData);
+    if( nResult != CADErrorCodes::SUCCESS )
+        return nResult;
+
+    pageMap.clear ();
+    long long nOffset = 0;
+    for( size_t i = 0; i + 16 <= pageMapData.size (); i += 16 )
+    {
+        DWG2007Page page;
+        page.nOffset = DWG2007PagesOffset + nOffset;
+        page.nSize = getValue<long long>(pageMapData, i);
+        long long nId = getValue<long long>(pageMapData, i + 8);
+        if( nId > 0 ) // gaps have negative ids
+            pageMap[nId] = page;
+        nOffset += page.nSize;
+    }
+
+    auto sectionMapPage = pageMap.find (headerValue (24));
+    if( sectionMapPage == pageMap.end () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    vector<char> sectionMapData;
+    nResult = readSystemPage (sectionMapPage->second.nOffset, headerValue (22),
+                              headerValue (25), headerValue (27),
+                              sectionMapData);
+    if( nResult != CADErrorCodes::SUCCESS )
+        return nResult;
+
+    sectionMap.clear ();
+    size_t nPosition = 0;
+    while( nPosition + DWG2007SectionValues * 8 <= sectionMapData.size () )
+    {
+        long long anValues[DWG2007SectionValues];
+        memcpy (anValues, sectionMapData.data () + nPosition, sizeof (anValues));
+        nPosition += sizeof (anValues);
+
+        // data size, max size, encrypted, hash code, name length, unknown,
+        // encoded, pages count
+        DWG2007Section section;
+        section.nSize = anValues[0];
+        section.nEncrypted = anValues[2];
+        long long nNameLength = anValues[4];
+        long long nPagesCount = anValues[7];
+        if( nNameLength < 0 || nPagesCount < 0 ||
+            static_cast<size_t>(nNameLength) > sectionMapData.size () - nPosition )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+        // UTF-16 name, the section names are ASCII
+        for( size_t i = 0; i + 1 < static_cast<size_t>(nNameLength); i += 2 )
+        {
+            char cChar = sectionMapData[nPosition + i];
+            if( cChar == 0 )
+                break;
+            section.sName += cChar;
+        }
+        nPosition += static_cast<size_t>(nNameLength);
+
+        if( static_cast<size_t>(nPagesCount) > ( sectionMapData.size () -
+                nPosition ) / ( DWG2007SectionPageValues * 8 ) )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+        for( long long i = 0; i < nPagesCount; ++i )
+        {
+            long long anPageValues[DWG2007SectionPageValues];
+            memcpy (anPageValues, sectionMapData.data () + nPosition,
+                    sizeof (anPageValues));
+            nPosition += sizeof (anPageValues);
+
+            // offset, size, id, decompressed size, compressed size,
+            // checksum, CRC
+            DWG2007SectionPage page;
+            page.nStartOffset = anPageValues[0];
+            page.nId = anPageValues[2];
+            page.nDecompressedSize = anPageValues[3];
+            page.nCompressedSize = anPageValues[4];
+            section.pages.push_back (page);
+        }
+
+        DebugMsg ("  Section %s : %lld bytes in %lld pages\n",
+                  section.sName.c_str (), section.nSize, nPagesCount);
+        sectionMap.push_back (section);
+    }
+
+    return CADErrorCodes::SUCCESS;
+}
+
+int DWGFileR2007::readSystemPage(long long nAddress, long long nCompressedSize,
+                                 long long nDecompressedSize,
+                                 long long nCorrection, vector<char>& data)
+{
+    if( nCompressedSize <= 0 || nDecompressedSize <= 0 || nCorrection <= 0 )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    // the data is repeated nCorrection times before the encoding
+    size_t nEncodedSize = ( ( static_cast<size_t>(nCompressedSize) + 7 ) &
+                            ~size_t(7) ) * static_cast<size_t>(nCorrection);
+    size_t nBlockCount = ( nEncodedSize + DWG2007SystemBlockDataSize - 1 ) /
+                         DWG2007SystemBlockDataSize;
+    vector<char> page(getEncodedSize (nBlockCount));
+    if( fileIO->Seek (nAddress, CADFileIO::SeekOrigin::BEG) != 0 ||
+        fileIO->Read (page.data (), page.size ()) != page.size () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    data.resize (static_cast<size_t>(nDecompressedSize));
+    if( !decodePage (page, nBlockCount, DWG2007SystemBlockDataSize,
+                     static_cast<size_t>(nCompressedSize), data.data (),
+                     data.size ()) )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    return CADErrorCodes::SUCCESS;
+}
+
+// ----------------------------------------------------------------------------
+// Sections
+// ----------------------------------------------------------------------------
+
+int DWGFileR2007::readSection(const char* pszName, vector<char>& data)
+{
+    auto section = find_if (sectionMap.begin (), sectionMap.end (),
+                            [pszName](const DWG2007Section& item)
+                            { return item.sName == pszName; });
+    if( section == sectionMap.end () )
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    if( section->nEncrypted == 1 )
+    {
+        DebugMsg ("Encrypted section %s is not supported\n", pszName);
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    }
+
+    // the pages are read one by one, the file in/out is not shared
+    const size_t nPagesCount = section->pages.size ();
+    size_t nDataSize = static_cast<size_t>(max (section->nSize, 0LL));
+    vector< vector<char> > pages(nPagesCount);
+    for( size_t i = 0; i < nPagesCount; ++i )
+    {
+        const DWG2007SectionPage& sectionPage = section->pages[i];
+        auto page = pageMap.find (sectionPage.nId);
+        if( page == pageMap.end () || page->second.nSize <= 0 ||
+            sectionPage.nStartOffset < 0 ||
+            sectionPage.nCompressedSize < 0 ||
+            sectionPage.nDecompressedSize < 0 )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+        pages[i].resize (static_cast<size_t>(page->second.nSize));
+        if( fileIO->Seek (page->second.nOffset, CADFileIO::SeekOrigin::BEG) != 0 ||
+            fileIO->Read (pages[i].data (), pages[i].size ()) != pages[i].size () )
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+        nDataSize = max (nDataSize,
+                         static_cast<size_t>(sectionPage.nStartOffset +
+                                             sectionPage.nDecompressedSize));
+    }
+
+    // de-interleaving and decompression of the pages are independent
+    data.assign (nDataSize, 0);
+    bool bDecoded = decodePages (nPagesCount, [&](size_t nPage)
+    {
+        const DWG2007SectionPage& sectionPage = section->pages[nPage];
+        size_t nCompressedSize = static_cast<size_t>(sectionPage.nCompressedSize);
+        size_t nBlockCount = ( ( ( nCompressedSize + 7 ) & ~size_t(7) ) +
+                               DWG2007DataBlockDataSize - 1 ) /
+                             DWG2007DataBlockDataSize;
+        return decodePage (pages[nPage], nBlockCount, DWG2007DataBlockDataSize,
+                           nCompressedSize,
+                           data.data () + sectionPage.nStartOffset,
+                           static_cast<size_t>(sectionPage.nDecompressedSize));
+    });
+
+    if( !bDecoded )
+    {
+        DebugMsg ("Section %s is corrupted\n", pszName);
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+    }
+    return CADErrorCodes::SUCCESS;
+}
@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#ifndef DWG_R2007_H_H
+#define DWG_R2007_H_H
+
+#include "r2004.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The R2007 page from the page map
+ */
+struct DWG2007Page
+{
+    long long   nOffset = 0; // file offset
+    long long   nSize   = 0; // size in the file
+};
+
+/**
+ * @brief The R2007 section page, the part of the section data
+ */
+struct DWG2007SectionPage
+{
+    long long   nId               = 0;
+    long long   nStartOffset      = 0;
+    long long   nCompressedSize   = 0;
+    long long   nDecompressedSize = 0;
+};
+
+/**
+ * @brief The R2007 section description from the section map
+ */
+struct DWG2007Section
+{
+    std::string sName;
+    long long   nSize      = 0;
+    long long   nEncrypted = 0;
+    std::vector<DWG2007SectionPage> pages;
+};
+
+/**
+ * @brief R2007 DWG file. The pages are Reed-Solomon encoded and interleaved,
+ * the strings are UTF-16 and stored in own streams. The objects are decoded
+ * by the shared R2000 decoders.
+ */
+class DWGFileR2007 : public DWGFileR2004
+{
+public:
+    DWGFileR2007(CADFileIO* poFileIO);
+    virtual             ~DWGFileR2007();
+
+protected:
+    virtual int         readSectionLocator() override;
+    virtual int         readSection(const char* pszName,
+                                    std::vector<char>& data) override;
+
+protected:
+    /**
+     * @brief Read and decode the system page: page map or section map
+     * @param nAddress Page file offset
+     * @param nCompressedSize Compressed data size
+     * @param nDecompressedSize Decompressed data size
+     * @param nCorrection Reed-Solomon correction factor, the data repeat count
+     * @param data Decoded data
+     * @return CADErrorCodes::SUCCESS if OK, or error code
+     */
+    int                 readSystemPage(long long nAddress,
+                                       long long nCompressedSize,
+                                       long long nDecompressedSize,
+                                       long long nCorrection,
+                                       std::vector<char>& data);
+
+protected:
+    std::map<long long, DWG2007Page>    pageMap;
+    std::vector<DWG2007Section>         sectionMap;
+};
+
+#endif // DWG_R2007_H_H
@@ -0,0 +1,359 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#ifndef DWG_SCHEMA_H
+#define DWG_SCHEMA_H
+
+#include "cadfile.h"
+#include "io.h"
+#include "traits.h"
+
+#include <climits>
+
+/*
+ * Object layouts are described as compile-time lists of fields:
+ *
+ *  typedef DWGSchema<
+ *      DWG_FIELD(DWGVectorField, CADCircleObject, vertPosition),
+ *      DWG_FIELD(DWGBitDoubleField, CADCircleObject, dfRadius)
+ *      > DWGCircleSchema;
+ *
+ * DWGCircleSchema::read<DWG_R2000>(circle, ..., projection) decodes the
+ * fields into the object. Fields outside of the version range are neither
+ * read nor skipped. Fields declared with DWG_PROJECTED_FIELD are read only if
+ * the CADFile::ProjectionFlags mask has their flag, otherwise they are stepped
+ * over without constructing values. Field types take the version too, as some
+ * encodings differ between the versions (R13-R14 thickness and extrusion are
+ * not compressed).
+ */
+
+// ----------------------------------------------------------------------------
+// Field types
+// ----------------------------------------------------------------------------
+
+struct DWGBitField
+{
+    template<int nVersion>
+    static bool read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadBIT (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipBIT (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+struct DWGCharField
+{
+    template<int nVersion>
+    static unsigned char read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadCHAR (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * /*pabyInput*/, size_t& nBitOffsetFromStart)
+    {
+        nBitOffsetFromStart += 8;
+    }
+};
+
+struct DWGBitShortField
+{
+    template<int nVersion>
+    static short read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadBITSHORT (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipBITSHORT (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+struct DWGBitLongField
+{
+    template<int nVersion>
+    static int read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadBITLONG (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipBITLONG (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+struct DWGBitDoubleField
+{
+    template<int nVersion>
+    static double read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+struct DWGRawDoubleField
+{
+    template<int nVersion>
+    static double read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+/**
+ * @brief T, the inline TV or the R2007+ string stream TU, see DWGStringStream
+ */
+struct DWGTextField
+{
+    template<int nVersion>
+    static std::string read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadText (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipText (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+struct DWGHandleField
+{
+    template<int nVersion>
+    static CADHandle read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadHANDLE (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipHANDLE (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+/**
+ * @brief 3BD, three BITDOUBLE coordinates
+ */
+struct DWGVectorField
+{
+    template<int nVersion>
+    static CADVector read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadVector (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        skipBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        skipBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+/**
+ * @brief 2RD, two RAWDOUBLE coordinates
+ */
+struct DWGRawVectorField
+{
+    template<int nVersion>
+    static CADVector read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        return ReadRAWVector (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        skipRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+        skipRAWDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+/**
+ * @brief BT, thickness. The set bit means the default 0.0 thickness.
+ * R13-R14 store the BITDOUBLE only.
+ */
+struct DWGThicknessField
+{
+    template<int nVersion>
+    static double read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        if( !DWGVersionTraits<nVersion>::hasCompressedData )
+            return ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+        return ReadBIT (pabyInput, nBitOffsetFromStart) ?
+                    0.0 : ReadBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        if( !DWGVersionTraits<nVersion>::hasCompressedData ||
+            !ReadBIT (pabyInput, nBitOffsetFromStart) )
+            skipBITDOUBLE (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+/**
+ * @brief BE, extrusion. The set bit means the default 0,0,1 extrusion.
+ * R13-R14 store the 3BD vector only.
+ */
+struct DWGExtrusionField
+{
+    template<int nVersion>
+    static CADVector read(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        if( DWGVersionTraits<nVersion>::hasCompressedData &&
+            ReadBIT (pabyInput, nBitOffsetFromStart) )
+            return CADVector(0.0, 0.0, 1.0);
+        return ReadVector (pabyInput, nBitOffsetFromStart);
+    }
+    template<int nVersion>
+    static void skip(const char * pabyInput, size_t& nBitOffsetFromStart)
+    {
+        if( !DWGVersionTraits<nVersion>::hasCompressedData ||
+            !ReadBIT (pabyInput, nBitOffsetFromStart) )
+            DWGVectorField::skip<nVersion> (pabyInput, nBitOffsetFromStart);
+    }
+};
+
+// ----------------------------------------------------------------------------
+// Fields
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief The value which is decoded if the projection has one of the
+ * nProjection flags and stepped over otherwise. PROJECTION_COORDINATES (0)
+ * values are always decoded.
+ */
+template<class FieldType, int nProjection>
+struct DWGProjectedField
+{
+    template<int nVersion, class T>
+    static void read(T& value, const char * pabyInput,
+                     size_t& nBitOffsetFromStart, int nDecodeProjection)
+    {
+        if( nProjection == CADFile::PROJECTION_COORDINATES ||
+            (nDecodeProjection & nProjection) != 0 )
+            value = static_cast<T>(FieldType::template read<nVersion>(
+                                       pabyInput, nBitOffsetFromStart));
+        else
+            FieldType::template skip<nVersion>(pabyInput, nBitOffsetFromStart);
+    }
+};
+
+/**
+ * @brief The object field, read into Object::*Member if the file version is
+ * in the [nMinVersion, nMaxVersion] range and the field is in projection
+ */
+template<class FieldType, class Object, class T, T Object::*Member,
+         int nMinVersion = 0, int nMaxVersion = INT_MAX,
+         int nProjection = CADFile::PROJECTION_COORDINATES>
+struct DWGField
+{
+    template<int nVersion, class Target>
+    static void read(Target * object, const char * pabyInput,
+                     size_t& nBitOffsetFromStart, int nDecodeProjection)
+    {
+        if( nVersion < nMinVersion || nVersion > nMaxVersion )
+            return;
+        DWGProjectedField<FieldType, nProjection>::template read<nVersion>(
+                    object->*Member, pabyInput, nBitOffsetFromStart,
+                    nDecodeProjection);
+    }
+};
+
+/**
+ * @brief The field which is present in the data but not stored in the object
+ */
+template<class FieldType, int nMinVersion = 0, int nMaxVersion = INT_MAX>
+struct DWGUnusedField
+{
+    template<int nVersion, class Target>
+    static void read(Target * /*object*/, const char * pabyInput,
+                     size_t& nBitOffsetFromStart, int /*nDecodeProjection*/)
+    {
+        if( nVersion < nMinVersion || nVersion > nMaxVersion )
+            return;
+        FieldType::template skip<nVersion>(pabyInput, nBitOffsetFromStart);
+    }
+};
+
+#define DWG_FIELD(type, object, member) \
+    DWGField<type, object, decltype(object::member), &object::member>
+#define DWG_VERSION_FIELD(type, object, member, minVersion, maxVersion) \
+    DWGField<type, object, decltype(object::member), &object::member, \
+             minVersion, maxVersion>
+#define DWG_PROJECTED_FIELD(type, object, member, projection) \
+    DWGField<type, object, decltype(object::member), &object::member, \
+             0, INT_MAX, projection>
+
+// ----------------------------------------------------------------------------
+// Schema
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief The object layout, list of fields in the order they are stored
+ */
+template<class... Fields>
+struct DWGSchema
+{
+    /**
+     * @brief Decode the fields into the object, the fields out of the
+     * projection are stepped over
+     * @param nDecodeProjection CADFile::ProjectionFlags mask
+     */
+    template<int nVersion, class Target>
+    static void read(Target * object, const char * pabyInput,
+                     size_t& nBitOffsetFromStart,
+                     int nDecodeProjection = CADFile::PROJECTION_ALL)
+    {
+        // braced init list guarantees the left to right evaluation order
+        int order[] = { 0, (Fields::template read<nVersion>(
+                                object, pabyInput, nBitOffsetFromStart,
+                                nDecodeProjection), 0)... };
+        (void)order;
+    }
+};
+
+#endif // DWG_SCHEMA_H
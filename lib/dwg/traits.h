@@ -0,0 +1,79 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+
+#ifndef DWG_TRAITS_H
+#define DWG_TRAITS_H
+
+#include "opencad_api.h"
+
+/*
+ * The object layout differences between the DWG versions are described by
+ * the version traits. The object decoders are templates on the traits, so
+ * each version has its own decoder instantiation and the version checks are
+ * resolved at compile time:
+ *
+ *  if( Traits::hasNoXDictionaryFlag )
+ *      object->bNoXDictionaryPresent = ReadBIT (pabyInput, nBitOffset);
+ */
+
+template<int nVersion>
+struct DWGVersionTraits
+{
+    /** CADVersions value */
+    static constexpr int version = nVersion;
+    /** R13-R14 objects store the size in bits after the EED, later versions
+        store it before the object handle */
+    static constexpr bool objectSizeAfterEED = nVersion < CADVersions::DWG_R2000;
+    /** R2000+ entity data is compressed: BT thickness, BE extrusion, data
+        flags and doubles with defaults */
+    static constexpr bool hasCompressedData = nVersion >= CADVersions::DWG_R2000;
+    /** R2000+ entities have the line type and plot style flags and the line
+        weight, R13-R14 entities have the by layer line type bit */
+    static constexpr bool hasPlotStyle = nVersion >= CADVersions::DWG_R2000;
+    /** R2004+ objects have the missing extension dictionary flag */
+    static constexpr bool hasNoXDictionaryFlag = nVersion >= CADVersions::DWG_R2004;
+    /** R2004+ entities have no links to the neighbours and the ENC color,
+        owners list the handles of all owned objects */
+    static constexpr bool hasOwnedHandles = nVersion >= CADVersions::DWG_R2004;
+    /** R2007+ entities have the material and shadow flags */
+    static constexpr bool hasMaterials = nVersion >= CADVersions::DWG_R2007;
+    /** R2007+ strings are stored in the separate stream */
+    static constexpr bool hasStringStream = nVersion >= CADVersions::DWG_R2007;
+};
+
+typedef DWGVersionTraits<CADVersions::DWG_R13>   DWGR13Traits;
+typedef DWGVersionTraits<CADVersions::DWG_R14>   DWGR14Traits;
+typedef DWGVersionTraits<CADVersions::DWG_R2000> DWGR2000Traits;
+typedef DWGVersionTraits<CADVersions::DWG_R2004> DWGR2004Traits;
+typedef DWGVersionTraits<CADVersions::DWG_R2007> DWGR2007Traits;
+
+#endif // DWG_TRAITS_H
@@ -0,0 +1,1229 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "dxffile.h"
+#include "cadgeometry.h"
+#include "cadobjects.h"
+#include "opencad_api.h"
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+static const double DXFDegreesToRadians = acos(-1.0) / 180.0;
+
+// ----------------------------------------------------------------------------
+// Helpers
+// ----------------------------------------------------------------------------
+
+static string toUpper(const string& value)
+{
+    string result(value);
+    for(char& c : result)
+        c = static_cast<char>(toupper (static_cast<unsigned char>(c)));
+    return result;
+}
+
+static CADHandle makeHandle(long value)
+{
+    CADHandle handle;
+    unsigned char bytes[sizeof(long)];
+    size_t count = 0;
+    for(unsigned long rest = static_cast<unsigned long>(value); rest != 0;
+        rest >>= 8)
+        bytes[count++] = static_cast<unsigned char>(rest & 0xFF);
+    // most significant byte first
+    while(count > 0)
+        handle.addOffset (bytes[--count]);
+    return handle;
+}
+
+/**
+ * @brief Moves the geometry from the entity OCS to WCS using its extrusion.
+ * The elevation is the OCS Z for entities stored with 2D coordinates. The
+ * planar geometries get their extrusion from the transformation, so the
+ * exact extrusion is set after the move.
+ */
+static void transformOCSToWCS(CADGeometry *geometry, const CADVector &extrusion,
+                              double elevation = 0.0)
+{
+    Matrix ocs = Matrix::fromExtrusion (extrusion);
+    if( elevation != 0.0 )
+        ocs.translate (CADVector(0.0, 0.0, elevation));
+    if( !ocs.isIdentity () )
+        geometry->transform (ocs);
+}
+
+struct DXFEntityName
+{
+    const char *    name;
+    short           type;
+};
+
+static const DXFEntityName DXFEntityNames[] =
+{
+    { "LINE", CADObject::LINE },
+    { "POINT", CADObject::POINT },
+    { "CIRCLE", CADObject::CIRCLE },
+    { "ARC", CADObject::ARC },
+    { "ELLIPSE", CADObject::ELLIPSE },
+    { "LWPOLYLINE", CADObject::LWPOLYLINE },
+    { "POLYLINE", CADObject::POLYLINE2D },
+    { "SPLINE", CADObject::SPLINE },
+    { "TEXT", CADObject::TEXT },
+    { "MTEXT", CADObject::MTEXT },
+    { "SOLID", CADObject::SOLID },
+    { "TRACE", CADObject::SOLID },
+    { "3DFACE", CADObject::FACE3D },
+    { "RAY", CADObject::RAY },
+    { "XLINE", CADObject::XLINE },
+    { "MLINE", CADObject::MLINE },
+    { "INSERT", CADObject::INSERT },
+    { "ATTDEF", CADObject::ATTDEF }
+};
+
+/**
+ * @brief Get the type of the entity by its DXF name
+ * @return CADObject::ObjectType or UNUSED if the entity is not supported
+ */
+static short getEntityType(const DXFGroup& group)
+{
+    for(const DXFEntityName& entityName : DXFEntityNames)
+    {
+        if(group.equals (entityName.name))
+            return entityName.type;
+    }
+    return CADObject::UNUSED;
+}
+
+/**
+ * @brief Get the POLYLINE type by its 70 group flags
+ */
+static short getPolylineType(long flags)
+{
+    if(flags & 8)
+        return CADObject::POLYLINE3D;
+    if(flags & 16)
+        return CADObject::POLYLINE_MESH;
+    if(flags & 64)
+        return CADObject::POLYLINE_PFACE;
+    return CADObject::POLYLINE2D;
+}
+
+// ----------------------------------------------------------------------------
+// DXFEntityData
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief The entity groups collected by code. Coordinates of the repeated
+ * points and repeated reals are kept in the file order.
+ */
+struct DXFEntityData
+{
+    vector<CADVector>   points[9];  // 10-18 groups
+    vector<double>      reals[20];  // 40-59 groups
+    long                ints[40];   // 60-99 groups, last value
+    vector<double>      bulges;     // 42 groups, per 10 group vertex
+    CADVector           extrusion;
+    double              thickness;
+    double              elevation;
+    string              text;
+    string              name;
+    vector<string>      eed;
+
+    DXFEntityData() : extrusion(0.0, 0.0, 1.0), thickness(0.0),
+        elevation(0.0)
+    {
+        fill (ints, ints + 40, 0);
+        ints[62 - 60] = 256; // ByLayer
+    }
+
+    /**
+     * @brief Read the entity groups up to the next 0 group, which is left
+     * unread
+     */
+    void read(DXFGroupReader& reader, int projection)
+    {
+        DXFGroup group;
+        size_t offset = reader.tell ();
+        CADVector eedPoint;
+        while(reader.next (group))
+        {
+            const int code = group.code;
+            if(code == 0)
+            {
+                reader.seek (offset);
+                break;
+            }
+            offset = reader.tell ();
+
+            if(code >= 10 && code <= 18)
+                points[code - 10].push_back (CADVector(group.toDouble (), 0.0));
+            else if(code >= 20 && code <= 28)
+            {
+                if(!points[code - 20].empty ())
+                    points[code - 20].back ().setY (group.toDouble ());
+            }
+            else if(code >= 30 && code <= 37)
+            {
+                if(!points[code - 30].empty ())
+                    points[code - 30].back ().setZ (group.toDouble ());
+            }
+            else if(code == 38)
+                elevation = group.toDouble ();
+            else if(code == 39)
+                thickness = group.toDouble ();
+            else if(code >= 40 && code <= 59)
+            {
+                double value = group.toDouble ();
+                reals[code - 40].push_back (value);
+                if(code == 42 && !points[0].empty ())
+                {
+                    bulges.resize (points[0].size (), 0.0);
+                    bulges.back () = value;
+                }
+            }
+            else if(code >= 60 && code <= 99)
+                ints[code - 60] = group.toLong ();
+            else if(code == 210)
+                extrusion.setX (group.toDouble ());
+            else if(code == 220)
+                extrusion.setY (group.toDouble ());
+            else if(code == 230)
+                extrusion.setZ (group.toDouble ());
+            else if(code == 1 || code == 3)
+            {
+                // MTEXT is split into 3 groups followed by the last 1 group
+                if(projection & CADFile::PROJECTION_TEXT)
+                    text.append (group.value, group.length);
+            }
+            else if(code == 2)
+                name = group.toString ();
+            else if(code >= 1000 && (projection & CADFile::PROJECTION_EED))
+                readEED (group, eedPoint);
+        }
+    }
+
+    void readEED(const DXFGroup& group, CADVector& point)
+    {
+        switch(group.code)
+        {
+            case 1000:
+                eed.push_back (group.toString ());
+                break;
+            case 1002:
+                eed.push_back (group.equals ("{") ? "{" : "}");
+                break;
+            case 1003:
+                eed.push_back ("Layer table ref (handle):" + group.toString ());
+                break;
+            case 1004:
+                eed.push_back ("Binary chunk (chars):" + group.toString ());
+                break;
+            case 1005:
+                eed.push_back ("Entity handle ref (handle):" + group.toString ());
+                break;
+            case 1010: case 1011: case 1012: case 1013:
+                point.setX (group.toDouble ());
+                break;
+            case 1020: case 1021: case 1022: case 1023:
+                point.setY (group.toDouble ());
+                break;
+            case 1030: case 1031: case 1032: case 1033:
+                point.setZ (group.toDouble ());
+                eed.push_back ("Point: {" + to_string (point.getX ()) + ';' +
+                               to_string (point.getY ()) + ';' +
+                               to_string (point.getZ ()) + '}');
+                break;
+            case 1040: case 1041: case 1042:
+                eed.push_back ("Double:" + to_string (group.toDouble ()));
+                break;
+            case 1070:
+                eed.push_back ("Short:" + to_string (group.toLong ()));
+                break;
+            case 1071:
+                eed.push_back ("Long Int:" + to_string (group.toLong ()));
+                break;
+            default:
+                break;
+        }
+    }
+
+    CADVector point(int code, size_t index = 0) const
+    {
+        const vector<CADVector>& values = points[code - 10];
+        return index < values.size () ? values[index] : CADVector(0.0, 0.0, 0.0);
+    }
+
+    double real(int code, double defaultValue = 0.0) const
+    {
+        const vector<double>& values = reals[code - 40];
+        return values.empty () ? defaultValue : values.front ();
+    }
+
+    long integer(int code) const
+    {
+        return ints[code - 60];
+    }
+
+    short color() const
+    {
+        long value = labs (ints[62 - 60]); // negative if the layer is off
+        return static_cast<short>(value > 256 ? 256 : value);
+    }
+};
+
+/**
+ * @brief Read the VERTEX entities following the POLYLINE up to the SEQEND
+ */
+static void readVertexes(DXFGroupReader& reader, int projection,
+                         vector<DXFEntityData>& vertexes)
+{
+    DXFGroup group;
+    while(reader.next (group) && group.code == 0 && group.equals ("VERTEX"))
+    {
+        vertexes.push_back (DXFEntityData());
+        vertexes.back ().read (reader, projection);
+    }
+}
+
+// ----------------------------------------------------------------------------
+// DXFFile
+// ----------------------------------------------------------------------------
+
+DXFFile::DXFFile(CADFileIO *poFileIO) : CADFile(poFileIO), dataBuffer(nullptr),
+    dataSize(0), binary(false)
+{
+}
+
+DXFFile::~DXFFile()
+{
+}
+
+string DXFFile::getESRISpatialRef()
+{
+    return "";
+}
+
+int DXFFile::readSectionLocator()
+{
+    // The whole file is parsed, so it is read at once, the file in memory
+    // is parsed in place. Entities are parsed later from the memory, the
+    // cursors do not need own file in/outs.
+    dataBuffer = fileIO->GetData (dataSize);
+    if(nullptr == dataBuffer)
+    {
+        if(0 != fileIO->Seek (0, CADFileIO::SeekOrigin::END))
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+        long nFileSize = fileIO->Tell ();
+        if(nFileSize <= 0 ||
+           0 != fileIO->Seek (0, CADFileIO::SeekOrigin::BEG))
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+        data.resize (static_cast<size_t>(nFileSize));
+        if(fileIO->Read (data.data (), data.size ()) != data.size ())
+            return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+        dataBuffer = data.data ();
+        dataSize = data.size ();
+    }
+    if(0 == dataSize)
+        return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+
+    binary = DXFIsBinary (dataBuffer, dataSize);
+    DXFGroupReader reader(dataBuffer, dataSize,
+                          binary ? DXFBinarySentinelLength : 0, binary);
+    DXFGroup group;
+    string sectionName;
+    size_t offset = reader.tell ();
+    while(reader.next (group))
+    {
+        if(group.code == 0)
+        {
+            if(group.equals ("SECTION"))
+            {
+                if(!reader.next (group) || group.code != 2)
+                    return CADErrorCodes::SECTION_LOCATOR_READ_FAILED;
+                sectionName = group.toString ();
+                sections[sectionName].begin = reader.tell ();
+            }
+            else if(group.equals ("ENDSEC"))
+                sections[sectionName].end = offset;
+            else if(group.equals ("EOF"))
+                break;
+        }
+        offset = reader.tell ();
+    }
+
+    auto it = sections.find ("ENTITIES");
+    if(it == sections.end () || it->second.end < it->second.begin)
+        return CADErrorCodes::ENTITIES_SECTION_READ_FAILED;
+    return CADErrorCodes::SUCCESS;
+}
+
+int DXFFile::readHeader(OpenOptions eOptions)
+{
+    DXFSection section;
+    if(!getSection ("HEADER", section))
+    {
+        // R12 files may contain only entities
+        header.addValue (CADHeader::OPENCADVER, CADVersions::DXF_UNDEF);
+        return CADErrorCodes::SUCCESS;
+    }
+
+    const set<short>* wantedCodes = nullptr;
+    if(eOptions != OpenOptions::READ_ALL && !readFilter.headerCodes.empty ())
+        wantedCodes = &readFilter.headerCodes;
+
+    DXFGroupReader reader(dataBuffer, section.end, section.begin, binary);
+    DXFGroup group;
+    short code = -1;
+    double xyz[3] = { 0.0, 0.0, 0.0 };
+    int nCoordinates = 0;
+    auto addPoint = [&]()
+    {
+        if(code >= 0 && nCoordinates > 0)
+            header.addValue (code, xyz[0], xyz[1], xyz[2]);
+        xyz[0] = xyz[1] = xyz[2] = 0.0;
+        nCoordinates = 0;
+    };
+
+    while(reader.next (group))
+    {
+        if(group.code == 9)
+        {
+            addPoint ();
+            code = CADHeader::getConstant (group.toString ());
+            if(nullptr != wantedCodes && wantedCodes->count (code) == 0)
+                code = -1;
+            continue;
+        }
+        if(code < 0)
+            continue;
+
+        if(group.code >= 10 && group.code <= 39)
+        {
+            xyz[group.code / 10 - 1] = group.toDouble ();
+            ++nCoordinates;
+            continue;
+        }
+
+        switch(code)
+        {
+            case CADHeader::TDCREATE:
+            case CADHeader::TDUCREATE:
+            case CADHeader::TDUPDATE:
+            case CADHeader::TDUUPDATE:
+            case CADHeader::TDINDWG:
+            case CADHeader::TDUSRTIMER:
+            {
+                // julian date, the fraction is the time of day
+                double julianDate = group.toDouble ();
+                double julianDay = floor (julianDate);
+                header.addValue (code, static_cast<long>(julianDay),
+                                 static_cast<long>((julianDate - julianDay) *
+                                                   86400000.0));
+                continue;
+            }
+            default:
+                break;
+        }
+
+        switch(DXFGetValueType (group.code))
+        {
+            case DXFValueType::REAL:
+                header.addValue (code, group.toDouble ());
+                break;
+            case DXFValueType::INTEGER:
+                header.addValue (code, group.toLong ());
+                break;
+            case DXFValueType::BOOL:
+                header.addValue (code, group.toLong () != 0);
+                break;
+            case DXFValueType::HANDLE:
+                header.addValue (code, makeHandle (group.toHandle ()));
+                break;
+            default:
+                header.addValue (code, group.toString ());
+                break;
+        }
+    }
+    addPoint ();
+
+    int nVersion = CADVersions::DXF_UNDEF;
+    string sVersion = header.getValue (CADHeader::ACADVER).getString ();
+    if(sVersion.size () >= 6 && sVersion.compare (0, 2, "AC") == 0 &&
+       atoi (sVersion.c_str () + 2) >= CADVersions::DWG_R13)
+        nVersion = -atoi (sVersion.c_str () + 2);
+    header.addValue (CADHeader::OPENCADVER, nVersion);
+
+    return CADErrorCodes::SUCCESS;
+}
+
+int DXFFile::readClasses(OpenOptions eOptions)
+{
+    DXFSection section;
+    if(eOptions != OpenOptions::READ_ALL || !getSection ("CLASSES", section))
+        return CADErrorCodes::SUCCESS;
+
+    DXFGroupReader reader(dataBuffer, section.end, section.begin, binary);
+    DXFGroup group;
+    CADClass stClass;
+    short dClassNum = 500;
+    bool bHasClass = false;
+    while(reader.next (group))
+    {
+        switch(group.code)
+        {
+            case 0:
+                if(bHasClass)
+                    classes.addClass (stClass);
+                stClass = CADClass();
+                stClass.dClassNum = dClassNum++;
+                stClass.dClassVersion = 0;
+                bHasClass = group.equals ("CLASS");
+                break;
+            case 1:
+                stClass.sDXFRecordName = group.toString ();
+                break;
+            case 2:
+                stClass.sCppClassName = group.toString ();
+                break;
+            case 3:
+                stClass.sApplicationName = group.toString ();
+                break;
+            case 90:
+                stClass.dProxyCapFlag = static_cast<int>(group.toLong ());
+                break;
+            case 91:
+                stClass.dInstanceCount =
+                        static_cast<unsigned short>(group.toLong ());
+                break;
+            case 280:
+                stClass.bWasZombie = group.toLong () != 0;
+                break;
+            case 281:
+                stClass.bIsEntity = group.toLong () != 0;
+                break;
+            default:
+                break;
+        }
+    }
+    if(bHasClass)
+        classes.addClass (stClass);
+
+    return CADErrorCodes::SUCCESS;
+}
+
+int DXFFile::createFileMap()
+{
+    DXFSection section;
+    if(getSection ("BLOCKS", section))
+    {
+        DXFGroupReader reader(dataBuffer, section.end, section.begin, binary);
+        DXFGroup group;
+        size_t offset = reader.tell ();
+        DXFBlockRecord * block = nullptr;
+        while(reader.next (group))
+        {
+            if(group.code == 0)
+            {
+                if(nullptr != block)
+                {
+                    // the block entities follow the block properties
+                    reader.seek (indexEntities (offset, section.end,
+                                                block->entities));
+                    block = nullptr;
+                }
+                else if(group.equals ("BLOCK"))
+                {
+                    blocks.push_back (DXFBlockRecord());
+                    block = &blocks.back ();
+                }
+            }
+            else if(nullptr != block)
+            {
+                switch(group.code)
+                {
+                    case 2:
+                        block->name = group.toString ();
+                        blockIndexes[toUpper (block->name)] = blocks.size () - 1;
+                        break;
+                    case 10:
+                        block->basePoint.setX (group.toDouble ());
+                        break;
+                    case 20:
+                        block->basePoint.setY (group.toDouble ());
+                        break;
+                    case 30:
+                        block->basePoint.setZ (group.toDouble ());
+                        break;
+                    case 70:
+                        block->isXRef = (group.toLong () & 4) != 0;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            offset = reader.tell ();
+        }
+    }
+
+    getSection ("ENTITIES", section);
+    indexEntities (section.begin, section.end, modelSpaceEntities);
+
+    DebugMsg ("Indexed entities count: %d, blocks count: %d\n",
+              entities.size (), blocks.size ());
+    return CADErrorCodes::SUCCESS;
+}
+
+int DXFFile::readTables(OpenOptions /*eOptions*/)
+{
+    // TODO: read other tables in ALL option mode
+    layerHandles.resize (layerNames.size (), 0);
+
+    DXFSection section;
+    if(getSection ("TABLES", section))
+    {
+        DXFGroupReader reader(dataBuffer, section.end, section.begin, binary);
+        DXFGroup group;
+        bool bLayersTable = false;
+        unique_ptr<CADLayerObject> objLayer;
+        auto addLayer = [&]()
+        {
+            if(nullptr == objLayer)
+                return;
+            size_t nName = getLayerNameIndex (objLayer->sLayerName);
+            if(layerHandles.size () < layerNames.size ())
+                layerHandles.resize (layerNames.size (), 0);
+            if(objLayer->hObjectHandle.isNull ())
+                objLayer->hObjectHandle = makeHandle (-long(nName + 1));
+            layerHandles[nName] = objLayer->hObjectHandle.getAsLong ();
+            tables.addLayer (this, objLayer.get ());
+            objLayer.reset ();
+        };
+
+        while(reader.next (group))
+        {
+            if(group.code == 0)
+            {
+                addLayer ();
+                if(group.equals ("TABLE"))
+                {
+                    bLayersTable = reader.next (group) && group.code == 2 &&
+                            group.equals ("LAYER");
+                }
+                else if(bLayersTable && group.equals ("LAYER"))
+                {
+                    objLayer.reset (new CADLayerObject());
+                    objLayer->bFrozen = false;
+                    objLayer->bOn = true;
+                    objLayer->bFrozenInNewVPORT = false;
+                    objLayer->bLocked = false;
+                    objLayer->bPlottingFlag = true;
+                    objLayer->dLineWeight = -3; // default
+                    objLayer->dCMColor = 7;
+                }
+                continue;
+            }
+            if(nullptr == objLayer)
+                continue;
+
+            switch(group.code)
+            {
+                case 2:
+                    objLayer->sLayerName = group.toString ();
+                    break;
+                case 5:
+                    objLayer->hObjectHandle = makeHandle (group.toHandle ());
+                    break;
+                case 62:
+                {
+                    long nColor = group.toLong ();
+                    objLayer->bOn = nColor >= 0;
+                    objLayer->dCMColor = static_cast<short>(labs (nColor));
+                    break;
+                }
+                case 70:
+                {
+                    long nFlags = group.toLong ();
+                    objLayer->bFrozen = (nFlags & 1) != 0;
+                    objLayer->bFrozenInNewVPORT = (nFlags & 2) != 0;
+                    objLayer->bLocked = (nFlags & 4) != 0;
+                    break;
+                }
+                case 290:
+                    objLayer->bPlottingFlag = group.toLong () != 0;
+                    break;
+                case 370:
+                    objLayer->dLineWeight = static_cast<short>(group.toLong ());
+                    break;
+                default:
+                    break;
+            }
+        }
+        addLayer ();
+    }
+
+    // Layers used by entities but missing in the table get default properties
+    for(size_t i = 0; i < layerNames.size (); ++i)
+    {
+        if(layerHandles[i] != 0)
+            continue;
+        CADLayerObject objLayer;
+        objLayer.sLayerName = layerNames[i];
+        objLayer.hObjectHandle = makeHandle (-long(i + 1));
+        objLayer.bFrozen = false;
+        objLayer.bOn = true;
+        objLayer.bFrozenInNewVPORT = false;
+        objLayer.bLocked = false;
+        objLayer.bPlottingFlag = true;
+        objLayer.dLineWeight = -3;
+        objLayer.dCMColor = 7;
+        layerHandles[i] = objLayer.hObjectHandle.getAsLong ();
+        tables.addLayer (this, &objLayer);
+    }
+
+    for(long id : modelSpaceEntities)
+    {
+        const DXFEntityRecord& record = entities[id - 1];
+        tables.addEntity (this, layerHandles[record.layer], id, record.type);
+    }
+
+    DebugMsg ("Readed layers count: %d\n", tables.getLayerCount ());
+    return CADErrorCodes::SUCCESS;
+}
+
+CADObject *DXFFile::getObject(long index, bool bHandlesOnly)
+{
+    if(index <= 0)
+        return nullptr;
+
+    size_t nIndex = static_cast<size_t>(index - 1);
+    if(nIndex >= entities.size ())
+        return getBlockHeader (nIndex - entities.size ());
+
+    const DXFEntityRecord& record = entities[nIndex];
+    if(record.type == CADObject::INSERT && !bHandlesOnly)
+        return getInsert (index);
+
+    CADEntityObject * entity;
+    switch(record.type)
+    {
+        case CADObject::ATTDEF:
+            entity = new CADAttdefObject();
+            break;
+        default:
+            entity = new CADEntityObject();
+            entity->setType (static_cast<CADObject::ObjectType>(record.type));
+            break;
+    }
+    entity->stCed.hObjectHandle = makeHandle (index);
+    entity->stCed.nCMColor = 256;
+    entity->stCed.bNoLinks = true;
+    entity->stChed.hLayer = makeHandle (layerHandles.empty () ? 0 :
+                                        layerHandles[record.layer]);
+    return entity;
+}
+
+CADGeometry *DXFFile::getGeometry(long index, int projection)
+{
+    if(index <= 0 || static_cast<size_t>(index) > entities.size ())
+        return nullptr;
+
+    chrono::steady_clock::time_point decodeStart;
+    if(statisticsEnabled)
+        decodeStart = chrono::steady_clock::now ();
+
+    const DXFEntityRecord& record = entities[index - 1];
+    DXFGroupReader reader(dataBuffer, dataSize, record.offset, binary);
+    DXFGroup group;
+    if(!reader.next (group)) // entity name
+        return nullptr;
+
+    DXFEntityData entity;
+    entity.read (reader, projection);
+
+    CADGeometry * geometry = nullptr;
+    switch(record.type)
+    {
+    case CADObject::ARC:
+    {
+        CADArc * arc = new CADArc();
+        arc->setPosition (entity.point (10));
+        arc->setRadius (entity.real (40));
+        arc->setThickness (entity.thickness);
+        arc->setStartingAngle (entity.real (50) * DXFDegreesToRadians);
+        arc->setEndingAngle (entity.real (51) * DXFDegreesToRadians);
+        transformOCSToWCS (arc, entity.extrusion);
+        arc->setExtrusion (entity.extrusion);
+        geometry = arc;
+        break;
+    }
+
+    case CADObject::POINT:
+    {
+        CADPoint3D * point = new CADPoint3D();
+        point->setPosition (entity.point (10));
+        point->setExtrusion (entity.extrusion);
+        point->setXAxisAng (entity.real (50) * DXFDegreesToRadians);
+        point->setThickness (entity.thickness);
+        geometry = point;
+        break;
+    }
+
+    case CADObject::POLYLINE3D:
+    case CADObject::POLYLINE_PFACE:
+    {
+        vector<DXFEntityData> vertexes;
+        readVertexes (reader, projection, vertexes);
+        if(record.type == CADObject::POLYLINE3D)
+        {
+            CADPolyline3D * polyline = new CADPolyline3D();
+            for(const DXFEntityData& vertex : vertexes)
+            {
+                // skip the spline frame control points
+                if(!(vertex.integer (70) & 16))
+                    polyline->addVertex (vertex.point (10));
+            }
+            geometry = polyline;
+        }
+        else
+        {
+            CADPolylinePFace * polyline = new CADPolylinePFace();
+            for(const DXFEntityData& vertex : vertexes)
+            {
+                // face records have no position flag
+                if(vertex.integer (70) & 64)
+                    polyline->addVertex (vertex.point (10));
+            }
+            geometry = polyline;
+        }
+        break;
+    }
+
+    case CADObject::POLYLINE2D:
+    {
+        // 2D polylines are read as the lightweight ones
+        vector<DXFEntityData> vertexes;
+        readVertexes (reader, projection, vertexes);
+        CADLWPolyline * lwPolyline = new CADLWPolyline();
+        vector<double> bulges;
+        bool bHasBulges = false;
+        for(const DXFEntityData& vertex : vertexes)
+        {
+            if(vertex.integer (70) & 16)
+                continue;
+            CADVector point = vertex.point (10);
+            lwPolyline->addVertex (CADVector(point.getX (), point.getY ()));
+            bulges.push_back (vertex.real (42));
+            bHasBulges = bHasBulges || bulges.back () != 0.0;
+        }
+        double dfElevation = entity.point (10).getZ ();
+        lwPolyline->setConstWidth (entity.real (40));
+        lwPolyline->setElevation (dfElevation);
+        if(bHasBulges)
+            lwPolyline->setBulges (bulges);
+        lwPolyline->setClosed ((entity.integer (70) & 1) != 0);
+        lwPolyline->setThickness (entity.thickness);
+        transformOCSToWCS (lwPolyline, entity.extrusion, dfElevation);
+        lwPolyline->setVectExtrusion (entity.extrusion);
+        geometry = lwPolyline;
+        break;
+    }
+
+    case CADObject::LWPOLYLINE:
+    {
+        CADLWPolyline * lwPolyline = new CADLWPolyline();
+        for(const CADVector& vertex : entity.points[0])
+            lwPolyline->addVertex (vertex);
+        lwPolyline->setConstWidth (entity.real (43));
+        lwPolyline->setElevation (entity.elevation);
+        if(!entity.bulges.empty ())
+        {
+            entity.bulges.resize (entity.points[0].size (), 0.0);
+            lwPolyline->setBulges (entity.bulges);
+        }
+        lwPolyline->setClosed ((entity.integer (70) & 1) != 0);
+        lwPolyline->setThickness (entity.thickness);
+        transformOCSToWCS (lwPolyline, entity.extrusion, entity.elevation);
+        lwPolyline->setVectExtrusion (entity.extrusion);
+        geometry = lwPolyline;
+        break;
+    }
+
+    case CADObject::CIRCLE:
+    {
+        CADCircle * circle = new CADCircle();
+        circle->setPosition (entity.point (10));
+        circle->setRadius (entity.real (40));
+        circle->setThickness (entity.thickness);
+        transformOCSToWCS (circle, entity.extrusion);
+        circle->setExtrusion (entity.extrusion);
+        geometry = circle;
+        break;
+    }
+
+    case CADObject::ATTDEF:
+    {
+        CADAttdef * attdef = new CADAttdef();
+        attdef->setPosition (entity.point (10));
+        attdef->setExtrusion (entity.extrusion);
+        attdef->setRotationAngle (entity.real (50) * DXFDegreesToRadians);
+        attdef->setAlignmentPoint (entity.point (11));
+        attdef->setElevation (entity.point (10).getZ ());
+        attdef->setHeight (entity.real (40));
+        attdef->setObliqueAngle (entity.real (51) * DXFDegreesToRadians);
+        attdef->setPositionLocked (false);
+        attdef->setTag (entity.name);
+        attdef->setTextValue (entity.text);
+        attdef->setThickness (entity.thickness);
+        transformOCSToWCS (attdef, entity.extrusion);
+        geometry = attdef;
+        break;
+    }
+
+    case CADObject::ELLIPSE:
+    {
+        CADEllipse * ellipse = new CADEllipse();
+        ellipse->setPosition (entity.point (10));
+        ellipse->setSMAxis (entity.point (11));
+        ellipse->setExtrusion (entity.extrusion);
+        ellipse->setAxisRatio (entity.real (40));
+        ellipse->setStartingAngle (entity.real (41));
+        ellipse->setEndingAngle (entity.real (42));
+        geometry = ellipse;
+        break;
+    }
+
+    case CADObject::LINE:
+    {
+        CADPoint3D ptBeg(entity.point (10), entity.thickness);
+        CADPoint3D ptEnd(entity.point (11), entity.thickness);
+        geometry = new CADLine(ptBeg, ptEnd);
+        break;
+    }
+
+    case CADObject::RAY:
+    case CADObject::XLINE:
+    {
+        CADRay * ray = record.type == CADObject::RAY ? new CADRay() :
+                                                       new CADXLine();
+        ray->setVectVector (entity.point (11));
+        ray->setPosition (entity.point (10));
+        geometry = ray;
+        break;
+    }
+
+    case CADObject::SPLINE:
+    {
+        CADSpline * spline = new CADSpline();
+        long nFlags = entity.integer (70);
+        // control points define the spline, fit points are the fallback
+        spline->setScenario (entity.points[0].empty () ? 2 : 1);
+        spline->setDegree (entity.integer (71));
+        spline->setClosed ((nFlags & 1) != 0);
+        spline->setRational ((nFlags & 4) != 0);
+        spline->setWeight (!entity.reals[1].empty ());
+        spline->setFitTollerance (entity.real (44));
+        if(!entity.points[2].empty ())
+            spline->setBegTangent (entity.point (12));
+        if(!entity.points[3].empty ())
+            spline->setEndTangent (entity.point (13));
+        for(double weight : entity.reals[1])
+            spline->addControlPointsWeight (weight);
+        for(const CADVector &pt : entity.points[1])
+            spline->addFitPoint (pt);
+        for(const CADVector &pt : entity.points[0])
+            spline->addControlPoint (pt);
+        for(double knot : entity.reals[0])
+            spline->addKnot (knot);
+        geometry = spline;
+        break;
+    }
+
+    case CADObject::TEXT:
+    {
+        CADText * text = new CADText();
+        text->setPosition (entity.point (10));
+        text->setTextValue (entity.text);
+        text->setRotationAngle (entity.real (50) * DXFDegreesToRadians);
+        text->setObliqueAngle (entity.real (51) * DXFDegreesToRadians);
+        text->setThickness (entity.thickness);
+        text->setHeight (entity.real (40));
+        text->setExtrusion (entity.extrusion);
+        transformOCSToWCS (text, entity.extrusion);
+        geometry = text;
+        break;
+    }
+
+    case CADObject::MTEXT:
+    {
+        CADMText * mtext = new CADMText();
+        mtext->setTextValue (entity.text);
+        // the rotation is in radians, or defined by the X axis direction
+        if(!entity.points[1].empty ())
+        {
+            CADVector xAxis = entity.point (11);
+            mtext->setXAxisAng (atan2 (xAxis.getY (), xAxis.getX ()));
+        }
+        else
+            mtext->setXAxisAng (entity.real (50));
+        mtext->setPosition (entity.point (10));
+        mtext->setExtrusion (entity.extrusion);
+        mtext->setHeight (entity.real (40));
+        mtext->setRectWidth (entity.real (41));
+        mtext->setExtents (entity.real (43));
+        mtext->setExtentsWidth (entity.real (42));
+        geometry = mtext;
+        break;
+    }
+
+    case CADObject::SOLID:
+    {
+        CADSolid * solid = new CADSolid();
+        double dfElevation = entity.point (10).getZ ();
+        solid->setElevation (dfElevation);
+        solid->setThickness (entity.thickness);
+        for(int code = 10; code <= 13; ++code)
+        {
+            CADVector corner = entity.point (code);
+            solid->addAverCorner (CADVector(corner.getX (), corner.getY ()));
+        }
+        solid->setExtrusion (entity.extrusion);
+        transformOCSToWCS (solid, entity.extrusion, dfElevation);
+        geometry = solid;
+        break;
+    }
+
+    case CADObject::MLINE:
+    {
+        CADMLine * mline = new CADMLine();
+        mline->setScale (entity.real (40, 1.0));
+        mline->setOpened ((entity.integer (71) & 2) == 0);
+        mline->setPosition (entity.point (10));
+        for(const CADVector& vertex : entity.points[1])
+            mline->addVertex (vertex);
+        geometry = mline;
+        break;
+    }
+
+    case CADObject::FACE3D:
+    {
+        CADFace3D * face = new CADFace3D();
+        for(int code = 10; code <= 13; ++code)
+            face->addCorner (entity.point (code));
+        face->setInvisFlags (static_cast<short>(entity.integer (70)));
+        geometry = face;
+        break;
+    }
+
+    case CADObject::POLYLINE_MESH:
+    default:
+        cerr << "Asked geometry has unsupported type." << endl;
+        return nullptr;
+    }
+
+    geometry->setColor (entity.color ());
+    geometry->setEED (entity.eed);
+
+    if(statisticsEnabled)
+    {
+        chrono::duration<double> decodeTime = chrono::steady_clock::now () -
+                decodeStart;
+        addStatistics (record.type, reader.tell () - record.offset,
+                       decodeTime.count ());
+    }
+
+    return geometry;
+}
+
+bool DXFFile::getSection(const char *name, DXFSection &section) const
+{
+    auto it = sections.find (name);
+    if(it == sections.end () || it->second.end < it->second.begin)
+        return false;
+    section = it->second;
+    return true;
+}
+
+size_t DXFFile::indexEntities(size_t offset, size_t end, vector<long> &ids)
+{
+    DXFGroupReader reader(dataBuffer, end, offset, binary);
+    DXFGroup group;
+    const size_t nNoLayer = static_cast<size_t>(-1);
+    DXFEntityRecord record = { 0, CADObject::UNUSED, nNoLayer };
+    bool bPaperSpace = false;
+    // the VERTEX, ATTRIB and SEQEND groups are not the parent properties
+    bool bParentGroups = false;
+    size_t nLastLayer = nNoLayer;
+
+    auto addRecord = [&]()
+    {
+        if(record.type != CADObject::UNUSED && !bPaperSpace)
+        {
+            if(record.layer == nNoLayer)
+                record.layer = getLayerNameIndex ("0");
+            entities.push_back (record);
+            ids.push_back (static_cast<long>(entities.size ()));
+        }
+        record.type = CADObject::UNUSED;
+    };
+
+    size_t groupOffset = reader.tell ();
+    while(reader.next (group))
+    {
+        if(group.code == 0)
+        {
+            if(group.equals ("ENDSEC") || group.equals ("ENDBLK"))
+            {
+                addRecord ();
+                return groupOffset;
+            }
+
+            bool bChild = group.equals ("VERTEX") || group.equals ("SEQEND") ||
+                    group.equals ("ATTRIB");
+            bool bParent = record.type == CADObject::INSERT ||
+                    record.type == CADObject::POLYLINE2D ||
+                    record.type == CADObject::POLYLINE3D ||
+                    record.type == CADObject::POLYLINE_PFACE ||
+                    record.type == CADObject::POLYLINE_MESH;
+            if(bChild && bParent)
+                bParentGroups = false;
+            else
+            {
+                addRecord ();
+                record.offset = groupOffset;
+                record.type = getEntityType (group);
+                record.layer = nNoLayer;
+                bPaperSpace = false;
+                bParentGroups = true;
+            }
+        }
+        else if(bParentGroups && record.type != CADObject::UNUSED)
+        {
+            switch(group.code)
+            {
+                case 8:
+                {
+                    // entities are grouped by layers, so the name usually
+                    // repeats
+                    if(nLastLayer == nNoLayer ||
+                       layerNames[nLastLayer].compare (0, string::npos,
+                                                       group.value,
+                                                       group.length) != 0)
+                        nLastLayer = getLayerNameIndex (group.toString ());
+                    record.layer = nLastLayer;
+                    break;
+                }
+                case 67:
+                    bPaperSpace = group.toLong () == 1;
+                    break;
+                case 70:
+                    if(record.type == CADObject::POLYLINE2D)
+                        record.type = getPolylineType (group.toLong ());
+                    break;
+                default:
+                    break;
+            }
+        }
+        groupOffset = reader.tell ();
+    }
+
+    addRecord ();
+    return groupOffset;
+}
+
+size_t DXFFile::getLayerNameIndex(const string &name)
+{
+    string sKey = toUpper (name);
+    auto it = layerNameIndexes.find (sKey);
+    if(it != layerNameIndexes.end ())
+        return it->second;
+    layerNames.push_back (name);
+    layerNameIndexes[sKey] = layerNames.size () - 1;
+    return layerNames.size () - 1;
+}
+
+CADInsertObject *DXFFile::getInsert(long index)
+{
+    const DXFEntityRecord& record = entities[index - 1];
+    DXFGroupReader reader(dataBuffer, dataSize, record.offset, binary);
+    DXFGroup group;
+    if(!reader.next (group)) // entity name
+        return nullptr;
+
+    DXFEntityData entity;
+    entity.read (reader, CADFile::PROJECTION_COORDINATES);
+
+    CADInsertObject * insert = new CADInsertObject();
+    insert->stCed.hObjectHandle = makeHandle (index);
+    insert->stCed.nCMColor = entity.color ();
+    insert->stCed.bNoLinks = true;
+    insert->stChed.hLayer = makeHandle (layerHandles.empty () ? 0 :
+                                        layerHandles[record.layer]);
+    insert->vertInsertionPoint = entity.point (10);
+    insert->vertScales = CADVector(entity.real (41, 1.0), entity.real (42, 1.0),
+                                   entity.real (43, 1.0));
+    insert->dfRotation = entity.real (50) * DXFDegreesToRadians;
+    insert->vectExtrusion = entity.extrusion;
+    insert->bHasAttribs = entity.integer (66) != 0;
+    insert->nObjectsOwned = 0;
+
+    auto it = blockIndexes.find (toUpper (entity.name));
+    if(it != blockIndexes.end ())
+        insert->hBlockHeader = makeHandle (static_cast<long>(
+                                    entities.size () + 1 + it->second));
+    return insert;
+}
+
+CADBlockHeaderObject *DXFFile::getBlockHeader(size_t blockIndex)
+{
+    if(blockIndex >= blocks.size ())
+        return nullptr;
+
+    const DXFBlockRecord& block = blocks[blockIndex];
+    CADBlockHeaderObject * blockHeader = new CADBlockHeaderObject();
+    blockHeader->hObjectHandle = makeHandle (static_cast<long>(
+                                    entities.size () + 1 + blockIndex));
+    blockHeader->sEntryName = block.name;
+    blockHeader->bAnonymous = !block.name.empty () && block.name[0] == '*';
+    blockHeader->bBlkisXRef = block.isXRef;
+    blockHeader->bXRefOverlaid = false;
+    blockHeader->bHasAtts = false;
+    blockHeader->nOwnedObjectsCount = static_cast<long>(block.entities.size ());
+    blockHeader->vertBasePoint = block.basePoint;
+    for(long id : block.entities)
+        blockHeader->hEntities.push_back (makeHandle (id));
+    return blockHeader;
+}
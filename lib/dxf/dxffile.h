@@ -0,0 +1,120 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#ifndef DXF_DXFFILE_H
+#define DXF_DXFFILE_H
+
+#include "cadfile.h"
+#include "io.h"
+
+/**
+ * @brief The DXF section, offsets of the first group after the section name
+ * and of the ENDSEC group
+ */
+struct DXFSection
+{
+    size_t      begin = 0;
+    size_t      end   = 0;
+};
+
+/**
+ * @brief The indexed entity. POLYLINE and INSERT records cover their VERTEX,
+ * ATTRIB and SEQEND entities.
+ */
+struct DXFEntityRecord
+{
+    size_t      offset;     // offset of the entity type group
+    short       type;       // CADObject::ObjectType
+    size_t      layer;      // index in layer names
+};
+
+struct DXFBlockRecord
+{
+    string      name;
+    CADVector   basePoint;
+    bool        isXRef = false;
+    vector<long> entities; // entity ids
+};
+
+/**
+ * @brief The ASCII DXF file. The file is read into memory once, the section
+ * locator finds the sections and the file map indexes entities, so any
+ * entity is parsed on request from its offset. Entity ids are indexes in the
+ * entity records + 1, block ids follow the entity ids.
+ */
+class DXFFile : public CADFile
+{
+public:
+    DXFFile(CADFileIO* poFileIO);
+    virtual             ~DXFFile();
+
+    string              getESRISpatialRef() override;
+protected:
+    virtual int         readSectionLocator() override;
+    virtual int         readHeader(enum OpenOptions eOptions) override;
+    virtual int         readClasses(enum OpenOptions eOptions) override;
+    virtual int         createFileMap() override;
+    virtual int         readTables(enum OpenOptions eOptions) override;
+
+    CADObject *         getObject(long index, bool bHandlesOnly = false) override;
+    CADGeometry *       getGeometry(long index, int projection) override;
+
+protected:
+    bool                getSection(const char * name, DXFSection& section) const;
+    /**
+     * @brief Index entities from the offset up to the ENDSEC or ENDBLK group
+     * @param offset Offset of the first entity
+     * @param end Section end offset
+     * @param ids Ids of the indexed model space entities
+     * @return offset of the group which stopped indexing
+     */
+    size_t              indexEntities(size_t offset, size_t end,
+                                      vector<long>& ids);
+    size_t              getLayerNameIndex(const string& name);
+    CADInsertObject *   getInsert(long index);
+    CADBlockHeaderObject * getBlockHeader(size_t blockIndex);
+
+protected:
+    const char*         dataBuffer; // the file in memory or the data copy
+    size_t              dataSize;
+    vector<char>        data;       // copy of the file not in memory
+    bool                binary;
+    map<string, DXFSection> sections;
+    vector<DXFEntityRecord> entities;
+    vector<long>        modelSpaceEntities; // entity ids
+    vector<DXFBlockRecord> blocks;
+    map<string, size_t> blockIndexes; // upper case name <-> index in blocks
+    vector<string>      layerNames;
+    map<string, size_t> layerNameIndexes; // upper case name <-> index in names
+    vector<long>        layerHandles; // layer name index <-> layer handle
+};
+
+#endif // DXF_DXFFILE_H
@@ -0,0 +1,430 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+#include "io.h"
+
+#include <cstring>
+#include <locale>
+#include <sstream>
+
+// ----------------------------------------------------------------------------
+// Values parsing
+// ----------------------------------------------------------------------------
+
+static const double DXFPowersOf10[] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+static double parseDoubleSlow(const char * value, size_t length)
+{
+    std::istringstream stream(std::string(value, length));
+    stream.imbue (std::locale::classic ());
+    double result = 0.0;
+    stream >> result;
+    return result;
+}
+
+double DXFParseDouble(const char * value, size_t length)
+{
+    const char * p = value;
+    const char * end = value + length;
+    while( p < end && isSpace (*p) )
+        ++p;
+
+    bool negative = false;
+    if( p < end && ( *p == '-' || *p == '+' ) )
+        negative = *p++ == '-';
+
+    // mantissa digits, the exponent is corrected by the fraction digits
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    for( ; p < end && *p >= '0' && *p <= '9'; ++p )
+    {
+        hasDigits = true;
+        if( digits < 19 )
+        {
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            if( mantissa != 0 )
+                ++digits;
+        }
+        else
+            return parseDoubleSlow (value, length);
+    }
+    if( p < end && *p == '.' )
+    {
+        for( ++p; p < end && *p >= '0' && *p <= '9'; ++p )
+        {
+            hasDigits = true;
+            if( digits >= 19 )
+                return parseDoubleSlow (value, length);
+            mantissa = mantissa * 10 + static_cast<unsigned>(*p - '0');
+            if( mantissa != 0 )
+                ++digits;
+            --exponent;
+        }
+    }
+    if( !hasDigits )
+        return 0.0;
+    if( p < end && ( *p == 'e' || *p == 'E' ) )
+    {
+        ++p;
+        bool negativeExponent = false;
+        if( p < end && ( *p == '-' || *p == '+' ) )
+            negativeExponent = *p++ == '-';
+        int exponentValue = 0;
+        for( ; p < end && *p >= '0' && *p <= '9'; ++p )
+        {
+            if( exponentValue < 10000 )
+                exponentValue = exponentValue * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -exponentValue : exponentValue;
+    }
+    while( p < end && isSpace (*p) )
+        ++p;
+    if( p != end )
+        return parseDoubleSlow (value, length);
+
+    // both the mantissa and the power of 10 are exact doubles, so the single
+    // multiplication or division is correctly rounded
+    if( mantissa > (1ULL << 53) || exponent < -22 || exponent > 22 )
+        return parseDoubleSlow (value, length);
+
+    double result = static_cast<double>(mantissa);
+    if( exponent < 0 )
+        result /= DXFPowersOf10[-exponent];
+    else
+        result *= DXFPowersOf10[exponent];
+    return negative ? -result : result;
+}
+
+long DXFParseLong(const char * value, size_t length)
+{
+    const char * p = value;
+    const char * end = value + length;
+    while( p < end && isSpace (*p) )
+        ++p;
+
+    bool negative = false;
+    if( p < end && ( *p == '-' || *p == '+' ) )
+        negative = *p++ == '-';
+
+    long result = 0;
+    for( ; p < end && *p >= '0' && *p <= '9'; ++p )
+        result = result * 10 + (*p - '0');
+    return negative ? -result : result;
+}
+
+DXFValueType DXFGetValueType(int code)
+{
+    if( code == 5 || code == 105 || ( code >= 320 && code <= 369 ) ||
+        ( code >= 390 && code <= 399 ) || ( code >= 480 && code <= 481 ) ||
+        code == 1005 )
+        return DXFValueType::HANDLE;
+    if( ( code >= 10 && code <= 59 ) || ( code >= 110 && code <= 149 ) ||
+        ( code >= 210 && code <= 239 ) || ( code >= 460 && code <= 469 ) ||
+        ( code >= 1010 && code <= 1059 ) )
+        return DXFValueType::REAL;
+    if( ( code >= 60 && code <= 99 ) || ( code >= 160 && code <= 179 ) ||
+        ( code >= 270 && code <= 289 ) || ( code >= 370 && code <= 389 ) ||
+        ( code >= 400 && code <= 409 ) || ( code >= 420 && code <= 429 ) ||
+        ( code >= 440 && code <= 459 ) || ( code >= 1060 && code <= 1071 ) )
+        return DXFValueType::INTEGER;
+    if( code >= 290 && code <= 299 )
+        return DXFValueType::BOOL;
+    if( ( code >= 310 && code <= 319 ) || code == 1004 )
+        return DXFValueType::BINARY;
+    return DXFValueType::STRING;
+}
+
+/**
+ * @brief Get the size of the binary integer value
+ */
+static size_t getBinaryIntegerSize(int code)
+{
+    if( code >= 280 && code <= 289 )
+        return 1;
+    if( ( code >= 90 && code <= 99 ) || ( code >= 420 && code <= 429 ) ||
+        ( code >= 440 && code <= 459 ) || code == 1071 )
+        return 4;
+    if( code >= 160 && code <= 169 )
+        return 8;
+    return 2;
+}
+
+/**
+ * @brief Read the little endian signed integer of 1, 2, 4 or 8 bytes
+ */
+static long readBinaryInteger(const char * value, size_t length)
+{
+    switch( length )
+    {
+        case 1:
+            return static_cast<signed char>(value[0]);
+        case 2:
+        {
+            short result;
+            memcpy (&result, value, sizeof(result));
+            return result;
+        }
+        case 4:
+        {
+            int result;
+            memcpy (&result, value, sizeof(result));
+            return result;
+        }
+        default:
+        {
+            long long result;
+            memcpy (&result, value, sizeof(result));
+            return static_cast<long>(result);
+        }
+    }
+}
+
+bool DXFIsBinary(const char * data, size_t size)
+{
+    if( size < DXFBinarySentinelLength + 2 ||
+        memcmp (data, DXFBinarySentinel, DXFBinarySentinelLength) != 0 )
+        return false;
+    // the first group is 0 SECTION or 999 comment, the 1 byte codes of R12
+    // are not supported
+    short code;
+    memcpy (&code, data + DXFBinarySentinelLength, sizeof(code));
+    return code == 0 || code == 999;
+}
+
+// ----------------------------------------------------------------------------
+// DXFGroup
+// ----------------------------------------------------------------------------
+
+double DXFGroup::toDouble() const
+{
+    if( binary )
+    {
+        switch( DXFGetValueType (code) )
+        {
+            case DXFValueType::REAL:
+            {
+                double result;
+                memcpy (&result, value, sizeof(result));
+                return result;
+            }
+            case DXFValueType::INTEGER:
+            case DXFValueType::BOOL:
+                return static_cast<double>(readBinaryInteger (value, length));
+            default:
+                break;
+        }
+    }
+    return DXFParseDouble (value, length);
+}
+
+long DXFGroup::toLong() const
+{
+    if( binary )
+    {
+        switch( DXFGetValueType (code) )
+        {
+            case DXFValueType::REAL:
+                return static_cast<long>(toDouble ());
+            case DXFValueType::INTEGER:
+            case DXFValueType::BOOL:
+                return readBinaryInteger (value, length);
+            default:
+                break;
+        }
+    }
+    return DXFParseLong (value, length);
+}
+
+long DXFGroup::toHandle() const
+{
+    long result = 0;
+    for( size_t i = 0; i < length; ++i )
+    {
+        char c = value[i];
+        if( c >= '0' && c <= '9' )
+            result = ( result << 4 ) | (c - '0');
+        else if( c >= 'A' && c <= 'F' )
+            result = ( result << 4 ) | (c - 'A' + 10);
+        else if( c >= 'a' && c <= 'f' )
+            result = ( result << 4 ) | (c - 'a' + 10);
+        else if( !isSpace (c) )
+            break;
+    }
+    return result;
+}
+
+std::string DXFGroup::toString() const
+{
+    return std::string(value, length);
+}
+
+bool DXFGroup::equals(const char * str) const
+{
+    return strlen (str) == length && memcmp (value, str, length) == 0;
+}
+
+// ----------------------------------------------------------------------------
+// DXFGroupReader
+// ----------------------------------------------------------------------------
+
+DXFGroupReader::DXFGroupReader(const char * data, size_t size, size_t offset,
+                               bool binary) :
+    data(data), size(size), position(offset), binary(binary)
+{
+}
+
+bool DXFGroupReader::next(DXFGroup &group)
+{
+    group.binary = binary;
+    if( binary )
+        return readBinary (group);
+
+    const char * line;
+    size_t length;
+    if( !readLine (line, length) )
+        return false;
+
+    // the group code is the integer, possibly right aligned with spaces
+    const char * p = line;
+    const char * end = line + length;
+    while( p < end && isSpace (*p) )
+        ++p;
+    if( p == end )
+        return false;
+    const char * digits = p;
+    if( *p == '-' )
+        ++p;
+    while( p < end && *p >= '0' && *p <= '9' )
+        ++p;
+    if( p == digits )
+        return false;
+    group.code = static_cast<int>(DXFParseLong (digits, p - digits));
+
+    return readLine (group.value, group.length);
+}
+
+size_t DXFGroupReader::tell() const
+{
+    return position;
+}
+
+void DXFGroupReader::seek(size_t offset)
+{
+    position = offset;
+}
+
+bool DXFGroupReader::readLine(const char *& line, size_t& length)
+{
+    if( position >= size )
+        return false;
+
+    line = data + position;
+    const char * newLine = static_cast<const char *>(
+                memchr (line, '\n', size - position));
+    if( nullptr == newLine )
+    {
+        length = size - position;
+        position = size;
+    }
+    else
+    {
+        length = static_cast<size_t>(newLine - line);
+        position += length + 1;
+    }
+    if( length > 0 && line[length - 1] == '\r' )
+        --length;
+    return true;
+}
+
+bool DXFGroupReader::readBinary(DXFGroup &group)
+{
+    if( position + 2 > size )
+        return false;
+    short code;
+    memcpy (&code, data + position, sizeof(code));
+    group.code = code;
+    position += 2;
+
+    size_t valueSize;
+    switch( DXFGetValueType (code) )
+    {
+        case DXFValueType::REAL:
+            valueSize = 8;
+            break;
+        case DXFValueType::INTEGER:
+            valueSize = getBinaryIntegerSize (code);
+            break;
+        case DXFValueType::BOOL:
+            valueSize = 1;
+            break;
+        case DXFValueType::BINARY:
+        {
+            // the chunk length byte and the chunk
+            if( position >= size )
+                return false;
+            group.length = static_cast<unsigned char>(data[position++]);
+            group.value = data + position;
+            if( position + group.length > size )
+                return false;
+            position += group.length;
+            return true;
+        }
+        default:
+        {
+            // zero terminated string
+            group.value = data + position;
+            const char * end = static_cast<const char *>(
+                        memchr (group.value, 0, size - position));
+            if( nullptr == end )
+                return false;
+            group.length = static_cast<size_t>(end - group.value);
+            position += group.length + 1;
+            return true;
+        }
+    }
+
+    if( position + valueSize > size )
+        return false;
+    group.value = data + position;
+    group.length = valueSize;
+    position += valueSize;
+    return true;
+}
@@ -0,0 +1,129 @@
+/*******************************************************************************
+ *  Project: libopencad
+ *  Purpose: OpenSource CAD formats support library
+ *  Author: Alexandr Borzykh, mush3d at gmail.com
+ *  Author: Dmitry Baryshnikov, bishop.dev@gmail.com
+ *  Language: C++
+ *******************************************************************************
+ *  The MIT License (MIT)
+ *
+ *  Copyright (c) 2016 Alexandr Borzykh
+ *  Copyright (c) 2016 NextGIS, <info@nextgis.com>
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *******************************************************************************/
+
+#ifndef DXF_IO_H
+#define DXF_IO_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief The binary DXF file starts with the sentinel, including its
+ * terminating zero
+ */
+static const size_t DXFBinarySentinelLength = 22;
+static constexpr const char * DXFBinarySentinel = "AutoCAD Binary DXF\r\n\x1a";
+
+/**
+ * @brief Check the binary DXF sentinel. Only the R13 and later files with
+ * 2 byte group codes are supported.
+ */
+bool DXFIsBinary(const char * data, size_t size);
+
+/**
+ * @brief The type of the DXF group value, defined by the group code range
+ */
+enum class DXFValueType
+{
+    STRING,
+    REAL,
+    INTEGER,
+    BOOL,
+    HANDLE,
+    BINARY
+};
+
+DXFValueType DXFGetValueType(int code);
+
+/**
+ * @brief The DXF group: code and value. The value points to the file data
+ * and is not zero terminated. The binary values are little endian numbers,
+ * they are converted in place.
+ */
+struct DXFGroup
+{
+    int             code = -1;
+    const char *    value = nullptr;
+    size_t          length = 0;
+    bool            binary = false;
+
+    double          toDouble() const;
+    long            toLong() const;
+    /**
+     * @brief Parse the hexadecimal handle value
+     */
+    long            toHandle() const;
+    std::string     toString() const;
+    bool            equals(const char * str) const;
+};
+
+/**
+ * @brief The DXF groups tokenizer over the file data in memory, values are
+ * not copied. ASCII lines are found with memchr, binary values are sized by
+ * the group code.
+ */
+class DXFGroupReader
+{
+public:
+    DXFGroupReader(const char * data, size_t size, size_t offset = 0,
+                   bool binary = false);
+
+    /**
+     * @brief Read the next group
+     * @return false at the end of data or on the broken group code
+     */
+    bool            next(DXFGroup& group);
+    /**
+     * @brief Get the offset of the next group
+     */
+    size_t          tell() const;
+    void            seek(size_t offset);
+
+protected:
+    bool            readLine(const char *& line, size_t& length);
+    bool            readBinary(DXFGroup& group);
+
+protected:
+    const char *    data;
+    size_t          size;
+    size_t          position;
+    bool            binary;
+};
+
+/**
+ * @brief Parse the decimal number, the decimal point is always '.'. The
+ * mantissa up to 2^53 with the exponent up to 22 is parsed exactly by the
+ * fast path, others are parsed by the C++ stream in the classic locale.
+ */
+double  DXFParseDouble(const char * value, size_t length);
+long    DXFParseLong(const char * value, size_t length);
+
+#endif // DXF_IO_H
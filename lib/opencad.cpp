@@ -31,14 +31,62 @@
 
 #include "opencad_api.h"
 #include "cadfilestreamio.h"
+#include "cadbufferio.h"
+#include "cadcompressedio.h"
 #include "dwg/r2000.h"
+#include "dwg/r2004.h"
+#include "dwg/r2007.h"
+#include "dxf/dxffile.h"
 
 #include <cctype>
 #include <cstdarg>
 #include <cstring>
 #include <iostream>
 
-static int gLastError = CADErrorCodes::SUCCESS;
+// Each thread opening files gets its own last error
+static thread_local int gLastError = CADErrorCodes::SUCCESS;
+
+/**
+ * @brief Get the ASCII or binary DXF version from the $ACADVER header variable
+ * @return negative DXF version, DXF_UNDEF if there is no $ACADVER at the file
+ * start, or 0 if the file is not DXF
+ */
+static int CheckDXFFile(CADFileIO* pCADFileIO)
+{
+    // the version is the first header variable
+    char pabyHead[4096];
+    pCADFileIO->Rewind ();
+    size_t nSize = pCADFileIO->Read( pabyHead, sizeof(pabyHead));
+
+    size_t nOffset = 0;
+    bool bBinary = DXFIsBinary(pabyHead, nSize);
+    if(bBinary)
+        nOffset = DXFBinarySentinelLength;
+    else if(nSize >= DXFBinarySentinelLength &&
+            memcmp(pabyHead, DXFBinarySentinel, DXFBinarySentinelLength) == 0)
+        return 0; // R12 binary DXF with 1 byte group codes
+
+    DXFGroupReader reader(pabyHead, nSize, nOffset, bBinary);
+    DXFGroup group;
+    if(!reader.next(group) || (group.code != 0 && group.code != 999))
+        return 0;
+    while(reader.next(group))
+    {
+        if(group.code == 9 && group.equals("$ACADVER"))
+        {
+            if(!reader.next(group) || group.length < 6 ||
+               strncmp(group.value, "AC", 2) != 0)
+                break;
+            // R12 and earlier DXF files are read the same way
+            int nVersion = atoi(group.toString().c_str() + 2);
+            return nVersion < CADVersions::DWG_R13 ? CADVersions::DXF_UNDEF :
+                                                     -nVersion;
+        }
+        if(group.code == 0 && group.equals("ENDSEC"))
+            break;
+    }
+    return CADVersions::DXF_UNDEF;
+}
 
 static int CheckCADFile(CADFileIO* pCADFileIO)
 {
@@ -47,15 +95,11 @@ static int CheckCADFile(CADFileIO* pCADFileIO)
 
     const char* pszFilePath = pCADFileIO->GetFilePath();
     size_t nPathLen = strlen(pszFilePath);
-    if(toupper(pszFilePath[nPathLen - 3]) == 'D' &&
-       toupper(pszFilePath[nPathLen - 2]) == 'X' &&
-       toupper(pszFilePath[nPathLen - 1]) == 'F')
-    {
-        //TODO: "AutoCAD Binary DXF"
-        std::cerr << "DXF ASCII and binary is not supported yet";
-        return 0;
-    }
-    if(!(toupper(pszFilePath[nPathLen - 3]) == 'D' &&
+    bool bDXF = toupper(pszFilePath[nPathLen - 3]) == 'D' &&
+                toupper(pszFilePath[nPathLen - 2]) == 'X' &&
+                toupper(pszFilePath[nPathLen - 1]) == 'F';
+    if(!bDXF &&
+       !(toupper(pszFilePath[nPathLen - 3]) == 'D' &&
          toupper(pszFilePath[nPathLen - 2]) == 'W' &&
          toupper(pszFilePath[nPathLen - 1]) == 'G'))
     {
@@ -67,6 +111,9 @@ static int CheckCADFile(CADFileIO* pCADFileIO)
     if(!pCADFileIO->IsOpened())
         return 0;
 
+    if(bDXF)
+        return CheckDXFFile(pCADFileIO);
+
     char pabyDWGVersion[DWG_VERSION_STR_SIZE + 1] = {0};
     pCADFileIO->Rewind ();
     pCADFileIO->Read( pabyDWGVersion, DWG_VERSION_STR_SIZE);
@@ -80,6 +127,19 @@ static int CheckCADFile(CADFileIO* pCADFileIO)
  * @return CADFile pointer or NULL if failed. The pointer have to be freed by user
  */
 CADFile* OpenCADFile( CADFileIO* pCADFileIO, enum CADFile::OpenOptions eOptions )
+{
+    return OpenCADFile (pCADFileIO, eOptions, CADFile::ReadFilter());
+}
+
+/**
+ * @brief Open CAD file and decode only what the filter asks for
+ * @param pCADFileIO CAD file reader pointer ownd by function
+ * @param eOptions Open options
+ * @param filter Read filter, applied in READ_FAST and READ_FASTEST modes
+ * @return CADFile pointer or NULL if failed. The pointer have to be freed by user
+ */
+CADFile* OpenCADFile( CADFileIO* pCADFileIO, enum CADFile::OpenOptions eOptions,
+                      const CADFile::ReadFilter& filter )
 {
     int nCADFileVersion = CheckCADFile(pCADFileIO);
     CADFile * poCAD = nullptr;
@@ -88,12 +148,29 @@ CADFile* OpenCADFile( CADFileIO* pCADFileIO, enum CADFile::OpenOptions eOptions
     case CADVersions::DWG_R2000:
         poCAD = new DWGFileR2000 (pCADFileIO);
         break;
+    case CADVersions::DWG_R2004:
+        poCAD = new DWGFileR2004 (pCADFileIO);
+        break;
+    case CADVersions::DWG_R2007:
+        poCAD = new DWGFileR2007 (pCADFileIO);
+        break;
+    case CADVersions::DXF_UNDEF:
+    case CADVersions::DXF_R13:
+    case CADVersions::DXF_R14:
+    case CADVersions::DXF_R2000:
+    case CADVersions::DXF_R2004:
+    case CADVersions::DXF_R2007:
+    case CADVersions::DXF_R2010:
+    case CADVersions::DXF_R2013:
+        poCAD = new DXFFile (pCADFileIO);
+        break;
     default:
         gLastError = CADErrorCodes::UNSUPPORTED_VERSION;
         delete pCADFileIO;
         return nullptr;
     }
 
+    poCAD->setReadFilter (filter);
     gLastError = poCAD->parseFile(eOptions);
     if(gLastError != CADErrorCodes::SUCCESS)
     {
@@ -124,7 +201,7 @@ const char* GetVersionString()
 }
 
 /**
- * @brief Get last error code
+ * @brief Get last error code of the files opened by the current thread
  * @return last error code
  */
 int GetLastErrorCode()
@@ -132,15 +209,83 @@ int GetLastErrorCode()
     return gLastError;
 }
 
+static bool HasSuffix(const char* pszFileName, const char* pszSuffix)
+{
+    size_t nNameLen = strlen(pszFileName);
+    size_t nSuffixLen = strlen(pszSuffix);
+    if(nNameLen <= nSuffixLen)
+        return false;
+    for(size_t i = 0; i < nSuffixLen; ++i)
+    {
+        if(tolower(pszFileName[nNameLen - nSuffixLen + i]) != pszSuffix[i])
+            return false;
+    }
+    return true;
+}
+
 /**
- * @brief GetDefaultFileIO return default file in/out class.
+ * @brief GetDefaultFileIO return default file in/out class. The gzip (.gz) and
+ * zstd seekable format (.zst) archives are read without unpacking them, if
+ * the library is built with the compression support.
  * @param pszFileName CAD file path
  * @return CADFileIO pointer or null if error. The pointer have to be freed by
  * user
  */
 CADFileIO* GetDefaultFileIO ( const char *pszFileName )
 {
-    return new CADFileStreamIO(pszFileName);
+    CADFileIO* poFileIO = new CADFileStreamIO(pszFileName);
+    CADFileIO* poCompressedIO = GetCompressedFileIO (poFileIO);
+    return poCompressedIO ? poCompressedIO : poFileIO;
+}
+
+/**
+ * @brief GetCompressedFileIO return in/out class reading the compressed
+ * archive through other in/out, i.e. the user one for the remote storage. The
+ * archive type is detected from the file path suffix: .gz for gzip (BGZF
+ * archives are read fastest), .zst for zstd seekable format.
+ * @param poFileIO Archive in/out, owned by the returned one on success
+ * @return CADFileIO pointer or null if the archive type is not supported. The
+ * pointer have to be freed by user
+ */
+CADFileIO* GetCompressedFileIO ( CADFileIO* poFileIO )
+{
+#ifdef HAVE_ZLIB
+    if(HasSuffix (poFileIO->GetFilePath (), ".gz"))
+        return new CADGzipIO(poFileIO);
+#endif
+#ifdef HAVE_ZSTD
+    if(HasSuffix (poFileIO->GetFilePath (), ".zst"))
+        return new CADZstdIO(poFileIO);
+#endif
+    return nullptr;
+}
+
+/**
+ * @brief GetBufferFileIO return in/out class reading the file from memory.
+ * @param pszFileName CAD file name, the extension is used to detect the format
+ * @param pData Buffer with the file content, have to outlive the in/out, the
+ * opened CADFile and their clones
+ * @param nSize Buffer size
+ * @return CADFileIO pointer. The pointer have to be freed by user
+ */
+CADFileIO* GetBufferFileIO ( const char *pszFileName, const void *pData,
+                             size_t nSize )
+{
+    return new CADBufferIO(pszFileName, pData, nSize);
+}
+
+/**
+ * @brief GetBufferFileIO return in/out class reading the file from the shared
+ * memory buffer, the buffer is released with the last in/out using it.
+ * @param pszFileName CAD file name, the extension is used to detect the format
+ * @param pData Buffer with the file content
+ * @param nSize Buffer size
+ * @return CADFileIO pointer. The pointer have to be freed by user
+ */
+CADFileIO* GetBufferFileIO ( const char *pszFileName,
+                             std::shared_ptr<const char> pData, size_t nSize )
+{
+    return new CADBufferIO(pszFileName, pData, nSize);
 }
 
 /**
@@ -163,7 +308,11 @@ int IdentifyCADFile( CADFileIO* pCADFileIO, bool own )
  */
 const char* GetCADFormats()
 {
-    return "DWG R2000 [ACAD1015]\n";
+    return "DWG R2000 [ACAD1015]\n"
+           "DWG R2004 [ACAD1018]\n"
+           "DWG R2007 [ACAD1021]\n"
+           "DXF ASCII R12-R2013 [AC1009-AC1027]\n"
+           "DXF Binary R13-R2013 [AC1012-AC1027]\n";
 }
 
 /**
@@ -177,6 +326,19 @@ CADFile* OpenCADFile( const char* pszFileName, enum CADFile::OpenOptions eOption
     return OpenCADFile (GetDefaultFileIO (pszFileName), eOptions);
 }
 
+/**
+ * @brief Open CAD file and decode only what the filter asks for
+ * @param pszFileName Path to CAD file
+ * @param eOptions Open options
+ * @param filter Read filter, applied in READ_FAST and READ_FASTEST modes
+ * @return CADFile pointer or NULL if failed. The pointer have to be freed by user.
+ */
+CADFile* OpenCADFile( const char* pszFileName, enum CADFile::OpenOptions eOptions,
+                      const CADFile::ReadFilter& filter )
+{
+    return OpenCADFile (GetDefaultFileIO (pszFileName), eOptions, filter);
+}
+
 void DebugMsg(const char* format, ...)
 {
 #ifdef _DEBUG
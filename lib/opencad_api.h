@@ -34,6 +34,8 @@
 
 #include "cadfile.h"
 
+#include <memory>
+
 enum CADVersions
 {
     DWG_R13 = 1012,
@@ -68,7 +70,8 @@ enum CADErrorCodes
     OBJECTS_SECTION_READ_FAILED,    /**< failed to read objects section */
     THUMBNAILIMAGE_SECTION_READ_FAILED,   /**< failed to read thumbnailimage section */
     TABLE_READ_FAILED,              /**< failed to read table*/
-    VALUE_EXISTS                    /**< the value already exist in the header */
+    VALUE_EXISTS,                   /**< the value already exist in the header */
+    INVALID_TILE                    /**< tile is out of the tiles pyramid */
 };
 
 
@@ -76,8 +79,18 @@ OCAD_EXTERN int             GetVersion();
 OCAD_EXTERN const char*     GetVersionString();
 OCAD_EXTERN CADFile*        OpenCADFile( CADFileIO* pCADFileIO, enum CADFile::OpenOptions eOptions);
 OCAD_EXTERN CADFile*        OpenCADFile( const char* pszFileName, enum CADFile::OpenOptions eOptions );
+OCAD_EXTERN CADFile*        OpenCADFile( CADFileIO* pCADFileIO, enum CADFile::OpenOptions eOptions,
+                                         const CADFile::ReadFilter& filter );
+OCAD_EXTERN CADFile*        OpenCADFile( const char* pszFileName, enum CADFile::OpenOptions eOptions,
+                                         const CADFile::ReadFilter& filter );
 OCAD_EXTERN int             GetLastErrorCode();
 OCAD_EXTERN CADFileIO*      GetDefaultFileIO ( const char *pszFileName );
+OCAD_EXTERN CADFileIO*      GetCompressedFileIO ( CADFileIO* poFileIO );
+OCAD_EXTERN CADFileIO*      GetBufferFileIO ( const char *pszFileName,
+                                              const void *pData, size_t nSize );
+OCAD_EXTERN CADFileIO*      GetBufferFileIO ( const char *pszFileName,
+                                              std::shared_ptr<const char> pData,
+                                              size_t nSize );
 OCAD_EXTERN int             IdentifyCADFile( CADFileIO* pCADFileIO, bool own = true );
 OCAD_EXTERN const char*     GetCADFormats();
 
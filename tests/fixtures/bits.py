@@ -0,0 +1,188 @@
+import struct
+
+
+class BitWriter:
+    def __init__(self):
+        self.bits = []
+
+    def __len__(self):
+        return len(self.bits)
+
+    def B(self, v):
+        self.bits.append(1 if v else 0)
+
+    def nbits(self, v, n):
+        for i in range(n - 1, -1, -1):
+            self.bits.append((v >> i) & 1)
+
+    def BB(self, v):
+        self.nbits(v, 2)
+
+    def RC(self, v):
+        self.nbits(v & 0xFF, 8)
+
+    def raw(self, data):
+        for b in data:
+            self.RC(b)
+
+    def RS(self, v):
+        self.raw(struct.pack('<h' if v < 0 else '<H', v))
+
+    def RL(self, v):
+        self.raw(struct.pack('<i' if v < 0 else '<I', v))
+
+    def RD(self, v):
+        self.raw(struct.pack('<d', v))
+
+    def BS(self, v):
+        if v == 0:
+            self.BB(2)
+        elif v == 256:
+            self.BB(3)
+        elif 0 < v < 256:
+            self.BB(1)
+            self.RC(v)
+        else:
+            self.BB(0)
+            self.RS(v)
+
+    def BL(self, v):
+        if v == 0:
+            self.BB(2)
+        elif 0 < v < 256:
+            self.BB(1)
+            self.RC(v)
+        else:
+            self.BB(0)
+            self.RL(v)
+
+    def BD(self, v):
+        if v == 0.0:
+            self.BB(2)
+        elif v == 1.0:
+            self.BB(1)
+        else:
+            self.BB(0)
+            self.RD(v)
+
+    def DD(self, v, default):
+        if v == default:
+            self.BB(0)
+        else:
+            self.BB(3)
+            self.RD(v)
+
+    def BT(self, v):
+        if v == 0.0:
+            self.B(1)
+        else:
+            self.B(0)
+            self.BD(v)
+
+    def BE(self, v):
+        if tuple(v) == (0.0, 0.0, 1.0):
+            self.B(1)
+        else:
+            self.B(0)
+            for c in v:
+                self.BD(c)
+
+    def BD3(self, v):
+        for c in v:
+            self.BD(c)
+
+    def RD2(self, v):
+        self.RD(v[0])
+        self.RD(v[1])
+
+    def H(self, code, value):
+        data = []
+        while value:
+            data.insert(0, value & 0xFF)
+            value >>= 8
+        self.nbits(code, 4)
+        self.nbits(len(data), 4)
+        self.raw(data)
+
+    def TV(self, s):
+        data = s.encode('latin-1')
+        self.BS(len(data))
+        self.raw(data)
+
+    def TU(self, s):
+        data = s.encode('utf-16-le')
+        self.BS(len(data) // 2)
+        self.raw(data)
+
+    def CMC2004(self, index, rgb=None):
+        # R2004+: the index is 0, the color method is in the RGB high byte
+        self.BS(0)
+        self.BL(rgb if rgb is not None else 0xC3000000 | index)
+        self.RC(0)
+
+    def extend(self, other):
+        self.bits.extend(other.bits)
+
+    def pad(self):
+        while len(self.bits) % 8:
+            self.bits.append(0)
+
+    def tobytes(self):
+        bits = self.bits + [0] * (-len(self.bits) % 8)
+        out = bytearray()
+        for i in range(0, len(bits), 8):
+            v = 0
+            for b in bits[i:i + 8]:
+                v = (v << 1) | b
+            out.append(v)
+        return bytes(out)
+
+    def set_RL(self, pos, v):
+        w = BitWriter()
+        w.RL(v)
+        self.bits[pos:pos + 32] = w.bits
+
+
+_crc_table = []
+for _i in range(256):
+    _c = _i
+    for _ in range(8):
+        _c = (_c >> 1) ^ 0xA001 if _c & 1 else _c >> 1
+    _crc_table.append(_c)
+
+
+def crc8(data, seed=0xC0C1):
+    crc = seed
+    for b in data:
+        crc = (crc >> 8) ^ _crc_table[(b ^ crc) & 0xFF]
+    return crc
+
+
+def MC(value):
+    """Unsigned modular char"""
+    out = bytearray()
+    while True:
+        b = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(b | 0x80)
+        else:
+            out.append(b)
+            return bytes(out)
+
+
+def MCs(value):
+    """Signed modular char, the sign is the 0x40 bit of the last byte"""
+    neg = value < 0
+    value = abs(value)
+    out = bytearray()
+    while value >= 0x40:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value | (0x40 if neg else 0))
+    return bytes(out)
+
+
+def MS(value):
+    assert value < 0x8000
+    return struct.pack('<H', value)
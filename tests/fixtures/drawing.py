@@ -0,0 +1,471 @@
+"""DWG R2004/R2007 object data written from the format description"""
+import math
+import struct
+
+from bits import BitWriter, crc8, MC, MCs, MS
+
+HEADER_START = bytes.fromhex('CF7B1F23FDDE38A95F7C68B84E6D335F')
+HEADER_END = bytes.fromhex('3084E0DC0221C756A0839747B192CCA0')
+CLASSES_START = bytes.fromhex('8DA1C4B8C4A9F8C5C0DCF45FE7CFB68A')
+CLASSES_END = bytes.fromhex('725E3B473B56073A3F230BA018304975')
+
+# handles
+BLOCK_CONTROL, LAYER_CONTROL, STYLE_CONTROL, LTYPE_CONTROL = 1, 2, 3, 5
+VIEW_CONTROL, UCS_CONTROL, VPORT_CONTROL, APPID_CONTROL = 6, 7, 8, 9
+DIMSTYLE_CONTROL, NAMED_DICT, GROUP_DICT, MLINESTYLE_DICT = 0x0A, 0x0C, 0x0D, 0x0E
+LAYERS = [(0x10, '0', 7), (0x11, 'Walls', 1), (0x12, 'Text', 3), (0x13, 'Grid', 8)]
+STYLE_STANDARD, LTYPE_BYLAYER, LTYPE_BYBLOCK, LTYPE_CONTINUOUS = 0x14, 0x15, 0x16, 0x17
+DIMSTYLE_STANDARD, MLINESTYLE_STANDARD = 0x18, 0x19
+LAYOUTS_DICT, PLOTSETTINGS_DICT, PLOTSTYLES_DICT = 0x1A, 0x1B, 0x1C
+MATERIALS_DICT, COLORS_DICT, VISUALSTYLE_DICT = 0x1D, 0x1E, 0x1F
+PSPACE, MSPACE = 0x20, 0x21
+PSPACE_BLOCK, PSPACE_ENDBLK, MSPACE_BLOCK, MSPACE_ENDBLK = 0x22, 0x23, 0x24, 0x25
+PSPACE_LAYOUT, MSPACE_LAYOUT = 0x26, 0x27
+PLACEHOLDER_STYLE = 0x28
+FIRST_ENTITY = 0x30
+
+GRID_LINES = 2000
+
+
+class Streams:
+    """Data, string and handle streams of an object, R2004 has no separate
+    string stream and the handles follow the data"""
+
+    def __init__(self, ver):
+        self.ver = ver
+        self.d = BitWriter()
+        self.s = BitWriter() if ver >= 2007 else self.d
+        self.h = BitWriter()
+
+    def T(self, s):
+        if self.ver >= 2007:
+            self.s.TU(s)
+        else:
+            self.d.TV(s)
+
+    def H(self, code, value):
+        self.h.H(code, value)
+
+    def CMC(self, index, rgb=None):
+        self.d.CMC2004(index, rgb)
+
+    def data_with_strings(self):
+        """Data stream followed by the R2007 string stream and its flag"""
+        if self.ver < 2007:
+            return self.d
+        out = BitWriter()
+        out.extend(self.d)
+        if len(self.s):
+            out.extend(self.s)
+            size = len(self.s)
+            if size >= 0x8000:
+                out.RS(size >> 15)
+                out.RS((size & 0x7FFF) | 0x8000)
+            else:
+                out.RS(size)
+            out.B(1)
+        else:
+            out.B(0)
+        return out
+
+
+class DWGObject(Streams):
+    def __init__(self, ver, type, handle):
+        Streams.__init__(self, ver)
+        self.handle = handle
+        self.d.BS(type)
+        self.rlpos = len(self.d)
+        self.d.RL(0)
+        self.d.H(0, handle)
+        self.d.BS(0)  # no EED
+
+    def common_object(self, owner):
+        self.d.BL(0)  # reactors
+        self.d.B(1)   # no extension dictionary
+        self.H(4, owner)
+
+    def common_entity(self, layer, color=256, rgb=None, owner=None):
+        d = self.d
+        d.B(0)                       # no graphics
+        d.BB(2 if owner is None else 0)
+        d.BL(0)                      # reactors
+        d.B(1)                       # no extension dictionary
+        d.B(1)                       # no links, always set since R2004
+        if rgb is None:
+            d.BS(color)
+        else:
+            d.BS(0x8000 | color)
+            d.BL(rgb)
+        d.BD(1.0)                    # line type scale
+        d.BB(0)                      # by layer line type
+        d.BB(0)                      # by layer plot style
+        if self.ver >= 2007:
+            d.BB(0)                  # by layer material
+            d.RC(0)                  # shadow flags
+        d.BS(0)                      # visible
+        d.RC(29)                     # by layer line weight
+        self.entity_handles = [(5, layer)]
+        if owner is not None:
+            self.H(4, owner)
+
+    def finish(self):
+        for code, value in getattr(self, 'entity_handles', []):
+            self.H(code, value)
+        data = self.data_with_strings()
+        data.set_RL(self.rlpos, len(data))
+        data.extend(self.h)
+        body = data.tobytes()
+        size = MS(len(body))
+        return size + body + struct.pack('<H', crc8(size + body))
+
+
+def lwpolyline_bits(o, points, bulges, closed):
+    d = o.d
+    flag = (512 if closed else 0) | (16 if bulges else 0)
+    d.BS(flag)
+    d.BL(len(points))
+    if bulges:
+        d.BL(len(bulges))
+    d.RD2(points[0])
+    for prev, pt in zip(points, points[1:]):
+        d.DD(pt[0], prev[0])
+        d.DD(pt[1], prev[1])
+    for b in bulges:
+        d.BD(b)
+
+
+def entities(ver):
+    """Model space entities: handle, layer, encoder"""
+    text = 'Hello R2004' if ver < 2007 else 'Grüße R2007 ✓'
+    result = []
+
+    def line(o, p1, p2):
+        d = o.d
+        d.B(1)  # Z are zeros
+        d.RD(p1[0]); d.DD(p2[0], p1[0])
+        d.RD(p1[1]); d.DD(p2[1], p1[1])
+        d.BT(0.0)
+        d.BE((0.0, 0.0, 1.0))
+
+    def make_line(h, layer, p1, p2):
+        o = DWGObject(ver, 19, h)
+        o.common_entity(layer)
+        line(o, p1, p2)
+        return o
+
+    result.append(make_line(FIRST_ENTITY, 0x10, (1.0, 2.0), (11.0, 2.0)))
+
+    o = DWGObject(ver, 18, FIRST_ENTITY + 1)
+    o.common_entity(0x11, color=5, rgb=0xC3000005)
+    o.d.BD3((5.0, 5.0, 0.0)); o.d.BD(2.5); o.d.BT(0.0); o.d.BE((0.0, 0.0, 1.0))
+    result.append(o)
+
+    o = DWGObject(ver, 17, FIRST_ENTITY + 2)
+    o.common_entity(0x11)
+    o.d.BD3((10.0, 10.0, 0.0)); o.d.BD(3.0); o.d.BT(0.0); o.d.BE((0.0, 0.0, 1.0))
+    o.d.BD(0.0); o.d.BD(math.pi / 2)
+    result.append(o)
+
+    o = DWGObject(ver, 77, FIRST_ENTITY + 3)
+    o.common_entity(0x11)
+    lwpolyline_bits(o, [(0.0, 0.0), (20.0, 0.0), (20.0, 15.0), (0.0, 15.0)],
+                    [0.0, 0.5, 0.0, 0.0], True)
+    result.append(o)
+
+    o = DWGObject(ver, 1, FIRST_ENTITY + 4)
+    o.common_entity(0x12)
+    d = o.d
+    d.RC(0xF7)                 # only the rotation and the height are stored
+    d.RD2((2.0, 3.0))          # insertion point
+    d.BE((0.0, 0.0, 1.0))
+    d.BT(0.0)
+    d.RD(0.5)                  # rotation
+    d.RD(2.5)                  # height
+    o.T(text)
+    o.entity_handles.append((5, PLACEHOLDER_STYLE))
+    result.append(o)
+
+    for i in range(GRID_LINES):
+        result.append(make_line(FIRST_ENTITY + 5 + i, 0x13, (float(i), 0.0),
+                                (float(i), 100.0)))
+    return result
+
+
+def objects(ver):
+    result = []
+
+    # block control: no named blocks, model and paper space
+    o = DWGObject(ver, 48, BLOCK_CONTROL)
+    o.common_object(0)
+    o.d.BL(0)
+    o.H(3, MSPACE)
+    o.H(3, PSPACE)
+    result.append(o)
+
+    o = DWGObject(ver, 50, LAYER_CONTROL)
+    o.common_object(0)
+    o.d.BL(len(LAYERS))
+    for handle, name, color in LAYERS:
+        o.H(2, handle)
+    result.append(o)
+
+    for handle, name, color in LAYERS:
+        o = DWGObject(ver, 51, handle)
+        o.common_object(LAYER_CONTROL)
+        o.T(name)
+        o.d.B(0); o.d.BS(0); o.d.B(0)  # 64 flag, xref index, xref dependent
+        o.d.BS(0x10)                   # plotted
+        o.CMC(color)
+        o.H(5, 0)                      # xref block
+        o.H(5, PLOTSTYLES_DICT)
+        if ver >= 2007:
+            o.H(5, 0)                  # material
+        o.H(5, LTYPE_CONTINUOUS)
+        result.append(o)
+
+    ents = entities(ver)
+    for handle, name, block, endblk, layout, owned in (
+            (PSPACE, '*Paper_Space', PSPACE_BLOCK, PSPACE_ENDBLK,
+             PSPACE_LAYOUT, []),
+            (MSPACE, '*Model_Space', MSPACE_BLOCK, MSPACE_ENDBLK,
+             MSPACE_LAYOUT, [e.handle for e in ents])):
+        o = DWGObject(ver, 49, handle)
+        o.common_object(BLOCK_CONTROL)
+        d = o.d
+        o.T(name)
+        d.B(0); d.BS(0); d.B(0)        # 64 flag, xref index, xref dependent
+        d.B(0); d.B(0); d.B(0); d.B(0)  # anonymous, attributes, xref, overlaid
+        d.B(0)                         # loaded
+        d.BL(len(owned))
+        d.BD3((0.0, 0.0, 0.0))
+        o.T('')                        # xref path
+        d.RC(0)                        # no inserts
+        o.T('')                        # description
+        d.BL(0)                        # no preview
+        if ver >= 2007:
+            d.BS(0); d.B(1); d.RC(0)   # units, explodable, scaling
+        o.H(5, 0)                      # null
+        o.H(3, block)
+        for h in owned:
+            o.H(3, h)
+        o.H(3, endblk)
+        o.H(5, layout)
+        result.append(o)
+
+        o = DWGObject(ver, 4, block)
+        o.common_entity(0x10, owner=handle)
+        o.T(name)
+        result.append(o)
+        o = DWGObject(ver, 5, endblk)
+        o.common_entity(0x10, owner=handle)
+        result.append(o)
+
+    return result + ents
+
+
+def handseed(ver):
+    return FIRST_ENTITY + 5 + GRID_LINES
+
+
+def header(ver):
+    s = Streams(ver)
+    if ver < 2007:
+        s.h = s.d  # handles are inline before R2007
+    d, T, H, CMC = s.d, s.T, s.H, s.CMC
+    if ver >= 2007:
+        d.RL(0)  # size in bits, set below
+    d.BD(412148564080.0); d.BD(1.0); d.BD(1.0); d.BD(1.0)
+    T('m'); T(''); T(''); T('')
+    d.BL(24); d.BL(0)
+    d.B(1); d.B(0)                                 # DIMASO, DIMSHO
+    for v in (0, 1, 1, 1, 0, 1, 0):                # PLINEGEN .. LIMCHECK
+        d.B(v)
+    d.B(0)                                         # undocumented
+    for v in (1, 0, 0, 0, 0, 1, 1, 0, 1, 0, 1):    # USRTIMER .. PELLIPSE
+        d.B(v)
+    d.BS(1); d.BS(3020); d.BS(2); d.BS(4); d.BS(0); d.BS(0)  # .. AUPREC
+    d.BS(1); d.BS(0)                               # ATTMODE, PDMODE
+    d.BL(0); d.BL(0); d.BL(0)
+    for v in (0, 0, 0, 0, 0, 8, 6, 6, 6, 6, 6, 6, 3, 3, 0, 64, 4, 0, 50):
+        d.BS(v)                                    # USERI1 .. TEXTQLTY
+    for v in (1.0, 2.5, 0.05, 0.1, 0.0, 0.0, 0.0, 0.0, 0.0):
+        d.BD(v)                                    # LTSCALE .. PLINEWID
+    for v in (0.0,) * 5 + (0.5, 0.5, 1.0, 0.0, 0.5, 1.0, 1.0):
+        d.BD(v)                                    # USERR1 .. CELTSCALE
+    if ver < 2007:
+        T('.')                                     # MENU
+    for i in range(2):                             # TDCREATE, TDUPDATE
+        d.BL(2460000 + i); d.BL(1000 * (i + 1))
+    d.BL(0); d.BL(0); d.BL(0)
+    d.BL(0); d.BL(600000)                          # TDINDWG
+    d.BL(0); d.BL(600000)                          # TDUSRTIMER
+    CMC(0, 0xC0000000)                             # CECOLOR by layer
+    seed = handseed(ver)                           # HANDSEED, 8 bit length
+    d.RC(2); d.RC(seed >> 8); d.RC(seed & 0xFF)
+    H(5, 0x10); H(5, STYLE_STANDARD); H(5, LTYPE_BYLAYER)
+    if ver >= 2007:
+        H(5, 0)                                    # CMATERIAL
+    H(5, DIMSTYLE_STANDARD); H(5, MLINESTYLE_STANDARD)
+    d.BD(0.0)                                      # PSVPSCALE
+    zero3 = (0.0, 0.0, 0.0)
+    for pspace in (True, False):
+        d.BD3(zero3)                               # INSBASE
+        if pspace:
+            d.BD3((0.0, 0.0, 0.0)); d.BD3((0.0, 0.0, 0.0))
+            d.RD2((0.0, 0.0)); d.RD2((12.0, 9.0))
+        else:
+            d.BD3((0.0, 0.0, 0.0)); d.BD3((2000.0, 100.0, 0.0))
+            d.RD2((0.0, 0.0)); d.RD2((420.0, 297.0))
+        d.BD(0.0)                                  # ELEVATION
+        d.BD3(zero3); d.BD3((1.0, 0.0, 0.0)); d.BD3((0.0, 1.0, 0.0))
+        H(5, 0)                                    # UCSNAME
+        H(5, 0)                                    # UCSORTHOREF
+        d.BS(0)                                    # UCSORTHOVIEW
+        H(5, 0)                                    # UCSBASE
+        for i in range(6):
+            d.BD3(zero3)                           # UCSORGTOP .. BACK
+    T(''); T('')                                   # DIMPOST, DIMAPOST
+    for v in (1.0, 0.18, 0.0625, 0.38, 0.18, 0.0, 0.0, 0.0, 0.0):
+        d.BD(v)                                    # DIMSCALE .. DIMTM
+    if ver >= 2007:
+        d.BD(1.0); d.BD(0.785398)                  # DIMFXL, DIMJOGANG
+        d.BS(0); CMC(0, 0xC1000000)                # DIMTFILL, DIMTFILLCLR
+    for v in (0, 0, 1, 1, 0, 0):
+        d.B(v)                                     # DIMTOL .. DIMSE2
+    d.BS(0); d.BS(0); d.BS(0)                      # DIMTAD, DIMZIN, DIMAZIN
+    if ver >= 2007:
+        d.BS(0)                                    # DIMARCSYM
+    for v in (0.18, 0.09, 0.0, 25.4, 1.0, 0.0, 1.0, 0.09, 0.0):
+        d.BD(v)                                    # DIMTXT .. DIMALTRND
+    d.B(0); d.BS(2)                                # DIMALT, DIMALTD
+    d.B(0); d.B(0); d.B(0); d.B(0)                 # DIMTOFL .. DIMSOXD
+    for i in range(3):
+        CMC(0, 0xC1000000)                         # DIMCLRD, DIMCLRE, DIMCLRT
+    for v in (0, 4, 4, 2, 2, 0, 0, 2, 46, 0, 0):
+        d.BS(v)                                    # DIMADEC .. DIMJUST
+    d.B(0); d.B(0)                                 # DIMSD1, DIMSD2
+    for v in (1, 0, 0, 0):
+        d.BS(v)                                    # DIMTOLJ .. DIMALTTZ
+    d.B(0)                                         # DIMUPT
+    d.BS(3)                                        # DIMATFIT
+    if ver >= 2007:
+        d.B(0)                                     # DIMFXLON
+    H(5, STYLE_STANDARD)                           # DIMTXSTY
+    for i in range(4):
+        H(5, 0)                                    # DIMLDRBLK .. DIMBLK2
+    if ver >= 2007:
+        for i in range(3):
+            H(5, 0)                                # DIMLTYPE, DIMLTEX1, DIMLTEX2
+    d.BS(0xFFFE); d.BS(0xFFFE)                     # DIMLWD, DIMLWE
+    for h in (BLOCK_CONTROL, LAYER_CONTROL, STYLE_CONTROL, LTYPE_CONTROL,
+              VIEW_CONTROL, UCS_CONTROL, VPORT_CONTROL, APPID_CONTROL,
+              DIMSTYLE_CONTROL, GROUP_DICT, MLINESTYLE_DICT, NAMED_DICT):
+        H(3, h)
+    d.BS(1); d.BS(70)                              # TSTACKALIGN, TSTACKSIZE
+    T(''); T('')                                   # HYPERLINKBASE, STYLESHEET
+    H(5, LAYOUTS_DICT); H(5, PLOTSETTINGS_DICT); H(5, PLOTSTYLES_DICT)
+    H(5, MATERIALS_DICT); H(5, COLORS_DICT)
+    if ver >= 2007:
+        H(5, VISUALSTYLE_DICT)
+    d.BL(0x1D | 0x0200 | 0x0800)                   # CELWEIGHT and flags
+    d.BS(4)                                        # INSUNITS
+    d.BS(0)                                        # CEPSNTYPE
+    T('{1F9A2C3E-0B4D-4E5F-8A6B-7C8D9E0F1A2B}')    # FINGERPRINTGUID
+    T('{3C4D5E6F-7A8B-4C9D-AE0F-1B2C3D4E5F60}')    # VERSIONGUID
+    for v in (127, 0, 1, 1, 2, 0):
+        d.RC(v)                                    # SORTENTS .. HALOGAP
+    d.BS(257); d.BS(257)                           # OBSCOLOR, INTERSECTIONCOLOR
+    d.RC(0); d.RC(0)                               # OBSLTYPE, INTERSECTIONDISPLAY
+    T('')                                          # PROJECTNAME
+    H(5, PSPACE); H(5, MSPACE)
+    H(5, LTYPE_BYLAYER); H(5, LTYPE_BYBLOCK); H(5, LTYPE_CONTINUOUS)
+    if ver >= 2007:
+        d.B(0); d.BL(0); d.BL(0); d.BD(0.0)
+        d.BD(2.0); d.BD(6.0); d.BD(2.0); d.BD(50.0); d.BD(0.0)
+        d.RC(0); d.RC(0)                           # SOLIDHIST, SHOWHIST
+        for v in (0.25, 4.0, math.pi / 2, math.pi / 2, 0.0, 0.0):
+            d.BD(v)                                # PSOLWIDTH .. LOFTMAG2
+        d.BS(7); d.RC(1)                           # LOFTPARAM, LOFTNORMALS
+        d.BD(37.795); d.BD(-122.394); d.BD(0.0)    # LATITUDE .. NORTHDIRECTION
+        d.BL(-8000)                                # TIMEZONE
+        d.RC(1); d.RC(1); d.RC(2); d.RC(2)         # LIGHTGLYPHDISPLAY .. DGNFRAME
+        d.B(1)                                     # REALWORLDSCALE
+        CMC(1)                                     # INTERFERECOLOR
+        H(5, 0); H(5, 0); H(5, 0)                  # INTERFEREOBJVS .. DRAGVS
+        d.RC(0)                                    # CSHADOW
+        d.BD(0.0)                                  # SHADOWPLANELOCATION
+    d.BS(0); d.BS(0); d.BS(0); d.BS(0)             # unknown
+
+    if ver >= 2007:
+        data = s.data_with_strings()
+        data.set_RL(0, len(data))
+        data.extend(s.h)
+    else:
+        data = BitWriter()
+        data.extend(d)
+    body = data.tobytes()
+    size = struct.pack('<I', len(body))
+    return (HEADER_START + size + body +
+            struct.pack('<H', crc8(size + body)) + HEADER_END)
+
+
+def classes(ver):
+    s = Streams(ver)
+    d = s.d
+    if ver >= 2007:
+        d.RL(0)
+    d.BS(499)          # maximum class number, no classes
+    d.RC(0); d.RC(0)
+    d.B(1)
+    if ver >= 2007:
+        data = s.data_with_strings()
+        data.set_RL(0, len(data))
+    else:
+        data = d
+    body = data.tobytes()
+    size = struct.pack('<I', len(body))
+    return (CLASSES_START + size + body +
+            struct.pack('<H', crc8(size + body)) + CLASSES_END)
+
+
+def objects_section(ver):
+    """AcDb:AcDbObjects data and the object map offsets"""
+    data = bytearray(struct.pack('<I', 0x0DCA))
+    offsets = {}
+    for o in objects(ver):
+        offsets[o.handle] = len(data)
+        data += o.finish()
+    return bytes(data), offsets
+
+
+def handles_section(offsets):
+    out = bytearray()
+    chunk = bytearray()
+    last_handle = last_offset = 0
+
+    def flush():
+        size = struct.pack('>H', len(chunk) + 2)
+        crc = crc8(size + chunk)
+        out.extend(size + chunk + struct.pack('>H', crc))
+
+    for handle in sorted(offsets):
+        record = MC(handle - last_handle) + MCs(offsets[handle] - last_offset)
+        if len(chunk) + len(record) > 2030:
+            flush()
+            chunk = bytearray()
+            last_handle = last_offset = 0
+            record = MC(handle) + MCs(offsets[handle])
+        chunk += record
+        last_handle, last_offset = handle, offsets[handle]
+    flush()
+    chunk = bytearray()
+    flush()
+    return bytes(out)
+
+
+def sections(ver):
+    objs, offsets = objects_section(ver)
+    return [('AcDb:Header', header(ver)),
+            ('AcDb:Classes', classes(ver)),
+            ('AcDb:Handles', handles_section(offsets)),
+            ('AcDb:AcDbObjects', objs)]
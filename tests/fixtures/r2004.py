@@ -0,0 +1,224 @@
+"""DWG R2004 container: LZ77 pages, page and section maps, encrypted header"""
+import struct
+import zlib
+
+import drawing
+
+PAGE_MAP_TYPE = 0x41630E3B
+SECTION_MAP_TYPE = 0x4163003B
+DATA_PAGE_TYPE = 0x4163043B
+DATA_PAGE_MASK = 0x4164536B
+MAX_DECOMPRESSED = 0x7400
+
+
+def lz_literal_length(n):
+    assert n >= 4
+    if n <= 18:
+        return bytes([n - 3])
+    out = bytearray([0])
+    rem = n - 3 - 0x0F
+    while rem > 0xFF:
+        out.append(0)
+        rem -= 0xFF
+    out.append(rem)
+    return bytes(out)
+
+
+def lz_long_length(v):
+    assert v >= 1
+    if v <= 0xFF:
+        return bytes([v])
+    out = bytearray([0])
+    rem = v - 0xFF
+    while rem > 0xFF:
+        out.append(0)
+        rem -= 0xFF
+    out.append(rem)
+    return bytes(out)
+
+
+def lz_match(length, offset, lits):
+    """Match opcode with up to 3 literals in its low bits, offset = distance-1"""
+    if length <= 14 and offset <= 0x3FF:
+        return bytes([((length + 1) << 4) | ((offset & 3) << 2) | lits,
+                      offset >> 2])
+    two = bytes([((offset & 0x3F) << 2) | lits, offset >> 6])
+    if length <= 33:
+        return bytes([length + 0x1E]) + two
+    return bytes([0x20]) + lz_long_length(length - 0x21) + two
+
+
+def compress(data):
+    """Greedy LZ77 in the R2004 format, matches are limited to 0x4000 bytes
+    back and literal runs before the first match are at least 4 bytes"""
+    n = len(data)
+    table = {}
+    tokens = []   # (literal start, literal end, match length, offset)
+    lit_start = 0
+    i = 0
+    while i + 3 <= n:
+        key = data[i:i + 3]
+        best_len = best_dist = 0
+        if i - lit_start >= 4 or tokens:
+            for j in reversed(table.get(key, [])[-16:]):
+                dist = i - j
+                if dist > 0x4000:
+                    break
+                k = 3
+                while i + k < n and k < 0x1000 and data[j + k] == data[i + k]:
+                    k += 1
+                if k > best_len:
+                    best_len, best_dist = k, dist
+        table.setdefault(key, []).append(i)
+        if best_len >= 3:
+            tokens.append((lit_start, i, best_len, best_dist - 1))
+            for p in range(i + 1, min(i + best_len, n - 2)):
+                table.setdefault(data[p:p + 3], []).append(p)
+            i += best_len
+            lit_start = i
+        else:
+            i += 1
+    tail = (lit_start, n)
+
+    out = bytearray()
+    # the first literal run, then each match carries the next short run
+    runs = [(t[0], t[1]) for t in tokens] + [tail]
+    first = runs[0]
+    if first[1] > first[0]:
+        out += lz_literal_length(first[1] - first[0]) + data[first[0]:first[1]]
+    for index, (s, e, length, offset) in enumerate(tokens):
+        ns, ne = runs[index + 1]
+        count = ne - ns
+        if count == 0 and index + 1 < len(tokens):
+            out += lz_match(length, offset, 0)
+        elif 1 <= count <= 3:
+            out += lz_match(length, offset, count) + data[ns:ne]
+        else:
+            out += lz_match(length, offset, 0)
+            if count:
+                out += lz_literal_length(count) + data[ns:ne]
+    out.append(0x11)
+    return bytes(out)
+
+
+def checksum(seed, data):
+    sum1 = seed & 0xFFFF
+    sum2 = seed >> 16
+    pos = 0
+    while pos < len(data):
+        chunk = data[pos:pos + 0x15B0]
+        for b in chunk:
+            sum1 += b
+            sum2 += sum1
+        sum1 %= 0xFFF1
+        sum2 %= 0xFFF1
+        pos += len(chunk)
+    return (sum2 << 16) | (sum1 & 0xFFFF)
+
+
+def align(n, a=0x20):
+    return (n + a - 1) // a * a
+
+
+def system_page(type, data):
+    comp = compress(data)
+    head = struct.pack('<5I', type, len(data), len(comp), 2, 0)
+    crc = checksum(checksum(0, head), comp)
+    head = struct.pack('<5I', type, len(data), len(comp), 2, crc)
+    page = head + comp
+    return page + b'\0' * (align(len(page)) - len(page))
+
+
+def data_page(address, section_id, start, data):
+    comp = compress(data)
+    data_crc = checksum(0, comp)
+    fields = [DATA_PAGE_TYPE, section_id, len(comp), len(data), start, 0,
+              data_crc, 0]
+    fields[5] = checksum(data_crc, struct.pack('<8I', *fields))
+    mask = DATA_PAGE_MASK ^ address
+    head = struct.pack('<8I', *[v ^ mask for v in fields])
+    page = head + comp
+    return page + b'\0' * (align(len(page)) - len(page))
+
+
+def mask_bytes(n):
+    seed = 1
+    out = bytearray()
+    for _ in range(n):
+        seed = (seed * 0x343FD + 0x269EC3) & 0xFFFFFFFF
+        out.append((seed >> 16) & 0xFF)
+    return bytes(out)
+
+
+def build():
+    sections = drawing.sections(2004)
+    pages = []      # (number, bytes)
+    descriptions = bytearray()
+    address = 0x100
+    number = 1
+    for section_id, (name, data) in enumerate(sections, 1):
+        entries = bytearray()
+        chunks = [data[p:p + MAX_DECOMPRESSED]
+                  for p in range(0, len(data), MAX_DECOMPRESSED)]
+        for index, chunk in enumerate(chunks):
+            start = index * MAX_DECOMPRESSED
+            page = data_page(address, section_id, start, chunk)
+            entries += struct.pack('<iiq', number, len(page) - 32, start)
+            pages.append((number, page))
+            address += len(page)
+            number += 1
+        descriptions += struct.pack('<qiiiiii', len(data), len(chunks),
+                                    MAX_DECOMPRESSED, 1, 2, section_id, 0)
+        descriptions += name.encode('ascii').ljust(64, b'\0') + entries
+
+    section_map = struct.pack('<5i', len(sections), 2, MAX_DECOMPRESSED, 0,
+                              len(sections)) + descriptions
+    section_map_id = number
+    page = system_page(SECTION_MAP_TYPE, section_map)
+    pages.append((number, page))
+    address += len(page)
+    number += 1
+
+    # the page map lists itself, its size is found by a few passes
+    page_map_id = number
+    page_map_address = address
+    size = 0
+    for _ in range(8):
+        entries = [(n, len(p)) for n, p in pages] + [(page_map_id, size)]
+        page = system_page(PAGE_MAP_TYPE,
+                           b''.join(struct.pack('<ii', *e) for e in entries))
+        if len(page) == size:
+            break
+        size = len(page)
+    assert len(page) == size
+    pages.append((page_map_id, page))
+    end = page_map_address + size
+
+    head = bytearray(0x6C)
+    head[0:12] = b'AcFssFcAJMB\0'
+    struct.pack_into('<iiii', head, 0x0C, 0, 0x6C, 4, 0)
+    struct.pack_into('<iiii', head, 0x1C, 0, 0, 1, page_map_id)
+    struct.pack_into('<qq', head, 0x2C, end, end)
+    struct.pack_into('<iiiii', head, 0x3C, 0, len(pages), 0x20, 0x80, 0x40)
+    struct.pack_into('<iqiii', head, 0x50, page_map_id,
+                     page_map_address - 0x100, section_map_id, len(pages), 0)
+    struct.pack_into('<I', head, 0x68, zlib.crc32(bytes(head)) & 0xFFFFFFFF)
+    mask = mask_bytes(0x6C)
+    encrypted = bytes(b ^ m for b, m in zip(head, mask))
+
+    start = bytearray(0x80)
+    start[0:6] = b'AC1018'
+    struct.pack_into('<I', start, 0x0D, 0)       # no preview
+    start[0x11] = 25                            # application version
+    start[0x12] = 0
+    struct.pack_into('<H', start, 0x13, 30)     # ANSI 1252
+    struct.pack_into('<I', start, 0x28, 0x80)
+    out = bytes(start) + encrypted + mask_bytes(0x14)
+    assert len(out) == 0x100
+    return out + b''.join(p for n, p in pages)
+
+
+if __name__ == '__main__':
+    import sys
+    with open(sys.argv[1], 'wb') as f:
+        f.write(build())
@@ -0,0 +1,171 @@
+"""DWG R2007 container: Reed-Solomon coded interleaved pages, page and
+section maps. The pages are stored raw, their compressed size is the data
+size."""
+import struct
+
+import drawing
+
+PAGES_OFFSET = 0x480
+MAX_DECOMPRESSED = 0x7400
+
+# GF(2^8) with the 0x11D polynomial
+EXP = [0] * 512
+LOG = [0] * 256
+_x = 1
+for _i in range(255):
+    EXP[_i] = _x
+    LOG[_x] = _i
+    _x <<= 1
+    if _x & 0x100:
+        _x ^= 0x11D
+for _i in range(255, 512):
+    EXP[_i] = EXP[_i - 255]
+
+
+def gf_mul(a, b):
+    if a == 0 or b == 0:
+        return 0
+    return EXP[LOG[a] + LOG[b]]
+
+
+def generator(nparity):
+    """(x - a^0) ... (x - a^(nparity-1)), the highest degree first"""
+    g = [1]
+    for i in range(nparity):
+        out = g + [0]
+        for j, c in enumerate(g):
+            out[j + 1] ^= gf_mul(c, EXP[i])
+        g = out
+    return g
+
+
+def rs_encode(data, nparity):
+    """Systematic code word: the data then the parity, the first byte is the
+    highest degree coefficient"""
+    g = generator(nparity)
+    rem = [0] * nparity
+    for b in data:
+        factor = b ^ rem[0]
+        rem = rem[1:] + [0]
+        if factor:
+            for j in range(nparity):
+                rem[j] ^= gf_mul(g[j + 1], factor)
+    return bytes(data) + bytes(rem)
+
+
+def encode_blocks(data, block_data_size):
+    nparity = 255 - block_data_size
+    blocks = []
+    for p in range(0, len(data), block_data_size):
+        chunk = data[p:p + block_data_size]
+        chunk = chunk + b'\0' * (block_data_size - len(chunk))
+        blocks.append(rs_encode(chunk, nparity))
+    out = bytearray(len(blocks) * 255)
+    for i, block in enumerate(blocks):
+        for j, b in enumerate(block):
+            out[j * len(blocks) + i] = b
+    return bytes(out) + b'\0' * (-len(out) % 8)
+
+
+def pad8(data):
+    return data + b'\0' * (-len(data) % 8)
+
+
+def system_page(data):
+    return encode_blocks(pad8(data), 239)
+
+
+def data_page(data):
+    return encode_blocks(pad8(data), 251)
+
+
+HASHES = {'AcDb:Header': 0x32B803D9, 'AcDb:Classes': 0x3F54045F,
+          'AcDb:Handles': 0x3F6E0450, 'AcDb:AcDbObjects': 0x674C05A9}
+
+
+def build(sections=None):
+    if sections is None:
+        sections = drawing.sections(2007)
+    pages = []          # (id, bytes)
+    section_map = bytearray()
+    page_id = 1
+    for name, data in sections:
+        name_bytes = (name + '\0').encode('utf-16-le')
+        chunks = [data[p:p + MAX_DECOMPRESSED]
+                  for p in range(0, len(data), MAX_DECOMPRESSED)]
+        section_map += struct.pack('<8q', len(data), MAX_DECOMPRESSED, 0,
+                                   HASHES[name], len(name_bytes), 0, 4,
+                                   len(chunks))
+        section_map += name_bytes
+        for index, chunk in enumerate(chunks):
+            page = data_page(chunk)
+            section_map += struct.pack('<7q', index * MAX_DECOMPRESSED,
+                                       len(page), page_id, len(chunk),
+                                       len(chunk), 0, 0)
+            pages.append((page_id, page))
+            page_id += 1
+
+    section_map_id = page_id
+    pages.append((section_map_id, system_page(bytes(section_map))))
+    page_id += 1
+
+    page_map_id = page_id
+    entries = [(len(p), i) for i, p in pages]
+    page_map = b''.join(struct.pack('<qq', *e) for e in entries)
+    # the page map entry of itself has the size of the encoded page
+    page_map_size = len(system_page(page_map + bytes(16)))
+    page_map = page_map + struct.pack('<qq', page_map_size, page_map_id)
+    page_map_page = system_page(page_map)
+    assert len(page_map_page) == page_map_size
+    page_map_offset = sum(len(p) for i, p in pages)
+    pages.append((page_map_id, page_map_page))
+    file_size = PAGES_OFFSET + page_map_offset + page_map_size
+
+    values = [0] * 34
+    values[0] = 0x70
+    values[1] = file_size
+    values[3] = 1                           # page map correction
+    values[5] = page_map_offset
+    values[6] = page_map_id
+    values[7] = page_map_offset
+    values[8] = page_map_id
+    values[10] = len(page_map)              # raw: compressed = decompressed
+    values[11] = len(page_map)
+    values[12] = len(pages)
+    values[13] = page_map_id
+    values[14] = 0x20
+    values[15] = 0x40
+    values[17] = 0xF800
+    values[18] = 4
+    values[19] = 1
+    values[20] = len(sections)
+    values[22] = len(section_map)
+    values[23] = section_map_id
+    values[24] = section_map_id
+    values[25] = len(section_map)
+    values[27] = 1                          # section map correction
+    values[29] = 0x60100
+    file_header = struct.pack('<34q', *values)
+    assert len(file_header) == 0x110
+
+    # CRCs and key are left zero, the negative size tells the header is raw
+    header_data = bytes(24) + struct.pack('<ii', -len(file_header),
+                                          len(file_header)) + file_header
+    header_data = header_data + bytes(3 * 239 - len(header_data))
+    encoded = encode_blocks(header_data, 239)[:3 * 255]
+    header = encoded + bytes(0x3D8 - len(encoded))
+
+    start = bytearray(0x80)
+    start[0:6] = b'AC1021'
+    start[0x11] = 27                        # application version
+    struct.pack_into('<H', start, 0x13, 30)  # ANSI 1252
+    struct.pack_into('<I', start, 0x28, 0x80)
+    out = bytes(start) + header + bytes(PAGES_OFFSET - 0x80 - 0x3D8)
+    assert len(out) == PAGES_OFFSET
+    return out + b''.join(p for i, p in pages)
+
+
+if __name__ == '__main__':
+    import sys
+    with open(sys.argv[1], 'wb') as f:
+        f.write(build())
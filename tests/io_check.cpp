@@ -1,5 +1,8 @@
 #include "gtest/gtest.h"
 #include "dwg/io.h"
+#include "dwg/schema.h"
+#include "dxf/io.h"
+#include "opencad_api.h"
 
 /*                                                          */
 /*               ReadBITSHORT() tests packet.               */
@@ -174,3 +177,129 @@ TEST(rawshort, rawshort_offset7)
     short a = ReadRAWSHORT ( buffer, bitOffsetFromStart );
     ASSERT_EQ (-18216, a);
 }
+
+/*                                                          */
+/*               DWGSchema tests packet.                    */
+/*                                                          */
+
+struct SchemaTestObject
+{
+    double dfRadius = -1.0;
+    double dfThickness = -1.0;
+    CADVector vectExtrusion;
+    short dFlags = -1;
+    short dNewFlags = -1;
+};
+
+typedef DWGSchema<
+    DWG_FIELD(DWGBitDoubleField, SchemaTestObject, dfRadius),
+    DWG_FIELD(DWGThicknessField, SchemaTestObject, dfThickness),
+    DWG_FIELD(DWGExtrusionField, SchemaTestObject, vectExtrusion),
+    DWG_PROJECTED_FIELD(DWGBitShortField, SchemaTestObject, dFlags,
+                        CADFile::PROJECTION_DETAILS),
+    DWG_VERSION_FIELD(DWGBitShortField, SchemaTestObject, dNewFlags,
+                      CADVersions::DWG_R2004, INT_MAX)
+    > SchemaTestSchema;
+
+TEST(schema, read_projected)
+{
+    // 01 - 1.0, 1 - zero thickness, 1 - 0,0,1 extrusion, 10 - zero, 10 - zero
+    char buffer[2];
+    buffer[0] = 0b01111010;
+    buffer[1] = 0b00000000;
+
+    SchemaTestObject object;
+    size_t bitOffsetFromStart = 0;
+    SchemaTestSchema::read<CADVersions::DWG_R2000>(&object, buffer,
+                                                   bitOffsetFromStart);
+    ASSERT_EQ (6, bitOffsetFromStart);
+    ASSERT_DOUBLE_EQ (1.0, object.dfRadius);
+    ASSERT_DOUBLE_EQ (0.0, object.dfThickness);
+    ASSERT_DOUBLE_EQ (1.0, object.vectExtrusion.getZ ());
+    ASSERT_EQ (0, object.dFlags);
+    ASSERT_EQ (-1, object.dNewFlags); // not in R2000
+
+    // the details are stepped over
+    SchemaTestObject coordinates;
+    bitOffsetFromStart = 0;
+    SchemaTestSchema::read<CADVersions::DWG_R2000>(&coordinates, buffer,
+                                                   bitOffsetFromStart,
+                                                   CADFile::PROJECTION_COORDINATES);
+    ASSERT_EQ (6, bitOffsetFromStart);
+    ASSERT_DOUBLE_EQ (1.0, coordinates.dfRadius);
+    ASSERT_EQ (-1, coordinates.dFlags);
+
+    bitOffsetFromStart = 0;
+    SchemaTestSchema::read<CADVersions::DWG_R2004>(&object, buffer,
+                                                   bitOffsetFromStart);
+    ASSERT_EQ (8, bitOffsetFromStart);
+    ASSERT_EQ (0, object.dNewFlags);
+}
+
+TEST(schema, read_r13_uncompressed)
+{
+    // 01 - 1.0, 10 - zero thickness, 10 10 01 - 0,0,1 extrusion, 10 - zero
+    char buffer[2];
+    buffer[0] = 0b01101010;
+    buffer[1] = 0b01100000;
+
+    SchemaTestObject object;
+    size_t bitOffsetFromStart = 0;
+    SchemaTestSchema::read<CADVersions::DWG_R13>(&object, buffer,
+                                                 bitOffsetFromStart);
+    ASSERT_EQ (12, bitOffsetFromStart);
+    ASSERT_DOUBLE_EQ (1.0, object.dfRadius);
+    ASSERT_DOUBLE_EQ (0.0, object.dfThickness);
+    ASSERT_DOUBLE_EQ (1.0, object.vectExtrusion.getZ ());
+    ASSERT_EQ (0, object.dFlags);
+
+    bitOffsetFromStart = 0;
+    SchemaTestSchema::read<CADVersions::DWG_R14>(&object, buffer,
+                                                 bitOffsetFromStart,
+                                                 CADFile::PROJECTION_COORDINATES);
+    ASSERT_EQ (12, bitOffsetFromStart);
+}
+
+/*                                                          */
+/*              Binary DXF integer groups packet.           */
+/*                                                          */
+
+static void writeBinaryGroup(std::string& data, short code, long long value,
+                             size_t size)
+{
+    data.append (reinterpret_cast<const char *>(&code), sizeof(code));
+    data.append (reinterpret_cast<const char *>(&value), size);
+}
+
+TEST(dxf_binary, integer_sizes)
+{
+    // the group code range gives the value size, little endian
+    std::string data;
+    writeBinaryGroup (data, 70, -3, 2);
+    writeBinaryGroup (data, 90, 100000, 4);
+    writeBinaryGroup (data, 160, 1LL << 40, 8);
+    writeBinaryGroup (data, 280, -1, 1);
+    writeBinaryGroup (data, 420, 0xFF00FF, 4);
+    writeBinaryGroup (data, 450, -2, 4);
+    writeBinaryGroup (data, 459, 70000, 4);
+    writeBinaryGroup (data, 1071, 12345678, 4);
+    writeBinaryGroup (data, 0, 0x464F45, 4); // 0 EOF
+
+    const long expected[][2] = { { 70, -3 }, { 90, 100000 },
+                                 { 160, static_cast<long>(1LL << 40) },
+                                 { 280, -1 }, { 420, 0xFF00FF }, { 450, -2 },
+                                 { 459, 70000 }, { 1071, 12345678 } };
+    DXFGroupReader reader(data.data (), data.size (), 0, true);
+    DXFGroup group;
+    for( const long * codeValue : expected )
+    {
+        ASSERT_TRUE (reader.next (group));
+        ASSERT_EQ (codeValue[0], group.code);
+        ASSERT_EQ (codeValue[1], group.toLong ());
+    }
+    ASSERT_TRUE (reader.next (group));
+    ASSERT_EQ (0, group.code);
+    ASSERT_TRUE (group.equals ("EOF"));
+    ASSERT_EQ (data.size (), reader.tell ());
+    ASSERT_FALSE (reader.next (group));
+}
@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "cadgeometry.h"
+#include "cadnurbs.h"
+#include "cadtessellate.h"
+
+#include <cmath>
+#include <vector>
+
+TEST(nurbs, evaluation)
+{
+    // rational quadratic quarter of the unit circle
+    CADSpline arc;
+    arc.setScenario (1);
+    arc.setDegree (2);
+    arc.setRational (true);
+    arc.addControlPoint (CADVector(1.0, 0.0, 0.0));
+    arc.addControlPoint (CADVector(1.0, 1.0, 0.0));
+    arc.addControlPoint (CADVector(0.0, 1.0, 0.0));
+    arc.addControlPointsWeight (1.0);
+    arc.addControlPointsWeight (sqrt(0.5));
+    arc.addControlPointsWeight (1.0);
+    for( double knot : { 0.0, 0.0, 0.0, 1.0, 1.0, 1.0 } )
+        arc.addKnot (knot);
+
+    CADNurbsEvaluator evaluator(&arc);
+    ASSERT_TRUE (evaluator.isValid ());
+    vector<double> params(100), xyz(300);
+    for( size_t i = 0; i < params.size (); ++i )
+        params[i] = i / 99.0;
+    evaluator.evaluate (params.data (), params.size (), xyz.data ());
+    for( size_t i = 0; i < params.size (); ++i )
+        ASSERT_NEAR (sqrt(xyz[i * 3] * xyz[i * 3] +
+                          xyz[i * 3 + 1] * xyz[i * 3 + 1]), 1.0, 1e-12);
+
+    const double tolerance = 1e-3;
+    vector<CADVector> vertexes;
+    size_t nCount = evaluator.flatten (tolerance, vertexes);
+    ASSERT_GT (nCount, 2);
+    ASSERT_NEAR (vertexes.back ().getY (), 1.0, 1e-12);
+    for( size_t i = 0; i + 1 < nCount; ++i )
+    {
+        double mx = (vertexes[i].getX () + vertexes[i + 1].getX ()) / 2;
+        double my = (vertexes[i].getY () + vertexes[i + 1].getY ()) / 2;
+        ASSERT_LE (1.0 - sqrt(mx * mx + my * my), tolerance);
+    }
+
+    // fit points spline passes its points at the chord length parameters
+    CADSpline fit;
+    fit.setScenario (2);
+    fit.setDegree (3);
+    vector<double> chords(1, 0.0);
+    for( int i = 0; i < 20; ++i )
+    {
+        fit.addFitPoint (CADVector(i, sin(i / 3.0), 0.0));
+        if( i > 0 )
+            chords.push_back (chords.back () + sqrt(1.0 +
+                pow(sin(i / 3.0) - sin((i - 1) / 3.0), 2)));
+    }
+    fit.setBegTangent (CADVector(0.0, 1.0, 0.0));
+    CADNurbsEvaluator fitEvaluator(&fit);
+    ASSERT_TRUE (fitEvaluator.isValid ());
+    ASSERT_EQ (fitEvaluator.getControlPoints ().size (), 21);
+    for( size_t i = 0; i < chords.size (); ++i )
+    {
+        CADVector point = fitEvaluator.evaluate (chords[i] / chords.back ());
+        ASSERT_NEAR (point.getX (), fit.getFitPoints ()[i].getX (), 1e-9);
+        ASSERT_NEAR (point.getY (), fit.getFitPoints ()[i].getY (), 1e-9);
+    }
+    // the curve leaves the first point along the tangent
+    CADVector next = fitEvaluator.evaluate (1e-6);
+    ASSERT_LT (fabs(next.getX ()), 1e-9);
+    ASSERT_GT (next.getY (), 0.0);
+
+    // broken knots are tessellated as the control polygon
+    arc.getKnots ()[4] = -1.0;
+    ASSERT_FALSE (CADNurbsEvaluator(&arc).isValid ());
+    vertexes.clear ();
+    ASSERT_EQ (CADTessellator(tolerance).tessellate (&arc, vertexes), 3);
+}
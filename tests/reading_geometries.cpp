@@ -1,6 +1,21 @@
 #include "gtest/gtest.h"
 #include "opencad_api.h"
 #include "cadgeometry.h"
+#include "cadasyncreader.h"
+#include "cadcachedio.h"
+#include "cadtessellate.h"
+#include "dwg/io.h"
+#include "dxf/io.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 // Following test demonstrates reading only actual geometries (deleted skipped).
 
@@ -299,3 +314,1327 @@ TEST(reading_geometries, 1arc)
     delete opened_dwg;
 }
 
+
+TEST(transforms, insert_composition)
+{
+    // Block shifted by (10,0), rotated 90 deg and scaled 2x.
+    Matrix mat;
+    mat.translate (CADVector(10.0, 0.0, 0.0));
+    mat.rotate (acos (-1.0) / 2);
+    mat.scale (CADVector(2.0, 2.0, 2.0));
+
+    CADVector pt = mat.multiply (CADVector(1.0, 0.0, 0.0));
+    ASSERT_NEAR (pt.getX (), 10.0, 0.0001);
+    ASSERT_NEAR (pt.getY (), 2.0, 0.0001);
+    ASSERT_NEAR (pt.getZ (), 0.0, 0.0001);
+
+    // Nested insert: parent shift applied after the child transformation.
+    Matrix parent;
+    parent.translate (CADVector(0.0, 5.0, 1.0));
+    Matrix nested = parent.multiply (mat);
+
+    double xyz[6] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0 };
+    nested.multiply (xyz, 2);
+    ASSERT_NEAR (xyz[0], 10.0, 0.0001);
+    ASSERT_NEAR (xyz[1], 7.0, 0.0001);
+    ASSERT_NEAR (xyz[2], 1.0, 0.0001);
+    ASSERT_NEAR (xyz[3], 8.0, 0.0001);
+    ASSERT_NEAR (xyz[4], 5.0, 0.0001);
+    ASSERT_NEAR (xyz[5], 1.0, 0.0001);
+}
+
+TEST(transforms, arbitrary_axis)
+{
+    ASSERT_TRUE (Matrix::fromExtrusion (CADVector(0.0, 0.0, 1.0)).isIdentity ());
+
+    // Extrusion (0,0,-1) mirrors X, Y stays.
+    Matrix ocs = Matrix::fromExtrusion (CADVector(0.0, 0.0, -1.0));
+    CADVector pt = ocs.multiply (CADVector(3.0, 4.0, 5.0));
+    ASSERT_NEAR (pt.getX (), -3.0, 0.0001);
+    ASSERT_NEAR (pt.getY (), 4.0, 0.0001);
+    ASSERT_NEAR (pt.getZ (), -5.0, 0.0001);
+
+    // Extrusion along world X: OCS X is world Y, OCS Y is world Z.
+    ocs = Matrix::fromExtrusion (CADVector(1.0, 0.0, 0.0));
+    pt = ocs.multiply (CADVector(1.0, 2.0, 3.0));
+    ASSERT_NEAR (pt.getX (), 3.0, 0.0001);
+    ASSERT_NEAR (pt.getY (), 1.0, 0.0001);
+    ASSERT_NEAR (pt.getZ (), 2.0, 0.0001);
+}
+
+TEST(reading_header, typed_values)
+{
+    auto opened_dwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_ALL);
+    ASSERT_NE (opened_dwg, nullptr);
+
+    const CADHeader &header = opened_dwg->getHeader ();
+    ASSERT_EQ (header.get<CADHeader::OPENCADVER>(), CADVersions::DWG_R2000);
+    ASSERT_EQ (header.get<CADHeader::ACADVER>(), "AC1015");
+
+    CADVector extMin = header.get<CADHeader::EXTMIN>();
+    CADVector extMax = header.get<CADHeader::EXTMAX>();
+    ASSERT_LE (extMin.getX (), extMax.getX ());
+    ASSERT_LE (extMin.getY (), extMax.getY ());
+    ASSERT_EQ (extMin.getX (), header.getValue (CADHeader::EXTMIN).getX ());
+    ASSERT_EQ (header.get<CADHeader::LTSCALE>(),
+               header.getValue (CADHeader::LTSCALE).getReal ());
+    ASSERT_EQ (header.get<CADHeader::CLAYER>().getAsLong (),
+               header.getValue (CADHeader::CLAYER).getHandle ().getAsLong ());
+
+    // the typed values are read without copies, unset ones are empty
+    CADHeader empty;
+    ASSERT_EQ (&header.get<CADHeader::ACADVER>(),
+               &header.get<CADHeader::ACADVER>());
+    ASSERT_TRUE (empty.get<CADHeader::MENU>().empty ());
+    ASSERT_TRUE (empty.get<CADHeader::CLAYER>().isNull ());
+    ASSERT_EQ (empty.get<CADHeader::EXTMAX>().getZ (), 0.0);
+    ASSERT_EQ (empty.get<CADHeader::LUNITS>(), 0);
+
+    // not typed codes are returned as CADVariant
+    ASSERT_EQ (header.get<CADHeader::DIMASO>().getType (),
+               CADVariant::DataType::DECIMAL);
+    ASSERT_EQ (header.getValue (CADHeader::MAX_HEADER_CONSTANT + 1).getType (),
+               CADVariant::DataType::REAL);
+
+    delete opened_dwg;
+}
+
+TEST(reading_header, fast_filter)
+{
+    CADFile::ReadFilter filter;
+    filter.headerCodes = { CADHeader::EXTMIN, CADHeader::EXTMAX };
+    auto opened_dwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (opened_dwg, nullptr);
+
+    const CADHeader &header = opened_dwg->getHeader ();
+    ASSERT_EQ (header.getValue (CADHeader::EXTMIN).getType (),
+               CADVariant::DataType::COORDINATES);
+    ASSERT_EQ (header.getValue (CADHeader::EXTMAX).getType (),
+               CADVariant::DataType::COORDINATES);
+    // skipped variables are not present
+    ASSERT_EQ (header.getValue (CADHeader::LTSCALE).getType (),
+               CADVariant::DataType::INVALID);
+    ASSERT_EQ (header.getValue (CADHeader::MENU).getType (),
+               CADVariant::DataType::INVALID);
+    ASSERT_GT (opened_dwg->getLayersCount (), 0);
+
+    delete opened_dwg;
+}
+
+TEST(reading_classes, custom_class_types)
+{
+    CADClasses classes;
+    CADClass rasterImage;
+    rasterImage.sCppClassName = "AcDbRasterImage";
+    rasterImage.dClassNum = 500;
+    classes.addClass (rasterImage);
+
+    // the wipeout has the raster image layout, so the image decoder reads it
+    CADClass wipeout;
+    wipeout.sCppClassName = "AcDbWipeout";
+    wipeout.dClassNum = 502;
+    classes.addClass (wipeout);
+    ASSERT_EQ (classes.getObjectType (502), 502);
+    classes.setClassType ("AcDbWipeout", CADObject::IMAGE);
+
+    ASSERT_EQ (classes.getObjectType (500), CADObject::IMAGE);
+    ASSERT_EQ (classes.getObjectType (501), 501);
+    ASSERT_EQ (classes.getObjectType (502), CADObject::IMAGE);
+    ASSERT_EQ (classes.getObjectType (503), 503);
+    ASSERT_EQ (classes.getObjectType (CADObject::LINE), CADObject::LINE);
+
+    // the override is kept by the instance only
+    CADClasses other;
+    other.addClass (wipeout);
+    ASSERT_EQ (other.getObjectType (502), 502);
+
+    // and set per file with the read filter
+    CADFile::ReadFilter filter;
+    filter.classTypes["AcDbDictionaryWithDefault"] = CADObject::DICTIONARY;
+    unique_ptr<CADFile> openedDxf(OpenCADFile ("./data/dxf/entities.dxf",
+                                              CADFile::OpenOptions::READ_ALL,
+                                              filter));
+    ASSERT_NE (openedDxf, nullptr);
+    ASSERT_EQ (openedDxf->getClasses ().getObjectType (500),
+               CADObject::DICTIONARY);
+}
+
+TEST(reading_objects, decode_statistics)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_TRUE (openedDwg->getStatistics ().empty ());
+
+    openedDwg->setStatisticsEnabled (true);
+    CADLayer &layer = openedDwg->getLayer (0);
+    for( size_t i = 0; i < 3; ++i )
+        delete layer.getGeometry (i);
+
+    auto statistics = openedDwg->getStatistics ();
+    ASSERT_EQ (statistics.count (CADObject::CIRCLE), 1);
+    ASSERT_EQ (statistics[CADObject::CIRCLE].count, 3);
+    ASSERT_GT (statistics[CADObject::CIRCLE].bytes, 0);
+    ASSERT_GE (statistics[CADObject::CIRCLE].decodeTime, 0.0);
+
+    openedDwg->setStatisticsEnabled (false);
+    delete layer.getGeometry (0);
+    ASSERT_EQ (openedDwg->getStatistics ().at (CADObject::CIRCLE).count, 3);
+
+    // the statistics are read while the other thread decodes
+    openedDwg->setStatisticsEnabled (true);
+    atomic<bool> finished(false);
+    thread reader([&]()
+    {
+        unique_ptr<CADFileCursor> cursor(openedDwg->createCursor ());
+        for( size_t i = 0; i < 300; ++i )
+            delete cursor->getGeometry (0, i % 3);
+        finished = true;
+    });
+    size_t lastCount = 0;
+    while( !finished )
+    {
+        auto current = openedDwg->getStatistics ();
+        size_t count = current.count (CADObject::CIRCLE) ?
+                    current[CADObject::CIRCLE].count : 0;
+        EXPECT_GE (count, lastCount);
+        lastCount = count;
+    }
+    reader.join ();
+    ASSERT_EQ (openedDwg->getStatistics ().at (CADObject::CIRCLE).count, 300);
+
+    delete openedDwg;
+}
+
+TEST(reading_objects, object_census)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    openedDwg->setStatisticsEnabled (true);
+    CADLayer &layer = openedDwg->getLayer (0);
+    for( size_t i = 0; i < 3; ++i )
+        delete layer.getGeometry (i);
+
+    CADFile::ObjectCensus census;
+    ASSERT_EQ (openedDwg->getObjectCensus (census), CADErrorCodes::SUCCESS);
+    ASSERT_EQ (census.failed, 0);
+    ASSERT_EQ (census.types.count (CADObject::CIRCLE), 1);
+    ASSERT_EQ (census.types[CADObject::CIRCLE].count, 3);
+    ASSERT_EQ (census.types[CADObject::CIRCLE].bytes,
+               openedDwg->getStatistics ().at (CADObject::CIRCLE).bytes);
+    ASSERT_GT (census.types.count (CADObject::LAYER), 0);
+    ASSERT_EQ (census.layers.count (layer.getHandle ()), 1);
+    ASSERT_GE (census.layers[layer.getHandle ()].count, 3);
+
+    ASSERT_EQ (openedDwg->getObjectCensus (census, false),
+               CADErrorCodes::SUCCESS);
+    ASSERT_EQ (census.types[CADObject::CIRCLE].count, 3);
+    ASSERT_TRUE (census.layers.empty ());
+
+    delete openedDwg;
+}
+
+TEST(reading_geometries, projection)
+{
+    CADFile::ReadFilter filter;
+    filter.projection = CADFile::PROJECTION_COORDINATES;
+    auto openedDwg = OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                   CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+    CADLayer &layer = openedDwg->getLayer (0);
+
+    unique_ptr<CADGeometry> full(layer.getGeometry (1,
+                                                    CADFile::PROJECTION_ALL));
+    unique_ptr<CADGeometry> projected(layer.getGeometry (1));
+    ASSERT_EQ (projected->getType(), CADGeometry::GeometryType::CIRCLE);
+
+    CADCircle *fullCircle = static_cast<CADCircle *>( full.get () );
+    CADCircle *circle = static_cast<CADCircle *>( projected.get () );
+    ASSERT_NEAR (circle->getPosition().getX(),
+                 fullCircle->getPosition().getX(), 0.0001);
+    ASSERT_NEAR (circle->getRadius(), fullCircle->getRadius(), 0.0001);
+    ASSERT_NEAR (circle->getThickness(), fullCircle->getThickness(), 0.0001);
+    ASSERT_TRUE (circle->getEED ().empty ());
+
+    delete openedDwg;
+}
+
+TEST(reading_geometries, layer_and_type_filter)
+{
+    CADFile::ReadFilter filter;
+    filter.objectTypes = { CADObject::RAY };
+    auto openedDwg = OpenCADFile ("./data/r2000/5rays_3xlines.dwg",
+                                   CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_EQ (openedDwg->getLayersCount (), 1);
+    ASSERT_EQ (openedDwg->getLayer (0).getGeometryCount (), 5);
+    ASSERT_EQ (openedDwg->getLayer (0).getGeometryType (), CADObject::RAY);
+    delete openedDwg;
+
+    filter = CADFile::ReadFilter();
+    filter.layerNames = { "ROADS", "PARCELS" };
+    openedDwg = OpenCADFile ("./data/r2000/5rays_3xlines.dwg",
+                             CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_EQ (openedDwg->getLayersCount (), 0);
+    delete openedDwg;
+
+    filter.layerNames.insert ("0");
+    openedDwg = OpenCADFile ("./data/r2000/5rays_3xlines.dwg",
+                             CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_EQ (openedDwg->getLayersCount (), 1);
+    ASSERT_EQ (openedDwg->getLayer (0).getGeometryCount (), 8);
+    delete openedDwg;
+}
+
+TEST(reading_geometries, concurrent_cursors)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/256_lwpolylines_7vertexes.dwg",
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    const size_t geometryCount = openedDwg->getLayer (0).getGeometryCount ();
+
+    // 4 threads with own cursors and one reading through the shared file
+    const size_t threadCount = 5;
+    vector<size_t> vertexCounts(threadCount, 0);
+    vector<thread> threads;
+    for( size_t t = 0; t < threadCount; ++t )
+    {
+        threads.push_back (thread([&, t]()
+        {
+            unique_ptr<CADFileCursor> cursor(t + 1 < threadCount ?
+                                             openedDwg->createCursor () :
+                                             nullptr);
+            for( size_t i = 0; i < geometryCount; ++i )
+            {
+                unique_ptr<CADGeometry> geom(cursor ?
+                            cursor->getGeometry (0, i) :
+                            openedDwg->getLayer (0).getGeometry (i));
+                if( geom && geom->getType () == CADGeometry::LWPOLYLINE )
+                    vertexCounts[t] += static_cast<CADLWPolyline *>(
+                                geom.get ())->getVertexCount ();
+            }
+        }));
+    }
+    for( thread &worker : threads )
+        worker.join ();
+
+    for( size_t t = 0; t < threadCount; ++t )
+        ASSERT_EQ (vertexCounts[t], 256 * 7);
+
+    delete openedDwg;
+}
+
+TEST(reading_geometries, memory_buffer)
+{
+    ifstream file("./data/r2000/256_lwpolylines_7vertexes.dwg",
+                  ios_base::binary);
+    vector<char> content((istreambuf_iterator<char>(file)),
+                         istreambuf_iterator<char>());
+    ASSERT_FALSE (content.empty ());
+
+    // caller owned buffer, the extension tells the format
+    auto openedDwg = OpenCADFile (GetBufferFileIO ("upload.dwg", content.data (),
+                                                   content.size ()),
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_EQ (openedDwg->getLayer (0).getGeometryCount (), 256);
+    delete openedDwg;
+
+    // shared buffer outlives the caller copy, cursors read through the clones
+    shared_ptr<char> shared(new char[content.size ()], default_delete<char[]>());
+    memcpy (shared.get (), content.data (), content.size ());
+    openedDwg = OpenCADFile (GetBufferFileIO ("upload.dwg", shared,
+                                              content.size ()),
+                             CADFile::OpenOptions::READ_FAST);
+    shared.reset ();
+    ASSERT_NE (openedDwg, nullptr);
+    unique_ptr<CADFileCursor> cursor(openedDwg->createCursor ());
+    ASSERT_NE (cursor, nullptr);
+    size_t vertexCount = 0;
+    for( size_t i = 0; i < openedDwg->getLayer (0).getGeometryCount (); ++i )
+    {
+        unique_ptr<CADGeometry> geom(cursor->getGeometry (0, i));
+        if( geom && geom->getType () == CADGeometry::LWPOLYLINE )
+            vertexCount += static_cast<CADLWPolyline *>(
+                        geom.get ())->getVertexCount ();
+    }
+    ASSERT_EQ (vertexCount, 256 * 7);
+    cursor.reset ();
+    delete openedDwg;
+
+    // the buffer is read in place, the streams have no span
+    size_t nSize = 0;
+    unique_ptr<CADFileIO> buffer(GetBufferFileIO ("upload.dwg", content.data (),
+                                                  content.size ()));
+    ASSERT_EQ (buffer->GetData (nSize), content.data ());
+    ASSERT_EQ (nSize, content.size ());
+    unique_ptr<CADFileIO> stream(GetDefaultFileIO (
+                                     "./data/r2000/256_lwpolylines_7vertexes.dwg"));
+    ASSERT_EQ (stream->GetData (nSize), nullptr);
+
+    // the DXF entities are parsed later from the caller buffer itself
+    ifstream dxfFile("./data/dxf/entities.dxf", ios_base::binary);
+    vector<char> dxf((istreambuf_iterator<char>(dxfFile)),
+                     istreambuf_iterator<char>());
+    unique_ptr<CADFile> openedDxf(OpenCADFile (
+                GetBufferFileIO ("upload.dxf", dxf.data (), dxf.size ()),
+                CADFile::OpenOptions::READ_FAST));
+    ASSERT_NE (openedDxf, nullptr);
+    const string pattern = "30\r\n  8\r\nLines\r\n 62\r\n3\r\n 10\r\n";
+    auto start = search (dxf.begin (), dxf.end (), pattern.begin (),
+                         pattern.end ());
+    ASSERT_NE (start, dxf.end ());
+    start[pattern.size ()] = '7';
+    size_t linesCount = 0;
+    for( size_t i = 0; i < openedDxf->getLayersCount (); ++i )
+    {
+        CADLayer &layer = openedDxf->getLayer (i);
+        if( layer.getName () != "Lines" )
+            continue;
+        unique_ptr<CADGeometry> geom(layer.getGeometry (0));
+        ASSERT_EQ (geom->getType (), CADGeometry::LINE);
+        ASSERT_EQ (static_cast<CADLine *>(geom.get ())->getStart ()
+                   .getPosition ().getX (), 7.0);
+        ++linesCount;
+    }
+    ASSERT_EQ (linesCount, 1);
+}
+
+// Local stand-in for the remote storage, counts the requests.
+class CountingIO : public CADFileIO
+{
+public:
+    explicit CountingIO(const char* pszFilePath) : CADFileIO(pszFilePath),
+        backend(GetDefaultFileIO (pszFilePath)), reads(0), bytes(0) {}
+    explicit CountingIO(CADFileIO* poBackend) :
+        CADFileIO(poBackend->GetFilePath ()), backend(poBackend), reads(0),
+        bytes(0) {}
+    virtual ~CountingIO() { delete backend; }
+
+    virtual const char* ReadLine() override { return backend->ReadLine (); }
+    virtual bool Eof() override { return backend->Eof (); }
+    virtual bool Open(int mode) override
+    {
+        return m_bIsOpened = backend->Open (mode);
+    }
+    virtual bool Close() override
+    {
+        backend->Close ();
+        return CADFileIO::Close ();
+    }
+    virtual int Seek(long int offset, SeekOrigin origin) override
+    {
+        return backend->Seek (offset, origin);
+    }
+    virtual long int Tell() override { return backend->Tell (); }
+    virtual size_t Read(void* ptr, size_t size) override
+    {
+        ++reads;
+        bytes += size;
+        return backend->Read (ptr, size);
+    }
+    virtual size_t Write(void*, size_t) override { return 0; }
+    virtual void Rewind() override { backend->Rewind (); }
+
+    CADFileIO* backend;
+    size_t reads;
+    size_t bytes;
+};
+
+TEST(reading_geometries, block_cache)
+{
+    const char* pszPath = "./data/r2000/24127_circles_128_lines.dwg";
+    CountingIO* remote = new CountingIO(pszPath);
+    CADCachedIO* cached = new CADCachedIO(remote, 4096, 32, 8);
+    auto openedDwg = OpenCADFile (cached, CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+
+    CADLayer &layer = openedDwg->getLayer (0);
+    size_t circlesCount = 0;
+    for( size_t i = 0; i < layer.getGeometryCount (); ++i )
+    {
+        unique_ptr<CADGeometry> geom(layer.getGeometry (i));
+        if( geom->getType () == CADGeometry::CIRCLE )
+            ++circlesCount;
+    }
+    ASSERT_EQ (circlesCount, 24127);
+
+    // the decoder small reads are served by a few large backend reads
+    const CADCachedIO::Statistics &stats = cached->getStatistics ();
+    ASSERT_EQ (remote->reads, stats.backendReads);
+    ASSERT_LT (stats.backendReads * 50, stats.reads);
+    ASSERT_GT (stats.getHitRate (), 0.9);
+    ASSERT_GE (stats.bytesFetched, stats.bytesRead / 50);
+    delete openedDwg;
+
+    // reads crossing the block boundaries and the end of file
+    CADCachedIO small(GetDefaultFileIO (pszPath), 16, 2, 4);
+    unique_ptr<CADFileIO> plain(GetDefaultFileIO (pszPath));
+    ASSERT_TRUE (small.Open (CADFileIO::read | CADFileIO::binary));
+    ASSERT_TRUE (plain->Open (CADFileIO::read | CADFileIO::binary));
+    char abyCached[100], abyPlain[100];
+    const long anOffsets[] = { 0, 5, 30, 1000, 7, -40 };
+    for( long offset : anOffsets )
+    {
+        CADFileIO::SeekOrigin origin = offset < 0 ? CADFileIO::SeekOrigin::END :
+                                                    CADFileIO::SeekOrigin::BEG;
+        ASSERT_EQ (small.Seek (offset, origin), 0);
+        ASSERT_EQ (plain->Seek (offset, origin), 0);
+        long position = small.Tell ();
+        size_t nRead = small.Read (abyCached, sizeof (abyCached));
+        ASSERT_EQ (nRead, plain->Read (abyPlain, sizeof (abyPlain)));
+        ASSERT_EQ (memcmp (abyCached, abyPlain, nRead), 0);
+        ASSERT_EQ (small.Tell (), position + long(nRead));
+    }
+    ASSERT_TRUE (small.Eof ());
+}
+
+TEST(reading_geometries, compressed_input)
+{
+    const char* pszArchive = "./data/r2000/4solids.dwg.gz";
+    unique_ptr<CADFileIO> archive(GetDefaultFileIO (pszArchive));
+    if( strcmp (archive->GetFilePath (), pszArchive) == 0 )
+        return; // built without zlib
+    ASSERT_STREQ (archive->GetFilePath (), "./data/r2000/4solids.dwg");
+
+    // BGZF blocks are read at random offsets as the plain file is
+    unique_ptr<CADFileIO> plain(GetDefaultFileIO ("./data/r2000/4solids.dwg"));
+    ASSERT_TRUE (archive->Open (CADFileIO::read | CADFileIO::binary));
+    ASSERT_TRUE (plain->Open (CADFileIO::read | CADFileIO::binary));
+    ASSERT_EQ (archive->Seek (0, CADFileIO::SeekOrigin::END), 0);
+    ASSERT_EQ (plain->Seek (0, CADFileIO::SeekOrigin::END), 0);
+    ASSERT_EQ (archive->Tell (), plain->Tell ());
+    char abyArchive[40000], abyPlain[40000];
+    const long anOffsets[] = { 100000, 16380, 0, 170000 };
+    for( long offset : anOffsets )
+    {
+        ASSERT_EQ (archive->Seek (offset, CADFileIO::SeekOrigin::BEG), 0);
+        ASSERT_EQ (plain->Seek (offset, CADFileIO::SeekOrigin::BEG), 0);
+        size_t nRead = archive->Read (abyArchive, sizeof (abyArchive));
+        ASSERT_EQ (nRead, plain->Read (abyPlain, sizeof (abyPlain)));
+        ASSERT_EQ (memcmp (abyArchive, abyPlain, nRead), 0);
+    }
+    ASSERT_TRUE (archive->Eof ());
+
+    auto openedDwg = OpenCADFile (pszArchive, CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    unique_ptr<CADFileCursor> cursor(openedDwg->createCursor ());
+    ASSERT_NE (cursor, nullptr);
+    ASSERT_EQ (openedDwg->getLayer (0).getGeometryCount (), 4);
+    for( size_t i = 0; i < 4; ++i )
+    {
+        unique_ptr<CADGeometry> geom(cursor->getGeometry (0, i));
+        ASSERT_EQ (geom->getType (), CADGeometry::SOLID);
+    }
+    cursor.reset ();
+    delete openedDwg;
+
+    // single member archive is indexed by inflating it
+    openedDwg = OpenCADFile ("./data/r2000/1arc.dwg.gz",
+                             CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    ASSERT_EQ (openedDwg->getLayer (0).getGeometryCount (), 1);
+    unique_ptr<CADGeometry> arc(openedDwg->getLayer (0).getGeometry (0));
+    ASSERT_EQ (arc->getType (), CADGeometry::ARC);
+    delete openedDwg;
+}
+
+TEST(reading_geometries, gzip_access_points)
+{
+    // the plain gzip of more than a megabyte is split inside its only member
+    const char* pszPath = "./data/r2000/24127_circles_128_lines.dwg";
+    const char* pszArchive = "./data/r2000/24127_circles_128_lines.dwg.gz";
+    ifstream file(pszArchive, ios::binary);
+    vector<char> archiveData((istreambuf_iterator<char>(file)),
+                             istreambuf_iterator<char>());
+    ASSERT_FALSE (archiveData.empty ());
+    CountingIO* remote = new CountingIO(GetBufferFileIO (pszArchive,
+                             archiveData.data (), archiveData.size ()));
+    unique_ptr<CADFileIO> archive(GetCompressedFileIO (remote));
+    if( nullptr == archive )
+    {
+        delete remote;
+        return; // built without zlib
+    }
+    unique_ptr<CADFileIO> plain(GetDefaultFileIO (pszPath));
+    ASSERT_TRUE (archive->Open (CADFileIO::read | CADFileIO::binary));
+    ASSERT_TRUE (plain->Open (CADFileIO::read | CADFileIO::binary));
+    ASSERT_EQ (archive->Seek (0, CADFileIO::SeekOrigin::END), 0);
+    ASSERT_EQ (plain->Seek (0, CADFileIO::SeekOrigin::END), 0);
+    ASSERT_EQ (archive->Tell (), plain->Tell ());
+    const size_t nArchiveSize = remote->bytes;
+
+    // the tail is inflated from the access point, not from the member start
+    remote->bytes = 0;
+    vector<char> abyArchive(300000), abyPlain(300000);
+    ASSERT_EQ (archive->Seek (-1000, CADFileIO::SeekOrigin::END), 0);
+    ASSERT_EQ (plain->Seek (-1000, CADFileIO::SeekOrigin::END), 0);
+    ASSERT_EQ (archive->Read (abyArchive.data (), 1000), 1000);
+    ASSERT_EQ (plain->Read (abyPlain.data (), 1000), 1000);
+    ASSERT_EQ (memcmp (abyArchive.data (), abyPlain.data (), 1000), 0);
+    ASSERT_GT (remote->bytes, 0);
+    ASSERT_LT (remote->bytes, nArchiveSize / 2);
+
+    // reads crossing the frames boundaries
+    const long anOffsets[] = { 1000000, 0, 900000, 1200000, 1048000 };
+    for( long offset : anOffsets )
+    {
+        ASSERT_EQ (archive->Seek (offset, CADFileIO::SeekOrigin::BEG), 0);
+        ASSERT_EQ (plain->Seek (offset, CADFileIO::SeekOrigin::BEG), 0);
+        size_t nRead = archive->Read (abyArchive.data (), abyArchive.size ());
+        ASSERT_EQ (nRead, plain->Read (abyPlain.data (), abyPlain.size ()));
+        ASSERT_EQ (memcmp (abyArchive.data (), abyPlain.data (), nRead), 0);
+    }
+    archive.reset ();
+
+    auto openedDwg = OpenCADFile (pszArchive, CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    CADLayer &layer = openedDwg->getLayer (0);
+    size_t circlesCount = 0;
+    for( size_t i = 0; i < layer.getGeometryCount (); ++i )
+    {
+        unique_ptr<CADGeometry> geom(layer.getGeometry (i));
+        if( geom->getType () == CADGeometry::CIRCLE )
+            ++circlesCount;
+    }
+    ASSERT_EQ (circlesCount, 24127);
+    delete openedDwg;
+}
+
+TEST(reading_geometries, async_reader)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/256_lwpolylines_7vertexes.dwg",
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    const size_t geometryCount = openedDwg->getLayer (0).getGeometryCount ();
+    {
+        CADAsyncReader reader(openedDwg, 3);
+
+        vector< future<CADGeometry*> > geometries;
+        for( size_t i = 0; i < geometryCount; ++i )
+            geometries.push_back (reader.getGeometry (0, i));
+
+        size_t vertexCount = 0;
+        reader.readGeometries (0, [&vertexCount](CADGeometry* geometry)
+        {
+            unique_ptr<CADGeometry> geom(geometry);
+            vertexCount += static_cast<CADLWPolyline *>(
+                        geom.get ())->getVertexCount ();
+            return true;
+        }).wait ();
+        ASSERT_EQ (vertexCount, 256 * 7);
+
+        // stop after the first geometry
+        ASSERT_EQ (reader.readGeometries (0, [](CADGeometry* geometry)
+        {
+            delete geometry;
+            return false;
+        }).get (), 1);
+
+        for( future<CADGeometry*> &geometry : geometries )
+        {
+            unique_ptr<CADGeometry> geom(geometry.get ());
+            ASSERT_NE (geom, nullptr);
+            ASSERT_EQ (geom->getType (), CADGeometry::LWPOLYLINE);
+        }
+    }
+
+    // two files read by the readers sharing one pool
+    unique_ptr<CADFile> circlesDwg(OpenCADFile ("./data/r2000/triple_circles.dwg",
+                                               CADFile::OpenOptions::READ_FAST));
+    ASSERT_NE (circlesDwg, nullptr);
+    {
+        CADThreadPool pool(2);
+        CADAsyncReader polylines(openedDwg, pool);
+        CADAsyncReader circles(circlesDwg.get (), pool);
+        vector< future<CADGeometry*> > polylineGeometries, circleGeometries;
+        for( size_t i = 0; i < geometryCount; ++i )
+        {
+            polylineGeometries.push_back (polylines.getGeometry (0, i));
+            circleGeometries.push_back (circles.getGeometry (0, i % 3));
+        }
+        for( size_t i = 0; i < geometryCount; ++i )
+        {
+            unique_ptr<CADGeometry> polyline(polylineGeometries[i].get ());
+            unique_ptr<CADGeometry> circle(circleGeometries[i].get ());
+            ASSERT_EQ (polyline->getType (), CADGeometry::LWPOLYLINE);
+            ASSERT_EQ (circle->getType (), CADGeometry::CIRCLE);
+        }
+        ASSERT_EQ (pool.getThreadCount (), 2);
+    }
+
+    delete openedDwg;
+}
+
+TEST(reading_geometries, compute_extents)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    {
+        CADExtents extents;
+        vector<CADExtents> layerExtents;
+        ASSERT_EQ (openedDwg->computeExtents (extents, &layerExtents, 1),
+                   CADErrorCodes::SUCCESS);
+        ASSERT_FALSE (extents.isEmpty ());
+        ASSERT_EQ (layerExtents.size (), openedDwg->getLayersCount ());
+
+        // the same extents in parallel
+        CADExtents parallelExtents;
+        ASSERT_EQ (openedDwg->computeExtents (parallelExtents, nullptr, 4),
+                   CADErrorCodes::SUCCESS);
+        ASSERT_EQ (parallelExtents.getMin ().getX (), extents.getMin ().getX ());
+        ASSERT_EQ (parallelExtents.getMax ().getY (), extents.getMax ().getY ());
+
+        // the analytic bounds are the limit of the fine tessellation
+        CADExtents tessellated;
+        const CADTessellator tessellator(1e-6);
+        CADLayer &layer = openedDwg->getLayer (0);
+        for( size_t i = 0; i < layer.getGeometryCount (); ++i )
+        {
+            unique_ptr<CADGeometry> geometry(layer.getGeometry (i));
+            vector<CADVector> vertexes;
+            tessellator.tessellate (geometry.get (), vertexes);
+            for( const CADVector& vertex : vertexes )
+                tessellated.add (vertex);
+        }
+        ASSERT_NEAR (tessellated.getMin ().getX (),
+                     layerExtents[0].getMin ().getX (), 1e-5);
+        ASSERT_NEAR (tessellated.getMin ().getY (),
+                     layerExtents[0].getMin ().getY (), 1e-5);
+        ASSERT_NEAR (tessellated.getMax ().getX (),
+                     layerExtents[0].getMax ().getX (), 1e-5);
+        ASSERT_NEAR (tessellated.getMax ().getY (),
+                     layerExtents[0].getMax ().getY (), 1e-5);
+    }
+    delete openedDwg;
+
+    // the arc bounds include the crossed quadrant points only
+    CADArc arc;
+    arc.setPosition (CADVector(0.0, 0.0, 0.0));
+    arc.setRadius (2.0);
+    arc.setStartingAngle (acos(-1.0) / 4);
+    arc.setEndingAngle (acos(-1.0) * 3 / 4);
+    CADExtents arcExtents;
+    ASSERT_TRUE (arcExtents.addGeometry (&arc));
+    ASSERT_NEAR (arcExtents.getMax ().getY (), 2.0, 1e-12);
+    ASSERT_NEAR (arcExtents.getMin ().getY (), sqrt(2.0), 1e-12);
+    ASSERT_NEAR (arcExtents.getMax ().getX (), sqrt(2.0), 1e-12);
+}
+
+TEST(reading_geometries, compute_extents_clockwise_bulge)
+{
+    // the negative bulge is the clockwise arc, above the chord here
+    CADLWPolyline polyline;
+    polyline.addVertex (CADVector(0.0, 0.0));
+    polyline.addVertex (CADVector(2.0, 0.0));
+    polyline.setVectExtrusion (CADVector(0.0, 0.0, 1.0));
+    polyline.setBulges (vector<double>{ -1.0 });
+    CADExtents extents;
+    ASSERT_TRUE (extents.addGeometry (&polyline));
+    ASSERT_NEAR (extents.getMax ().getY (), 1.0, 1e-12);
+    ASSERT_NEAR (extents.getMin ().getY (), 0.0, 1e-12);
+    ASSERT_NEAR (extents.getMax ().getX (), 2.0, 1e-12);
+
+    // three quarters clockwise from (1, 0) to (0, 1) cross three extremes
+    polyline.setVertexes (vector<CADVector>{ CADVector(1.0, 0.0),
+                                             CADVector(0.0, 1.0) });
+    polyline.setBulges (vector<double>{ -tan(acos(-1.0) * 3 / 8) });
+    CADExtents threeQuarters;
+    ASSERT_TRUE (threeQuarters.addGeometry (&polyline));
+    ASSERT_NEAR (threeQuarters.getMin ().getX (), -1.0, 1e-12);
+    ASSERT_NEAR (threeQuarters.getMin ().getY (), -1.0, 1e-12);
+    ASSERT_NEAR (threeQuarters.getMax ().getX (), 1.0, 1e-12);
+    ASSERT_NEAR (threeQuarters.getMax ().getY (), 1.0, 1e-12);
+}
+
+TEST(reading_geometries, scan_objects_map)
+{
+    auto linkedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (linkedDwg, nullptr);
+
+    CADFile::ReadFilter filter;
+    filter.scanObjectsMap = true;
+    filter.scanThreadCount = 4;
+    auto scannedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                   CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (scannedDwg, nullptr);
+    filter.keepEntitiesOrder = true;
+    auto orderedDwg = OpenCADFile ("./data/r2000/24127_circles_128_lines.dwg",
+                                   CADFile::OpenOptions::READ_FAST, filter);
+    ASSERT_NE (orderedDwg, nullptr);
+
+    ASSERT_EQ (scannedDwg->getLayersCount (), linkedDwg->getLayersCount ());
+    CADLayer &linkedLayer = linkedDwg->getLayer (0);
+    CADLayer &scannedLayer = scannedDwg->getLayer (0);
+    CADLayer &orderedLayer = orderedDwg->getLayer (0);
+    ASSERT_EQ (linkedLayer.getGeometryCount (), 24127 + 128);
+    ASSERT_EQ (scannedLayer.getGeometryCount (),
+               linkedLayer.getGeometryCount ());
+    ASSERT_EQ (orderedLayer.getGeometryCount (),
+               linkedLayer.getGeometryCount ());
+
+    // the model space order is restored
+    size_t nCircles = 0;
+    for( size_t i = 0; i < linkedLayer.getGeometryCount (); ++i )
+    {
+        unique_ptr<CADGeometry> linked(linkedLayer.getGeometry (i));
+        unique_ptr<CADGeometry> scanned(scannedLayer.getGeometry (i));
+        unique_ptr<CADGeometry> ordered(orderedLayer.getGeometry (i));
+        ASSERT_NE (linked, nullptr);
+        ASSERT_NE (scanned, nullptr);
+        ASSERT_NE (ordered, nullptr);
+        ASSERT_EQ (ordered->getType (), linked->getType ());
+        if( scanned->getType () == CADGeometry::CIRCLE )
+            ++nCircles;
+    }
+    ASSERT_EQ (nCircles, 24127);
+
+    delete orderedDwg;
+    delete scannedDwg;
+    delete linkedDwg;
+}
+
+TEST(reading_dxf, file_lines)
+{
+    const char* pszPath = "./data/dxf/entities.dxf";
+    ifstream file(pszPath, ios_base::binary);
+    vector<char> content((istreambuf_iterator<char>(file)),
+                         istreambuf_iterator<char>());
+    ASSERT_FALSE (content.empty ());
+
+    // the file lines are the same as the buffer ones, without the CR LF
+    unique_ptr<CADFileIO> stream(GetDefaultFileIO (pszPath));
+    unique_ptr<CADFileIO> buffer(GetBufferFileIO (pszPath, content.data (),
+                                                  content.size ()));
+    ASSERT_TRUE (stream->Open (CADFileIO::OpenMode::read));
+    ASSERT_TRUE (buffer->Open (CADFileIO::OpenMode::read));
+    size_t lines = 0;
+    while( const char* pszExpected = buffer->ReadLine () )
+    {
+        const char* pszLine = stream->ReadLine ();
+        ASSERT_NE (pszLine, nullptr);
+        ASSERT_STREQ (pszLine, pszExpected);
+        ++lines;
+    }
+    ASSERT_EQ (stream->ReadLine (), nullptr);
+    ASSERT_TRUE (stream->Eof ());
+    ASSERT_GT (lines, 100);
+
+    // the last line without the line end
+    {
+        ofstream unterminated("lines.txt", ios_base::binary);
+        unterminated << "first\r\n\r\nlast";
+    }
+    stream.reset (GetDefaultFileIO ("lines.txt"));
+    ASSERT_TRUE (stream->Open (CADFileIO::OpenMode::read));
+    ASSERT_STREQ (stream->ReadLine (), "first");
+    ASSERT_STREQ (stream->ReadLine (), "");
+    ASSERT_STREQ (stream->ReadLine (), "last");
+    ASSERT_EQ (stream->ReadLine (), nullptr);
+    stream.reset ();
+    remove ("lines.txt");
+}
+
+TEST(reading_dxf, ascii_entities)
+{
+    ASSERT_EQ (IdentifyCADFile (GetDefaultFileIO ("./data/dxf/entities.dxf")),
+               CADVersions::DXF_R2000);
+    auto openedDxf = OpenCADFile ("./data/dxf/entities.dxf",
+                                  CADFile::OpenOptions::READ_ALL);
+    ASSERT_NE (openedDxf, nullptr);
+
+    const CADHeader &header = openedDxf->getHeader ();
+    ASSERT_EQ (header.get<CADHeader::OPENCADVER>(), CADVersions::DXF_R2000);
+    ASSERT_EQ (header.get<CADHeader::EXTMIN>().getY (), -2.5);
+    ASSERT_EQ (header.getValue (CADHeader::LTSCALE).getReal (), 1.5);
+    ASSERT_STREQ (header.getValue (CADHeader::CLAYER).getString ().c_str (),
+                  "Lines");
+    ASSERT_EQ (header.getValue (CADHeader::HANDSEED).getHandle ().getAsLong (),
+               0x2F);
+    ASSERT_EQ (openedDxf->getClasses ().getClassByNum (500).sCppClassName,
+               "AcDbDictionaryWithDefault");
+
+    // the table layers, then the layers used by entities only
+    ASSERT_EQ (openedDxf->getLayersCount (), 4);
+    CADLayer &layer0 = openedDxf->getLayer (0);
+    CADLayer &lines = openedDxf->getLayer (1);
+    CADLayer &frozen = openedDxf->getLayer (2);
+    CADLayer &implicit = openedDxf->getLayer (3);
+    ASSERT_EQ (lines.getName (), "Lines");
+    ASSERT_TRUE (lines.getLocked ());
+    ASSERT_EQ (lines.getLineWeight (), 25);
+    ASSERT_TRUE (frozen.getFrozen ());
+    ASSERT_FALSE (frozen.getOn ());
+    ASSERT_EQ (implicit.getName (), "Implicit");
+
+    // the paper space line is skipped
+    ASSERT_EQ (lines.getGeometryCount (), 3);
+    unique_ptr<CADGeometry> geometry(lines.getGeometry (0));
+    ASSERT_EQ (geometry->getType (), CADGeometry::LINE);
+    CADLine *line = static_cast<CADLine*>(geometry.get ());
+    ASSERT_EQ (line->getEnd ().getPosition ().getX (), 10.0);
+    ASSERT_EQ (line->getColor ().G, 255);
+    ASSERT_EQ (line->getColor ().B, 0);
+
+    geometry.reset (lines.getGeometry (1));
+    ASSERT_EQ (geometry->getType (), CADGeometry::LWPOLYLINE);
+    CADLWPolyline *lwPolyline = static_cast<CADLWPolyline*>(geometry.get ());
+    ASSERT_EQ (lwPolyline->getVertexCount (), 4);
+    ASSERT_TRUE (lwPolyline->getClosed ());
+    ASSERT_EQ (lwPolyline->getBulges ().size (), 4);
+    ASSERT_EQ (lwPolyline->getBulges ()[1], 1.0);
+
+    geometry.reset (lines.getGeometry (2));
+    ASSERT_EQ (geometry->getType (), CADGeometry::POLYLINE3D);
+    CADPolyline3D *polyline = static_cast<CADPolyline3D*>(geometry.get ());
+    ASSERT_EQ (polyline->getVertexCount (), 3);
+    ASSERT_EQ (polyline->getVertex (2).getZ (), 6.0);
+
+    ASSERT_EQ (implicit.getGeometryCount (), 3);
+    geometry.reset (implicit.getGeometry (0));
+    ASSERT_EQ (geometry->getType (), CADGeometry::ARC);
+    ASSERT_NEAR (static_cast<CADArc*>(geometry.get ())->getEndingAngle (),
+                 acos (-1.0) / 2, 1e-12);
+    geometry.reset (implicit.getGeometry (1));
+    ASSERT_EQ (geometry->getType (), CADGeometry::TEXT);
+    ASSERT_EQ (static_cast<CADText*>(geometry.get ())->getTextValue (),
+               "Hello DXF");
+    ASSERT_EQ (static_cast<CADText*>(geometry.get ())->getHeight (), 0.25);
+    geometry.reset (implicit.getGeometry (2));
+    ASSERT_EQ (geometry->getType (), CADGeometry::SPLINE);
+    CADSpline *spline = static_cast<CADSpline*>(geometry.get ());
+    ASSERT_EQ (spline->getDegree (), 3);
+    ASSERT_EQ (spline->getControlPoints ().size (), 4);
+    ASSERT_EQ (spline->getKnots ().size (), 8);
+
+    // the block entities are placed by the insert
+    ASSERT_EQ (layer0.getGeometryCount (), 3);
+    geometry.reset (layer0.getGeometry (1));
+    ASSERT_EQ (geometry->getType (), CADGeometry::LINE);
+    line = static_cast<CADLine*>(geometry.get ());
+    ASSERT_NEAR (line->getStart ().getPosition ().getX (), 10.0, 1e-12);
+    ASSERT_NEAR (line->getEnd ().getPosition ().getX (), 12.0, 1e-12);
+    ASSERT_NEAR (line->getEnd ().getPosition ().getY (), 10.0, 1e-12);
+    geometry.reset (layer0.getGeometry (2));
+    ASSERT_EQ (geometry->getType (), CADGeometry::CIRCLE);
+    ASSERT_NEAR (static_cast<CADCircle*>(geometry.get ())->getPosition ().getY (),
+                 10.0, 1e-12);
+
+    delete openedDxf;
+
+    // the fast float parser agrees with the stream parser
+    const char * values[] = { "0.1", "-123.456", "1e-5", "  42", "6.02214076e23",
+                              "3.141592653589793238", "1.7976931348623157E308" };
+    for( const char * value : values )
+    {
+        istringstream stream(value);
+        double expected = 0.0;
+        stream >> expected;
+        ASSERT_EQ (DXFParseDouble (value, strlen (value)), expected);
+    }
+}
+
+TEST(reading_dxf, repeated_inserts)
+{
+    unique_ptr<CADFile> openedDxf(OpenCADFile ("./data/dxf/inserts.dxf",
+                                              CADFile::OpenOptions::READ_ALL));
+    ASSERT_NE (openedDxf, nullptr);
+    ASSERT_EQ (openedDxf->getLayersCount (), 1);
+    CADLayer &layer0 = openedDxf->getLayer (0);
+
+    // every insert places its own copy of the block line and arc
+    ASSERT_EQ (layer0.getGeometryCount (), 12);
+    const double starts[][2] = { { 10.0, 0.0 }, { 20.0, 0.0 }, { 0.0, 10.0 },
+                                 { 5.0, 10.0 }, { 30.0, 0.0 }, { 40.0, 0.0 } };
+    for(size_t i = 0; i < 6; ++i)
+    {
+        unique_ptr<CADGeometry> geometry(layer0.getGeometry (i * 2));
+        ASSERT_EQ (geometry->getType (), CADGeometry::LINE);
+        CADLine *line = static_cast<CADLine*>(geometry.get ());
+        ASSERT_NEAR (line->getStart ().getPosition ().getX (), starts[i][0], 1e-12);
+        ASSERT_NEAR (line->getStart ().getPosition ().getY (), starts[i][1], 1e-12);
+    }
+
+    // the arc inside the rotated and scaled insert
+    const double pi = acos (-1.0);
+    unique_ptr<CADGeometry> geometry(layer0.getGeometry (1));
+    ASSERT_EQ (geometry->getType (), CADGeometry::ARC);
+    CADArc *arc = static_cast<CADArc*>(geometry.get ());
+    ASSERT_NEAR (arc->getPosition ().getX (), 10.0, 1e-12);
+    ASSERT_NEAR (arc->getPosition ().getY (), 2.0, 1e-12);
+    ASSERT_NEAR (arc->getRadius (), 1.0, 1e-12);
+    ASSERT_NEAR (arc->getStartingAngle (), pi / 2, 1e-12);
+    ASSERT_NEAR (arc->getEndingAngle (), pi, 1e-12);
+    ASSERT_NEAR (arc->getExtrusion ().getZ (), 1.0, 1e-12);
+
+    // the nested insert composes both placements
+    geometry.reset (layer0.getGeometry (7));
+    arc = static_cast<CADArc*>(geometry.get ());
+    ASSERT_NEAR (arc->getPosition ().getX (), 6.0, 1e-12);
+    ASSERT_NEAR (arc->getPosition ().getY (), 10.0, 1e-12);
+    ASSERT_NEAR (arc->getRadius (), 0.5, 1e-12);
+
+    // the mirrored insert flips the arc extrusion and keeps its sweep
+    geometry.reset (layer0.getGeometry (9));
+    arc = static_cast<CADArc*>(geometry.get ());
+    ASSERT_NEAR (arc->getPosition ().getX (), 29.0, 1e-12);
+    ASSERT_NEAR (arc->getExtrusion ().getZ (), -1.0, 1e-12);
+    ASSERT_NEAR (arc->getStartingAngle (), 0.0, 1e-12);
+    ASSERT_NEAR (arc->getEndingAngle (), pi / 2, 1e-12);
+
+    // the non-uniformly scaled insert turns the arc into the ellipse
+    geometry.reset (layer0.getGeometry (11));
+    ASSERT_EQ (geometry->getType (), CADGeometry::ELLIPSE);
+    CADEllipse *ellipse = static_cast<CADEllipse*>(geometry.get ());
+    ASSERT_NEAR (ellipse->getPosition ().getX (), 42.0, 1e-12);
+    ASSERT_NEAR (ellipse->getPosition ().getY (), 0.0, 1e-12);
+    ASSERT_NEAR (ellipse->getSMAxis ().getX (), 1.0, 1e-12);
+    ASSERT_NEAR (ellipse->getSMAxis ().getY (), 0.0, 1e-12);
+    ASSERT_NEAR (ellipse->getAxisRatio (), 0.5, 1e-12);
+    ASSERT_NEAR (ellipse->getStartingAngle (), 0.0, 1e-12);
+    ASSERT_NEAR (ellipse->getEndingAngle (), pi / 2, 1e-12);
+}
+
+TEST(reading_geometries, transform_sheared_arc)
+{
+    // the rotation inside the non-uniform scale shears the arc plane
+    const double pi = acos (-1.0);
+    CADArc arc;
+    arc.setPosition (CADVector(0.0, 0.0, 0.0));
+    arc.setRadius (1.0);
+    arc.setStartingAngle (0.0);
+    arc.setEndingAngle (pi / 2);
+    Matrix matrix;
+    matrix.scale (CADVector(2.0, 1.0));
+    matrix.rotate (pi / 4);
+    ASSERT_FALSE (arc.isTransformedToCircle (matrix));
+
+    CADEllipse ellipse(arc);
+    ellipse.transform (matrix);
+    CADVector major = ellipse.getSMAxis ();
+    const double ratio = ellipse.getAxisRatio ();
+    ASSERT_LT (ratio, 1.0);
+    ASSERT_NEAR (ellipse.getExtrusion ().getZ (), 1.0, 1e-12);
+    // the axes lengths keep the area and the sum of squares of the diameters
+    double majorLength = sqrt (major.getX () * major.getX () +
+                               major.getY () * major.getY ());
+    ASSERT_NEAR (majorLength * majorLength * ratio, 2.0, 1e-12);
+    ASSERT_NEAR (majorLength * majorLength * (1 + ratio * ratio), 5.0, 1e-12);
+
+    // the end points are the transformed arc end points
+    auto point = [&](double t) {
+        return CADVector(major.getX () * cos (t) - major.getY () * ratio * sin (t),
+                         major.getY () * cos (t) + major.getX () * ratio * sin (t));
+    };
+    CADVector start = point (ellipse.getStartingAngle ());
+    CADVector end = point (ellipse.getEndingAngle ());
+    ASSERT_NEAR (start.getX (), sqrt (2.0), 1e-12);
+    ASSERT_NEAR (start.getY (), sqrt (0.5), 1e-12);
+    ASSERT_NEAR (end.getX (), -sqrt (2.0), 1e-12);
+    ASSERT_NEAR (end.getY (), sqrt (0.5), 1e-12);
+}
+
+TEST(reading_dxf, binary_entities)
+{
+    ASSERT_EQ (IdentifyCADFile (GetDefaultFileIO ("./data/dxf/entities_binary.dxf")),
+               CADVersions::DXF_R2000);
+    unique_ptr<CADFile> ascii(OpenCADFile ("./data/dxf/entities.dxf",
+                                           CADFile::OpenOptions::READ_ALL));
+    unique_ptr<CADFile> binary(OpenCADFile ("./data/dxf/entities_binary.dxf",
+                                            CADFile::OpenOptions::READ_ALL));
+    ASSERT_NE (ascii, nullptr);
+    ASSERT_NE (binary, nullptr);
+
+    const CADHeader &header = binary->getHeader ();
+    ASSERT_EQ (header.get<CADHeader::EXTMIN>().getY (), -2.5);
+    ASSERT_EQ (header.getValue (CADHeader::LTSCALE).getReal (), 1.5);
+    ASSERT_EQ (header.getValue (CADHeader::HANDSEED).getHandle ().getAsLong (),
+               0x2F);
+    ASSERT_EQ (binary->getClasses ().getClassByNum (500).sCppClassName,
+               "AcDbDictionaryWithDefault");
+    ASSERT_TRUE (binary->getLayer (1).getLocked ());
+    ASSERT_EQ (binary->getLayer (1).getLineWeight (), 25);
+
+    // the binary file has the same geometries as the ASCII one
+    ASSERT_EQ (binary->getLayersCount (), ascii->getLayersCount ());
+    for( size_t i = 0; i < ascii->getLayersCount (); ++i )
+    {
+        CADLayer &asciiLayer = ascii->getLayer (i);
+        CADLayer &binaryLayer = binary->getLayer (i);
+        ASSERT_EQ (binaryLayer.getName (), asciiLayer.getName ());
+        ASSERT_EQ (binaryLayer.getColor (), asciiLayer.getColor ());
+        ASSERT_EQ (binaryLayer.getGeometryCount (),
+                   asciiLayer.getGeometryCount ());
+        for( size_t j = 0; j < asciiLayer.getGeometryCount (); ++j )
+        {
+            unique_ptr<CADGeometry> asciiGeometry(asciiLayer.getGeometry (j));
+            unique_ptr<CADGeometry> binaryGeometry(binaryLayer.getGeometry (j));
+            ASSERT_EQ (binaryGeometry->getType (), asciiGeometry->getType ());
+            ASSERT_EQ (binaryGeometry->getThickness (),
+                       asciiGeometry->getThickness ());
+        }
+    }
+
+    unique_ptr<CADGeometry> geometry(binary->getLayer (1).getGeometry (1));
+    ASSERT_EQ (geometry->getType (), CADGeometry::LWPOLYLINE);
+    ASSERT_EQ (static_cast<CADLWPolyline*>(geometry.get ())->getBulges ()[1],
+               1.0);
+    geometry.reset (binary->getLayer (3).getGeometry (1));
+    ASSERT_EQ (static_cast<CADText*>(geometry.get ())->getTextValue (),
+               "Hello DXF");
+}
+
+TEST(reading_dwg, r2004_pages)
+{
+    // file header mask is the pseudo random sequence
+    char abyHeader[8] = {0};
+    DecryptR2004Header (abyHeader, sizeof (abyHeader));
+    const unsigned char abyMask[] = { 0x29, 0x23, 0xBE, 0x84,
+                                      0xE1, 0x6C, 0xD6, 0xAE };
+    ASSERT_EQ (memcmp (abyHeader, abyMask, sizeof (abyMask)), 0);
+
+    // 8 literals, the overlapping match of 5 bytes at distance 1, the match
+    // of 4 bytes at distance 13 followed by 1 literal, end of stream
+    const char abyCompressed[] = { 0x05, 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
+                                   0x60, 0x00, 0x22, 0x31, 0x00, 'Z', 0x11 };
+    vector<char> data(64);
+    size_t nSize = 0;
+    ASSERT_TRUE (DecompressR2004 (abyCompressed, sizeof (abyCompressed),
+                                  data.data (), data.size (), nSize));
+    ASSERT_EQ (string(data.data (), nSize), "ABCDEFGHHHHHHABCDZ");
+
+    // truncated stream and too small buffer are rejected
+    ASSERT_FALSE (DecompressR2004 (abyCompressed, sizeof (abyCompressed) - 1,
+                                   data.data (), data.size (), nSize));
+    ASSERT_FALSE (DecompressR2004 (abyCompressed, sizeof (abyCompressed),
+                                   data.data (), 12, nSize));
+}
+
+/**
+ * @brief Append the R2007 Reed-Solomon parity to the data, the generator
+ * roots are a^0 ... a^(parity - 1) in GF(2^8) of the 0x11D polynomial
+ */
+static void encodeReedSolomonR2007(unsigned char * pabyBlock, size_t nDataSize)
+{
+    unsigned char abyExp[510];
+    unsigned char abyLog[256] = { 0 };
+    unsigned int x = 1;
+    for( int i = 0; i < 255; ++i )
+    {
+        abyExp[i] = abyExp[i + 255] = static_cast<unsigned char>(x);
+        abyLog[x] = static_cast<unsigned char>(i);
+        x = ( x << 1 ) ^ ( x & 0x80 ? 0x11D : 0 );
+    }
+    auto mul = [&](unsigned char a, unsigned char b) -> unsigned char
+    {
+        return a == 0 || b == 0 ? 0 : abyExp[abyLog[a] + abyLog[b]];
+    };
+
+    // generator polynomial, the highest degree first
+    const size_t nParity = 255 - nDataSize;
+    vector<unsigned char> generator(1, 1);
+    for( size_t i = 0; i < nParity; ++i )
+    {
+        generator.push_back (0);
+        for( size_t j = generator.size () - 1; j > 0; --j )
+            generator[j] ^= mul (generator[j - 1], abyExp[i]);
+    }
+
+    vector<unsigned char> remainder(nParity, 0);
+    for( size_t i = 0; i < nDataSize; ++i )
+    {
+        unsigned char factor = pabyBlock[i] ^ remainder[0];
+        remainder.erase (remainder.begin ());
+        remainder.push_back (0);
+        for( size_t j = 0; j < nParity; ++j )
+            remainder[j] ^= mul (generator[j + 1], factor);
+    }
+    memcpy (pabyBlock + nDataSize, remainder.data (), nParity);
+}
+
+TEST(reading_dwg, r2007_pages)
+{
+    // the byte j of the block i is stored at j * blocks + i, 11 blocks check
+    // both the 8 blocks and the single block paths
+    const size_t nBlocks = 11;
+    const size_t nDataSize = 239;
+    vector<char> encoded(nBlocks * 255);
+    for( size_t i = 0; i < nBlocks; ++i )
+    {
+        unsigned char abyBlock[255];
+        for( size_t j = 0; j < nDataSize; ++j )
+            abyBlock[j] = static_cast<unsigned char>(i * 7 + j);
+        encodeReedSolomonR2007 (abyBlock, nDataSize);
+        for( size_t j = 0; j < 255; ++j )
+            encoded[j * nBlocks + i] = static_cast<char>(abyBlock[j]);
+    }
+    // wrong data and parity bytes are corrected
+    encoded[5 * nBlocks + 9] ^= 0x5A;
+    encoded[250 * nBlocks + 2] ^= 0x01;
+    vector<char> decoded(nBlocks * nDataSize);
+    ASSERT_EQ (DeinterleaveR2007 (encoded.data (), nBlocks, nDataSize,
+                                  decoded.data ()), 0);
+    for( size_t i = 0; i < nBlocks; ++i )
+        for( size_t j = 0; j < nDataSize; ++j )
+            ASSERT_EQ (decoded[i * nDataSize + j], static_cast<char>(i * 7 + j));
+
+    // 8 literals, the match of 4 bytes at distance 8 followed by 2 literals
+    // which are stored in reverse order
+    const char abyCompressed[] = { 0x00, 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H',
+                                   0x47, 0x02, 'X', 'Y' };
+    vector<char> data(64);
+    size_t nSize = 0;
+    ASSERT_TRUE (DecompressR2007 (abyCompressed, sizeof (abyCompressed),
+                                  data.data (), data.size (), nSize));
+    ASSERT_EQ (string(data.data (), nSize), "ABCDEFGHABCDYX");
+    ASSERT_FALSE (DecompressR2007 (abyCompressed, sizeof (abyCompressed),
+                                   data.data (), 10, nSize));
+
+    // TU string: BS length with 01 code and 8 bit value, UTF-16LE characters
+    vector<bool> bits = { false, true };
+    auto addByte = [&bits](unsigned char byte)
+    {
+        for( int i = 7; i >= 0; --i )
+            bits.push_back ((byte >> i) & 1);
+    };
+    addByte (3);
+    for( unsigned short code : { 0x0041, 0x00E9, 0x20AC } )
+    {
+        addByte (code & 0xFF);
+        addByte (code >> 8);
+    }
+    vector<char> tu(bits.size () / 8 + 4, 0);
+    for( size_t i = 0; i < bits.size (); ++i )
+        if( bits[i] )
+            tu[i / 8] |= static_cast<char>(0x80 >> (i % 8));
+    size_t nBitOffset = 0;
+    ASSERT_EQ (ReadTU (tu.data (), nBitOffset), "A\xC3\xA9\xE2\x82\xAC");
+    ASSERT_EQ (nBitOffset, bits.size ());
+}
+
+/**
+ * @brief Check the entities of the R2004 and R2007 drawings: the layers 0,
+ * Walls, Text and Grid, the model space lists the entities without links
+ */
+static void checkEntitiesDrawing(CADFileIO * poFileIO,
+                                 const string& sTextValue)
+{
+    unique_ptr<CADFile> openedDwg(OpenCADFile (poFileIO,
+                                               CADFile::OpenOptions::READ_FAST));
+    ASSERT_NE (openedDwg.get (), nullptr);
+    ASSERT_EQ (openedDwg->getLayersCount (), 4);
+
+    const char * apszNames[] = { "0", "Walls", "Text", "Grid" };
+    const size_t anCounts[] = { 1, 3, 1, 2000 };
+    for( size_t i = 0; i < 4; ++i )
+    {
+        ASSERT_EQ (openedDwg->getLayer (i).getName (), apszNames[i]);
+        ASSERT_EQ (openedDwg->getLayer (i).getGeometryCount (), anCounts[i]);
+    }
+    ASSERT_EQ (openedDwg->getLayer (1).getColor (), 1);
+
+    unique_ptr<CADGeometry> geometry(openedDwg->getLayer (0).getGeometry (0));
+    ASSERT_EQ (geometry->getType (), CADGeometry::LINE);
+    CADLine * line = static_cast<CADLine *>(geometry.get ());
+    ASSERT_EQ (line->getStart ().getPosition ().getX (), 1.0);
+    ASSERT_EQ (line->getEnd ().getPosition ().getX (), 11.0);
+
+    // the circle has the true color of the ACI 5
+    geometry.reset (openedDwg->getLayer (1).getGeometry (0));
+    ASSERT_EQ (geometry->getType (), CADGeometry::CIRCLE);
+    ASSERT_EQ (static_cast<CADCircle *>(geometry.get ())->getRadius (), 2.5);
+    ASSERT_EQ (geometry->getColor ().R, 0);
+    ASSERT_EQ (geometry->getColor ().B, 255);
+
+    geometry.reset (openedDwg->getLayer (1).getGeometry (2));
+    ASSERT_EQ (geometry->getType (), CADGeometry::LWPOLYLINE);
+    CADLWPolyline * polyline = static_cast<CADLWPolyline *>(geometry.get ());
+    ASSERT_EQ (polyline->getVertexCount (), 4);
+    ASSERT_TRUE (polyline->getClosed ());
+    ASSERT_EQ (polyline->getBulges ()[1], 0.5);
+
+    geometry.reset (openedDwg->getLayer (2).getGeometry (0));
+    ASSERT_EQ (geometry->getType (), CADGeometry::TEXT);
+    ASSERT_EQ (static_cast<CADText *>(geometry.get ())->getTextValue (),
+               sTextValue);
+
+    // the grid lines take several pages of the objects section
+    geometry.reset (openedDwg->getLayer (3).getGeometry (1999));
+    ASSERT_EQ (geometry->getType (), CADGeometry::LINE);
+    line = static_cast<CADLine *>(geometry.get ());
+    ASSERT_EQ (line->getStart ().getPosition ().getX (), 1999.0);
+    ASSERT_EQ (line->getEnd ().getPosition ().getY (), 100.0);
+}
+
+TEST(reading_dwg, r2004_entities)
+{
+    checkEntitiesDrawing (GetDefaultFileIO ("./data/r2004/entities.dwg"),
+                          "Hello R2004");
+}
+
+TEST(reading_dwg, r2007_entities)
+{
+    checkEntitiesDrawing (GetDefaultFileIO ("./data/r2007/entities.dwg"),
+                          "Gr\xC3\xBC\xC3\x9F" "e R2007 \xE2\x9C\x93");
+}
+
+TEST(reading_dwg, r2007_error_correction)
+{
+    // 8 wrong bytes of the system block are corrected, 9 are not
+    unsigned char abyBlock[255];
+    for( size_t j = 0; j < 239; ++j )
+        abyBlock[j] = static_cast<unsigned char>(j * 13);
+    encodeReedSolomonR2007 (abyBlock, 239);
+    char abyCorrupted[255];
+    memcpy (abyCorrupted, abyBlock, sizeof (abyCorrupted));
+    for( size_t i = 0; i < 8; ++i )
+        abyCorrupted[i * 31] ^= static_cast<char>(0x11 + i);
+    ASSERT_TRUE (CorrectReedSolomonR2007 (abyCorrupted, 239));
+    ASSERT_EQ (memcmp (abyCorrupted, abyBlock, sizeof (abyCorrupted)), 0);
+    for( size_t i = 0; i < 9; ++i )
+        abyCorrupted[i * 29 + 1] ^= static_cast<char>(0x21 + i);
+    ASSERT_FALSE (CorrectReedSolomonR2007 (abyCorrupted, 239));
+
+    // the data block corrects 2 wrong bytes
+    encodeReedSolomonR2007 (abyBlock, 251);
+    memcpy (abyCorrupted, abyBlock, sizeof (abyCorrupted));
+    abyCorrupted[17] ^= 0x80;
+    abyCorrupted[253] ^= 0x7F;
+    ASSERT_TRUE (CorrectReedSolomonR2007 (abyCorrupted, 251));
+    ASSERT_EQ (memcmp (abyCorrupted, abyBlock, sizeof (abyCorrupted)), 0);
+
+    // a wrong byte in the file header and in the blocks of the pages
+    ifstream file("./data/r2007/entities.dwg", ios_base::binary);
+    vector<char> content((istreambuf_iterator<char>(file)),
+                         istreambuf_iterator<char>());
+    ASSERT_FALSE (content.empty ());
+    content[0x80 + 5] ^= 0x40;
+    for( size_t i = 0x480; i < content.size (); i += 4099 )
+        content[i] ^= 0x40;
+    checkEntitiesDrawing (GetBufferFileIO ("corrupted.dwg", content.data (),
+                                           content.size ()),
+                          "Gr\xC3\xBC\xC3\x9F" "e R2007 \xE2\x9C\x93");
+
+    // the block which can not be corrected is read as is: the first of
+    // the 3 file header blocks has 9 wrong bytes in its unused CRCs
+    vector<char> encoded(8 * 255);
+    for( size_t i = 0; i < 9; ++i )
+        encoded[i * 29 * 8] ^= 0x40;
+    vector<char> decoded(8 * 239);
+    ASSERT_EQ (DeinterleaveR2007 (encoded.data (), 8, 239, decoded.data ()), 1);
+    for( size_t i = 0; i < 9; ++i )
+        ASSERT_EQ (decoded[i * 29], 0x40);
+    for( size_t i = 0; i < 9; ++i )
+        content[0x80 + i * 3] ^= 0x40;
+    checkEntitiesDrawing (GetBufferFileIO ("corrupted.dwg", content.data (),
+                                           content.size ()),
+                          "Gr\xC3\xBC\xC3\x9F" "e R2007 \xE2\x9C\x93");
+}
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "opencad_api.h"
+#include "cadgeometry.h"
+#include "cadsimplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+TEST(simplification, pyramid)
+{
+    // the small noise is dropped, the spike is kept
+    vector<CADVector> line;
+    for( int i = 0; i <= 100; ++i )
+        line.push_back (CADVector(i, i == 50 ? 10.0 : (i % 2) * 0.01));
+    for( CADSimplifier::Method method : { CADSimplifier::DOUGLAS_PEUCKER,
+                                          CADSimplifier::VISVALINGAM } )
+    {
+        vector<size_t> indexes = CADSimplifier::simplify (line, 0.5, method);
+        ASSERT_EQ (indexes.front (), 0);
+        ASSERT_EQ (indexes.back (), 100);
+        ASSERT_NE (find (indexes.begin (), indexes.end (), 50), indexes.end ());
+        ASSERT_LT (indexes.size (), 10);
+    }
+
+    // the closed ring does not collapse
+    vector<CADVector> ring = { CADVector(0, 0), CADVector(1, 0),
+                               CADVector(1, 1), CADVector(0, 1),
+                               CADVector(0, 0) };
+    ASSERT_EQ (CADSimplifier::simplify (ring, 10.0,
+                                        CADSimplifier::DOUGLAS_PEUCKER,
+                                        true).size (), 4);
+
+    auto openedDwg = OpenCADFile ("./data/r2000/256_lwpolylines_7vertexes.dwg",
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    {
+        const vector<double> tolerances = { 1e-9, 1e9 };
+        CADGeometryPyramid pyramid(openedDwg, tolerances, 7);
+        ASSERT_EQ (pyramid.build (), CADErrorCodes::SUCCESS);
+        ASSERT_EQ (pyramid.getVertexes (0, 0, 1e-10), nullptr);
+        ASSERT_EQ (pyramid.getVertexes (0, 0, 1.0)->size (), 7);
+        ASSERT_EQ (pyramid.getVertexes (0, 0, 1e10)->size (), 2);
+
+        unique_ptr<CADGeometry> geom(pyramid.getGeometry (0, 0, 1e10));
+        ASSERT_EQ (static_cast<CADLWPolyline *>(
+                       geom.get ())->getVertexCount (), 2);
+
+        ASSERT_EQ (pyramid.save ("pyramid.bin"), CADErrorCodes::SUCCESS);
+        CADGeometryPyramid loaded(openedDwg, tolerances, 7);
+        ASSERT_EQ (loaded.load ("pyramid.bin"), CADErrorCodes::SUCCESS);
+        ASSERT_EQ (loaded.getVertexes (0, 255, 1e10)->size (), 2);
+        CADGeometryPyramid other(openedDwg, { 1.0 }, 7);
+        ASSERT_EQ (other.load ("pyramid.bin"), CADErrorCodes::FILE_PARSE_FAILED);
+        remove ("pyramid.bin");
+    }
+    delete openedDwg;
+}
+
+static bool isSelfCrossing(const vector<CADVector>& line,
+                           const vector<size_t>& indexes)
+{
+    auto orientation = [](const CADVector& a, const CADVector& b,
+                          const CADVector& c) {
+        return (b.getX () - a.getX ()) * (c.getY () - a.getY ()) -
+               (b.getY () - a.getY ()) * (c.getX () - a.getX ());
+    };
+    for( size_t i = 0; i + 1 < indexes.size (); ++i )
+        for( size_t j = i + 2; j + 1 < indexes.size (); ++j )
+        {
+            const CADVector& a = line[indexes[i]];
+            const CADVector& b = line[indexes[i + 1]];
+            const CADVector& c = line[indexes[j]];
+            const CADVector& d = line[indexes[j + 1]];
+            if( orientation (a, b, c) * orientation (a, b, d) < 0.0 &&
+                orientation (c, d, a) * orientation (c, d, b) < 0.0 )
+                return true;
+        }
+    return false;
+}
+
+TEST(simplification, topology)
+{
+    // the chords which cross only the simplified line
+    vector<CADVector> peucker = { CADVector(3, 4), CADVector(0, 4),
+                                  CADVector(5, 8), CADVector(9, 6),
+                                  CADVector(1, 1), CADVector(1, 4) };
+    vector<size_t> indexes = CADSimplifier::simplify (
+                peucker, 3.0, CADSimplifier::DOUGLAS_PEUCKER, true);
+    ASSERT_FALSE (isSelfCrossing (peucker, indexes));
+    ASSERT_EQ (indexes, vector<size_t>({ 0, 1, 2, 3, 5 }));
+
+    vector<CADVector> visvalingam = { CADVector(3, 2), CADVector(1, 1),
+                                      CADVector(9, 0), CADVector(7, 6),
+                                      CADVector(2, 1), CADVector(3, 1) };
+    indexes = CADSimplifier::simplify (visvalingam, 3.0,
+                                       CADSimplifier::VISVALINGAM, true);
+    ASSERT_FALSE (isSelfCrossing (visvalingam, indexes));
+    ASSERT_EQ (indexes, vector<size_t>({ 0, 1, 2, 3, 5 }));
+
+    // the long noisy spiral
+    vector<CADVector> spiral;
+    for( int i = 0; i < 20000; ++i )
+    {
+        double angle = i * 0.01;
+        double radius = 1.0 + angle * 0.2 + (i % 3) * 0.01;
+        spiral.push_back (CADVector(radius * cos(angle), radius * sin(angle)));
+    }
+    for( CADSimplifier::Method method : { CADSimplifier::DOUGLAS_PEUCKER,
+                                          CADSimplifier::VISVALINGAM } )
+    {
+        indexes = CADSimplifier::simplify (spiral, 0.5, method, true);
+        ASSERT_LT (indexes.size (), spiral.size () / 10);
+        ASSERT_FALSE (isSelfCrossing (spiral, indexes));
+    }
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "cadgeometry.h"
+#include "cadtessellate.h"
+
+#include <cmath>
+#include <vector>
+
+TEST(tessellation, curves)
+{
+    const double tolerance = 0.01;
+    CADTessellator tessellator(tolerance);
+
+    CADCircle circle;
+    circle.setPosition (CADVector(10.0, 20.0, 0.0));
+    circle.setExtrusion (CADVector(0.0, 0.0, 1.0));
+    circle.setRadius (5.0);
+    vector<CADVector> vertexes;
+    size_t nCount = tessellator.tessellate (&circle, vertexes);
+    ASSERT_EQ (nCount, vertexes.size ());
+    ASSERT_EQ (nCount, tessellator.getArcSegments (5.0, 2 * acos(-1.0)) + 1);
+    for( size_t i = 0; i + 1 < nCount; ++i )
+    {
+        // vertexes on the circle, chords midpoints within tolerance
+        double dx = vertexes[i].getX () - 10.0, dy = vertexes[i].getY () - 20.0;
+        ASSERT_NEAR (sqrt(dx * dx + dy * dy), 5.0, 1e-9);
+        double mx = (vertexes[i].getX () + vertexes[i + 1].getX ()) / 2 - 10.0;
+        double my = (vertexes[i].getY () + vertexes[i + 1].getY ()) / 2 - 20.0;
+        ASSERT_LE (5.0 - sqrt(mx * mx + my * my), tolerance);
+    }
+
+    // the small buffer gets only its capacity, the count is full
+    double xyz[3 * 4];
+    ASSERT_EQ (tessellator.tessellate (&circle, xyz, 4), nCount);
+    ASSERT_NEAR (xyz[0], 15.0, 1e-9);
+    ASSERT_NEAR (xyz[1], 20.0, 1e-9);
+
+    // closed polyline of two half circles
+    CADLWPolyline polyline;
+    polyline.addVertex (CADVector(0.0, 0.0));
+    polyline.addVertex (CADVector(2.0, 0.0));
+    polyline.setBulges ({ 1.0, 1.0 });
+    polyline.setClosed (true);
+    vertexes.clear ();
+    nCount = tessellator.tessellate (&polyline, vertexes);
+    ASSERT_EQ (nCount, 2 * tessellator.getArcSegments (1.0, acos(-1.0)) + 1);
+    ASSERT_NEAR (vertexes.back ().getX (), 0.0, 1e-12);
+    double minY = 0.0, maxY = 0.0;
+    for( const CADVector& vertex : vertexes )
+    {
+        minY = min(minY, vertex.getY ());
+        maxY = max(maxY, vertex.getY ());
+    }
+    // the first segment goes counterclockwise, below the chord
+    ASSERT_NEAR (minY, -1.0, 1e-9);
+    ASSERT_NEAR (maxY, 1.0, 1e-9);
+}
@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+#include "opencad_api.h"
+#include "cadsimplify.h"
+#include "cadvectortile.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Minimal protocol buffers reader to check the vector tiles
+static uint64_t readVarint(const string& data, size_t& offset)
+{
+    uint64_t value = 0;
+    for( int shift = 0; offset < data.size (); shift += 7 )
+    {
+        unsigned char byte = static_cast<unsigned char>(data[offset++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if( !(byte & 0x80) )
+            break;
+    }
+    return value;
+}
+
+static map<int, vector<string> > readMessage(const string& data)
+{
+    map<int, vector<string> > fields;
+    size_t offset = 0;
+    while( offset < data.size () )
+    {
+        uint64_t key = readVarint (data, offset);
+        if( (key & 0x7) == 2 )
+        {
+            size_t length = static_cast<size_t>(readVarint (data, offset));
+            fields[static_cast<int>(key >> 3)].push_back (
+                        data.substr (offset, length));
+            offset += length;
+        }
+        else
+            fields[static_cast<int>(key >> 3)].push_back (
+                        to_string (readVarint (data, offset)));
+    }
+    return fields;
+}
+
+TEST(vector_tiles, lwpolylines)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/256_lwpolylines_7vertexes.dwg",
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    {
+        CADVectorTileGenerator generator(openedDwg);
+        string tile;
+        ASSERT_EQ (generator.getTile (0, 0, 0, tile),
+                   CADErrorCodes::INVALID_TILE);
+        ASSERT_EQ (generator.buildIndex (), CADErrorCodes::SUCCESS);
+        ASSERT_EQ (generator.getTile (0, 1, 0, tile),
+                   CADErrorCodes::INVALID_TILE);
+
+        ASSERT_EQ (generator.getTile (0, 0, 0, tile), CADErrorCodes::SUCCESS);
+        auto layers = readMessage (tile)[3];
+        ASSERT_EQ (layers.size (), 1);
+        auto layer = readMessage (layers[0]);
+        ASSERT_EQ (layer[1][0], "0");
+        ASSERT_EQ (layer[2].size (), 256);
+        ASSERT_EQ (layer[5][0], "4096");
+        auto feature = readMessage (layer[2][0]);
+        ASSERT_EQ (feature[3][0], "2"); // LINESTRING
+
+        // the quarter tiles together have every polyline
+        size_t features = 0;
+        for( int x = 0; x < 2; ++x )
+            for( int y = 0; y < 2; ++y )
+            {
+                ASSERT_EQ (generator.getTile (1, x, y, tile),
+                           CADErrorCodes::SUCCESS);
+                auto tileLayers = readMessage (tile)[3];
+                for( const string& encoded : tileLayers )
+                    features += readMessage (encoded)[2].size ();
+            }
+        ASSERT_GE (features, 256);
+    }
+    delete openedDwg;
+}
+
+TEST(vector_tiles, pyramid_levels)
+{
+    auto openedDwg = OpenCADFile ("./data/r2000/256_lwpolylines_7vertexes.dwg",
+                                  CADFile::OpenOptions::READ_FAST);
+    ASSERT_NE (openedDwg, nullptr);
+    {
+        CADGeometryPyramid pyramid(openedDwg, { 1e-9, 1.0 }, 7);
+        ASSERT_EQ (pyramid.build (), CADErrorCodes::SUCCESS);
+        CADVectorTileGenerator generator(openedDwg, 64);
+        ASSERT_EQ (generator.buildIndex (), CADErrorCodes::SUCCESS);
+
+        // half of the 0/0/0 pixel is over 1.0, the coarse level is taken
+        string decoded, simplified;
+        ASSERT_EQ (generator.getTile (0, 0, 0, decoded), CADErrorCodes::SUCCESS);
+        generator.setPyramid (&pyramid);
+        ASSERT_EQ (generator.getTile (0, 0, 0, simplified),
+                   CADErrorCodes::SUCCESS);
+        ASSERT_LT (simplified.size (), decoded.size ());
+        auto layers = readMessage (simplified)[3];
+        ASSERT_EQ (layers.size (), 1);
+        ASSERT_EQ (readMessage (layers[0])[2].size (), 256);
+
+        // the deeper zoom gets the whole lines
+        generator.setPyramid (nullptr);
+        ASSERT_EQ (generator.getTile (3, 2, 3, decoded), CADErrorCodes::SUCCESS);
+        generator.setPyramid (&pyramid);
+        ASSERT_EQ (generator.getTile (3, 2, 3, simplified),
+                   CADErrorCodes::SUCCESS);
+        ASSERT_FALSE (decoded.empty ());
+        ASSERT_EQ (simplified, decoded);
+    }
+    delete openedDwg;
+}